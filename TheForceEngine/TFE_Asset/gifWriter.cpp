@@ -4,6 +4,10 @@
 #include <TFE_FileSystem/paths.h>
 #include <assert.h>
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 #include <map>
@@ -11,58 +15,227 @@
 #define MSF_GIF_IMPL
 #include "msf_gif.h"
 
+// Encoding is done on a worker thread, frames are handed off through a small queue.
+// This bounds the memory used by frames waiting to be encoded.
+#define GIF_FRAME_QUEUE_SIZE 4
+
 namespace TFE_GIF
 {
+	struct GifFrame
+	{
+		std::vector<u8> image;
+		s32 centiseconds;
+	};
+
 	static MsfGifState s_gifState;
 	static s32 s_centisecondsPerFrame;
 	static s32 s_width;
 	static s32 s_height;
 	static char s_path[TFE_MAX_PATH];
+	static FileStream s_file;
+	static bool s_fileError = false;
+
+	// Frame queue, shared between the main thread and the encoder.
+	static GifFrame s_frames[GIF_FRAME_QUEUE_SIZE];
+	static std::vector<GifFrame*> s_freeFrames;
+	static std::deque<GifFrame*> s_pendingFrames;
+	static std::mutex s_frameMutex;
+	static std::condition_variable s_frameReady;
+	static std::thread s_encoder;
+	static bool s_encoding = false;
+	static bool s_finish = false;
 
-	static std::vector<u8> s_tempBuffer;
+	// Stats.
+	static u32 s_encodedCount;
+	static u32 s_droppedCount;
+	static f64 s_encodeTime;
+	static f64 s_encodeTimeMax;
+
+	void encoderThread();
+
+	// Write out all of the encoded blocks and start a new (empty) block list so that
+	// the encoded data does not accumulate in memory while recording.
+	void streamEncodedBlocks()
+	{
+		if (!s_gifState.listHead) { return; }
+
+		for (u8* node = s_gifState.listHead; node;)
+		{
+			MsfBufferHeader* header = (MsfBufferHeader*)node;
+			if (!s_fileError && header->size)
+			{
+				s_file.writeBuffer(node + sizeof(MsfBufferHeader), (u32)header->size);
+			}
+			node = header->next;
+			MSF_GIF_FREE(s_gifState.customAllocatorContext, header, sizeof(MsfBufferHeader) + header->size);
+		}
+
+		MsfBufferHeader* empty = (MsfBufferHeader*)MSF_GIF_MALLOC(s_gifState.customAllocatorContext, sizeof(MsfBufferHeader));
+		if (empty)
+		{
+			empty->next = nullptr;
+			empty->size = 0;
+		}
+		s_gifState.listHead = (u8*)empty;
+		s_gifState.listTail = (u8*)empty;
+	}
 
 	bool startGif(const char* path, u32 width, u32 height, u32 fps)
 	{
+		// Finish any recording still in progress.
+		if (s_encoding) { write(); }
+
 		memset(&s_gifState, 0, sizeof(MsfGifState));
-		msf_gif_begin(&s_gifState, width, height);
+		if (!msf_gif_begin(&s_gifState, width, height))
+		{
+			TFE_System::logWrite(LOG_ERROR, "GIF", "Cannot start GIF recording, out of memory.");
+			return false;
+		}
 
 		s_width = width;
 		s_height = height;
 
 		s_centisecondsPerFrame = s32(100.0f/f32(fps) + 0.5f);
 		strcpy(s_path, path);
-		
-		s_tempBuffer.resize(width * height * 4);
-		
+
+		s_fileError = !s_file.open(s_path, Stream::MODE_WRITE);
+		if (s_fileError)
+		{
+			TFE_System::logWrite(LOG_ERROR, "GIF", "Cannot open '%s' for writing.", s_path);
+		}
+		// Write the header right away.
+		streamEncodedBlocks();
+
+		s_freeFrames.clear();
+		s_pendingFrames.clear();
+		for (s32 i = 0; i < GIF_FRAME_QUEUE_SIZE; i++)
+		{
+			s_frames[i].image.resize(width * height * 4);
+			s_freeFrames.push_back(&s_frames[i]);
+		}
+
+		s_encodedCount = 0;
+		s_droppedCount = 0;
+		s_encodeTime = 0.0;
+		s_encodeTimeMax = 0.0;
+
+		s_finish = false;
+		s_encoding = true;
+		s_encoder = std::thread(encoderThread);
 		return true;
 	}
 
 	void addFrame(const u8* imageData)
 	{
-		// We have to flip the frame vertically.
-		u8* output = s_tempBuffer.data();
-		for (s32 y = 0; y < s_height; y++, output += s_width*4)
+		if (!s_encoding) { return; }
+
+		GifFrame* frame = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(s_frameMutex);
+			if (s_freeFrames.empty())
+			{
+				// The encoder is behind, drop the frame rather than stalling the game.
+				// The previous frame is shown for longer instead, so the timing stays correct.
+				// The queue cannot be empty here because the encoder only holds one frame at a time.
+				assert(!s_pendingFrames.empty());
+				if (!s_pendingFrames.empty())
+				{
+					s_pendingFrames.back()->centiseconds += s_centisecondsPerFrame;
+				}
+				s_droppedCount++;
+				return;
+			}
+			frame = s_freeFrames.back();
+			s_freeFrames.pop_back();
+		}
+
+		// The image is flipped vertically during encoding.
+		memcpy(frame->image.data(), imageData, frame->image.size());
+		frame->centiseconds = s_centisecondsPerFrame;
+
+		{
+			std::lock_guard<std::mutex> lock(s_frameMutex);
+			s_pendingFrames.push_back(frame);
+		}
+		s_frameReady.notify_one();
+	}
+
+	void encodeFrame(GifFrame* frame)
+	{
+		const f64 start = TFE_System::getTime();
+
+		// A negative pitch encodes the image bottom-up, which flips it to match the OpenGL framebuffer.
+		const s32 pitch = s_width * 4;
+		if (!msf_gif_frame(&s_gifState, frame->image.data(), frame->centiseconds, 16, -pitch))
 		{
-			memcpy(output, &imageData[(s_height - y - 1) * s_width * 4], s_width * 4);
+			if (!s_fileError)
+			{
+				TFE_System::logWrite(LOG_ERROR, "GIF", "Failed to encode GIF frame, out of memory.");
+			}
+			s_fileError = true;
 		}
+		streamEncodedBlocks();
 
-		msf_gif_frame(&s_gifState, s_tempBuffer.data(), s_centisecondsPerFrame, 16, s_width * 4);
+		const f64 encodeTime = TFE_System::getTime() - start;
+		s_encodeTime += encodeTime;
+		s_encodeTimeMax = std::max(s_encodeTimeMax, encodeTime);
+		s_encodedCount++;
+	}
+
+	void encoderThread()
+	{
+		while (true)
+		{
+			GifFrame* frame = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(s_frameMutex);
+				s_frameReady.wait(lock, [] { return !s_pendingFrames.empty() || s_finish; });
+				if (s_pendingFrames.empty()) { break; }
+
+				frame = s_pendingFrames.front();
+				s_pendingFrames.pop_front();
+			}
+
+			// Encoding happens outside of the lock; only this thread touches the GIF state while recording.
+			encodeFrame(frame);
+
+			std::lock_guard<std::mutex> lock(s_frameMutex);
+			s_freeFrames.push_back(frame);
+		}
 	}
 
 	bool write()
 	{
-		MsfGifResult result = msf_gif_end(&s_gifState);
-		
-		FileStream file;
-		if (!file.open(s_path, Stream::MODE_WRITE))
+		if (!s_encoding) { return false; }
+
+		// Let the encoder finish the queued frames.
 		{
-			msf_gif_free(result);
-			return false;
+			std::lock_guard<std::mutex> lock(s_frameMutex);
+			s_finish = true;
 		}
-		file.writeBuffer(result.data, (u32)result.dataSize);
-		file.close();
+		s_frameReady.notify_one();
+		s_encoder.join();
+		s_encoding = false;
 
+		// The remaining data is just the trailer.
+		MsfGifResult result = msf_gif_end(&s_gifState);
+		if (!s_fileError && result.data)
+		{
+			s_file.writeBuffer(result.data, (u32)result.dataSize);
+		}
 		msf_gif_free(result);
-		return true;
+		s_file.close();
+
+		for (s32 i = 0; i < GIF_FRAME_QUEUE_SIZE; i++)
+		{
+			s_frames[i].image = std::vector<u8>();
+		}
+
+		if (s_encodedCount)
+		{
+			TFE_System::logWrite(LOG_MSG, "GIF", "Recorded %u frames to '%s', %u frames dropped. Encode time: %.2fms average, %.2fms max.",
+				s_encodedCount, s_path, s_droppedCount, 1000.0 * s_encodeTime / f64(s_encodedCount), 1000.0 * s_encodeTimeMax);
+		}
+		return !s_fileError;
 	}
-}
\ No newline at end of file
+}
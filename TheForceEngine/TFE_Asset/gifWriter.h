@@ -8,7 +8,10 @@
 
 namespace TFE_GIF
 {
+	// Frames are encoded on a worker thread and streamed to the file as they are encoded.
 	bool startGif(const char* path, u32 width, u32 height, u32 fps);
+	// Queue a frame for encoding, the frame is dropped if the encoder falls behind.
 	void addFrame(const u8* imageData);
+	// Finish encoding the queued frames and close the file.
 	bool write();
 }
@@ -243,7 +243,8 @@ namespace TFE_Sprite_Jedi
 		return asset;
 	}
 
-	static std::vector<u32> s_cellOffsets;
+	// Per thread, the editor decodes sprites on worker threads.
+	static thread_local std::vector<u32> s_cellOffsets;
 
 	bool isUniqueCell(u32 offset)
 	{
@@ -16,6 +16,8 @@
 #include <TFE_Audio/midi.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/IMuse/imList.h>
+#include <TFE_System/system.h>
+#include <vector>
 #include <cstring>
 #include <algorithm>
 #include <assert.h>
@@ -62,6 +64,7 @@ namespace TFE_Audio
 		FM4_TimbreCount = 167,
 		FM4_BankRemapMax = 27,
 		FM4_BankCenter = 68,
+		FM4_BlockSize = 256,	// Stereo samples rendered per OPL3 block.
 	};
 	const f32 c_outputScale = 1.5f / 32768.0f;	// slight volume boost to compete with other midi outputs.
 
@@ -69,7 +72,7 @@ namespace TFE_Audio
 	static const char* c_Output_Name = "FM4 Driver";
 
 	// This is stored internally, there will only be one FM chip (for now).
-	static opl3_chip s_fmChip = { 0 };
+	static opl3_chip s_fmChip = {};
 
 	Fm4Opl3Device::~Fm4Opl3Device()
 	{
@@ -120,7 +123,7 @@ namespace TFE_Audio
 	void Fm4Opl3Device::beginStream(s32 sampleRate)
 	{
 		assert(!m_streamActive);
-		s_fmChip = { 0 };
+		s_fmChip = {};
 		memset(m_registers, 0, FM4_RegisterCount * FM4_OutCount);
 
 		OPL3_Reset(&s_fmChip, sampleRate);
@@ -158,7 +161,7 @@ namespace TFE_Audio
 
 	void Fm4Opl3Device::exit()
 	{
-		s_fmChip = { 0 };
+		s_fmChip = {};
 		m_streamActive = false;
 	}
 		
@@ -171,15 +174,118 @@ namespace TFE_Audio
 	{
 		if (!m_streamActive) { return false; }
 
+		// Render in blocks, the OPL3 output is already in the 16-bit range so the conversion is a simple scale.
+		s16 left[FM4_BlockSize], right[FM4_BlockSize];
+		while (sampleCount)
+		{
+			const u32 count = std::min(sampleCount, (u32)FM4_BlockSize);
+			OPL3_GenerateResampledBlock(&s_fmChip, left, right, count);
+			for (u32 i = 0; i < count; i++)
+			{
+				buffer[i * 2 + 0] = f32(left[i])  * m_volumeScaled;
+				buffer[i * 2 + 1] = f32(right[i]) * m_volumeScaled;
+			}
+			buffer += count * 2;
+			sampleCount -= count;
+		}
+		return true;
+	}
+
+	// Benchmark register script: a fixed voice setup followed by key on/off events at a fixed sample interval,
+	// so both render paths see the same register writes at the same sample positions independent of the live device.
+	// The events go through the write buffer like the device does, so they land inside the native sample blocks.
+	enum BenchmarkConstants
+	{
+		FM4_BenchChannels      = 9,
+		FM4_BenchEventInterval = 2205,	// 50ms at 44.1kHz, deliberately not a multiple of the block size.
+		FM4_BenchRhythmEvents  = 8,		// Every fourth run of this many events plays in rhythm mode.
+	};
+	static const u16 c_benchFnum[] = { 0x157, 0x16b, 0x181, 0x198, 0x1b0, 0x1ca, 0x1e5, 0x202, 0x220, 0x241, 0x263, 0x287 };
+
+	static void fm4_benchmarkSetup(opl3_chip* chip)
+	{
+		OPL3_Reset(chip, FM4_SampleRate);
+		OPL3_WriteReg(chip, 0x100 | REG_MODE_REGISTER, VALUE_ENABLE);
+		for (u16 ch = 0; ch < FM4_BenchChannels; ch++)
+		{
+			const u16 op = (ch % 3) + (ch / 3) * 8;
+			for (u16 slot = 0; slot < 2; slot++)
+			{
+				const u16 reg = op + slot * 3;
+				OPL3_WriteReg(chip, REG_ENABLE_WAVE_SELECT + reg, 0x21 + ch);
+				OPL3_WriteReg(chip, REG_KSL_LEVEL + reg, slot ? 0x00 : 0x10 + ch * 2);
+				OPL3_WriteReg(chip, REG_ATTACK_DECAY + reg, 0xf2 + ch);
+				OPL3_WriteReg(chip, REG_SUSTAIN_RELEASE + reg, 0x54 + ch);
+				OPL3_WriteReg(chip, REG_WAVE_SELECT + reg, (ch + slot) & 7);
+			}
+			// Alternate between FM and additive connections, with feedback, and both outputs enabled.
+			OPL3_WriteReg(chip, REG_FEEDBACK_CONNECTION + ch, VALUE_VOICE_LEFT | VALUE_VOICE_RIGHT | ((ch & 3) << 1) | (ch & 1));
+		}
+	}
+
+	static void fm4_benchmarkEvent(opl3_chip* chip, u32 eventIndex)
+	{
+		// Each event toggles one channel, cycling through the channels and pitches.
+		const u16 ch = eventIndex % FM4_BenchChannels;
+		const bool keyOn = ((eventIndex / FM4_BenchChannels) & 1) == 0;
+		const u16 fnum = c_benchFnum[(eventIndex * 5) % TFE_ARRAYSIZE(c_benchFnum)];
+		const u16 block = 3 + (eventIndex % 3);
+		OPL3_WriteRegBuffered(chip, REG_FNUM_LOW + ch, fnum & 0xff);
+		OPL3_WriteRegBuffered(chip, REG_KEYON_BLOCK + ch, (keyOn ? VALUE_KEYON_BIT : 0) | (block << 2) | (fnum >> 8));
+
+		// Rhythm mode turns channels 6-8 into drums and keeps the block path on the per-sample fallback.
+		if (eventIndex % FM4_BenchRhythmEvents == 0)
+		{
+			const bool rhythm = (eventIndex / FM4_BenchRhythmEvents) % 4 == 3;
+			OPL3_WriteRegBuffered(chip, REG_PERCUSSION_REGISTER, rhythm ? 0x3f : 0x00);
+		}
+	}
+
+	// Render 'seconds' of the benchmark register script using both the per-sample and block paths.
+	// The per-sample path is the reference, returns true if the outputs match.
+	bool Fm4Opl3Device::benchmark(f32 seconds, f64* perSampleMs, f64* blockMs)
+	{
+		const u32 sampleCount = u32(seconds * FM4_SampleRate);
+		std::vector<s16> reference(sampleCount * 2);
+		std::vector<s16> left(sampleCount), right(sampleCount);
+
+		// The chip state is large, keep it off of the stack.
+		opl3_chip* chip = new opl3_chip;
+		fm4_benchmarkSetup(chip);
+		u64 start = TFE_System::getCurrentTimeInTicks();
 		for (u32 i = 0; i < sampleCount; i++)
 		{
-			s16 buf[2];
-			OPL3_GenerateResampled(&s_fmChip, buf);
-			
-			s16 left  = clamp(s32(buf[0]), INT16_MIN, INT16_MAX);
-			s16 right = clamp(s32(buf[1]), INT16_MIN, INT16_MAX);
-			*buffer++ = f32(left)  * m_volumeScaled;
-			*buffer++ = f32(right) * m_volumeScaled;
+			if (i % FM4_BenchEventInterval == 0)
+			{
+				fm4_benchmarkEvent(chip, i / FM4_BenchEventInterval);
+			}
+			OPL3_GenerateResampled(chip, &reference[i * 2]);
+		}
+		*perSampleMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+
+		fm4_benchmarkSetup(chip);
+		start = TFE_System::getCurrentTimeInTicks();
+		for (u32 i = 0; i < sampleCount; )
+		{
+			// Blocks are split at event boundaries so the register writes land on the same samples.
+			if (i % FM4_BenchEventInterval == 0)
+			{
+				fm4_benchmarkEvent(chip, i / FM4_BenchEventInterval);
+			}
+			const u32 toEvent = FM4_BenchEventInterval - (i % FM4_BenchEventInterval);
+			const u32 count = std::min(std::min(sampleCount - i, toEvent), (u32)FM4_BlockSize);
+			OPL3_GenerateResampledBlock(chip, &left[i], &right[i], count);
+			i += count;
+		}
+		*blockMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+		delete chip;
+
+		for (u32 i = 0; i < sampleCount; i++)
+		{
+			if (reference[i * 2] != left[i] || reference[i * 2 + 1] != right[i])
+			{
+				return false;
+			}
 		}
 		return true;
 	}
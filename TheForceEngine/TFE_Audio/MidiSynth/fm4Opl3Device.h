@@ -44,6 +44,9 @@ namespace TFE_Audio
 		bool selectOutput(s32 index) override;
 		s32  getActiveOutput(void) override;
 
+		// Compare the per-sample and block OPL3 render paths on a fixed register script, independent of the active device.
+		static bool benchmark(f32 seconds, f64* perSampleMs, f64* blockMs);
+
 	private:
 		enum
 		{
@@ -384,7 +384,8 @@ static void OPL3_EnvelopeUpdateKSL(opl3_slot *slot)
     slot->eg_ksl = (uint8_t)ksl;
 }
 
-static void OPL3_EnvelopeCalc(opl3_slot *slot)
+// TFE: The chip wide timing state is passed in, so the block path can step one slot over many samples.
+static void OPL3_EnvelopeStep(opl3_slot *slot, uint8_t trem, uint8_t eg_add, uint8_t eg_state, uint16_t timer)
 {
     uint8_t nonzero;
     uint8_t rate;
@@ -398,7 +399,7 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     uint8_t eg_off;
     uint8_t reset = 0;
     slot->eg_out = slot->eg_rout + (slot->reg_tl << 2)
-                 + (slot->eg_ksl >> kslshift[slot->reg_ksl]) + *slot->trem;
+                 + (slot->eg_ksl >> kslshift[slot->reg_ksl]) + trem;
     if (slot->key && slot->eg_gen == envelope_gen_num_release)
     {
         reset = 1;
@@ -435,13 +436,13 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     {
         rate_hi = 0x0f;
     }
-    eg_shift = rate_hi + slot->chip->eg_add;
+    eg_shift = rate_hi + eg_add;
     shift = 0;
     if (nonzero)
     {
         if (rate_hi < 12)
         {
-            if (slot->chip->eg_state)
+            if (eg_state)
             {
                 switch (eg_shift)
                 {
@@ -461,14 +462,14 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
         }
         else
         {
-            shift = (rate_hi & 0x03) + eg_incstep[rate_lo][slot->chip->timer & 0x03];
+            shift = (rate_hi & 0x03) + eg_incstep[rate_lo][timer & 0x03];
             if (shift & 0x04)
             {
                 shift = 0x03;
             }
             if (!shift)
             {
-                shift = slot->chip->eg_state;
+                shift = eg_state;
             }
         }
     }
@@ -531,6 +532,12 @@ static void OPL3_EnvelopeCalc(opl3_slot *slot)
     }
 }
 
+static void OPL3_EnvelopeCalc(opl3_slot *slot)
+{
+    opl3_chip *chip = slot->chip;
+    OPL3_EnvelopeStep(slot, *slot->trem, chip->eg_add, chip->eg_state, chip->timer);
+}
+
 static void OPL3_EnvelopeKeyOn(opl3_slot *slot, uint8_t type)
 {
     slot->key |= type;
@@ -545,24 +552,19 @@ static void OPL3_EnvelopeKeyOff(opl3_slot *slot, uint8_t type)
     Phase Generator
 */
 
-static void OPL3_PhaseGenerate(opl3_slot *slot)
+// TFE: Advance the phase accumulator and return the phase for this sample, vibpos is passed in for the block path.
+static uint16_t OPL3_PhaseStep(opl3_slot *slot, uint8_t vibpos)
 {
-    opl3_chip *chip;
     uint16_t f_num;
     uint32_t basefreq;
-    uint8_t rm_xor, n_bit;
-    uint32_t noise;
     uint16_t phase;
 
-    chip = slot->chip;
     f_num = slot->channel->f_num;
     if (slot->reg_vib)
     {
         int8_t range;
-        uint8_t vibpos;
 
         range = (f_num >> 7) & 7;
-        vibpos = slot->chip->vibpos;
 
         if (!(vibpos & 3))
         {
@@ -587,6 +589,18 @@ static void OPL3_PhaseGenerate(opl3_slot *slot)
         slot->pg_phase = 0;
     }
     slot->pg_phase += (basefreq * mt[slot->reg_mult]) >> 1;
+    return phase;
+}
+
+static void OPL3_PhaseGenerate(opl3_slot *slot)
+{
+    opl3_chip *chip;
+    uint8_t rm_xor, n_bit;
+    uint32_t noise;
+    uint16_t phase;
+
+    chip = slot->chip;
+    phase = OPL3_PhaseStep(slot, chip->vibpos);
     /* Rhythm mode */
     noise = chip->noise;
     slot->pg_phase_out = phase;
@@ -1108,15 +1122,89 @@ static void OPL3_ProcessSlot(opl3_slot *slot)
     OPL3_SlotGenerate(slot);
 }
 
+// TFE: Advance the chip wide tremolo, vibrato and envelope timers by one sample.
+static void OPL3_ChipTick(opl3_chip *chip)
+{
+    uint8_t shift = 0;
+
+    if ((chip->timer & 0x3f) == 0x3f)
+    {
+        chip->tremolopos = (chip->tremolopos + 1) % 210;
+    }
+    if (chip->tremolopos < 105)
+    {
+        chip->tremolo = chip->tremolopos >> chip->tremoloshift;
+    }
+    else
+    {
+        chip->tremolo = (210 - chip->tremolopos) >> chip->tremoloshift;
+    }
+
+    if ((chip->timer & 0x3ff) == 0x3ff)
+    {
+        chip->vibpos = (chip->vibpos + 1) & 7;
+    }
+
+    chip->timer++;
+
+    chip->eg_add = 0;
+    if (chip->eg_timer)
+    {
+        while (shift < 36 && ((chip->eg_timer >> shift) & 1) == 0)
+        {
+            shift++;
+        }
+        if (shift > 12)
+        {
+            chip->eg_add = 0;
+        }
+        else
+        {
+            chip->eg_add = shift + 1;
+        }
+    }
+
+    if (chip->eg_timerrem || chip->eg_state)
+    {
+        if (chip->eg_timer == 0xfffffffff)
+        {
+            chip->eg_timer = 0;
+            chip->eg_timerrem = 1;
+        }
+        else
+        {
+            chip->eg_timer++;
+            chip->eg_timerrem = 0;
+        }
+    }
+
+    chip->eg_state ^= 1;
+}
+
+// TFE: Apply the buffered register writes that are due at the current sample.
+static void OPL3_ProcessWriteBuf(opl3_chip *chip)
+{
+    opl3_writebuf *writebuf;
+
+    while ((writebuf = &chip->writebuf[chip->writebuf_cur]), writebuf->time <= chip->writebuf_samplecnt)
+    {
+        if (!(writebuf->reg & 0x200))
+        {
+            break;
+        }
+        writebuf->reg &= 0x1ff;
+        OPL3_WriteReg(chip, writebuf->reg, writebuf->data);
+        chip->writebuf_cur = (chip->writebuf_cur + 1) % OPL_WRITEBUF_SIZE;
+    }
+}
+
 inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
 {
     opl3_channel *channel;
-    opl3_writebuf *writebuf;
     int16_t **out;
     int32_t mix[2];
     uint8_t ii;
     int16_t accm;
-    uint8_t shift = 0;
 
     buf4[1] = OPL3_ClipSample(chip->mixbuff[1]);
     buf4[3] = OPL3_ClipSample(chip->mixbuff[3]);
@@ -1186,69 +1274,8 @@ inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
     }
 #endif
 
-    if ((chip->timer & 0x3f) == 0x3f)
-    {
-        chip->tremolopos = (chip->tremolopos + 1) % 210;
-    }
-    if (chip->tremolopos < 105)
-    {
-        chip->tremolo = chip->tremolopos >> chip->tremoloshift;
-    }
-    else
-    {
-        chip->tremolo = (210 - chip->tremolopos) >> chip->tremoloshift;
-    }
-
-    if ((chip->timer & 0x3ff) == 0x3ff)
-    {
-        chip->vibpos = (chip->vibpos + 1) & 7;
-    }
-
-    chip->timer++;
-
-    chip->eg_add = 0;
-    if (chip->eg_timer)
-    {
-        while (shift < 36 && ((chip->eg_timer >> shift) & 1) == 0)
-        {
-            shift++;
-        }
-        if (shift > 12)
-        {
-            chip->eg_add = 0;
-        }
-        else
-        {
-            chip->eg_add = shift + 1;
-        }
-    }
-
-    if (chip->eg_timerrem || chip->eg_state)
-    {
-        if (chip->eg_timer == 0xfffffffff)
-        {
-            chip->eg_timer = 0;
-            chip->eg_timerrem = 1;
-        }
-        else
-        {
-            chip->eg_timer++;
-            chip->eg_timerrem = 0;
-        }
-    }
-
-    chip->eg_state ^= 1;
-
-    while ((writebuf = &chip->writebuf[chip->writebuf_cur]), writebuf->time <= chip->writebuf_samplecnt)
-    {
-        if (!(writebuf->reg & 0x200))
-        {
-            break;
-        }
-        writebuf->reg &= 0x1ff;
-        OPL3_WriteReg(chip, writebuf->reg, writebuf->data);
-        chip->writebuf_cur = (chip->writebuf_cur + 1) % OPL_WRITEBUF_SIZE;
-    }
+    OPL3_ChipTick(chip);
+    OPL3_ProcessWriteBuf(chip);
     chip->writebuf_samplecnt++;
 }
 
@@ -1290,6 +1317,253 @@ void OPL3_GenerateResampled(opl3_chip *chip, int16_t *buf)
     buf[1] = samples[1];
 }
 
+// TFE: Native samples per block pass, small enough that the per-slot outputs stay in the L1 cache.
+#define OPL3_BLOCK_SIZE 64
+
+// TFE: Per-sample chip state and slot outputs for one block pass, stored as one array per value.
+typedef struct
+{
+    uint8_t tremolo[OPL3_BLOCK_SIZE];
+    uint8_t vibpos[OPL3_BLOCK_SIZE];
+    uint8_t eg_add[OPL3_BLOCK_SIZE];
+    uint8_t eg_state[OPL3_BLOCK_SIZE];
+    uint16_t timer[OPL3_BLOCK_SIZE];
+    int16_t out[36][OPL3_BLOCK_SIZE];
+    int32_t mix[4][OPL3_BLOCK_SIZE];
+} opl3_block;
+
+// TFE: Returns the slot whose output 'ptr' points to, or -1 for the zero and feedback inputs.
+static int32_t OPL3_OutputSlot(const opl3_chip *chip, const int16_t *ptr)
+{
+    const uint8_t *base = (const uint8_t*)chip->slot;
+    const uint8_t *p = (const uint8_t*)ptr;
+    int32_t index;
+
+    if (p < base || p >= base + sizeof(chip->slot))
+    {
+        return -1;
+    }
+    index = (int32_t)((p - base) / sizeof(opl3_slot));
+    return ptr == &chip->slot[index].out ? index : -1;
+}
+
+// TFE: The block pass processes one slot at a time, which only matches the per-sample order if every modulator
+// is processed before the slot it modulates. Rhythm mode shares phase bits between slots within a sample and the
+// channel sample delay quirk mixes in between slots, both stay on the per-sample path.
+static uint8_t OPL3_CanProcessBlock(const opl3_chip *chip)
+{
+    uint8_t ii;
+
+    if (OPL_QUIRK_CHANNELSAMPLEDELAY || (chip->rhy & 0x20))
+    {
+        return 0;
+    }
+    for (ii = 0; ii < 36; ii++)
+    {
+        if (OPL3_OutputSlot(chip, chip->slot[ii].mod) > ii)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// TFE: Generate 'count' native samples one slot at a time, the output and chip state match calling
+// OPL3_Generate4Ch() 'count' times. No buffered register write may be due before the last sample.
+static void OPL3_ProcessBlock(opl3_chip *chip, int16_t *buf4, uint32_t count)
+{
+    opl3_block block;
+    opl3_slot *slot;
+    opl3_channel *channel;
+    const int16_t *src[4];
+    const int16_t *modbuf;
+    envelope_sinfunc envelope;
+    uint32_t noise;
+    uint32_t t, srccount;
+    int32_t index, sum;
+    uint8_t ii, jj, trem, n_bit;
+    int16_t accm;
+
+    // The chip wide timers don't depend on the slots, so step them first.
+    for (t = 0; t < count; t++)
+    {
+        block.tremolo[t] = chip->tremolo;
+        block.vibpos[t] = chip->vibpos;
+        block.eg_add[t] = chip->eg_add;
+        block.eg_state[t] = chip->eg_state;
+        block.timer[t] = chip->timer;
+        OPL3_ChipTick(chip);
+    }
+
+    // Each slot runs over the whole block, modulators have lower slot numbers so their outputs are already done.
+    for (ii = 0; ii < 36; ii++)
+    {
+        slot = &chip->slot[ii];
+        index = OPL3_OutputSlot(chip, slot->mod);
+        modbuf = index >= 0 ? block.out[index] : NULL;
+        trem = (slot->trem == &chip->tremolo);
+        envelope = envelope_sin[slot->reg_wf];
+        for (t = 0; t < count; t++)
+        {
+            OPL3_SlotCalcFB(slot);
+            OPL3_EnvelopeStep(slot, trem ? block.tremolo[t] : *slot->trem, block.eg_add[t], block.eg_state[t], block.timer[t]);
+            slot->pg_phase_out = OPL3_PhaseStep(slot, block.vibpos[t]);
+            slot->out = envelope(slot->pg_phase_out + (modbuf ? modbuf[t] : *slot->mod), slot->eg_out);
+            block.out[ii][t] = slot->out;
+        }
+    }
+
+    // Rhythm mode is off, so only the hi-hat phase bits and the noise generator need to catch up.
+    slot = &chip->slot[13];
+    chip->rm_hh_bit2 = (slot->pg_phase_out >> 2) & 1;
+    chip->rm_hh_bit3 = (slot->pg_phase_out >> 3) & 1;
+    chip->rm_hh_bit7 = (slot->pg_phase_out >> 7) & 1;
+    chip->rm_hh_bit8 = (slot->pg_phase_out >> 8) & 1;
+    noise = chip->noise;
+    for (t = 0; t < count * 36; t++)
+    {
+        n_bit = ((noise >> 14) ^ noise) & 0x01;
+        noise = (noise >> 1) | (n_bit << 22);
+    }
+    chip->noise = noise;
+
+    memset(block.mix, 0, sizeof(block.mix));
+    for (ii = 0; ii < 18; ii++)
+    {
+        channel = &chip->channel[ii];
+        srccount = 0;
+        for (jj = 0; jj < 4; jj++)
+        {
+            index = OPL3_OutputSlot(chip, channel->out[jj]);
+            if (index >= 0)
+            {
+                src[srccount++] = block.out[index];
+            }
+        }
+        if (!srccount)
+        {
+            continue;
+        }
+        for (t = 0; t < count; t++)
+        {
+            sum = src[0][t];
+            for (jj = 1; jj < srccount; jj++)
+            {
+                sum += src[jj][t];
+            }
+            accm = (int16_t)sum;
+#if OPL_ENABLE_STEREOEXT
+            block.mix[0][t] += (int16_t)((accm * channel->leftpan) >> 16);
+            block.mix[1][t] += (int16_t)((accm * channel->rightpan) >> 16);
+#else
+            block.mix[0][t] += (int16_t)(accm & channel->cha);
+            block.mix[1][t] += (int16_t)(accm & channel->chb);
+#endif
+            block.mix[2][t] += (int16_t)(accm & channel->chc);
+            block.mix[3][t] += (int16_t)(accm & channel->chd);
+        }
+    }
+
+    // The second output pair lags by one sample, same as OPL3_Generate4Ch().
+    for (t = 0; t < count; t++, buf4 += 4)
+    {
+        buf4[1] = OPL3_ClipSample(chip->mixbuff[1]);
+        buf4[3] = OPL3_ClipSample(chip->mixbuff[3]);
+        chip->mixbuff[0] = block.mix[0][t];
+        chip->mixbuff[2] = block.mix[2][t];
+        buf4[0] = OPL3_ClipSample(chip->mixbuff[0]);
+        buf4[2] = OPL3_ClipSample(chip->mixbuff[2]);
+        chip->mixbuff[1] = block.mix[1][t];
+        chip->mixbuff[3] = block.mix[3][t];
+    }
+
+    chip->writebuf_samplecnt += count - 1;
+    OPL3_ProcessWriteBuf(chip);
+    chip->writebuf_samplecnt++;
+}
+
+// TFE: Generate 'count' native samples, using the block pass between the buffered register writes.
+static void OPL3_Generate4ChBlock(opl3_chip *chip, int16_t *buf4, uint32_t count)
+{
+    opl3_writebuf *writebuf;
+    uint64_t due;
+    uint32_t n, i;
+
+    while (count)
+    {
+        n = count < OPL3_BLOCK_SIZE ? count : OPL3_BLOCK_SIZE;
+        // A pending write is applied at the end of the sample where writebuf_samplecnt reaches its time.
+        writebuf = &chip->writebuf[chip->writebuf_cur];
+        if (writebuf->reg & 0x200)
+        {
+            due = writebuf->time > chip->writebuf_samplecnt ? writebuf->time - chip->writebuf_samplecnt + 1 : 1;
+            if (due < n)
+            {
+                n = (uint32_t)due;
+            }
+        }
+        if (n > 1 && OPL3_CanProcessBlock(chip))
+        {
+            OPL3_ProcessBlock(chip, buf4, n);
+        }
+        else
+        {
+            for (i = 0; i < n; i++)
+            {
+                OPL3_Generate4Ch(chip, buf4 + i * 4);
+            }
+        }
+        buf4 += n * 4;
+        count -= n;
+    }
+}
+
+// TFE: Generate a block of resampled stereo output into separate left and right buffers.
+// This produces the same output and chip state as calling OPL3_GenerateResampled() 'numsamples' times,
+// the native samples are generated up front in blocks and then resampled.
+void OPL3_GenerateResampledBlock(opl3_chip *chip, int16_t *left, int16_t *right, uint32_t numsamples)
+{
+    int16_t native[OPL3_BLOCK_SIZE * 4];
+    const int32_t rateratio = chip->rateratio;
+    int32_t samplecnt = chip->samplecnt;
+    uint32_t remaining = 0, avail = 0, pos = 0;
+    uint_fast32_t i;
+
+    // Count the native samples the resampler consumes, so the chip never runs ahead of the per-sample path.
+    for (i = 0; i < numsamples; i++)
+    {
+        while (samplecnt >= rateratio)
+        {
+            samplecnt -= rateratio;
+            remaining++;
+        }
+        samplecnt += 1 << RSM_FRAC;
+    }
+    samplecnt = chip->samplecnt;
+
+    for (i = 0; i < numsamples; i++)
+    {
+        while (samplecnt >= rateratio)
+        {
+            if (pos == avail)
+            {
+                avail = remaining < OPL3_BLOCK_SIZE ? remaining : OPL3_BLOCK_SIZE;
+                OPL3_Generate4ChBlock(chip, native, avail);
+                remaining -= avail;
+                pos = 0;
+            }
+            memcpy(chip->oldsamples, chip->samples, sizeof(chip->samples));
+            memcpy(chip->samples, &native[pos * 4], sizeof(chip->samples));
+            pos++;
+            samplecnt -= rateratio;
+        }
+        left[i]  = (int16_t)((chip->oldsamples[0] * (rateratio - samplecnt) + chip->samples[0] * samplecnt) / rateratio);
+        right[i] = (int16_t)((chip->oldsamples[1] * (rateratio - samplecnt) + chip->samples[1] * samplecnt) / rateratio);
+        samplecnt += 1 << RSM_FRAC;
+    }
+    chip->samplecnt = samplecnt;
+}
+
 void OPL3_Reset(opl3_chip *chip, uint32_t samplerate)
 {
     opl3_slot *slot;
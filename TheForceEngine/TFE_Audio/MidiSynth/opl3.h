@@ -164,6 +164,8 @@ void OPL3_Reset(opl3_chip *chip, uint32_t samplerate);
 void OPL3_WriteReg(opl3_chip *chip, uint16_t reg, uint8_t v);
 void OPL3_WriteRegBuffered(opl3_chip *chip, uint16_t reg, uint8_t v);
 void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples);
+// TFE: block rendering, identical output to calling OPL3_GenerateResampled() numsamples times.
+void OPL3_GenerateResampledBlock(opl3_chip *chip, int16_t *left, int16_t *right, uint32_t numsamples);
 
 void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4);
 void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4);
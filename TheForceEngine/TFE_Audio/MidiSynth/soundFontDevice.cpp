@@ -1,8 +1,11 @@
 #include "soundFontDevice.h"
 #include <TFE_Audio/midi.h>
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_System/system.h>
 #include <algorithm>
 #include <assert.h>
+#include <mutex>
+#include <thread>
 
 #define TSF_IMPLEMENTATION
 #include "tsf.h"
@@ -19,6 +22,72 @@ namespace TFE_Audio
 	static const char* c_SFD_Name = "SF2 Synthesized Midi";
 	static const char* c_defaultOutput = "Roland SC-55";
 
+	// Shared between the device and the loading thread, the device may move on to another SoundFont
+	// (or be destroyed) before loading finishes.
+	struct SoundFontLoad
+	{
+		std::mutex mutex;
+		char path[TFE_MAX_PATH];
+		s32  outputId = -1;
+		tsf* soundFont = nullptr;
+		bool done = false;
+		bool cancelled = false;
+		f64  loadTime = 0.0;
+	};
+
+	void setupSoundFont(tsf* soundFont, s32 sampleRate)
+	{
+		// Set the SoundFont rendering output mode
+		tsf_set_output(soundFont, TSF_STEREO_INTERLEAVED, sampleRate, 0);
+		tsf_set_max_voices(soundFont, SFD_MAX_VOICES);
+		// pre-allocate channels, clear programs or set them to the stored values.
+		for (s32 i = 0; i < MIDI_CHANNEL_COUNT; i++)
+		{
+			tsf_channel_set_presetnumber(soundFont, i, 0, i == SFD_DRUM_CHANNEL);
+		}
+		// Set the drum bank.
+		tsf_channel_set_bank_preset(soundFont, SFD_DRUM_CHANNEL, SFD_DRUM_BANK, 0);
+	}
+
+	// Check the RIFF header before starting the load thread, so a missing or invalid file is reported to the caller
+	// right away and it can fall back to another SoundFont.
+	bool validateSoundFont(const char* path)
+	{
+		FileStream file;
+		if (!file.open(path, Stream::MODE_READ)) { return false; }
+
+		char riff[4], form[4];
+		u32 riffSize = 0;
+		const size_t fileSize = file.getSize();
+		file.readBuffer(riff, 4);
+		file.read(&riffSize);
+		file.readBuffer(form, 4);
+		file.close();
+
+		return fileSize >= 12 && memcmp(riff, "RIFF", 4) == 0 && memcmp(form, "sfbk", 4) == 0 && size_t(riffSize) + 8 <= fileSize;
+	}
+
+	// Loading thread: the whole file is read and the samples are converted to float, which can take seconds for large SoundFonts.
+	void loadSoundFont(std::shared_ptr<SoundFontLoad> load, s32 sampleRate)
+	{
+		const u64 startTick = TFE_System::getCurrentTimeInTicks();
+		tsf* soundFont = tsf_load_filename(load->path);
+		if (soundFont)
+		{
+			setupSoundFont(soundFont, sampleRate);
+		}
+
+		std::lock_guard<std::mutex> lock(load->mutex);
+		if (load->cancelled)
+		{
+			if (soundFont) { tsf_close(soundFont); }
+			return;
+		}
+		load->soundFont = soundFont;
+		load->loadTime = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - startTick);
+		load->done = true;
+	}
+
 	SoundFontDevice::~SoundFontDevice()
 	{
 		exit();
@@ -75,10 +144,10 @@ namespace TFE_Audio
 		{
 			char outputName[TFE_MAX_PATH];
 			getOutputName(index, outputName, TFE_MAX_PATH);
-			m_outputId = index;
 
-			exit();
-			res = beginStream(outputName, SFD_SAMPLE_RATE);
+			// The current SoundFont keeps playing until the new one has loaded.
+			res = beginStream(outputName, index, SFD_SAMPLE_RATE);
+			if (res) { m_outputId = index; }
 		}
 		return res;
 	}
@@ -88,7 +157,7 @@ namespace TFE_Audio
 		return m_outputId;
 	}
 
-	bool SoundFontDevice::beginStream(const char* soundFont, s32 sampleRate)
+	bool SoundFontDevice::beginStream(const char* soundFont, s32 outputId, s32 sampleRate)
 	{
 		getOutputCount();
 
@@ -98,29 +167,91 @@ namespace TFE_Audio
 		if (!TFE_Paths::mapSystemPath(filePath))
 			sprintf(filePath, "%sSoundFonts/%s.sf2", programDir, soundFont);
 
-		m_soundFont = tsf_load_filename(filePath);
-		if (m_soundFont)
+		if (!FileUtil::exists(filePath) || !validateSoundFont(filePath))
+		{
+			TFE_System::logWrite(LOG_ERROR, "SoundFont", "'%s' is not a valid SoundFont.", filePath);
+			return false;
+		}
+
+		cancelLoad();
+		m_load = std::make_shared<SoundFontLoad>();
+		strcpy(m_load->path, filePath);
+		m_load->outputId = outputId;
+		std::thread(loadSoundFont, m_load, sampleRate).detach();
+		return true;
+	}
+
+	void SoundFontDevice::cancelLoad()
+	{
+		if (!m_load) { return; }
 		{
-			// Set the SoundFont rendering output mode
-			tsf_set_output(m_soundFont, TSF_STEREO_INTERLEAVED, sampleRate, 0);
-			tsf_set_max_voices(m_soundFont, SFD_MAX_VOICES);
-			// pre-allocate channels, clear programs or set them to the stored values.
-			for (s32 i = 0; i < MIDI_CHANNEL_COUNT; i++)
+			std::lock_guard<std::mutex> lock(m_load->mutex);
+			m_load->cancelled = true;
+			if (m_load->soundFont)
 			{
-				tsf_channel_set_presetnumber(m_soundFont, i, 0, i == SFD_DRUM_CHANNEL);
+				tsf_close(m_load->soundFont);
+				m_load->soundFont = nullptr;
+			}
+		}
+		m_load.reset();
+	}
+
+	void SoundFontDevice::updateLoad()
+	{
+		if (!m_load) { return; }
+
+		tsf* soundFont = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_load->mutex);
+			if (!m_load->done) { return; }
+			soundFont = m_load->soundFont;
+			m_load->soundFont = nullptr;
+		}
+
+		if (soundFont)
+		{
+			const f64 sampleMB = f64(soundFont->fontSampleCount) * sizeof(f32) / (1024.0 * 1024.0);
+			TFE_System::logWrite(LOG_MSG, "SoundFont", "Loaded '%s' in %0.2f ms, %0.2f MB of sample data.", m_load->path, m_load->loadTime, sampleMB);
+
+			if (m_soundFont)
+			{
+				// Keep the current programs so that a song that is already playing sounds the same.
+				for (s32 i = 0; i < MIDI_CHANNEL_COUNT; i++)
+				{
+					tsf_channel_set_bank_preset(soundFont, i, tsf_channel_get_preset_bank(m_soundFont, i), tsf_channel_get_preset_number(m_soundFont, i));
+					tsf_channel_set_volume(soundFont, i, tsf_channel_get_volume(m_soundFont, i));
+				}
+				tsf_reset(m_soundFont);
+				tsf_close(m_soundFont);
+			}
+			tsf_set_volume(soundFont, m_volume);
+			m_soundFont = soundFont;
+			m_loadedOutputId = m_load->outputId;
+			m_load.reset();
+		}
+		else
+		{
+			// The header was valid but the rest of the file was not, keep playing the current SoundFont if there is one.
+			// Otherwise fall back to the first SoundFont, the same as when selectOutput() fails.
+			TFE_System::logWrite(LOG_ERROR, "SoundFont", "Cannot load '%s'.", m_load->path);
+			const s32 failedId = m_load->outputId;
+			m_load.reset();
+			m_outputId = m_loadedOutputId;
+			if (!m_soundFont && failedId != 0)
+			{
+				selectOutput(0);
 			}
-			// Set the drum bank.
-			tsf_channel_set_bank_preset(m_soundFont, SFD_DRUM_CHANNEL, SFD_DRUM_BANK, 0);
 		}
-		return m_soundFont != nullptr;
 	}
 
 	void SoundFontDevice::exit()
 	{
+		cancelLoad();
 		if (m_soundFont)
 		{
 			tsf* soundFont = m_soundFont;
 			m_soundFont = nullptr;
+			m_loadedOutputId = -1;
 
 			tsf_reset(soundFont);
 			tsf_close(soundFont);
@@ -134,6 +265,7 @@ namespace TFE_Audio
 
 	bool SoundFontDevice::render(f32* buffer, u32 sampleCount)
 	{
+		updateLoad();
 		if (!m_soundFont) { return false; }
 		tsf_render_float(m_soundFont, buffer, sampleCount);
 		return true;
@@ -141,11 +273,13 @@ namespace TFE_Audio
 
 	bool SoundFontDevice::canRender()
 	{
+		updateLoad();
 		return m_soundFont != nullptr;
 	}
 
 	void SoundFontDevice::setVolume(f32 volume)
 	{
+		m_volume = volume;
 		if (!m_soundFont) { return; }
 		tsf_set_volume(m_soundFont, volume);
 	}
@@ -2,15 +2,18 @@
 #include <TFE_System/types.h>
 #include <TFE_Audio/midiDevice.h>
 #include <TFE_Audio/midi.h>
+#include <memory>
 
 struct tsf;
 
 namespace TFE_Audio
 {
+	struct SoundFontLoad;
+
 	class SoundFontDevice : public MidiDevice
 	{
 	public:
-		SoundFontDevice() : m_soundFont(nullptr), m_outputId(-1) {}
+		SoundFontDevice() : m_soundFont(nullptr), m_outputId(-1), m_loadedOutputId(-1), m_volume(1.0f) {}
 		~SoundFontDevice() override;
 
 		MidiDeviceType getType() override { return MIDI_TYPE_SF2; }
@@ -33,10 +36,18 @@ namespace TFE_Audio
 		s32  getActiveOutput(void) override;
 
 	private:
-		bool beginStream(const char* soundFont, s32 sampleRate);
+		// Validates the file and starts loading it, returns false if the SoundFont cannot be used.
+		bool beginStream(const char* soundFont, s32 outputId, s32 sampleRate);
+		// Switch to the pending SoundFont once it has finished loading.
+		void updateLoad();
+		void cancelLoad();
 
 		tsf* m_soundFont;
 		s32  m_outputId;
+		s32  m_loadedOutputId;	// Output of m_soundFont, m_outputId may be a SoundFont that is still loading.
+		f32  m_volume;
 		FileList m_outputs;
+		// SoundFonts are loaded on a background thread, the current one keeps playing until the new one is ready.
+		std::shared_ptr<SoundFontLoad> m_load;
 	};
 };
\ No newline at end of file
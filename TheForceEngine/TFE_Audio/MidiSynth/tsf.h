@@ -341,6 +341,7 @@ struct tsf
 	float outSampleRate;
 	float globalGainDB;
 	int* refCount;
+	unsigned int fontSampleCount;
 };
 
 #ifndef TSF_NO_STDIO
@@ -1306,6 +1307,7 @@ TSFDEF tsf* tsf_load(struct tsf_stream* stream)
 		TSF_MEMSET(res, 0, sizeof(tsf));
 		if (!tsf_load_presets(res, &hydra, fontSampleCount)) goto out_of_memory;
 		res->fontSamples = fontSamples;
+		res->fontSampleCount = fontSampleCount;
 		fontSamples = TSF_NULL; //don't free below
 		res->outSampleRate = 44100.0f;
 	}
@@ -8,6 +8,7 @@
 #include <SDL_thread.h>
 #include <TFE_Asset/gmidAsset.h>
 #include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Audio/MidiSynth/soundFontDevice.h>
@@ -70,6 +71,25 @@ namespace TFE_MidiPlayer
 	static std::vector<f32> s_sampleBuffer;
 	static f32* s_sampleBufferPtr = nullptr;
 
+	// Synthesized midi is rendered ahead on the midi thread into a single producer (midi thread),
+	// single consumer (audio callback) ring buffer, so the audio callback only has to mix the results.
+	enum MidiRenderConst : u32
+	{
+		MIDI_SAMPLE_RATE    = 44100,
+		MIDI_RENDER_CHUNK   = 256,		// Maximum stereo samples rendered per lock.
+		MIDI_RING_SIZE      = 16384,	// Ring size in stereo samples, must be a power of 2 (~370ms).
+		MIDI_RING_MASK      = MIDI_RING_SIZE - 1,
+		MIDI_RENDER_AHEAD_MIN_MS = 30,
+		MIDI_RENDER_AHEAD_MAX_MS = 250,
+	};
+	static f32 s_ring[MIDI_RING_SIZE * 2];
+	// Read and write positions are in stereo samples and wrap naturally.
+	static atomic_u32 s_ringRead;
+	static atomic_u32 s_ringWrite;
+	static atomic_u32 s_renderAheadSamples;
+	static atomic_bool s_ringActive;
+	static s32 s_underrunCount = 0;		// Only written by the audio callback.
+
 	// Hanging note detection.
 	struct Instrument
 	{
@@ -83,10 +103,12 @@ namespace TFE_MidiPlayer
 	void stopAllNotes();
 	void changeVolume();
 	void allocateMidiDevice(MidiDeviceType type);
+	bool opl3Benchmark(f32 seconds, char* result);
 
 	// Console Functions
 	void setMusicVolumeConsole(const ConsoleArgList& args);
 	void getMusicVolumeConsole(const ConsoleArgList& args);
+	void opl3BenchmarkConsole(const ConsoleArgList& args);
 
 	static const char* c_midiDeviceTypes[] =
 	{
@@ -134,6 +156,12 @@ namespace TFE_MidiPlayer
 		}
 		SDL_UnlockMutex(s_deviceChangeMutex);
 
+		s_ringRead.store(0);
+		s_ringWrite.store(0);
+		s_ringActive.store(false);
+		setRenderAhead(TFE_Settings::getSoundSettings()->midiRenderAheadMs);
+		TFE_COUNTER(s_underrunCount, "Midi Synth Underruns");
+
 		s_runMusicThread.store(true);
 		s_thread = SDL_CreateThread(midiUpdateFunc, "TFE_MidiThread", nullptr);
 		if (!s_thread)
@@ -144,6 +172,15 @@ namespace TFE_MidiPlayer
 
 		CCMD("setMusicVolume", setMusicVolumeConsole, 1, "Sets the music volume, range is 0.0 to 1.0");
 		CCMD("getMusicVolume", getMusicVolumeConsole, 0, "Get the current music volume where 0 = silent, 1 = maximum.");
+		CCMD("opl3Benchmark", opl3BenchmarkConsole, 0, "Render a fixed OPL3 register script with the per-sample and block paths, report the cost and verify the output matches. Optional argument: seconds (default 10).");
+
+		// --verify_opl3 <seconds>, the result is only written to the log.
+		const f32 verifyOpl3Seconds = TFE_Settings::getTempSettings()->verifyOpl3Seconds;
+		if (verifyOpl3Seconds > 0.0f)
+		{
+			char res[256];
+			opl3Benchmark(verifyOpl3Seconds, res);
+		}
 
 		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
 		setVolume(soundSettings->musicVolume);
@@ -305,34 +342,36 @@ namespace TFE_MidiPlayer
 		SDL_UnlockMutex(s_midiThreadMutex);
 	}
 
+	void setRenderAhead(s32 milliseconds)
+	{
+		milliseconds = std::max((s32)MIDI_RENDER_AHEAD_MIN_MS, std::min((s32)MIDI_RENDER_AHEAD_MAX_MS, milliseconds));
+		s_renderAheadSamples.store(u32(milliseconds) * MIDI_SAMPLE_RATE / 1000);
+	}
+
+	// Called from the audio callback, this only mixes the samples already rendered by the midi thread.
 	void synthesizeMidi(f32* buffer, u32 stereoSampleCount, bool updateBuffer)
 	{
+		const u32 readPos  = s_ringRead.load(std::memory_order_relaxed);
+		const u32 writePos = s_ringWrite.load(std::memory_order_acquire);
+		const u32 count = std::min(writePos - readPos, stereoSampleCount);
 		// In some cases, such as when using the System Midi Device, the midi audio is generated externally so
-		// rendering is not required.
-		SDL_LockMutex(s_deviceChangeMutex);  // Make sure we don't synthesize when the device is being changed.
-		if (s_midiDevice && s_midiDevice->canRender())
+		// nothing is rendered and there is nothing to mix.
+		if (count < stereoSampleCount && s_ringActive.load())
 		{
-			// Stereo samples -> actual samples.
-			const s32 linearSampleCount = (s32)stereoSampleCount * 2;
-			// Make sure the sample buffer is large enough, this should only happen once.
-			if (linearSampleCount > (s32)s_sampleBuffer.size() || !s_sampleBufferPtr)
-			{
-				s_sampleBuffer.resize(linearSampleCount);
-				s_sampleBufferPtr = s_sampleBuffer.data();
-			}
+			s_underrunCount++;
+		}
 
-			// The midi device takes the number of stereo samples.
-			s_midiDevice->render(s_sampleBufferPtr, stereoSampleCount);
-			// Accumulate midi samples with existing audio samples (from soundFX).
-			if (updateBuffer)
+		// Accumulate midi samples with existing audio samples (from soundFX).
+		if (updateBuffer)
+		{
+			for (u32 i = 0; i < count; i++, buffer += 2)
 			{
-				for (s32 i = 0; i < linearSampleCount; i++)
-				{
-					buffer[i] += s_sampleBufferPtr[i];
-				}
+				const f32* sample = &s_ring[((readPos + i) & MIDI_RING_MASK) * 2];
+				buffer[0] += sample[0];
+				buffer[1] += sample[1];
 			}
 		}
-		SDL_UnlockMutex(s_deviceChangeMutex);
+		s_ringRead.store(readPos + count, std::memory_order_release);
 	}
 
 	f32 getVolume()
@@ -469,6 +508,64 @@ namespace TFE_MidiPlayer
 		}
 	}
 
+	// Render 'count' stereo samples from the midi device into the ring.
+	// Note: the device change mutex must be held.
+	void renderToRing(u32 count)
+	{
+		const s32 linearSampleCount = (s32)count * 2;
+		// Make sure the sample buffer is large enough, this should only happen once.
+		if (linearSampleCount > (s32)s_sampleBuffer.size() || !s_sampleBufferPtr)
+		{
+			s_sampleBuffer.resize(linearSampleCount);
+			s_sampleBufferPtr = s_sampleBuffer.data();
+		}
+		// The midi device takes the number of stereo samples.
+		s_midiDevice->render(s_sampleBufferPtr, count);
+
+		const u32 writePos = s_ringWrite.load(std::memory_order_relaxed);
+		const u32 start = writePos & MIDI_RING_MASK;
+		const u32 firstCount = std::min(count, MIDI_RING_SIZE - start);
+		memcpy(&s_ring[start * 2], s_sampleBufferPtr, firstCount * 2 * sizeof(f32));
+		if (firstCount < count)
+		{
+			memcpy(s_ring, s_sampleBufferPtr + firstCount * 2, (count - firstCount) * 2 * sizeof(f32));
+		}
+		s_ringWrite.store(writePos + count, std::memory_order_release);
+	}
+
+	// Render the next chunk of midi audio if the ring is below the render-ahead target.
+	// The midi callback is driven by the sample position rather than the wall clock, and chunks are split
+	// on callback boundaries, so midi events are timestamped at the exact sample they occur on
+	// regardless of how far ahead the audio is rendered.
+	// Returns the number of stereo samples rendered.
+	u32 renderAhead(bool runCallback)
+	{
+		const u32 buffered = s_ringWrite.load(std::memory_order_relaxed) - s_ringRead.load(std::memory_order_acquire);
+		const u32 target = s_renderAheadSamples.load();
+		if (buffered >= target) { return 0; }
+
+		u32 count = std::min(target - buffered, (u32)MIDI_RENDER_CHUNK);
+		if (runCallback && s_midiCallback.callback)
+		{
+			// Process any callbacks due at the current sample.
+			while (s_midiCallback.callback && s_midiCallback.accumulator >= s_midiCallback.timeStep)
+			{
+				s_midiCallback.callback();
+				s_midiCallback.accumulator -= s_midiCallback.timeStep;
+				s_curNoteTime += s_midiCallback.timeStep;
+			}
+			// Then render up to the sample where the next callback is due.
+			const f64 samplesToNextCallback = (s_midiCallback.timeStep - s_midiCallback.accumulator) * f64(MIDI_SAMPLE_RATE);
+			count = std::max(1u, std::min(count, u32(ceil(samplesToNextCallback))));
+			s_midiCallback.accumulator += f64(count) / f64(MIDI_SAMPLE_RATE);
+
+			// Check for hanging notes.
+			detectHangingNotes();
+		}
+		renderToRing(count);
+		return count;
+	}
+
 	// Thread Function
 	int midiUpdateFunc(void* userData)
 	{
@@ -517,8 +614,24 @@ namespace TFE_MidiPlayer
 			}
 			s_midiCmdCount = 0;
 
-			// Process the midi callback, if it exists.
-			if (s_midiCallback.callback && !isPaused)
+			// Synthesized devices render ahead into the ring, which also drives the midi callback.
+			bool renderedDevice = false;
+			bool ringFull = false;
+			SDL_LockMutex(s_deviceChangeMutex);
+			if (s_midiDevice && s_midiDevice->canRender())
+			{
+				renderedDevice = true;
+				ringFull = renderAhead(!isPaused) == 0;
+			}
+			SDL_UnlockMutex(s_deviceChangeMutex);
+			s_ringActive.store(renderedDevice);
+
+			// Otherwise process the midi callback, if it exists, using the wall clock.
+			if (renderedDevice)
+			{
+				localTimeCallback = 0;
+			}
+			else if (s_midiCallback.callback && !isPaused)
 			{
 				s_midiCallback.accumulator += TFE_System::updateThreadLocal(&localTimeCallback);
 				while (s_midiCallback.callback && s_midiCallback.accumulator >= s_midiCallback.timeStep)
@@ -534,6 +647,12 @@ namespace TFE_MidiPlayer
 
 			SDL_UnlockMutex(s_midiThreadMutex);
 			runThread = s_runMusicThread.load();
+
+			// Give up the rest of the time slice if there is enough audio rendered ahead.
+			if (ringFull)
+			{
+				TFE_System::sleep(1);
+			}
 		};
 		
 		return 0;
@@ -558,6 +677,27 @@ namespace TFE_MidiPlayer
 		TFE_Console::addToHistory(res);
 	}
 
+	void opl3BenchmarkConsole(const ConsoleArgList& args)
+	{
+		const f32 seconds = args.size() >= 2 ? std::max(1.0f, TFE_Console::getFloatArg(args[1])) : 10.0f;
+		char res[256];
+		opl3Benchmark(seconds, res);
+		TFE_Console::addToHistory(res);
+	}
+
+	// The benchmark renders its own register script on private chips, so it doesn't touch the active device.
+	// The result is written to the log and into 'result', which must hold at least 256 characters.
+	bool opl3Benchmark(f32 seconds, char* result)
+	{
+		f64 perSampleMs = 0.0, blockMs = 0.0;
+		const bool match = Fm4Opl3Device::benchmark(seconds, &perSampleMs, &blockMs);
+
+		sprintf(result, "OPL3 synth cost per second of audio: per-sample %0.3f ms, block %0.3f ms, output %s.",
+			perSampleMs / seconds, blockMs / seconds, match ? "matches" : "DOES NOT MATCH");
+		TFE_System::logWrite(match ? LOG_MSG : LOG_ERROR, "Midi", "%s", result);
+		return match;
+	}
+
 	void allocateMidiDevice(MidiDeviceType type)
 	{
 		if (s_midiDevice && s_midiDevice->getType() == type) { return; }
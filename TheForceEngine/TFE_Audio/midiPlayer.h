@@ -42,6 +42,9 @@ namespace TFE_MidiPlayer
 	// Stop all notes.
 	void stopMidiSound();
 
+	// Set how far ahead synthesized midi is rendered on the midi thread, in milliseconds.
+	void setRenderAhead(s32 milliseconds);
+	// Mix the midi audio rendered ahead into the buffer, this is called from the audio callback.
 	void synthesizeMidi(f32* buffer, u32 stereoSampleCount, bool updateBuffer = true);
 
 	///////////////////////////////////////////////////////////
@@ -29,6 +29,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_Settings/settings.h>
 
 using namespace TFE_Jedi;
@@ -40,11 +41,14 @@ namespace TFE_DarkForces
 	///////////////////////////////////////////
 	ActorInternalState s_istate = { 0 };
 	List* s_physicsActors = nullptr;
+	SNAPSHOT_STATE(s_istate);
+	SNAPSHOT_STATE(s_physicsActors);
 
 	///////////////////////////////////////////
 	// Shared State
 	///////////////////////////////////////////
 	ActorState s_actorState = { 0 };
+	SNAPSHOT_STATE(s_actorState);
 	SoundSourceId s_alertSndSrc[ALERT_COUNT];
 	SoundSourceId s_officerAlertSndSrc[OFFICER_ALERT_COUNT];
 	SoundSourceId s_stormAlertSndSrc[STORM_ALERT_COUNT];
@@ -20,6 +20,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_Settings/settings.h>
 
 namespace TFE_DarkForces
@@ -91,6 +92,8 @@ namespace TFE_DarkForces
 
 	static BobaFett* s_curBobaFett = nullptr;
 	static BobaFettShared s_shared = {};
+	SNAPSHOT_STATE(s_curBobaFett);
+	SNAPSHOT_STATE(s_shared);
 	extern s32 s_lastMaintainVolume;
 
 	void bobaFett_exit()
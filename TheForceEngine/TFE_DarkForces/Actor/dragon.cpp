@@ -19,6 +19,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -65,6 +66,8 @@ namespace TFE_DarkForces
 	   
 	static KellDragon* s_curDragon = nullptr;
 	static DragonShared s_shared = {};
+	SNAPSHOT_STATE(s_curDragon);
+	SNAPSHOT_STATE(s_shared);
 
 	void kellDragon_exit()
 	{
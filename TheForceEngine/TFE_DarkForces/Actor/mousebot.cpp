@@ -18,6 +18,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -44,6 +45,8 @@ namespace TFE_DarkForces
 	static MouseBotResources s_mouseBotRes = { 0 };
 	static MouseBot* s_curMouseBot;
 	static s32 s_mouseNum = 0;
+	SNAPSHOT_STATE(s_curMouseBot);
+	SNAPSHOT_STATE(s_mouseNum);
 
 	MessageType mousebot_handleDamage(MessageType msg, MouseBot* mouseBot)
 	{
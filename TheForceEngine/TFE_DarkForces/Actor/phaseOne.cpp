@@ -19,6 +19,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -44,6 +45,8 @@ namespace TFE_DarkForces
 		
 	static PhaseOne* s_curTrooper = nullptr;
 	static PhaseOneShared s_shared = {};
+	SNAPSHOT_STATE(s_curTrooper);
+	SNAPSHOT_STATE(s_shared);
 
 	void phaseOne_exit()
 	{
@@ -19,6 +19,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -60,6 +61,8 @@ namespace TFE_DarkForces
 
 	static PhaseThree* s_curTrooper = nullptr;
 	static PhaseThreeShared s_shared = {};
+	SNAPSHOT_STATE(s_curTrooper);
+	SNAPSHOT_STATE(s_shared);
 
 	void phaseThree_exit()
 	{
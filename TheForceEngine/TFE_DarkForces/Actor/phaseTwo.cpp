@@ -19,6 +19,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -54,6 +55,8 @@ namespace TFE_DarkForces
 	};
 	static PhaseTwoShared s_shared = {};
 	static PhaseTwo* s_curTrooper = nullptr;
+	SNAPSHOT_STATE(s_shared);
+	SNAPSHOT_STATE(s_curTrooper);
 
 	void phaseTwo_exit()
 	{
@@ -19,6 +19,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -72,6 +73,8 @@ namespace TFE_DarkForces
 	static TurretResources s_turretRes = {};
 	static Turret* s_curTurret;
 	static s32 s_turretNum = 0;
+	SNAPSHOT_STATE(s_curTurret);
+	SNAPSHOT_STATE(s_turretNum);
 
 	void turret_exit()
 	{
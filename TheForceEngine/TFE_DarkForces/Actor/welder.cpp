@@ -20,6 +20,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -56,6 +57,9 @@ namespace TFE_DarkForces
 	static Wax* s_welderSpark = nullptr;
 	static Welder* s_curWelder = nullptr;
 	static WelderShared s_shared = {};
+	SNAPSHOT_STATE(s_welderSpark);
+	SNAPSHOT_STATE(s_curWelder);
+	SNAPSHOT_STATE(s_shared);
 
 	void welder_exit()
 	{
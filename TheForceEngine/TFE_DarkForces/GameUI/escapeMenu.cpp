@@ -19,6 +19,7 @@
 #include <TFE_Jedi/Level/rtexture.h>
 #include <TFE_Jedi/Level/roffscreenBuffer.h>
 #include <TFE_System/system.h>
+#include <TFE_System/framePipeline.h>
 
 using namespace TFE_Jedi;
 using namespace TFE_Input;
@@ -237,11 +238,17 @@ namespace TFE_DarkForces
 		}
 	}
 
+	// The menu can be opened during a pipelined simulation step, the post effect chain belongs to the main thread.
+	void escapeMenu_enableBloom(bool enable)
+	{
+		TFE_System::framePipeline_runOnMainThread([enable]() { TFE_RenderBackend::bloomPostEnable(enable); });
+	}
+
 	void escapeMenu_open(u8* framebuffer, u8* palette)
 	{
 		// TFE
 		reticle_enable(false);
-		TFE_RenderBackend::bloomPostEnable(false);
+		escapeMenu_enableBloom(false);
 
 		pauseLevelSound();
 		s_emState.escMenuOpen = JTRUE;
@@ -266,7 +273,7 @@ namespace TFE_DarkForces
 
 		// TFE
 		reticle_enable(true);
-		TFE_RenderBackend::bloomPostEnable(true);
+		escapeMenu_enableBloom(true);
 	}
 
 	JBool escapeMenu_isOpen()
@@ -541,7 +548,7 @@ namespace TFE_DarkForces
 
 			// TFE
 			reticle_enable(true);
-			TFE_RenderBackend::bloomPostEnable(true);
+			escapeMenu_enableBloom(true);
 		}
 
 		escapeMenu_draw(JTRUE, JTRUE);
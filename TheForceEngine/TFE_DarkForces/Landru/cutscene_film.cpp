@@ -1075,6 +1075,16 @@ namespace TFE_DarkForces
 		}
 	}
 
+	// Films with a draw function are not tracked by the view dirty rects.
+	JBool cutsceneFilm_hasVisibleDrawFunc()
+	{
+		for (Film* film = s_filmState.firstFilm; film; film = film->next)
+		{
+			if (film->drawFunc && (film->flags & CF_STATE_VISIBLE)) { return JTRUE; }
+		}
+		return JFALSE;
+	}
+
 	void cutsceneFilm_add(Film* film)
 	{
 		Film* curFilm = s_filmState.firstFilm;
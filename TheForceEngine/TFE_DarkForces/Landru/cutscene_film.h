@@ -141,4 +141,5 @@ namespace TFE_DarkForces
 	void cutsceneFilm_updateFilms(s32 time);
 	void cutsceneFilm_updateCallbacks(s32 time);
 	void cutsceneFilm_drawFilms(JBool refresh);
+	JBool cutsceneFilm_hasVisibleDrawFunc();
 }  // TFE_DarkForces
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "lactor.h"
+#include "lactorAnim.h"
+#include "lactorCust.h"
+#include "lactorDelt.h"
 #include "lsystem.h"
 #include "lcanvas.h"
 #include "lview.h"
 #include "ltimer.h"
 #include <TFE_Game/igame.h>
+#include <TFE_System/hash.h>
 #include <cassert>
 #include <cstring>
 
@@ -131,6 +135,11 @@ namespace TFE_DarkForces
 			}
 			actor->next = nullptr;
 		}
+
+		// The area the actor covered has to be redrawn.
+		lview_addDirtyRect(&actor->screenRect);
+		lrect_clear(&actor->screenRect);
+		actor->drawKey = 0;
 	}
 
 	LActor* lactor_alloc(s16 extend)
@@ -187,11 +196,114 @@ namespace TFE_DarkForces
 		s_refreshActors = JTRUE;
 	}
 
+	u8* lactor_getDrawData(LActor* actor)
+	{
+		return (actor->drawFunc == lactorAnim_draw) ? lactor_getArrayData(actor, actor->state) : actor->data;
+	}
+
+	// Build a key from everything that changes how the actor is drawn, other than its position.
+	u64 lactor_getDrawKey(LActor* actor)
+	{
+		const s16 flagMask = LAFLAG_VISIBLE | LAFLAG_REFRESHABLE | LAFLAG_REFRESH | LAFLAG_HFLIP | LAFLAG_VFLIP | LAFLAG_COLOR;
+		const s16 flags = actor->flags & flagMask;
+
+		u64 key = TFE_Hash::fnv1a64Value(actor->drawFunc);
+		key = TFE_Hash::fnv1a64Value(lactor_getDrawData(actor), key);
+		key = TFE_Hash::fnv1a64Value(actor->frame, key);
+		key = TFE_Hash::fnv1a64Value(actor->bounds, key);
+		key = TFE_Hash::fnv1a64Value(flags, key);
+		key = TFE_Hash::fnv1a64Value(actor->zplane, key);
+		key = TFE_Hash::fnv1a64Value(actor->state, key);
+		key = TFE_Hash::fnv1a64Value(actor->w, key);
+		key = TFE_Hash::fnv1a64Value(actor->h, key);
+		key = TFE_Hash::fnv1a64Value(actor->fgColor, key);
+		key = TFE_Hash::fnv1a64Value(actor->bgColor, key);
+		key = TFE_Hash::fnv1a64Value(actor->xScale, key);
+		key = TFE_Hash::fnv1a64Value(actor->yScale, key);
+		// Zero is reserved for actors that have not been drawn yet.
+		return key ? key : 1;
+	}
+
+	// Get the screen area covered by the actor image when drawn at (x, y).
+	// Returns JFALSE if the draw function is unknown, in which case it may draw anywhere.
+	JBool lactor_getDrawRect(LActor* actor, s16 x, s16 y, LRect* rect)
+	{
+		if (actor->drawFunc == lactorDelt_draw || actor->drawFunc == lactorAnim_draw)
+		{
+			u8* data = lactor_getDrawData(actor);
+			if (data) { lactorDelt_getDrawRect(actor, data, x, y, rect); }
+			else { lrect_clear(rect); }
+			return JTRUE;
+		}
+		else if (actor->drawFunc == lactorCust_draw)
+		{
+			lrect_set(rect, x, y, x + actor->w, y + actor->h);
+			return JTRUE;
+		}
+		return JFALSE;
+	}
+
+	// Compare each actor against the way it was drawn last frame and add the areas that changed
+	// to the view dirty region. Returns JFALSE if the whole screen needs to be redrawn instead.
+	JBool lactor_updateDirtyRects(JBool refresh)
+	{
+		JBool canTrack = s_refreshActors ? JFALSE : JTRUE;
+		refresh |= s_refreshActors;
+
+		for (LActor* actor = s_actorList; actor; actor = actor->next)
+		{
+			LRect screenRect;
+			lrect_clear(&screenRect);
+
+			s32 curRefresh = (actor->flags&LAFLAG_REFRESH) | (actor->flags&LAFLAG_REFRESHABLE) | refresh;
+			if (actor->drawFunc && lactor_isVisible(actor) && curRefresh)
+			{
+				for (s32 i = 0; i < LVIEW_COUNT; i++)
+				{
+					LRect rect, clipRect;
+					lview_getFrame(i, &rect);
+					if (lrect_isEmpty(&rect) || !lview_clipObjToView(i, actor->zplane, &actor->frame, &rect, &clipRect))
+					{
+						continue;
+					}
+
+					s16 x, y;
+					lactor_getRelativePos(actor, &rect, &x, &y);
+
+					LRect drawRect;
+					if (!lactor_getDrawRect(actor, x, y, &drawRect))
+					{
+						canTrack = JFALSE;
+						drawRect = clipRect;
+					}
+					if (lrect_clip(&drawRect, &clipRect))
+					{
+						lrect_enclose(&screenRect, &drawRect);
+					}
+				}
+			}
+
+			const u64 drawKey = lactor_getDrawKey(actor);
+			if (drawKey != actor->drawKey || !lrect_equal(&screenRect, &actor->screenRect))
+			{
+				lview_addDirtyRect(&actor->screenRect);
+				lview_addDirtyRect(&screenRect);
+				actor->screenRect = screenRect;
+				actor->drawKey = drawKey;
+			}
+		}
+		return canTrack;
+	}
+
 	void lactor_draw(JBool refresh)
 	{
 		refresh |= s_refreshActors;
 		s_refreshActors = JFALSE;
 
+		// Only the dirty parts of the screen are redrawn.
+		LRect* dirtyRects;
+		s32 dirtyCount = lview_getDirtyRects(&dirtyRects);
+
 		LActor* actorList = lactor_getList();
 		for (s32 i = 0; i < LVIEW_COUNT; i++)
 		{
@@ -211,11 +323,18 @@ namespace TFE_DarkForces
 						if (lview_clipObjToView(i, curActor->zplane, &curActor->frame, &rect, &clipRect))
 						{
 							s32 curRefresh = (curActor->flags&LAFLAG_REFRESH) | (curActor->flags&LAFLAG_REFRESHABLE) | refresh;
-							lcanvas_setClip(&clipRect);
-
 							s16 x, y;
 							lactor_getRelativePos(curActor, &rect, &x, &y);
-							curActor->drawFunc(curActor, &rect, &clipRect, x, y, curRefresh ? JTRUE : JFALSE);
+
+							// The dirty rects do not overlap, so each pixel is still drawn in the same order.
+							for (s32 d = 0; d < dirtyCount; d++)
+							{
+								LRect drawClip = clipRect;
+								if (!lrect_clip(&drawClip, &dirtyRects[d])) { continue; }
+
+								lcanvas_setClip(&drawClip);
+								curActor->drawFunc(curActor, &rect, &drawClip, x, y, curRefresh ? JTRUE : JFALSE);
+							}
 						}
 					}
 
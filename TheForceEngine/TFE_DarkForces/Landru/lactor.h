@@ -88,6 +88,11 @@ namespace TFE_DarkForces
 		LActorDrawFunc   drawFunc;
 		LActorUpdateFunc updateFunc;
 		LActorCallback   callbackFunc;
+
+		// Screen area covered when last drawn and a key built from the state that affects drawing.
+		// Used to find the parts of the screen that need to be redrawn.
+		LRect screenRect;
+		u64   drawKey;
 	};
 
 	struct LActorType
@@ -116,6 +121,7 @@ namespace TFE_DarkForces
 	LActor* lactor_find(u32 type, const char* name);
 
 	void lactor_refresh();
+	JBool lactor_updateDirtyRects(JBool refresh);
 	void lactor_draw(JBool refresh);
 	void lactor_update(LTick time);
 	void lactor_updateCallbacks(LTick time);
@@ -127,6 +133,7 @@ namespace TFE_DarkForces
 	
 	void lactor_setName(LActor* actor, u32 resType, const char* name);
 	void lactor_getRelativePos(LActor* actor, LRect* rect, s16* x, s16* y);
+	JBool lactor_getDrawRect(LActor* actor, s16 x, s16 y, LRect* rect);
 	void lactor_getOffset(LActor* actor, s16* x, s16* y);
 	void lactor_setPos(LActor* actor, s16 x, s16 y, s16 xFract, s16 yFract);
 	void lactor_getPos(LActor* actor, s16* x, s16* y, s16* xFract, s16* yFract);
@@ -12,7 +12,6 @@ namespace TFE_DarkForces
 	static JBool s_lactorCustInit = JFALSE;
 
 	void  lactorCust_initActor(LActor* actor, LRect* frame, s16 xOffset, s16 yOffset, s16 zPlane);
-	JBool lactorCust_draw(LActor* actor, LRect* rect, LRect* clipRect, s16 x, s16 y, JBool refresh);
 	void  lactorCust_update(LActor* actor);
 	
 	void lactorCust_init()
@@ -14,4 +14,5 @@ namespace TFE_DarkForces
 	void lactorCust_destroy();
 
 	LActor* lactorCust_alloc(u8* custom, LRect* frame, s16 xOffset, s16 yOffset, s16 zPlane);
+	JBool lactorCust_draw(LActor* actor, LRect* rect, LRect* clipRect, s16 x, s16 y, JBool refresh);
 }  // namespace TFE_DarkForces
\ No newline at end of file
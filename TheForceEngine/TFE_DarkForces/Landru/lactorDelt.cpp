@@ -150,6 +150,21 @@ namespace TFE_DarkForces
 		return retValue;
 	}
 		
+	// Get the screen area covered by the delta image when drawn at (x, y), matching the draw functions below.
+	void lactorDelt_getDrawRect(LActor* actor, u8* data, s16 x, s16 y, LRect* rect)
+	{
+		s16* data16 = (s16*)data;
+		if (actor->flags & LAFLAG_HFLIP)
+		{
+			s16 w = actor->bounds.right + actor->bounds.left - 1;
+			lrect_set(rect, w - data16[2] + x, data16[1] + y, w - data16[0] + x + 1, data16[3] + y + 1);
+		}
+		else
+		{
+			lrect_set(rect, data16[0] + x, data16[1] + y, data16[2] + x + 1, data16[3] + y + 1);
+		}
+	}
+
 	JBool lactorDelt_drawClipped(u8* data, s16 x, s16 y, JBool dirty)
 	{
 		s16* data16 = (s16*)data;
@@ -14,6 +14,7 @@ namespace TFE_DarkForces
 	void lactorDelt_destroy();
 
 	void lactorDelt_getFrame(LActor* actor, LRect* rect);
+	void lactorDelt_getDrawRect(LActor* actor, u8* data, s16 x, s16 y, LRect* rect);
 
 	LActor* lactorDelt_alloc(u8* delta,LRect* frame, s16 xOffset, s16 yOffset, s16 zPlane);
 	LActor* lactorDelt_load(const char* name, LRect* rect, s16 x, s16 y, s16 zPlane);
@@ -4,6 +4,7 @@
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/Renderer/virtualFramebuffer.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <map>
@@ -157,6 +158,24 @@ namespace TFE_DarkForces
 		drawDeltaIntoBitmap(data, x, y, ldraw_state.bitmap, ldraw_state.bitmapWidth);
 	}
 
+	// Skip over the pixel data of a delta line, returns the start of the next line.
+	static u8* deltaSkipLine(u8* srcImage, JBool rle, s32 pixelCount)
+	{
+		if (!rle)
+		{
+			return srcImage + pixelCount;
+		}
+		while (pixelCount > 0)
+		{
+			const u8 count = *srcImage; srcImage++;
+			srcImage += (count & 1) ? 1 : (count >> 1);
+			pixelCount -= count >> 1;
+		}
+		return srcImage;
+	}
+
+	// Lines outside of the clip rect are skipped without decoding and runs are clipped as a whole,
+	// so the cost depends on the clipped area rather than the full image.
 	void deltaClip(s16* data, s16 x, s16 y)
 	{
 		u8* framebuffer = ldraw_state.bitmap;
@@ -178,55 +197,32 @@ namespace TFE_DarkForces
 
 			const JBool rle = (sizeAndType & 1) ? JTRUE : JFALSE;
 			s32 pixelCount = (sizeAndType >> 1) & 0x3fff;
+			if (yStart < clipRect.top || yStart >= clipRect.bottom)
+			{
+				srcImage = deltaSkipLine(srcImage, rle, pixelCount);
+				continue;
+			}
 			u8* dstImage = &framebuffer[yStart*stride];
-			
-			s16 xCur = xStart;
-			s16 yCur = yStart;
-			JBool writeRow = (yCur >= clipRect.top && yCur < clipRect.bottom) ? JTRUE : JFALSE;
 
+			s32 xCur = xStart;
 			while (pixelCount > 0)
 			{
-				if (rle)
+				const u8 count = rle ? *srcImage++ : 0;
+				const s32 runCount = rle ? (count >> 1) : pixelCount;
+				const s32 x0 = std::max(xCur, s32(clipRect.left));
+				const s32 x1 = std::min(xCur + runCount, s32(clipRect.right));
+				if (rle && (count & 1))	// rle
 				{
-					//read count byte...
-					u8 count = *srcImage; srcImage++;
-					if (!(count & 1)) // direct
-					{
-						count >>= 1;
-						for (s32 p = 0; p < count; p++, srcImage++, xCur++)
-						{
-							if (writeRow && xCur >= clipRect.left && xCur < clipRect.right)
-							{
-								dstImage[xCur] = *srcImage;
-							}
-						}
-						pixelCount -= count;
-					}
-					else	//rle
-					{
-						count >>= 1;
-						const u8 pixel = *srcImage; srcImage++;
-						for (s32 p = 0; p < count; p++, xCur++)
-						{
-							if (writeRow && xCur >= clipRect.left && xCur < clipRect.right)
-							{
-								dstImage[xCur] = pixel;
-							}
-						}
-						pixelCount -= count;
-					}
+					if (x0 < x1) { memset(&dstImage[x0], *srcImage, x1 - x0); }
+					srcImage++;
 				}
-				else
+				else	// direct
 				{
-					for (s32 p = 0; p < pixelCount; p++, srcImage++, xCur++)
-					{
-						if (writeRow && xCur >= clipRect.left && xCur < clipRect.right)
-						{
-							dstImage[xCur] = *srcImage;
-						}
-					}
-					pixelCount = 0;
+					if (x0 < x1) { memcpy(&dstImage[x0], &srcImage[x0 - xCur], x1 - x0); }
+					srcImage += runCount;
 				}
+				xCur += runCount;
+				pixelCount -= runCount;
 			}
 		}
 	}
@@ -306,7 +302,6 @@ namespace TFE_DarkForces
 		{
 			const s16* deltaLine = (s16*)srcImage;
 			s16 sizeAndType = deltaLine[0];
-			s16 xStart = deltaLine[1] + x;
 			s16 yStart = deltaLine[2] + y;
 			srcImage += 3 * sizeof(s16);
 
@@ -314,55 +309,36 @@ namespace TFE_DarkForces
 
 			const JBool rle = (sizeAndType & 1) ? JTRUE : JFALSE;
 			s32 pixelCount = (sizeAndType >> 1) & 0x3fff;
+			if (yStart < clipRect.top || yStart >= clipRect.bottom)
+			{
+				srcImage = deltaSkipLine(srcImage, rle, pixelCount);
+				continue;
+			}
 			u8* dstImage = &framebuffer[yStart*stride];
 
-			s16 xCur = w - deltaLine[1] + x;
-			s16 yCur = yStart;
-			JBool writeRow = (yCur >= clipRect.top && yCur < clipRect.bottom) ? JTRUE : JFALSE;
-
+			// Pixels are written right to left, a run covers (xCur - runCount, xCur].
+			s32 xCur = s16(w - deltaLine[1] + x);
 			while (pixelCount > 0)
 			{
-				if (rle)
+				const u8 count = rle ? *srcImage++ : 0;
+				const s32 runCount = rle ? (count >> 1) : pixelCount;
+				const s32 x0 = std::max(xCur - runCount + 1, s32(clipRect.left));
+				const s32 x1 = std::min(xCur + 1, s32(clipRect.right));
+				if (rle && (count & 1))	// rle
 				{
-					//read count byte...
-					u8 count = *srcImage; srcImage++;
-					if (!(count & 1)) // direct
-					{
-						count >>= 1;
-						for (s32 p = 0; p < count; p++, srcImage++, xCur--)
-						{
-							if (writeRow && xCur >= clipRect.left && xCur < clipRect.right)
-							{
-								dstImage[xCur] = *srcImage;
-							}
-						}
-						pixelCount -= count;
-					}
-					else	//rle
-					{
-						count >>= 1;
-						const u8 pixel = *srcImage; srcImage++;
-						for (s32 p = 0; p < count; p++, xCur--)
-						{
-							if (writeRow && xCur >= clipRect.left && xCur < clipRect.right)
-							{
-								dstImage[xCur] = pixel;
-							}
-						}
-						pixelCount -= count;
-					}
+					if (x0 < x1) { memset(&dstImage[x0], *srcImage, x1 - x0); }
+					srcImage++;
 				}
-				else
+				else	// direct
 				{
-					for (s32 p = 0; p < pixelCount; p++, srcImage++, xCur--)
+					for (s32 xd = x0; xd < x1; xd++)
 					{
-						if (writeRow && xCur >= clipRect.left && xCur < clipRect.right)
-						{
-							dstImage[xCur] = *srcImage;
-						}
+						dstImage[xd] = srcImage[xCur - xd];
 					}
-					pixelCount = 0;
+					srcImage += runCount;
 				}
+				xCur -= runCount;
+				pixelCount -= runCount;
 			}
 		}
 	}
@@ -8,6 +8,8 @@
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/Renderer/virtualFramebuffer.h>
 #include <TFE_Jedi/Math/core_math.h>
+#include <TFE_FrontEndUI/console.h>
+#include <TFE_System/system.h>
 #include <cassert>
 #include <cstring>
 
@@ -15,6 +17,24 @@ using namespace TFE_Jedi;
 
 namespace TFE_DarkForces
 {
+	enum LViewDirtyConstants
+	{
+		LVIEW_MAX_DIRTY_RECTS = 16,
+	};
+
+	// The view state that determines where things are drawn, if any of it changes the whole screen is redrawn.
+	struct LViewDrawState
+	{
+		LRect frame[LVIEW_COUNT];
+		s16   zStart[LVIEW_COUNT];
+		s16   zStop[LVIEW_COUNT];
+		s16   xRel[LVIEW_COUNT];
+		s16   yRel[LVIEW_COUNT];
+		s16   clearView[LVIEW_COUNT];
+		LRect clipFrame;
+		s16   clear;
+	};
+
 	LView* s_view = nullptr;
 	JBool s_lviewInit = JFALSE;
 	JBool s_updateView = JTRUE;
@@ -22,14 +42,23 @@ namespace TFE_DarkForces
 	static JBool s_running = JFALSE;
 	static s32 s_exitValue = VIEW_LOOP_RUNNING;
 
+	// Dirty rects, these never overlap.
+	static LRect s_dirtyRects[LVIEW_MAX_DIRTY_RECTS];
+	static s32 s_dirtyCount = 0;
+	static JBool s_redrawAll = JTRUE;
+	static LView* s_drawStateView = nullptr;
+	static LViewDrawState s_drawState;
+
 	void lview_freeData(LView* view);
 	void lview_initView(LView* view);
 	void lview_trackView(s16 viewIndex, s16 snap);
 	void lview_update(s32 time);
 	void lview_updateCallback(s32 time);
+	void lview_drawBenchmarkConsole(const ConsoleArgList& args);
 
 	void lview_init()
 	{
+		CCMD("landruDrawBenchmark", lview_drawBenchmarkConsole, 0, "Time clearing and drawing the cutscene actors using the current dirty rects and using the whole screen. Optional argument: iterations (default 100).");
 		s_defaultView = lview_alloc();
 		if (s_defaultView)
 		{
@@ -89,23 +118,125 @@ namespace TFE_DarkForces
 		view->updateFunc = nullptr;
 	}
 
-	void lview_clear()
+	void lview_addDirtyRect(LRect* rect)
+	{
+		LRect bounds;
+		lcanvas_getBounds(&bounds);
+		LRect dirty = *rect;
+		if (!lrect_clip(&dirty, &bounds)) { return; }
+
+		// Merge with any overlapping rects, so that the rects never overlap.
+		for (s32 i = 0; i < s_dirtyCount;)
+		{
+			if (lrect_intersect(&dirty, &s_dirtyRects[i]))
+			{
+				lrect_enclose(&dirty, &s_dirtyRects[i]);
+				s_dirtyRects[i] = s_dirtyRects[--s_dirtyCount];
+				i = 0;
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		// Too many rects, collapse them into one.
+		if (s_dirtyCount == LVIEW_MAX_DIRTY_RECTS)
+		{
+			for (s32 i = 0; i < s_dirtyCount; i++)
+			{
+				lrect_enclose(&dirty, &s_dirtyRects[i]);
+			}
+			s_dirtyCount = 0;
+		}
+		s_dirtyRects[s_dirtyCount++] = dirty;
+	}
+
+	s32 lview_getDirtyRects(LRect** rects)
+	{
+		*rects = s_dirtyRects;
+		return s_dirtyCount;
+	}
+
+	// Force the whole screen to be redrawn on the next frame.
+	void lview_invalidate()
+	{
+		s_redrawAll = JTRUE;
+	}
+
+	void lview_getDrawState(LViewDrawState* state)
 	{
-		if (s_view->clear)
+		memset(state, 0, sizeof(LViewDrawState));
+		for (s32 i = 0; i < LVIEW_COUNT; i++)
+		{
+			state->frame[i]     = s_view->frame[i];
+			state->zStart[i]    = s_view->zStart[i];
+			state->zStop[i]     = s_view->zStop[i];
+			state->xRel[i]      = s_view->xRel[i];
+			state->yRel[i]      = s_view->yRel[i];
+			state->clearView[i] = s_view->clearView[i];
+		}
+		state->clipFrame = s_view->clipFrame;
+		state->clear = s_view->clear;
+	}
+
+	// Build the dirty region for this frame from the actors that changed.
+	// The whole screen is redrawn when the world is refreshed, the view changes or something cannot be tracked.
+	void lview_updateDirtyRegion(JBool refresh)
+	{
+		s_dirtyCount = 0;
+		JBool redrawAll = s_redrawAll || refresh;
+		s_redrawAll = JFALSE;
+
+		LViewDrawState state;
+		lview_getDrawState(&state);
+		if (s_drawStateView != s_view || memcmp(&state, &s_drawState, sizeof(LViewDrawState)) != 0)
 		{
-			lcanvas_eraseRect(&s_view->clipFrame);
+			redrawAll = JTRUE;
 		}
-		else
+		s_drawStateView = s_view;
+		s_drawState = state;
+
+		// Always update the actors so their screen rects stay current.
+		if (!lactor_updateDirtyRects(refresh) || cutsceneFilm_hasVisibleDrawFunc())
+		{
+			redrawAll = JTRUE;
+		}
+
+		if (redrawAll)
+		{
+			s_dirtyCount = 1;
+			lcanvas_getBounds(&s_dirtyRects[0]);
+		}
+	}
+
+	void lview_clear()
+	{
+		for (s32 d = 0; d < s_dirtyCount; d++)
 		{
-			for (s32 i = 0; i < LVIEW_COUNT; i++)
+			if (s_view->clear)
 			{
-				if (s_view->clearView[i] & LVIEW_FLAG_CLEAR)
+				LRect rect = s_view->clipFrame;
+				if (lrect_clip(&rect, &s_dirtyRects[d]))
 				{
-					LRect rect;
-					lview_getViewClipFrame(i, &rect);
 					lcanvas_eraseRect(&rect);
 				}
 			}
+			else
+			{
+				for (s32 i = 0; i < LVIEW_COUNT; i++)
+				{
+					if (s_view->clearView[i] & LVIEW_FLAG_CLEAR)
+					{
+						LRect rect;
+						lview_getViewClipFrame(i, &rect);
+						if (lrect_clip(&rect, &s_dirtyRects[d]))
+						{
+							lcanvas_eraseRect(&rect);
+						}
+					}
+				}
+			}
 		}
 	}
 
@@ -116,6 +247,62 @@ namespace TFE_DarkForces
 		// TODO: System dialogs.
 	}
 
+	// TFE: Time lview_clear() + lactor_draw() with the current dirty rects (after) and with the whole screen (before).
+	// Every actor is refreshed so both passes do the full draw work, then the world is refreshed so the next frame
+	// redraws everything normally.
+	void lview_drawBenchmarkConsole(const ConsoleArgList& args)
+	{
+		if (!s_lviewInit || !s_view)
+		{
+			TFE_Console::addToHistory("landruDrawBenchmark: no cutscene view is active.");
+			return;
+		}
+		const s32 iterations = args.size() >= 2 ? std::max(1, s32(strtol(args[1].c_str(), nullptr, 10))) : 100;
+
+		LRect dirtyRects[LVIEW_MAX_DIRTY_RECTS];
+		const s32 dirtyCount = s_dirtyCount;
+		memcpy(dirtyRects, s_dirtyRects, sizeof(LRect) * dirtyCount);
+		s32 dirtyArea = 0;
+		for (s32 d = 0; d < dirtyCount; d++)
+		{
+			dirtyArea += (dirtyRects[d].right - dirtyRects[d].left) * (dirtyRects[d].bottom - dirtyRects[d].top);
+		}
+
+		f64 timeMs[2];
+		for (s32 pass = 0; pass < 2; pass++)
+		{
+			if (pass == 0)
+			{
+				s_dirtyCount = 1;
+				lcanvas_getBounds(&s_dirtyRects[0]);
+			}
+			else
+			{
+				s_dirtyCount = dirtyCount;
+				memcpy(s_dirtyRects, dirtyRects, sizeof(LRect) * dirtyCount);
+			}
+
+			const u64 start = TFE_System::getCurrentTimeInTicks();
+			for (s32 i = 0; i < iterations; i++)
+			{
+				lview_clear();
+				lactor_draw(JTRUE);
+			}
+			timeMs[pass] = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start) / f64(iterations);
+		}
+		lview_refreshWorld();
+
+		LRect bounds;
+		lcanvas_getBounds(&bounds);
+		const s32 screenArea = (bounds.right - bounds.left) * (bounds.bottom - bounds.top);
+
+		char res[256];
+		sprintf(res, "Landru draw: whole screen %0.3f ms, %d dirty rect(s) covering %d of %d pixels %0.3f ms.",
+			timeMs[0], dirtyCount, dirtyArea, screenArea, timeMs[1]);
+		TFE_Console::addToHistory(res);
+		TFE_System::logWrite(LOG_MSG, "Landru", "%s", res);
+	}
+
 	void lview_blit()
 	{
 		// Note: in Dark Forces, the fade is a while loop, pausing the view code.
@@ -131,6 +318,8 @@ namespace TFE_DarkForces
 		s_view->step = 0;
 		s_view->stepCount = 0;
 		s_exitValue = VIEW_LOOP_RUNNING;
+		// The canvas may have been drawn to outside of the view loop.
+		lview_invalidate();
 	}
 
 	void lview_endLoop()
@@ -156,6 +345,7 @@ namespace TFE_DarkForces
 				lview_updateCallback(s_view->time);
 			}
 
+			lview_updateDirtyRegion(s_view->refreshWorld);
 			lview_clear();
 			lview_draw(s_view->refreshWorld);
 			s_view->refreshWorld = JFALSE;
@@ -208,6 +398,7 @@ namespace TFE_DarkForces
 	void lview_setCurrent(LView* view)
 	{
 		s_view = view;
+		lview_invalidate();
 	}
 
 	LView* lview_getCurrent()
@@ -67,6 +67,11 @@ namespace TFE_DarkForces
 	void lview_endLoop();
 	s32  lview_loop();
 
+	// Dirty rectangles: only the parts of the screen that changed since the last frame are cleared and redrawn.
+	void lview_addDirtyRect(LRect* rect);
+	s32  lview_getDirtyRects(LRect** rects);
+	void lview_invalidate();
+
 	void lview_setCurrent(LView* view);
 	LView* lview_getCurrent();
 
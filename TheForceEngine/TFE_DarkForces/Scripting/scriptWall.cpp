@@ -131,6 +131,7 @@ namespace TFE_DarkForces
 			lvlWall->nextSector = nullptr;
 
 			sector_setupWallDrawFlags(sector);
+			sector->dirtyFlags |= SDF_WALL_SHAPE;
 		}
 		else
 		{
@@ -138,6 +139,8 @@ namespace TFE_DarkForces
 
 			sector_setupWallDrawFlags(sector);
 			sector_setupWallDrawFlags(lvlWall->nextSector);
+			sector->dirtyFlags |= SDF_WALL_SHAPE;
+			lvlWall->nextSector->dirtyFlags |= SDF_WALL_SHAPE;
 		}
 	}
 	void setMirror(s32 id, ScriptWall* wall)
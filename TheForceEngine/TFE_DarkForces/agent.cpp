@@ -13,6 +13,7 @@
 #include <TFE_System/system.h>
 #include <TFE_System/parser.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <assert.h>
 
 namespace TFE_DarkForces
@@ -33,6 +34,10 @@ namespace TFE_DarkForces
 
 	static Task* s_levelEndTask = nullptr;
 
+	SNAPSHOT_STATE(s_agentData);
+	SNAPSHOT_STATE(s_levelComplete);
+	SNAPSHOT_STATE(s_levelEndTask);
+
 	void agent_writeSavedData(s32 agentId, LevelSaveData* saveData);
 	void agent_readSavedData(s32 agentId, LevelSaveData* levelData);
 		
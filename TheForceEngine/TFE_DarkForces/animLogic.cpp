@@ -3,6 +3,7 @@
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/InfSystem/message.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 using namespace TFE_Jedi;
 
@@ -10,6 +11,8 @@ namespace TFE_DarkForces
 {
 	Allocator* s_spriteAnimList = nullptr;
 	Task* s_spriteAnimTask = nullptr;
+	SNAPSHOT_STATE(s_spriteAnimList);
+	SNAPSHOT_STATE(s_spriteAnimTask);
 
 	void setSpriteAnimation(Task* spriteAnimTask, Allocator* spriteAnimAlloc)
 	{
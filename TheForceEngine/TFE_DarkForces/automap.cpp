@@ -12,7 +12,10 @@
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 #include <TFE_Jedi/Renderer/screenDraw.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_Settings/settings.h>
+#include <algorithm>
+#include <vector>
 
 using namespace TFE_Jedi;
 
@@ -47,7 +50,31 @@ namespace TFE_DarkForces
 
 	enum MapConstants
 	{
-		MOBJSPRITE_DRAW_LEN = FIXED(2)
+		MOBJSPRITE_DRAW_LEN = FIXED(2),
+		// Line cache grid.
+		MAP_LINES_PER_CELL  = 16,
+		MAP_MAX_GRID_DIM    = 64,
+	};
+
+	// TFE: The map lines are cached per layer and bucketed into a coarse grid by their bounds,
+	// so that only the lines near the visible part of the map need to be projected and drawn.
+	// The line color and seen state are still evaluated when drawing, since they change often.
+	struct MapLayerGrid
+	{
+		fixed16_16 minX;
+		fixed16_16 minZ;
+		fixed16_16 cellSize;
+		s32 cellCountX;
+		s32 cellCountZ;
+		std::vector<u32> cellStart;		// cellCountX * cellCountZ + 1 offsets into cellLines.
+		std::vector<u32> cellLines;		// Line indices.
+		std::vector<u32> dynamicLines;	// Lines that can move at runtime, these are always tested.
+	};
+
+	struct MapViewBounds
+	{
+		s64 minX, maxX;
+		s64 minZ, maxZ;
 	};
 
 	static fixed16_16 s_screenScale = 0xc000;	// 0.75
@@ -70,6 +97,13 @@ namespace TFE_DarkForces
 	static s32 s_mapPrevPlayerX;
 	static s32 s_mapPrevPlayerZ;
 	static u8* s_mapFramebuffer;
+
+	static JBool s_mapCacheValid = JFALSE;
+	static std::vector<RWall*> s_mapLines;		// All walls, in sector order so lines are drawn in the original order.
+	static std::vector<u32> s_mapLineStamp;		// Used to skip lines that overlap several cells.
+	static std::vector<MapLayerGrid> s_mapLayerGrid;
+	static std::vector<u32> s_mapVisibleLines;
+	static u32 s_mapStamp = 0;
 	
 	JBool s_pdaActive = JFALSE;
 	JBool s_drawAutomap = JFALSE;
@@ -80,6 +114,40 @@ namespace TFE_DarkForces
 	fixed16_16 s_mapZ1;
 	s32 s_mapLayer;
 
+	SNAPSHOT_STATE(s_screenScale);
+	SNAPSHOT_STATE(s_scrLeftScaled);
+	SNAPSHOT_STATE(s_scrRightScaled);
+	SNAPSHOT_STATE(s_scrTopScaled);
+	SNAPSHOT_STATE(s_scrBotScaled);
+	SNAPSHOT_STATE(s_automapAutoCenter);
+	SNAPSHOT_STATE(s_mapXCenterInPixels);
+	SNAPSHOT_STATE(s_mapZCenterInPixels);
+	SNAPSHOT_STATE(s_mapTop);
+	SNAPSHOT_STATE(s_mapLeft);
+	SNAPSHOT_STATE(s_mapRight);
+	SNAPSHOT_STATE(s_mapBot);
+	SNAPSHOT_STATE(s_mapShowSectorMode);
+	SNAPSHOT_STATE(s_mapShowAllLayers);
+	SNAPSHOT_STATE(s_mapPrevPlayerX);
+	SNAPSHOT_STATE(s_mapPrevPlayerZ);
+	SNAPSHOT_STATE(s_drawAutomap);
+	SNAPSHOT_STATE(s_automapLocked);
+	SNAPSHOT_STATE(s_mapX0);
+	SNAPSHOT_STATE(s_mapX1);
+	SNAPSHOT_STATE(s_mapZ0);
+	SNAPSHOT_STATE(s_mapZ1);
+	SNAPSHOT_STATE(s_mapLayer);
+
+	// The cached lines depend on which walls have been seen, which is restored with the level.
+	static void automap_snapshotState(Stream* stream, bool writeState)
+	{
+		if (!writeState)
+		{
+			s_mapCacheValid = JFALSE;
+		}
+	}
+	SNAPSHOT_STATE_FUNC(automap_snapshotState);
+
 	void automap_projectPosition(fixed16_16* x, fixed16_16* z);
 	void automap_drawPointWithRadius(fixed16_16 x, fixed16_16 z, fixed16_16 r, u8 color);
 	void automap_drawPointWithDirection(fixed16_16 x, fixed16_16 z, angle14_32 angle, fixed16_16 len, u8 color);
@@ -87,10 +155,11 @@ namespace TFE_DarkForces
 	void automap_drawLine(fixed16_16 px1, fixed16_16 pz1, fixed16_16 px2, fixed16_16 pz2, u8 color);
 	void automap_drawWall(RWall* wall, u8 color);
 	void automap_drawObject(SecObject* obj);
-	void automap_drawSector(RSector* sector);
 	void automap_drawPlayer(s32 layer);
 	void automap_drawSectors();
+	void automap_drawSectorObjects(RSector* sector);
 	void automap_updateDeltaCoords(s32 x, s32 z);
+	void automap_drawWallIfVisible(RWall* wall);
 
 	void automap_serialize(Stream* stream)
 	{
@@ -122,6 +191,219 @@ namespace TFE_DarkForces
 		SERIALIZE(SaveVersionInit, s_mapZ0, 0);
 		SERIALIZE(SaveVersionInit, s_mapZ1, 0);
 		SERIALIZE(SaveVersionInit, s_mapLayer, 0);
+
+		// The level is being replaced.
+		automap_invalidateCache();
+	}
+
+	void automap_invalidateCache()
+	{
+		s_mapCacheValid = JFALSE;
+		s_mapLines.clear();
+		s_mapLineStamp.clear();
+		s_mapLayerGrid.clear();
+	}
+
+	JBool automap_isDynamicWall(RWall* wall)
+	{
+		if (wall->flags1 & WF1_WALL_MORPHS) { return JTRUE; }
+		return (wall->mirrorWall && (wall->mirrorWall->flags1 & WF1_WALL_MORPHS)) ? JTRUE : JFALSE;
+	}
+
+	void automap_getLineBounds(RWall* wall, fixed16_16* minX, fixed16_16* maxX, fixed16_16* minZ, fixed16_16* maxZ)
+	{
+		*minX = min(wall->w0->x, wall->w1->x);
+		*maxX = max(wall->w0->x, wall->w1->x);
+		*minZ = min(wall->w0->z, wall->w1->z);
+		*maxZ = max(wall->w0->z, wall->w1->z);
+	}
+
+	s32 automap_getCell(s64 pos, fixed16_16 gridMin, fixed16_16 cellSize, s32 cellCount)
+	{
+		const s64 cell = (pos - gridMin) / cellSize;
+		return cell < 0 ? 0 : (cell >= cellCount ? cellCount - 1 : s32(cell));
+	}
+
+	void automap_getCellRange(MapLayerGrid* grid, s64 minX, s64 maxX, s64 minZ, s64 maxZ, s32* x0, s32* x1, s32* z0, s32* z1)
+	{
+		*x0 = automap_getCell(minX, grid->minX, grid->cellSize, grid->cellCountX);
+		*x1 = automap_getCell(maxX, grid->minX, grid->cellSize, grid->cellCountX);
+		*z0 = automap_getCell(minZ, grid->minZ, grid->cellSize, grid->cellCountZ);
+		*z1 = automap_getCell(maxZ, grid->minZ, grid->cellSize, grid->cellCountZ);
+	}
+
+	void automap_buildLayerGrid(MapLayerGrid* grid, const std::vector<u32>& lines)
+	{
+		grid->cellCountX = 1;
+		grid->cellCountZ = 1;
+		grid->minX = 0;
+		grid->minZ = 0;
+		grid->cellSize = FIXED(1);
+
+		// Find the bounds of the static lines.
+		JBool first = JTRUE;
+		fixed16_16 maxX = 0, maxZ = 0;
+		const size_t lineCount = lines.size();
+		for (size_t i = 0; i < lineCount; i++)
+		{
+			fixed16_16 x0, x1, z0, z1;
+			automap_getLineBounds(s_mapLines[lines[i]], &x0, &x1, &z0, &z1);
+			if (first)
+			{
+				grid->minX = x0; maxX = x1;
+				grid->minZ = z0; maxZ = z1;
+				first = JFALSE;
+			}
+			grid->minX = min(grid->minX, x0);
+			grid->minZ = min(grid->minZ, z0);
+			maxX = max(maxX, x1);
+			maxZ = max(maxZ, z1);
+		}
+
+		// Size the grid so each cell holds a handful of lines on average.
+		if (lineCount)
+		{
+			s32 gridDim = s32(sqrtf(f32(lineCount) / f32(MAP_LINES_PER_CELL)));
+			gridDim = clamp(gridDim, 1, (s32)MAP_MAX_GRID_DIM);
+
+			const s64 extent = max(s64(maxX) - s64(grid->minX), s64(maxZ) - s64(grid->minZ));
+			grid->cellSize = fixed16_16(max(extent / gridDim + 1, s64(FIXED(1))));
+			grid->cellCountX = s32((s64(maxX) - s64(grid->minX)) / grid->cellSize) + 1;
+			grid->cellCountZ = s32((s64(maxZ) - s64(grid->minZ)) / grid->cellSize) + 1;
+		}
+
+		// Count the lines per cell, then fill in the cells.
+		const s32 cellCount = grid->cellCountX * grid->cellCountZ;
+		grid->cellStart.assign(cellCount + 1, 0);
+		for (s32 pass = 0; pass < 2; pass++)
+		{
+			if (pass == 1)
+			{
+				for (s32 c = 0; c < cellCount; c++)
+				{
+					grid->cellStart[c + 1] += grid->cellStart[c];
+				}
+				grid->cellLines.resize(grid->cellStart[cellCount]);
+			}
+
+			std::vector<u32> cellFill;
+			if (pass == 1) { cellFill.assign(grid->cellStart.begin(), grid->cellStart.end() - 1); }
+
+			for (size_t i = 0; i < lineCount; i++)
+			{
+				fixed16_16 x0, x1, z0, z1;
+				automap_getLineBounds(s_mapLines[lines[i]], &x0, &x1, &z0, &z1);
+
+				s32 cx0, cx1, cz0, cz1;
+				automap_getCellRange(grid, x0, x1, z0, z1, &cx0, &cx1, &cz0, &cz1);
+				for (s32 z = cz0; z <= cz1; z++)
+				{
+					for (s32 x = cx0; x <= cx1; x++)
+					{
+						const s32 c = z * grid->cellCountX + x;
+						if (pass == 0) { grid->cellStart[c + 1]++; }
+						else { grid->cellLines[cellFill[c]++] = lines[i]; }
+					}
+				}
+			}
+		}
+	}
+
+	void automap_buildCache()
+	{
+		automap_invalidateCache();
+		const s32 layerCount = s_levelState.maxLayer - s_levelState.minLayer + 1;
+		if (!s_levelState.sectors || layerCount <= 0) { return; }
+
+		std::vector<std::vector<u32>> staticLines(layerCount);
+		s_mapLayerGrid.resize(layerCount);
+
+		RSector* sector = s_levelState.sectors;
+		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		{
+			const s32 layerIndex = sector->layer - s_levelState.minLayer;
+			if (layerIndex < 0 || layerIndex >= layerCount) { continue; }
+
+			RWall* wall = sector->walls;
+			for (s32 w = 0; w < sector->wallCount; w++, wall++)
+			{
+				const u32 index = u32(s_mapLines.size());
+				s_mapLines.push_back(wall);
+				if (automap_isDynamicWall(wall))
+				{
+					s_mapLayerGrid[layerIndex].dynamicLines.push_back(index);
+				}
+				else
+				{
+					staticLines[layerIndex].push_back(index);
+				}
+			}
+		}
+		s_mapLineStamp.assign(s_mapLines.size(), 0);
+		s_mapStamp = 0;
+
+		for (s32 l = 0; l < layerCount; l++)
+		{
+			automap_buildLayerGrid(&s_mapLayerGrid[l], staticLines[l]);
+		}
+		s_mapCacheValid = JTRUE;
+	}
+
+	// Convert a screen offset in pixels to a world offset, this does not need to fit in fixed point.
+	s64 automap_screenToWorldOffset(s32 pixels)
+	{
+		return (s64(pixels) << 32) / s64(s_screenScale);
+	}
+
+	// Get the world space area visible on the map, with a small margin.
+	void automap_getViewBounds(MapViewBounds* view)
+	{
+		ScreenRect* screenRect = vfb_getScreenRect(VFB_RECT_RENDER);
+		view->minX = s64(s_mapX0) + automap_screenToWorldOffset(screenRect->left  - s_mapXCenterInPixels - 2);
+		view->maxX = s64(s_mapX0) + automap_screenToWorldOffset(screenRect->right - s_mapXCenterInPixels + 2);
+		view->minZ = s64(s_mapZ0) - automap_screenToWorldOffset(screenRect->bot - s_mapZCenterInPixels + 2);
+		view->maxZ = s64(s_mapZ0) - automap_screenToWorldOffset(screenRect->top - s_mapZCenterInPixels - 2);
+	}
+
+	void automap_addVisibleLine(u32 index, const MapViewBounds* view)
+	{
+		if (s_mapLineStamp[index] == s_mapStamp) { return; }
+		s_mapLineStamp[index] = s_mapStamp;
+
+		fixed16_16 x0, x1, z0, z1;
+		automap_getLineBounds(s_mapLines[index], &x0, &x1, &z0, &z1);
+		if (x1 < view->minX || x0 > view->maxX || z1 < view->minZ || z0 > view->maxZ) { return; }
+		s_mapVisibleLines.push_back(index);
+	}
+
+	void automap_gatherVisibleLines(s32 layer, const MapViewBounds* view)
+	{
+		const s32 layerIndex = layer - s_levelState.minLayer;
+		if (layerIndex < 0 || layerIndex >= (s32)s_mapLayerGrid.size()) { return; }
+		MapLayerGrid* grid = &s_mapLayerGrid[layerIndex];
+
+		if (grid->cellLines.size())
+		{
+			s32 cx0, cx1, cz0, cz1;
+			automap_getCellRange(grid, view->minX, view->maxX, view->minZ, view->maxZ, &cx0, &cx1, &cz0, &cz1);
+			for (s32 z = cz0; z <= cz1; z++)
+			{
+				for (s32 x = cx0; x <= cx1; x++)
+				{
+					const s32 c = z * grid->cellCountX + x;
+					for (u32 i = grid->cellStart[c]; i < grid->cellStart[c + 1]; i++)
+					{
+						automap_addVisibleLine(grid->cellLines[i], view);
+					}
+				}
+			}
+		}
+
+		const size_t dynamicCount = grid->dynamicLines.size();
+		for (size_t i = 0; i < dynamicCount; i++)
+		{
+			automap_addVisibleLine(grid->dynamicLines[i], view);
+		}
 	}
 
 	// _computeScreenBounds() and computeScaledScreenBounds() in the original source:
@@ -374,22 +656,60 @@ namespace TFE_DarkForces
 		s_mapBot   = s_scrBotScaled + s_mapZ0;
 		s_mapTop   = s_scrTopScaled + s_mapZ0;
 
+		// Gather the lines that overlap the visible part of the map.
+		if (!s_mapCacheValid)
+		{
+			automap_buildCache();
+		}
+		MapViewBounds view;
+		automap_getViewBounds(&view);
+
+		s_mapStamp++;
+		s_mapVisibleLines.clear();
+		if (s_mapShowAllLayers)
+		{
+			for (s32 layer = s_levelState.minLayer; layer <= s_levelState.maxLayer; layer++)
+			{
+				automap_gatherVisibleLines(layer, &view);
+			}
+		}
+		else
+		{
+			automap_gatherVisibleLines(s_mapLayer, &view);
+		}
+		// Draw in sector order, the same order as walking the sectors.
+		std::sort(s_mapVisibleLines.begin(), s_mapVisibleLines.end());
+
 		// Draw the sectors.
-		RSector* sector = s_levelState.sectors;
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		const size_t visibleCount = s_mapVisibleLines.size();
+		if (s_mapShowSectorMode)
 		{
-			if (!s_mapShowAllLayers)
+			// Objects are drawn after the walls of their sector.
+			size_t line = 0;
+			RSector* sector = s_levelState.sectors;
+			for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
 			{
-				s32 layer = sector->layer;
-				if (layer != s_mapLayer)
+				if (!s_mapShowAllLayers && sector->layer != s_mapLayer)
 				{
 					continue;
 				}
+				for (; line < visibleCount && s_mapLines[s_mapVisibleLines[line]]->sector == sector; line++)
+				{
+					automap_drawWallIfVisible(s_mapLines[s_mapVisibleLines[line]]);
+				}
+				automap_drawSectorObjects(sector);
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < visibleCount; i++)
+			{
+				automap_drawWallIfVisible(s_mapLines[s_mapVisibleLines[i]]);
 			}
-			automap_drawSector(sector);
 		}
 
 		SecObject* player = s_playerObject;
+		RSector* sector;
 		sector = player->sector;
 		if (!s_automapAutoCenter || s_mapLayer != sector->layer)
 		{
@@ -572,27 +892,22 @@ namespace TFE_DarkForces
 		return color;
 	}
 
-	void automap_drawSector(RSector* sector)
+	void automap_drawWallIfVisible(RWall* wall)
 	{
-		if (!s_mapShowSectorMode && !(sector->flags1 & SEC_FLAGS1_RENDERED))
+		if (!s_mapShowSectorMode && (!(wall->sector->flags1 & SEC_FLAGS1_RENDERED) || !wall->seen))
 		{
 			return;
 		}
 
-		RWall* wall = sector->walls;
-		for (s32 i = 0; i < sector->wallCount; i++, wall++)
+		u8 color = automap_getWallColor(wall);
+		if (color != WCOLOR_INVISIBLE)
 		{
-			if (!s_mapShowSectorMode && !wall->seen)
-			{
-				continue;
-			}
-
-			u8 color = automap_getWallColor(wall);
-			if (color != WCOLOR_INVISIBLE)
-			{
-				automap_drawWall(wall, color);
-			}
+			automap_drawWall(wall, color);
 		}
+	}
+
+	void automap_drawSectorObjects(RSector* sector)
+	{
 		if (s_mapShowSectorMode)
 		{
 			SecObject** objIter = sector->objectList;
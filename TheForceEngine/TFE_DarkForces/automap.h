@@ -29,6 +29,8 @@ namespace TFE_DarkForces
 	};
 
 	void automap_serialize(Stream* stream);
+	// Clear the cached map lines, they are rebuilt from the current level when next drawn.
+	void automap_invalidateCache();
 
 	void automap_computeScreenBounds();
 	void automap_updateMapData(MapUpdateID id);
@@ -48,12 +48,14 @@
 #include <TFE_Archive/gobMemoryArchive.h>
 #include <TFE_Jedi/Level/rfont.h>
 #include <TFE_Jedi/Level/level.h>
+#include <TFE_Jedi/Level/levelData.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
 #include <TFE_Jedi/Task/task.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 #include <TFE_Jedi/Task/task.h>
 #include <TFE_Jedi/IMuse/imuse.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_ExternalData/weaponExternal.h>
 #include <TFE_ExternalData/pickupExternal.h>
 #include <assert.h>
@@ -222,6 +224,8 @@ namespace TFE_DarkForces
 	};
 	static RunGameState   s_runGameState = {};
 	static SharedGameState s_sharedState = {};
+	// Incremented each time the level region is cleared, in-place snapshots are only valid for the level they were taken in.
+	static u32 s_levelInstance = 0;
 
 	/////////////////////////////////////////////
 	// Forward Declarations
@@ -372,6 +376,7 @@ namespace TFE_DarkForces
 
 		// TFE Specific
 		// Reset state
+		s_levelInstance++;
 		actor_exitState();
 		weapon_resetState();
 		renderer_resetState();
@@ -455,6 +460,117 @@ namespace TFE_DarkForces
 		return s_runGameState.state == GSTATE_MISSION;
 	}
 
+	bool DarkForces::canPipelineFrame()
+	{
+		// Only in-level frames drawn by the software renderer are pipelined. Loading, the menus and the GPU renderer
+		// create and use GPU resources directly from game code.
+		return s_runGameState.state == GSTATE_MISSION && task_getCount() && s_missionMode == MISSION_MODE_MAIN &&
+			TFE_Jedi::getSubRenderer() != TSR_CLASSIC_GPU && !escapeMenu_isOpen() && !pda_isOpen();
+	}
+
+	// Everything that can allocate from the game or level regions outside of the simulation is recorded here,
+	// so that a snapshot is rejected rather than restored over memory that is in use.
+	struct SnapshotHeader
+	{
+		u32 levelInstance;
+		s32 levelIndex;
+		u32 rendererId;
+		s32 soundCount;
+		s32 textureCount[POOL_COUNT];
+		s32 modelCount[POOL_COUNT];
+		s32 waxCount[POOL_COUNT];
+		s32 frameCount[POOL_COUNT];
+		u64 blockCount[2];
+		u64 blockSize[2];
+	};
+
+	static void getSnapshotHeader(SnapshotHeader* header)
+	{
+		memset(header, 0, sizeof(SnapshotHeader));
+		header->levelInstance = s_levelInstance;
+		header->levelIndex = agent_getLevelIndex();
+		header->rendererId = renderer_getLevelDataId();
+		header->soundCount = sound_getLoadedCount();
+		for (s32 i = 0; i < POOL_COUNT; i++)
+		{
+			bitmap_getTextures(&header->textureCount[i], AssetPool(i));
+			header->modelCount[i] = (s32)TFE_Model_Jedi::getModelList(AssetPool(i)).size();
+			header->waxCount[i]   = (s32)TFE_Sprite_Jedi::getWaxList(AssetPool(i)).size();
+			header->frameCount[i] = (s32)TFE_Sprite_Jedi::getFrameList(AssetPool(i)).size();
+		}
+		region_getBlockInfo(s_gameRegion, &header->blockCount[0], &header->blockSize[0]);
+		region_getBlockInfo(s_levelRegion, &header->blockCount[1], &header->blockSize[1]);
+	}
+
+	bool DarkForces::captureSnapshot(Stream* stream)
+	{
+		// Script modules hold state outside of the regions, so levels with scripts use the full load path.
+		if (!stream || s_runGameState.state != GSTATE_MISSION || !s_playerEye || TFE_ForceScript::getModuleCount() > 0)
+		{
+			return false;
+		}
+
+		SnapshotHeader header;
+		getSnapshotHeader(&header);
+		// The renderer builds part of its level data from the level region on the first draw.
+		if (!header.rendererId)
+		{
+			return false;
+		}
+
+		// Mark each section so the rewind ring can share the pages that did not change between snapshots.
+		serialization_setMode(SMODE_WRITE);
+		serialization_clearBlocks();
+		stream->writeBuffer(&header, sizeof(SnapshotHeader));
+		region_serialize(s_gameRegion, stream);
+		serialization_markBlock(stream);
+		region_serialize(s_levelRegion, stream);
+		serialization_markBlock(stream);
+		snapshotState_write(stream);
+		serialization_markBlock(stream);
+		return true;
+	}
+
+	bool DarkForces::restoreSnapshot(Stream* stream)
+	{
+		if (!stream || s_runGameState.state != GSTATE_MISSION)
+		{
+			return false;
+		}
+
+		SnapshotHeader header, cur;
+		stream->readBuffer(&header, sizeof(SnapshotHeader));
+		getSnapshotHeader(&cur);
+		// Regions only grow, so the snapshot can be restored as long as the blocks it used still exist.
+		const bool blocksMatch = header.blockSize[0] == cur.blockSize[0] && header.blockSize[1] == cur.blockSize[1] &&
+			header.blockCount[0] <= cur.blockCount[0] && header.blockCount[1] <= cur.blockCount[1];
+		// Block counts are allowed to grow, everything else has to match exactly.
+		memcpy(header.blockCount, cur.blockCount, sizeof(header.blockCount));
+		if (!blocksMatch || memcmp(&header, &cur, sizeof(SnapshotHeader)) != 0)
+		{
+			return false;
+		}
+
+		// Playing sounds reference instance ids that are about to be replaced.
+		sound_stopAll();
+		if (!region_restoreInPlace(s_gameRegion, stream) || !region_restoreInPlace(s_levelRegion, stream))
+		{
+			// The header matched, so this means the stream itself is bad and the regions cannot be trusted.
+			TFE_System::logWrite(LOG_ERROR, "DarkForces", "Snapshot region data is invalid.");
+			assert(0);
+			return false;
+		}
+		snapshotState_read(stream);
+
+		// Rebuild any renderer data derived from the sectors without reallocating it.
+		RSector* sector = s_levelState.sectors;
+		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		{
+			sector->dirtyFlags |= (SDF_ALL & ~SDF_INIT_SETUP);
+		}
+		return true;
+	}
+
 	void DarkForces::getLevelName(char* name)
 	{
 		const char* levelName = agent_getLevelDisplayName();
@@ -710,6 +826,7 @@ namespace TFE_DarkForces
 				startNextMode();
 
 				region_clear(s_levelRegion);
+				s_levelInstance++;
 				bitmap_clearLevelData();
 				bitmap_setAllocator(s_gameRegion);
 				level_freeAllAssets();
@@ -1520,6 +1637,7 @@ namespace TFE_DarkForces
 		reticle_enable(true);
 
 		region_clear(s_levelRegion);
+		s_levelInstance++;
 		bitmap_clearLevelData();
 		level_freeAllAssets();
 
@@ -1593,12 +1711,14 @@ namespace TFE_DarkForces
 			serialization_setMode(SMODE_READ);
 		}
 
+		serialization_clearBlocks();
 		serializeVersion(stream);
 		const u32 curVersion = serialization_getVersion();
 
 		serializeLoopState(stream, this);
 		agent_serialize(stream);
 		time_serialize(stream);
+		serialization_markBlock(stream);
 		if (!writeState)
 		{
 			startMissionFromSave(agent_getLevelIndex());
@@ -1606,17 +1726,24 @@ namespace TFE_DarkForces
 		sound_serializeLevelSounds(stream);
 		random_serialize(stream);
 		automap_serialize(stream);
+		serialization_markBlock(stream);
 		hitEffect_serializeTasks(stream);
+		serialization_markBlock(stream);
 		weapon_serialize(stream);
 		mission_serializeColorMap(stream);
+		serialization_markBlock(stream);
 		level_serialize(stream);
+		serialization_markBlock(stream);
 		inf_serialize(stream);
+		serialization_markBlock(stream);
 		pickupLogic_serializeTasks(stream);
 		mission_serialize(stream);
+		serialization_markBlock(stream);
 
 		// TFE - Scripting.
 		serialization_setVersion(curVersion);
 		TFE_ForceScript::serialize(stream);
+		serialization_markBlock(stream);
 
 		TFE_System::messages_serialize(stream);
 
@@ -20,6 +20,9 @@ namespace TFE_DarkForces
 		bool serializeGameState(Stream* stream, const char* filename, bool writeState) override;
 		bool canSave() override;
 		bool isPaused() override;
+		bool canPipelineFrame() override;
+		bool captureSnapshot(Stream* stream) override;
+		bool restoreSnapshot(Stream* stream) override;
 		void getLevelName(char* name) override;
 		void getLevelId(char* name) override;
 		void getModList(char* modList) override;
@@ -8,6 +8,7 @@
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/robject.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Task/task.h>
 #include <TFE_ExternalData/weaponExternal.h>
@@ -40,6 +41,8 @@ namespace TFE_DarkForces
 	Task* s_hitEffectTask = nullptr;
 	vec3_fixed s_explodePos;
 	EffectData* s_curEffectData = nullptr;
+	SNAPSHOT_STATE(s_hitEffects);
+	SNAPSHOT_STATE(s_hitEffectTask);
 
 	EffectData setEffectData(HitEffectID type, TFE_ExternalData::ExternalEffect* extEffects);
 	void hitEffectExplodeFunc(SecObject* obj);
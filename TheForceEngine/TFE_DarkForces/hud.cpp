@@ -17,6 +17,7 @@
 #include <TFE_Jedi/Level/rfont.h>
 #include <TFE_Jedi/Level/rtexture.h>
 #include <TFE_Jedi/Level/roffscreenBuffer.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_RenderShared/texturePacker.h>
 #include <cstring>
 
@@ -117,6 +118,10 @@ namespace TFE_DarkForces
 	static s32 s_hudCurrentMsgId = 0;
 	static s32 s_hudMsgPriority = HUD_LOWEST_PRIORITY;
 	static Tick s_hudMsgExpireTick;
+	SNAPSHOT_STATE(s_hudMessage);
+	SNAPSHOT_STATE(s_hudCurrentMsgId);
+	SNAPSHOT_STATE(s_hudMsgPriority);
+	SNAPSHOT_STATE(s_hudMsgExpireTick);
 
 	static JBool s_screenDirtyLeft[4]  = { 0 };
 	static JBool s_screenDirtyRight[4] = { 0 };
@@ -171,6 +176,11 @@ namespace TFE_DarkForces
 	s32 s_secretsFound = 0;
 	s32 s_secretsPercent = 0;
 	JBool s_showData = JFALSE;
+	SNAPSHOT_STATE(s_flashEffect);
+	SNAPSHOT_STATE(s_healthDamageFx);
+	SNAPSHOT_STATE(s_shieldDamageFx);
+	SNAPSHOT_STATE(s_secretsFound);
+	SNAPSHOT_STATE(s_secretsPercent);
 
 	///////////////////////////////////////////
 	// Forward Declarations
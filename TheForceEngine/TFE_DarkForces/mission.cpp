@@ -31,6 +31,7 @@
 #include <TFE_Jedi/Renderer/RClassic_Fixed/rclassicFixed.h>
 #include <TFE_RenderShared/texturePacker.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Settings/settings.h>
@@ -100,6 +101,24 @@ namespace TFE_DarkForces
 	static s32 s_visionFxCountdown = 0;
 	static s32 s_visionFxEndCountdown = 0;
 
+	SNAPSHOT_STATE(s_palModified);
+	SNAPSHOT_STATE(s_canChangePal);
+	SNAPSHOT_STATE(s_screenFxEnabled);
+	SNAPSHOT_STATE(s_screenBrightnessEnabled);
+	SNAPSHOT_STATE(s_luminanceMask);
+	SNAPSHOT_STATE(s_updateHudColors);
+	SNAPSHOT_STATE(s_screenBrightnessChanged);
+	SNAPSHOT_STATE(s_screenFxChanged);
+	SNAPSHOT_STATE(s_lumMaskChanged);
+	SNAPSHOT_STATE(s_flashFxLevel);
+	SNAPSHOT_STATE(s_healthFxLevel);
+	SNAPSHOT_STATE(s_shieldFxLevel);
+	SNAPSHOT_STATE(s_screenBrightness);
+	SNAPSHOT_STATE(s_exitLevel);
+	SNAPSHOT_STATE(s_levelEndTask);
+	SNAPSHOT_STATE(s_visionFxCountdown);
+	SNAPSHOT_STATE(s_visionFxEndCountdown);
+
 	/////////////////////////////////////////////
 	// Forward Declarations
 	/////////////////////////////////////////////
@@ -205,6 +224,28 @@ namespace TFE_DarkForces
 		logic_spawnEnemy(args[1].c_str(), args[2].c_str());
 	}
 
+	void console_projStress(const ConsoleArgList& args)
+	{
+		if (args.size() < 2) { return; }
+		const s32 count = strtol(args[1].c_str(), nullptr, 10);
+		const s32 type = args.size() >= 3 ? s32(strtol(args[2].c_str(), nullptr, 10)) : s32(PROJ_REPEATER);
+		if (type < 0 || type >= PROJ_COUNT)
+		{
+			char msg[256];
+			sprintf(msg, "projStress: invalid projectile type %d, valid types are 0 - %d.", type, PROJ_COUNT - 1);
+			TFE_Console::addToHistory(msg);
+			return;
+		}
+		if (type == PROJ_LAND_MINE_PLACED)
+		{
+			char msg[256];
+			sprintf(msg, "projStress: projectile type %d is a pre-placed land mine, which does not move.", type);
+			TFE_Console::addToHistory(msg);
+			return;
+		}
+		projectile_stressTest(count, ProjectileType(type));
+	}
+
 	void mission_createDisplay()
 	{
 		vfb_setResolution(320, 200);
@@ -393,6 +434,7 @@ namespace TFE_DarkForces
 			// TFE-specific
 			mission_addCheatCommands();
 			CCMD("spawnEnemy", console_spawnEnemy, 2, "spawnEnemy(waxName, enemyTypeName) - spawns an enemy 8 units away in the player direction. Example: spawnEnemy offcfin.wax i_officer");
+			CCMD("projStress", console_projStress, 1, "projStress(count, [projectileType]) - fires 'count' projectiles around the player and logs the projectile update time. Example: projStress 500");
 
 			// Make sure the loading screen is displayed for at least 1 second.
 			if (!s_loadingFromSave)
@@ -602,7 +644,8 @@ namespace TFE_DarkForces
 					updateLevelScript(fixed16ToFloat(s_deltaTime));
 					// Dark Forces Draw.
 					updateScreensize();
-					if (s_playerEye)
+					// The world is not drawn while a demo is fast-forwarding to a seek position.
+					if (s_playerEye && !isReplaySeeking())
 					{
 						drawWorld(s_framebuffer, s_playerEye->sector, s_levelColorMap, s_lightSourceRamp);
 					}
@@ -761,6 +804,7 @@ namespace TFE_DarkForces
 		hud_startup(JFALSE);
 		hud_clearMessage();
 		automap_computeScreenBounds();
+		automap_invalidateCache();
 		weapon_clearFireRate();
 		weapon_createPlayerWeaponTask();
 		projectile_createTask();
@@ -9,6 +9,7 @@
 #include <TFE_Jedi/Level/levelData.h>
 #include <TFE_Jedi/Task/task.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_ExternalData/pickupExternal.h>
 #include <cstring>
 
@@ -35,6 +36,15 @@ namespace TFE_DarkForces
 	static Pickup* s_listToFree[MAX_PICKUP_FREE_ITEMS];
 	static s32 s_listToFreeCnt = 0;
 
+	SNAPSHOT_STATE(s_playerDying);
+	SNAPSHOT_STATE(s_pickupTask);
+	SNAPSHOT_STATE(s_superchargeTask);
+	SNAPSHOT_STATE(s_invincibilityTask);
+	SNAPSHOT_STATE(s_gasmaskTask);
+	SNAPSHOT_STATE(s_gasSectorTask);
+	SNAPSHOT_STATE(s_listToFree);
+	SNAPSHOT_STATE(s_listToFreeCnt);
+
 	//////////////////////////////////////////////////////////////
 	// Forward Declarations
 	//////////////////////////////////////////////////////////////
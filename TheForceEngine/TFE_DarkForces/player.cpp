@@ -21,6 +21,7 @@
 #include <TFE_Jedi/InfSystem/infSystem.h>
 #include <TFE_Jedi/Renderer/rlimits.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 // Internal types need to be included in this case.
 #include <TFE_Jedi/InfSystem/infTypesInternal.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
@@ -305,6 +306,101 @@ namespace TFE_DarkForces
 	JBool s_disablePlayerMovement = JFALSE;
 	JBool s_disablePlayerRotation = JFALSE;
 	JBool s_disablePlayerFire = JFALSE;
+
+	// Gameplay state restored by in-place snapshots, sounds and settings are left alone.
+	SNAPSHOT_STATE(s_externalYawSpd);
+	SNAPSHOT_STATE(s_playerPitch);
+	SNAPSHOT_STATE(s_playerRoll);
+	SNAPSHOT_STATE(s_forwardSpd);
+	SNAPSHOT_STATE(s_strafeSpd);
+	SNAPSHOT_STATE(s_maxMoveDist);
+	SNAPSHOT_STATE(s_playerStopAccel);
+	SNAPSHOT_STATE(s_minEyeDistFromFloor);
+	SNAPSHOT_STATE(s_postLandVel);
+	SNAPSHOT_STATE(s_landUpVel);
+	SNAPSHOT_STATE(s_externalVelX);
+	SNAPSHOT_STATE(s_externalVelZ);
+	SNAPSHOT_STATE(s_playerCrouchSpd);
+	SNAPSHOT_STATE(s_playerSpeedAve);
+	SNAPSHOT_STATE(s_prevDistFromFloor);
+	SNAPSHOT_STATE(s_wpnSin);
+	SNAPSHOT_STATE(s_wpnCos);
+	SNAPSHOT_STATE(s_moveDirX);
+	SNAPSHOT_STATE(s_moveDirZ);
+	SNAPSHOT_STATE(s_dist);
+	SNAPSHOT_STATE(s_distScale);
+	SNAPSHOT_STATE(s_levelAtten);
+	SNAPSHOT_STATE(s_prevCollisionFrameWall);
+	SNAPSHOT_STATE(s_curSafe);
+	SNAPSHOT_STATE(s_playerUse);
+	SNAPSHOT_STATE(s_playerActionUse);
+	SNAPSHOT_STATE(s_playerPrimaryFire);
+	SNAPSHOT_STATE(s_playerSecFire);
+	SNAPSHOT_STATE(s_playerJumping);
+	SNAPSHOT_STATE(s_playerInWater);
+	SNAPSHOT_STATE(s_aiActive);
+	SNAPSHOT_STATE(s_playerPos);
+	SNAPSHOT_STATE(s_playerObjHeight);
+	SNAPSHOT_STATE(s_playerObjPitch);
+	SNAPSHOT_STATE(s_playerObjYaw);
+	SNAPSHOT_STATE(s_playerObjSector);
+	SNAPSHOT_STATE(s_playerSlideWall);
+	SNAPSHOT_STATE(s_playerInfo);
+	SNAPSHOT_STATE(s_playerLogic);
+	SNAPSHOT_STATE(s_batteryPower);
+	SNAPSHOT_STATE(s_lifeCount);
+	SNAPSHOT_STATE(s_playerLight);
+	SNAPSHOT_STATE(s_headwaveVerticalOffset);
+	SNAPSHOT_STATE(s_onFloor);
+	SNAPSHOT_STATE(s_weaponLight);
+	SNAPSHOT_STATE(s_baseAtten);
+	SNAPSHOT_STATE(s_gravityAccel);
+	SNAPSHOT_STATE(s_invincibility);
+	SNAPSHOT_STATE(s_weaponFiring);
+	SNAPSHOT_STATE(s_weaponFiringSec);
+	SNAPSHOT_STATE(s_wearingCleats);
+	SNAPSHOT_STATE(s_wearingGasmask);
+	SNAPSHOT_STATE(s_nightVisionActive);
+	SNAPSHOT_STATE(s_headlampActive);
+	SNAPSHOT_STATE(s_superCharge);
+	SNAPSHOT_STATE(s_superChargeHud);
+	SNAPSHOT_STATE(s_playerSecMoved);
+	SNAPSHOT_STATE(s_playerSector);
+	SNAPSHOT_STATE(s_playerObject);
+	SNAPSHOT_STATE(s_playerEye);
+	SNAPSHOT_STATE(s_eyePos);
+	SNAPSHOT_STATE(s_eyePitch);
+	SNAPSHOT_STATE(s_eyeYaw);
+	SNAPSHOT_STATE(s_eyeRoll);
+	SNAPSHOT_STATE(s_externalCameraMode);
+	SNAPSHOT_STATE(s_playerEyeFlags);
+	SNAPSHOT_STATE(s_playerTick);
+	SNAPSHOT_STATE(s_prevPlayerTick);
+	SNAPSHOT_STATE(s_nextShieldDmgTick);
+	SNAPSHOT_STATE(s_reviveTick);
+	SNAPSHOT_STATE(s_nextPainSndTick);
+	SNAPSHOT_STATE(s_playerTask);
+	SNAPSHOT_STATE(s_playerYPos);
+	SNAPSHOT_STATE(s_camOffset);
+	SNAPSHOT_STATE(s_camOffsetPitch);
+	SNAPSHOT_STATE(s_camOffsetYaw);
+	SNAPSHOT_STATE(s_camOffsetRoll);
+	SNAPSHOT_STATE(s_playerYaw);
+	SNAPSHOT_STATE(s_playerVelX);
+	SNAPSHOT_STATE(s_playerUpVel);
+	SNAPSHOT_STATE(s_playerUpVel2);
+	SNAPSHOT_STATE(s_playerVelZ);
+	SNAPSHOT_STATE(s_itemUnknown1);
+	SNAPSHOT_STATE(s_itemUnknown2);
+	SNAPSHOT_STATE(s_playerHeight);
+	SNAPSHOT_STATE(s_playerRun);
+	SNAPSHOT_STATE(s_jumpScale);
+	SNAPSHOT_STATE(s_playerSlow);
+	SNAPSHOT_STATE(s_onMovingSurface);
+	SNAPSHOT_STATE(s_playerCrouch);
+	SNAPSHOT_STATE(s_disablePlayerMovement);
+	SNAPSHOT_STATE(s_disablePlayerRotation);
+	SNAPSHOT_STATE(s_disablePlayerFire);
 			   
 	///////////////////////////////////////////
 	// Forward Declarations
@@ -14,6 +14,7 @@
 #include <TFE_Jedi/InfSystem/infTypesInternal.h>
 #include <TFE_Jedi/Collision/collision.h>
 #include <TFE_System/profiler.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 // TFE
 #include <TFE_Jedi/Level/rtexture.h>
@@ -73,6 +74,7 @@ namespace TFE_DarkForces
 	vec2_fixed s_colResponsePos;
 	vec2_fixed s_colWallV0;
 	s32 s_collisionFrameSector;
+	SNAPSHOT_STATE(s_collisionFrameSector);
 
 	CollisionObjFunc s_objCollisionFunc;
 	CollisionProxFunc s_objCollisionProxFunc;
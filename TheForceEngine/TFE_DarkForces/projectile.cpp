@@ -3,7 +3,10 @@
 #include "random.h"
 #include "player.h"
 #include "sound.h"
+#include <algorithm>
 #include <cstring>
+#include <vector>
+#include <TFE_System/system.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Asset/spriteAsset_Jedi.h>
 #include <TFE_Jedi/Collision/collision.h>
@@ -14,6 +17,7 @@
 #include <TFE_Jedi/Level/rwall.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_ExternalData/weaponExternal.h>
 
 using namespace TFE_Jedi;
@@ -37,10 +41,84 @@ namespace TFE_DarkForces
 		PROJ_PATH_MAX_SECTORS      = 16,		 // The maximum number of sectors in a projectile path (i.e. how many sectors can a projectile cross in a single frame).
 	};
 
+	// Update phase, projectiles are partitioned by phase at the start of each tick.
+	enum ProjectilePhase
+	{
+		PPHASE_FLIGHT = 0,	// In flight.
+		PPHASE_FALLOFF,		// In flight and the damage falls off this tick.
+		PPHASE_END_OF_LIFE,	// Reached the end of its life, goes out of range.
+		PPHASE_MINE,		// Proximity or pre-placed landmine that has reached the end of its life, checks for nearby objects.
+		PPHASE_COUNT
+	};
+
+	// Snapshot of a projectile taken when the phases are built.
+	// The values are compared when the projectile is updated, so changes made by other projectiles earlier in the tick are respected.
+	struct ProjectileBatchEntry
+	{
+		ProjectileLogic* logic;
+		ProjectileType type;
+		Tick duration;
+		fixed16_16 dmg;
+		fixed16_16 falloffAmt;
+		Tick nextFalloffTick;
+		Tick dmgFalloffDelta;
+		fixed16_16 minDmg;
+		ProjectilePhase phase;
+		s32 falloffIndex;
+		s32 moveIndex;
+	};
+
+	// Damage falloff, packed for the batched update.
+	struct ProjectileFalloffBatch
+	{
+		std::vector<fixed16_16> dmg;
+		std::vector<fixed16_16> falloffAmt;
+		std::vector<fixed16_16> minDmg;
+		std::vector<Tick> nextTick;
+		std::vector<Tick> delta;
+	};
+
+	// Kinematic step of the standard and arcing projectiles (velocity + gravity -> frame delta), packed for the batched update.
+	// Standard projectiles use zero acceleration, so both share the same loop.
+	struct ProjectileMoveBatch
+	{
+		std::vector<fixed16_16> velX;
+		std::vector<fixed16_16> velY;
+		std::vector<fixed16_16> velZ;
+		std::vector<fixed16_16> accelY;
+		std::vector<fixed16_16> newVelY;
+		std::vector<fixed16_16> deltaX;
+		std::vector<fixed16_16> deltaY;
+		std::vector<fixed16_16> deltaZ;
+		fixed16_16 dt;
+	};
+
+	// TFE: Stress test statistics.
+	struct ProjectileStressStats
+	{
+		JBool active;
+		u32 ticks;
+		u32 peakCount;
+		u32 phaseCount[PPHASE_COUNT];
+		u32 batchedMoves;
+		u32 unbatchedMoves;
+		f64 time;
+		f64 maxTime;
+	};
+
 	//////////////////////////////////////////////////////////////
 	// Internal State
 	//////////////////////////////////////////////////////////////
 	static Allocator* s_projectiles = nullptr;
+	SNAPSHOT_STATE(s_projectiles);
+
+	// Batched update state (not serialized, rebuilt every tick).
+	static std::vector<ProjectileBatchEntry> s_projBatch;
+	static ProjectileFalloffBatch s_projFalloff;
+	static ProjectileMoveBatch s_projMove;
+	static s32 s_projMoveIndex = -1;	// Move batch index of the projectile being updated, -1 if it has none.
+	static size_t s_projBatchCursor = 0;
+	static ProjectileStressStats s_projStress = {};
 
 	// Arrays to hold projectile assets
 	static JediModel* s_projectileModels[PROJ_COUNT];
@@ -95,6 +173,7 @@ namespace TFE_DarkForces
 
 	// Task
 	static Task* s_projectileTask = nullptr;
+	SNAPSHOT_STATE(s_projectileTask);
 
 	WallHitFlag s_hitWallFlag = WH_IGNORE;
 	angle14_32 s_projReflectOverrideYaw = 0;
@@ -185,6 +264,10 @@ namespace TFE_DarkForces
 
 	void projectile_clearState()
 	{
+		s_projBatch.clear();
+		s_projBatchCursor = 0;
+		s_projMoveIndex = -1;
+		s_projStress = {};
 		s_projectiles = nullptr;
 		s_projectileTask = nullptr;
 		s_projReflectOverrideYaw = 0;
@@ -454,6 +537,242 @@ namespace TFE_DarkForces
 		return (Logic*)projLogic;
 	}
 		
+	void proj_applyFalloff(ProjectileLogic* projLogic)
+	{
+		projLogic->dmg -= projLogic->falloffAmt;
+		if (projLogic->dmg < projLogic->minDmg)
+		{
+			projLogic->nextFalloffTick = 0xffffffff;	// This basically sets the falloff to "infinity" so it never enters this block again.
+			projLogic->dmg = projLogic->minDmg;
+		}
+		else
+		{
+			projLogic->nextFalloffTick += projLogic->dmgFalloffDelta;
+		}
+	}
+
+	ProjectilePhase proj_getPhase(const ProjectileLogic* projLogic, Tick curTick)
+	{
+		if (curTick < projLogic->duration)
+		{
+			return (projLogic->falloffAmt && curTick > projLogic->nextFalloffTick) ? PPHASE_FALLOFF : PPHASE_FLIGHT;
+		}
+		// Note that proximity landmines that have reached end of life don't explode right away, but instead check for valid object proximity.
+		return (projLogic->type == PROJ_LAND_MINE_PLACED || projLogic->type == PROJ_LAND_MINE_PROX) ? PPHASE_MINE : PPHASE_END_OF_LIFE;
+	}
+
+	// TFE: Partition the projectiles by phase and compute the damage falloff and the kinematic step of the
+	// standard and arcing projectiles for all of them in one pass each.
+	// Collision is not batched since it depends on the other objects in the level, which earlier projectiles
+	// in the same tick can change.
+	void proj_buildBatch(Tick curTick)
+	{
+		s_projBatch.clear();
+		s_projBatchCursor = 0;
+		s_projMoveIndex = -1;
+		s_projFalloff.dmg.clear();
+		s_projFalloff.falloffAmt.clear();
+		s_projFalloff.minDmg.clear();
+		s_projFalloff.nextTick.clear();
+		s_projFalloff.delta.clear();
+		s_projMove.velX.clear();
+		s_projMove.velY.clear();
+		s_projMove.velZ.clear();
+		s_projMove.accelY.clear();
+		s_projMove.dt = s_deltaTime;
+
+		ProjectileLogic* projLogic = (ProjectileLogic*)allocator_getHead(s_projectiles);
+		while (projLogic)
+		{
+			ProjectileBatchEntry entry;
+			entry.logic = projLogic;
+			entry.type = projLogic->type;
+			entry.duration = projLogic->duration;
+			entry.dmg = projLogic->dmg;
+			entry.falloffAmt = projLogic->falloffAmt;
+			entry.nextFalloffTick = projLogic->nextFalloffTick;
+			entry.dmgFalloffDelta = projLogic->dmgFalloffDelta;
+			entry.minDmg = projLogic->minDmg;
+			entry.phase = proj_getPhase(projLogic, curTick);
+			entry.falloffIndex = -1;
+			if (entry.phase == PPHASE_FALLOFF)
+			{
+				entry.falloffIndex = s32(s_projFalloff.dmg.size());
+				s_projFalloff.dmg.push_back(entry.dmg);
+				s_projFalloff.falloffAmt.push_back(entry.falloffAmt);
+				s_projFalloff.minDmg.push_back(entry.minDmg);
+				s_projFalloff.nextTick.push_back(entry.nextFalloffTick);
+				s_projFalloff.delta.push_back(entry.dmgFalloffDelta);
+			}
+			entry.moveIndex = -1;
+			const JBool arcing = projLogic->updateFunc == arcingProjectileUpdateFunc;
+			if ((entry.phase == PPHASE_FLIGHT || entry.phase == PPHASE_FALLOFF) && (arcing || projLogic->updateFunc == stdProjectileUpdateFunc))
+			{
+				entry.moveIndex = s32(s_projMove.velX.size());
+				s_projMove.velX.push_back(projLogic->vel.x);
+				s_projMove.velY.push_back(projLogic->vel.y);
+				s_projMove.velZ.push_back(projLogic->vel.z);
+				s_projMove.accelY.push_back(arcing ? s_projGravityAccel : 0);
+			}
+			s_projBatch.push_back(entry);
+			projLogic = (ProjectileLogic*)allocator_getNext(s_projectiles);
+		}
+
+		// Damage falloff, this matches proj_applyFalloff().
+		const size_t falloffCount = s_projFalloff.dmg.size();
+		fixed16_16* dmg = s_projFalloff.dmg.data();
+		const fixed16_16* falloffAmt = s_projFalloff.falloffAmt.data();
+		const fixed16_16* minDmg = s_projFalloff.minDmg.data();
+		Tick* nextTick = s_projFalloff.nextTick.data();
+		const Tick* delta = s_projFalloff.delta.data();
+		for (size_t i = 0; i < falloffCount; i++)
+		{
+			const fixed16_16 newDmg = dmg[i] - falloffAmt[i];
+			const JBool clamp = newDmg < minDmg[i];
+			dmg[i] = clamp ? minDmg[i] : newDmg;
+			nextTick[i] = clamp ? 0xffffffff : nextTick[i] + delta[i];
+		}
+
+		// Kinematic step, this matches stdProjectileUpdateFunc() and arcingProjectileUpdateFunc() (mul16(0, dt) = 0).
+		const size_t moveCount = s_projMove.velX.size();
+		s_projMove.newVelY.resize(moveCount);
+		s_projMove.deltaX.resize(moveCount);
+		s_projMove.deltaY.resize(moveCount);
+		s_projMove.deltaZ.resize(moveCount);
+		const fixed16_16 dt = s_projMove.dt;
+		const fixed16_16* velX = s_projMove.velX.data();
+		const fixed16_16* velY = s_projMove.velY.data();
+		const fixed16_16* velZ = s_projMove.velZ.data();
+		const fixed16_16* accelY = s_projMove.accelY.data();
+		fixed16_16* newVelY = s_projMove.newVelY.data();
+		fixed16_16* deltaX = s_projMove.deltaX.data();
+		fixed16_16* deltaY = s_projMove.deltaY.data();
+		fixed16_16* deltaZ = s_projMove.deltaZ.data();
+		for (size_t i = 0; i < moveCount; i++)
+		{
+			newVelY[i] = velY[i] + mul16(accelY[i], dt);
+			deltaX[i] = mul16(velX[i], dt);
+			deltaY[i] = mul16(newVelY[i], dt);
+			deltaZ[i] = mul16(velZ[i], dt);
+		}
+	}
+
+	// Applies the batched kinematic step to the projectile being updated, returns JFALSE if the projectile has no batched step or
+	// something changed its velocity or acceleration since the batch was built (such as a moving floor), in which case the caller computes it.
+	JBool proj_applyBatchedMove(ProjectileLogic* projLogic, fixed16_16 accelY)
+	{
+		const s32 index = s_projMoveIndex;
+		s_projMoveIndex = -1;
+		if (index < 0 || s_projMove.dt != s_deltaTime || s_projMove.accelY[index] != accelY || s_projMove.velX[index] != projLogic->vel.x ||
+			s_projMove.velY[index] != projLogic->vel.y || s_projMove.velZ[index] != projLogic->vel.z)
+		{
+			s_projStress.unbatchedMoves++;
+			return JFALSE;
+		}
+		projLogic->vel.y = s_projMove.newVelY[index];
+		projLogic->delta.x = s_projMove.deltaX[index];
+		projLogic->delta.y = s_projMove.deltaY[index];
+		projLogic->delta.z = s_projMove.deltaZ[index];
+		s_projStress.batchedMoves++;
+		return JTRUE;
+	}
+
+	// Returns the update phase of the projectile and applies the damage falloff.
+	// The batched result is only used if nothing changed the projectile since the batch was built,
+	// otherwise the phase and falloff are computed here - exactly as if the batch did not exist.
+	ProjectilePhase proj_beginUpdate(ProjectileLogic* projLogic, Tick curTick)
+	{
+		// Projectiles are visited in allocator order, so the matching entry is at or after the cursor.
+		// Projectiles created during the tick are added at the end and have no entry.
+		const size_t count = s_projBatch.size();
+		s_projMoveIndex = -1;
+		while (s_projBatchCursor < count && s_projBatch[s_projBatchCursor].logic != projLogic)
+		{
+			s_projBatchCursor++;
+		}
+
+		if (s_projBatchCursor < count)
+		{
+			const ProjectileBatchEntry* entry = &s_projBatch[s_projBatchCursor];
+			s_projBatchCursor++;
+
+			if (entry->type == projLogic->type && entry->duration == projLogic->duration && entry->dmg == projLogic->dmg &&
+				entry->falloffAmt == projLogic->falloffAmt && entry->nextFalloffTick == projLogic->nextFalloffTick &&
+				entry->dmgFalloffDelta == projLogic->dmgFalloffDelta && entry->minDmg == projLogic->minDmg)
+			{
+				if (entry->phase == PPHASE_FALLOFF)
+				{
+					projLogic->dmg = s_projFalloff.dmg[entry->falloffIndex];
+					projLogic->nextFalloffTick = s_projFalloff.nextTick[entry->falloffIndex];
+				}
+				s_projMoveIndex = entry->moveIndex;
+				return entry->phase;
+			}
+		}
+
+		const ProjectilePhase phase = proj_getPhase(projLogic, curTick);
+		if (phase == PPHASE_FALLOFF)
+		{
+			proj_applyFalloff(projLogic);
+		}
+		return phase;
+	}
+
+	void proj_updateStressStats(f64 time)
+	{
+		s_projStress.ticks++;
+		s_projStress.time += time;
+		s_projStress.maxTime = std::max(s_projStress.maxTime, time);
+		s_projStress.peakCount = std::max(s_projStress.peakCount, u32(s_projBatch.size()));
+		for (size_t i = 0; i < s_projBatch.size(); i++)
+		{
+			s_projStress.phaseCount[s_projBatch[i].phase]++;
+		}
+	}
+
+	void proj_endStressTest()
+	{
+		if (!s_projStress.active) { return; }
+		s_projStress.active = JFALSE;
+		if (!s_projStress.ticks) { return; }
+
+		TFE_System::logWrite(LOG_MSG, "Projectile", "Stress test: %u ticks, %u peak projectiles, %.3fms average, %.3fms max per tick.",
+			s_projStress.ticks, s_projStress.peakCount, 1000.0 * s_projStress.time / f64(s_projStress.ticks), 1000.0 * s_projStress.maxTime);
+		TFE_System::logWrite(LOG_MSG, "Projectile", "Projectile updates by phase: %u in flight, %u falloff, %u end of life, %u mines.",
+			s_projStress.phaseCount[PPHASE_FLIGHT], s_projStress.phaseCount[PPHASE_FALLOFF], s_projStress.phaseCount[PPHASE_END_OF_LIFE], s_projStress.phaseCount[PPHASE_MINE]);
+		TFE_System::logWrite(LOG_MSG, "Projectile", "Kinematic steps: %u batched, %u computed per projectile.", s_projStress.batchedMoves, s_projStress.unbatchedMoves);
+	}
+
+	// TFE: Fire 'count' projectiles in a circle around the player and log the projectile update timing until they are gone.
+	void projectile_stressTest(s32 count, ProjectileType type)
+	{
+		if (!s_projectiles || !s_playerObject || count <= 0) { return; }
+		// Pre-placed land mines never move, so they would not measure anything.
+		if (type == PROJ_LAND_MINE_PLACED || type >= PROJ_COUNT)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Projectile", "Stress test: projectile type %d cannot be used, no projectiles fired.", type);
+			return;
+		}
+
+		const fixed16_16 yPos = s_playerObject->posWS.y - s_playerObject->worldHeight;
+		for (s32 i = 0; i < count; i++)
+		{
+			ProjectileLogic* projLogic = (ProjectileLogic*)createProjectile(type, s_playerObject->sector, s_playerObject->posWS.x, yPos, s_playerObject->posWS.z, s_playerObject);
+			if (!projLogic) { break; }
+			projLogic->flags &= ~PROJFLAG_CAMERA_PASS_SOUND;
+			projLogic->prevColObj = s_playerObject;
+			projLogic->excludeObj = s_playerObject;
+			// Spread the projectiles evenly, a few pitch angles keep them from all hitting the same walls.
+			const angle14_32 yaw = angle14_32((i * ANGLE_MAX) / count);
+			const angle14_32 pitch = angle14_32(((i & 3) - 1) * 256);
+			proj_setTransform(projLogic, pitch, yaw);
+		}
+
+		s_projStress = {};
+		s_projStress.active = JTRUE;
+		TFE_System::logWrite(LOG_MSG, "Projectile", "Stress test: fired %d projectiles.", count);
+	}
+
 	void projectileTaskFunc(MessageType msg)
 	{
 		struct LocalContext
@@ -474,10 +793,15 @@ namespace TFE_DarkForces
 				taskCtx->projLogic = (ProjectileLogic*)allocator_getHead(s_projectiles);
 				if (!taskCtx->projLogic)
 				{
+					proj_endStressTest();
 					task_yield(TASK_SLEEP);
 				}
 			}
 
+			// Note: nothing in the loop below yields, so the timing is just for this tick.
+			const f64 startTime = s_projStress.active ? TFE_System::getTime() : 0.0;
+			proj_buildBatch(s_curTick);
+
 			taskCtx->projLogic = (ProjectileLogic*)allocator_getHead(s_projectiles);
 			while (taskCtx->projLogic)
 			{
@@ -485,30 +809,12 @@ namespace TFE_DarkForces
 
 				SecObject* obj = projLogic->logic.obj;
 				ProjectileHitType projHitType = PHIT_NONE;
-				Tick curTick = s_curTick;
 
-				// The projectile is still active.
-				if (curTick < projLogic->duration)
-				{
-					// Handle damage falloff.
-					if (projLogic->falloffAmt && curTick > projLogic->nextFalloffTick)
-					{
-						projLogic->dmg -= projLogic->falloffAmt;
-						if (projLogic->dmg < projLogic->minDmg)
-						{
-							projLogic->nextFalloffTick = 0xffffffff;	// This basically sets the falloff to "infinity" so it never enters this block again.
-							projLogic->dmg = projLogic->minDmg;
-						}
-						else
-						{
-							projLogic->nextFalloffTick += projLogic->dmgFalloffDelta;
-						}
-					}
-				}
-				else  // The projectile has reached the end of its life.
+				// The damage falloff is handled by proj_beginUpdate().
+				const ProjectilePhase phase = proj_beginUpdate(projLogic, s_curTick);
+				if (phase == PPHASE_MINE)
 				{
 					const ProjectileType type = projLogic->type;
-					// Note that proximity landmines that have reached end of life don't explode right away, but instead check for valid object proximity.
 					if (type == PROJ_LAND_MINE_PLACED)	// Pre-placed landmines.
 					{
 						const fixed16_16 approxDist = distApprox(s_playerObject->posWS.x, s_playerObject->posWS.z, obj->posWS.x, obj->posWS.z);
@@ -523,7 +829,7 @@ namespace TFE_DarkForces
 							}
 						}
 					}
-					else if (type == PROJ_LAND_MINE_PROX)	// Player placed proximity landmine (secondary fire).
+					else  // Player placed proximity landmine (secondary fire).
 					{
 						if (collision_isAnyObjectInRange(obj->sector, WP_LANDMINE_TRIGGER_RADIUS, obj->posWS, obj, ETFLAG_PLAYER | ETFLAG_AI_ACTOR))
 						{
@@ -532,11 +838,11 @@ namespace TFE_DarkForces
 							sound_playCued(s_landMineTriggerSnd, obj->posWS);
 						}
 					}
-					else
-					{
-						projHitType = PHIT_OUT_OF_RANGE;
-					}
-				}  // if (curTick < projLogic->duration)
+				}
+				else if (phase == PPHASE_END_OF_LIFE)  // The projectile has reached the end of its life.
+				{
+					projHitType = PHIT_OUT_OF_RANGE;
+				}
 
 				if (projHitType == PHIT_NONE)
 				{
@@ -585,6 +891,11 @@ namespace TFE_DarkForces
 				}
 				taskCtx->projLogic = (ProjectileLogic*)allocator_getNext(s_projectiles);
 			}  // while (taskCtx->projLogic)
+
+			if (s_projStress.active)
+			{
+				proj_updateStressStats(TFE_System::getTime() - startTime);
+			}
 		}  // while (id != -1)
 
 		task_end;
@@ -640,10 +951,13 @@ namespace TFE_DarkForces
 	ProjectileHitType stdProjectileUpdateFunc(ProjectileLogic* projLogic)
 	{
 		// Calculate how much the projectile moves this timeslice.
-		const fixed16_16 dt = s_deltaTime;
-		projLogic->delta.x = mul16(projLogic->vel.x, dt);
-		projLogic->delta.y = mul16(projLogic->vel.y, dt);
-		projLogic->delta.z = mul16(projLogic->vel.z, dt);
+		if (!proj_applyBatchedMove(projLogic, 0))
+		{
+			const fixed16_16 dt = s_deltaTime;
+			projLogic->delta.x = mul16(projLogic->vel.x, dt);
+			projLogic->delta.y = mul16(projLogic->vel.y, dt);
+			projLogic->delta.z = mul16(projLogic->vel.z, dt);
+		}
 
 		return proj_handleMovement(projLogic);
 	}
@@ -671,13 +985,16 @@ namespace TFE_DarkForces
 	// over time based on gravity.
 	ProjectileHitType arcingProjectileUpdateFunc(ProjectileLogic* projLogic)
 	{
-		const fixed16_16 dt = s_deltaTime;
-		// The projectile arcs due to gravity, accel = 120.0 units / s^2
-		projLogic->vel.y += mul16(s_projGravityAccel, dt);
-		// Get the frame delta from the velocity and delta time.
-		projLogic->delta.x = mul16(projLogic->vel.x, dt);
-		projLogic->delta.y = mul16(projLogic->vel.y, dt);
-		projLogic->delta.z = mul16(projLogic->vel.z, dt);
+		if (!proj_applyBatchedMove(projLogic, s_projGravityAccel))
+		{
+			const fixed16_16 dt = s_deltaTime;
+			// The projectile arcs due to gravity, accel = 120.0 units / s^2
+			projLogic->vel.y += mul16(s_projGravityAccel, dt);
+			// Get the frame delta from the velocity and delta time.
+			projLogic->delta.x = mul16(projLogic->vel.x, dt);
+			projLogic->delta.y = mul16(projLogic->vel.y, dt);
+			projLogic->delta.z = mul16(projLogic->vel.z, dt);
+		}
 
 		// Arcing projectiles cannot move straight up or down.
 		const fixed16_16 horzSpeed = vec2Length(projLogic->vel.x, projLogic->vel.z);
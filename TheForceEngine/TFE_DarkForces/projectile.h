@@ -128,6 +128,9 @@ namespace TFE_DarkForces
 	void setProjectileGravityAccel(s32 accel);
 	s32 getProjectileGravityAccel();
 
+	// TFE: Fire 'count' projectiles around the player and log the projectile update timing until they are gone.
+	void projectile_stressTest(s32 count, ProjectileType type);
+
 	// TFE: Serialization functionality.
 	s32 proj_getLogicIndex(ProjectileLogic* logic);
 	ProjectileLogic* proj_getByLogicIndex(s32 index);
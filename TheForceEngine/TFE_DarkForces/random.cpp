@@ -1,5 +1,6 @@
 #include "random.h"
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_System/system.h>
 
 namespace TFE_DarkForces
@@ -7,6 +8,7 @@ namespace TFE_DarkForces
 	// TODO(Core Game Loop Release): Figure out what this value is at program start up. The value here is from when the program was already running.
 	// This should cause the random numbers to match up between TFE and DOS.
 	static u32 s_seed = 0xf444bb3b;
+	SNAPSHOT_STATE(s_seed);
 
 	void random_serialize(Stream* stream)
 	{
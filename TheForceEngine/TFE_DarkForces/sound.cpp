@@ -103,6 +103,11 @@ namespace TFE_DarkForces
 		ImSetResourceCallback(nullptr);
 	}
 
+	s32 sound_getLoadedCount()
+	{
+		return sound_state.gameSoundList ? allocator_getCount(sound_state.gameSoundList) : 0;
+	}
+
 	s32 sound_getIndexFromId(SoundSourceId id)
 	{
 		if (!id) { return -1; }
@@ -62,6 +62,8 @@ namespace TFE_DarkForces
 
 	// Serialization
 	void sound_serializeLevelSounds(Stream* stream);
+	// Number of loaded sound sources, used to validate in-place snapshots.
+	s32 sound_getLoadedCount();
 
 	// Load a sound source from disk.
 	SoundSourceId sound_load(const char* sound, u32 priority = SOUND_PRIORITY_MED0);
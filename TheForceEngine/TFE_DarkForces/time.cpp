@@ -2,6 +2,7 @@
 #include <TFE_System/system.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <cstring>
 #include <TFE_Input/replay.h>
 
@@ -20,6 +21,14 @@ namespace TFE_DarkForces
 	fixed16_16 s_curTickFract = 0;
 	fixed16_16 s_prevTickFract = 0;
 
+	SNAPSHOT_STATE(s_curTick);
+	SNAPSHOT_STATE(s_prevTick);
+	SNAPSHOT_STATE(s_timeAccum);
+	SNAPSHOT_STATE(s_deltaTime);
+	SNAPSHOT_STATE(s_frameTicks);
+	SNAPSHOT_STATE(s_curTickFract);
+	SNAPSHOT_STATE(s_prevTickFract);
+
 	void time_serialize(Stream* stream)
 	{
 		SERIALIZE(SaveVersionInit, s_curTick, 0);
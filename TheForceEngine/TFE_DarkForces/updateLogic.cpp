@@ -7,6 +7,7 @@
 #include <TFE_Jedi/InfSystem/infSystem.h>
 #include <TFE_Jedi/Collision/collision.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 using namespace TFE_Jedi;
 
@@ -37,6 +38,8 @@ namespace TFE_DarkForces
 
 	static Task* s_logicUpdateTask = nullptr;
 	static Allocator* s_logicUpdateList = nullptr;
+	SNAPSHOT_STATE(s_logicUpdateTask);
+	SNAPSHOT_STATE(s_logicUpdateList);
 
 	void updateLogicTaskFunc(MessageType msg);
 	void updateLogicCleanupFunc(Logic* logic);
@@ -10,6 +10,7 @@
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 #include <TFE_Jedi/Renderer/screenDraw.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_ExternalData/weaponExternal.h>
 
 namespace TFE_DarkForces
@@ -78,6 +79,27 @@ namespace TFE_DarkForces
 	SoundSourceId s_superchargeCountdownSound;
 	Task* s_playerWeaponTask = nullptr;
 
+	SNAPSHOT_STATE(s_switchWeapons);
+	SNAPSHOT_STATE(s_queWeaponSwitch);
+	SNAPSHOT_STATE(s_playerWeaponList);
+	SNAPSHOT_STATE(s_weaponDelayPrimary);
+	SNAPSHOT_STATE(s_weaponDelaySeconary);
+	SNAPSHOT_STATE(s_canFirePrimPtr);
+	SNAPSHOT_STATE(s_canFireSecPtr);
+	SNAPSHOT_STATE(s_weaponAnimState);
+	SNAPSHOT_STATE(s_prevWeapon);
+	SNAPSHOT_STATE(s_curWeapon);
+	SNAPSHOT_STATE(s_nextWeapon);
+	SNAPSHOT_STATE(s_lastWeapon);
+	SNAPSHOT_STATE(s_secondaryFire);
+	SNAPSHOT_STATE(s_weaponOffAnim);
+	SNAPSHOT_STATE(s_isShooting);
+	SNAPSHOT_STATE(s_canFireWeaponSec);
+	SNAPSHOT_STATE(s_canFireWeaponPrim);
+	SNAPSHOT_STATE(s_fireFrame);
+	SNAPSHOT_STATE(s_curPlayerWeapon);
+	SNAPSHOT_STATE(s_playerWeaponTask);
+
 	///////////////////////////////////////////
 	// Forward Declarations
 	///////////////////////////////////////////
@@ -9,6 +9,7 @@
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 // TFE
 #include <TFE_Settings/settings.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 namespace TFE_DarkForces
 {
@@ -42,6 +43,12 @@ namespace TFE_DarkForces
 	static fixed16_16 s_wpnPitchCos;
 	static angle14_32 s_weaponFirePitch;
 	static angle14_32 s_weaponFireYaw;
+	SNAPSHOT_STATE(s_autoAimDirX);
+	SNAPSHOT_STATE(s_autoAimDirZ);
+	SNAPSHOT_STATE(s_wpnPitchSin);
+	SNAPSHOT_STATE(s_wpnPitchCos);
+	SNAPSHOT_STATE(s_weaponFirePitch);
+	SNAPSHOT_STATE(s_weaponFireYaw);
 
 	extern WeaponAnimState s_weaponAnimState;
 	extern SoundEffectId s_repeaterFireSndID;
@@ -115,6 +122,8 @@ namespace TFE_DarkForces
 		-375, -125, 125, 375
 	};
 	static JBool s_fusionCycleForward = JTRUE;
+	SNAPSHOT_STATE(s_fusionCylinder);
+	SNAPSHOT_STATE(s_fusionCycleForward);
 
 	extern void weapon_handleState(MessageType msg);
 	extern void weapon_handleState2(MessageType msg);
@@ -23,12 +23,15 @@
 #include <TFE_Archive/archive.h>
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_System/parser.h>
+#include <TFE_System/hash.h>
+#include <TFE_System/parallel.h>
 #include <TFE_Ui/ui.h>
 
 #include <algorithm>
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 
 using namespace TFE_Editor;
 
@@ -100,6 +103,11 @@ namespace AssetBrowser
 	static ViewerInfo s_viewInfo = {};
 	static AssetList s_viewAssetList;
 	static AssetList s_projectAssetList[TYPE_COUNT];
+	// Assets waiting to be loaded into the view list, a few are loaded each frame.
+	static std::vector<const Asset*> s_pendingAssets;
+	static size_t s_pendingNext = 0;
+	// Archive timestamps for the thumbnail cache keys, read once per asset list update.
+	static std::map<Archive*, u64> s_archiveTimes;
 
 	// Forward Declarations
 	void updateAssetList();
@@ -111,6 +119,7 @@ namespace AssetBrowser
 	void importSelected();
 	s32 getAssetPalette(const char* name);
 	void drawAssetList(s32 w, s32 h);
+	void streamPendingAssets(bool loadAll = false);
 
 	void init()
 	{
@@ -128,6 +137,9 @@ namespace AssetBrowser
 
 		s_viewInfo = ViewerInfo{};
 		s_viewAssetList.clear();
+		s_pendingAssets.clear();
+		s_pendingNext = 0;
+		s_archiveTimes.clear();
 		for (s32 i = 0; i < TYPE_COUNT; i++)
 		{
 			s_projectAssetList[i].clear();
@@ -673,6 +685,8 @@ namespace AssetBrowser
 
 	void drawAssetList(s32 w, s32 h)
 	{
+		streamPendingAssets();
+
 		const s32 count = (s32)s_viewAssetList.size();
 		const Asset* asset = s_viewAssetList.data();
 
@@ -969,6 +983,8 @@ namespace AssetBrowser
 		s_selectRange[1] = -1;
 
 		updateAssetList();
+		// The selection needs the full list.
+		streamPendingAssets(true);
 		selectByAssetName(selectName);
 	}
 	
@@ -1250,210 +1266,435 @@ namespace AssetBrowser
 		assetList.push_back(assetName);
 	}
 
-	void preprocessAssets()
+	// Level metadata parsed from the .LEV and .O files.
+	struct LevelMetadata
 	{
-		if (!s_assetsNeedProcess) { return; }
-		s_assetsNeedProcess = false;
-		s_levelAssets.clear();
+		bool valid = false;
+		std::string paletteName;
+		std::vector<std::string> textures;
+		std::vector<std::string> frames;
+		std::vector<std::string> sprites;
+		std::vector<std::string> pods;
+	};
 
-		const u32 count = (u32)s_projectAssetList[TYPE_PALETTE].size();
+	// Raw level files read from the archive, parsed on the worker threads.
+	struct LevelSource
+	{
+		bool parse = false;
+		WorkBuffer lev;
+		WorkBuffer obj;
+	};
 
-		// First search for palettes.
-		const Asset* projAsset = s_projectAssetList[TYPE_PALETTE].data();
-		for (u32 f = 0; f < count; f++, projAsset++)
+	enum LevelCacheConst : u32
+	{
+		LEVEL_CACHE_MAGIC   = 0x4341454c,	// "LEAC"
+		LEVEL_CACHE_VERSION = 1,
+	};
+
+	// Parsed level metadata, keyed by archive path, entry names, sizes and the archive timestamp.
+	static std::map<u64, LevelMetadata> s_levelMetadataCache;
+	static bool s_levelMetadataCacheLoaded = false;
+
+	void getLevelMetadataCachePath(char* path)
+	{
+		sprintf(path, "%sEditorCache/levelAssets.cache", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+	}
+
+	void readStringList(FileStream& file, std::vector<std::string>& list)
+	{
+		u32 count = 0;
+		file.read(&count);
+		list.resize(count);
+		if (count) { file.read(list.data(), count); }
+	}
+
+	void writeStringList(FileStream& file, const std::vector<std::string>& list)
+	{
+		const u32 count = (u32)list.size();
+		file.write(&count);
+		if (count) { file.write(list.data(), count); }
+	}
+
+	void loadLevelMetadataCache()
+	{
+		if (s_levelMetadataCacheLoaded) { return; }
+		s_levelMetadataCacheLoaded = true;
+
+		char cachePath[TFE_MAX_PATH];
+		getLevelMetadataCachePath(cachePath);
+		FileStream file;
+		if (!FileUtil::exists(cachePath) || !file.open(cachePath, Stream::MODE_READ)) { return; }
+
+		u32 magic = 0, version = 0, count = 0;
+		file.read(&magic);
+		file.read(&version);
+		file.read(&count);
+		if (magic != LEVEL_CACHE_MAGIC || version != LEVEL_CACHE_VERSION)
 		{
-			addPalette(projAsset->name.c_str(), projAsset->archive);
+			file.close();
+			return;
 		}
+		for (u32 i = 0; i < count; i++)
+		{
+			u64 key = 0;
+			u8 valid = 0;
+			file.read(&key);
+			file.read(&valid);
 
-		// Then for levels.
-		WorkBuffer buffer;
-		const u32 levelCount = (u32)s_projectAssetList[TYPE_LEVEL].size();
-		projAsset = s_projectAssetList[TYPE_LEVEL].data();
-		for (u32 f = 0; f < levelCount; f++, projAsset++)
+			LevelMetadata& metadata = s_levelMetadataCache[key];
+			metadata.valid = valid != 0;
+			file.read(&metadata.paletteName);
+			readStringList(file, metadata.textures);
+			readStringList(file, metadata.frames);
+			readStringList(file, metadata.sprites);
+			readStringList(file, metadata.pods);
+		}
+		file.close();
+	}
+
+	void saveLevelMetadataCache()
+	{
+		char cacheDir[TFE_MAX_PATH];
+		sprintf(cacheDir, "%sEditorCache/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		if (!FileUtil::directoryExits(cacheDir))
 		{
-			Archive* archive = projAsset->archive;
-			// TODO: Handle non-archive levels.
-			if (!archive) { continue; }
+			FileUtil::makeDirectory(cacheDir);
+		}
 
-			// Parse the level for 1) the palette, 2) the data lists.
-			if (archive->openFile(projAsset->name.c_str()))
-			{
-				LevelAssets levelAssets;
-				levelAssets.levelName = projAsset->name;
-				s32 paletteId = s_defaultPal;
+		char cachePath[TFE_MAX_PATH];
+		getLevelMetadataCachePath(cachePath);
+		FileStream file;
+		if (!file.open(cachePath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Asset Browser", "Cannot write the level asset cache '%s'.", cachePath);
+			return;
+		}
 
-				// .LEV
-				{
-					size_t len = archive->getFileLength();
-					buffer.resize(len);
-					archive->readFile(buffer.data(), len);
-					archive->closeFile();
+		const u32 magic = LEVEL_CACHE_MAGIC, version = LEVEL_CACHE_VERSION;
+		const u32 count = (u32)s_levelMetadataCache.size();
+		file.write(&magic);
+		file.write(&version);
+		file.write(&count);
+		std::map<u64, LevelMetadata>::const_iterator iMetadata = s_levelMetadataCache.begin();
+		for (; iMetadata != s_levelMetadataCache.end(); ++iMetadata)
+		{
+			const LevelMetadata& metadata = iMetadata->second;
+			const u8 valid = metadata.valid ? 1 : 0;
+			file.write(&iMetadata->first);
+			file.write(&valid);
+			file.write(&metadata.paletteName);
+			writeStringList(file, metadata.textures);
+			writeStringList(file, metadata.frames);
+			writeStringList(file, metadata.sprites);
+			writeStringList(file, metadata.pods);
+		}
+		file.close();
+	}
 
-					TFE_Parser parser;
-					size_t bufferPos = 0;
-					parser.init((char*)buffer.data(), buffer.size());
-					parser.addCommentString("#");
-					parser.convertToUpperCase(true);
-
-					// Read just enough of the file...
-					const char* line;
-					line = parser.readLine(bufferPos);
-					s32 versionMajor, versionMinor;
-					if (sscanf(line, " LEV %d.%d", &versionMajor, &versionMinor) != 2)
-					{
-						continue;
-					}
+	// Parse the level for 1) the palette, 2) the data lists.
+	// This only touches its own data so that it can run on the worker threads.
+	void parseLevelMetadata(const LevelSource* source, LevelMetadata* metadata)
+	{
+		metadata->valid = false;
 
-					char readBuffer[256];
-					line = parser.readLine(bufferPos);
-					if (sscanf(line, " LEVELNAME %s", readBuffer) != 1)
-					{
-						continue;
-					}
+		// .LEV
+		{
+			TFE_Parser parser;
+			size_t bufferPos = 0;
+			parser.init((char*)source->lev.data(), source->lev.size());
+			parser.addCommentString("#");
+			parser.convertToUpperCase(true);
 
-					// This gets read here just to be overwritten later... so just ignore for now.
-					line = parser.readLine(bufferPos);
-					if (sscanf(line, " PALETTE %s", readBuffer) != 1)
-					{
-						continue;
-					}
-					// Fixup the palette, strip any path.
-					char paletteName[TFE_MAX_PATH];
-					FileUtil::getFileNameFromPath(readBuffer, paletteName, true);
-					paletteId = getPaletteId(paletteName);
-					if (paletteId < 0) { paletteId = 0; }
+			// Read just enough of the file...
+			const char* line;
+			line = parser.readLine(bufferPos);
+			s32 versionMajor, versionMinor;
+			if (!line || sscanf(line, " LEV %d.%d", &versionMajor, &versionMinor) != 2)
+			{
+				return;
+			}
 
-					levelAssets.paletteName = paletteName;
+			char readBuffer[256];
+			line = parser.readLine(bufferPos);
+			if (!line || sscanf(line, " LEVELNAME %s", readBuffer) != 1)
+			{
+				return;
+			}
 
-					// Another value that is ignored.
-					line = parser.readLine(bufferPos);
-					if (sscanf(line, " MUSIC %s", readBuffer) == 1)
-					{
-						line = parser.readLine(bufferPos);
-					}
+			// This gets read here just to be overwritten later... so just ignore for now.
+			line = parser.readLine(bufferPos);
+			if (!line || sscanf(line, " PALETTE %s", readBuffer) != 1)
+			{
+				return;
+			}
+			// Fixup the palette, strip any path.
+			char paletteName[TFE_MAX_PATH];
+			FileUtil::getFileNameFromPath(readBuffer, paletteName, true);
+			metadata->paletteName = paletteName;
+
+			// Another value that is ignored.
+			line = parser.readLine(bufferPos);
+			if (line && sscanf(line, " MUSIC %s", readBuffer) == 1)
+			{
+				line = parser.readLine(bufferPos);
+			}
 
-					// Sky Parallax - this option until version 1.9, so handle its absence.
-					f32 x, z;
-					if (sscanf(line, " PARALLAX %f %f", &x, &z) == 2)
-					{
-						line = parser.readLine(bufferPos);
-					}
+			// Sky Parallax - this option until version 1.9, so handle its absence.
+			f32 x, z;
+			if (line && sscanf(line, " PARALLAX %f %f", &x, &z) == 2)
+			{
+				line = parser.readLine(bufferPos);
+			}
 
-					// Number of textures used by the level.
-					s32 textureCount = 0;
-					if (sscanf(line, " TEXTURES %d", &textureCount) != 1)
-					{
-						continue;
-					}
+			// Number of textures used by the level.
+			s32 textureCount = 0;
+			if (!line || sscanf(line, " TEXTURES %d", &textureCount) != 1)
+			{
+				return;
+			}
 
-					// Read texture names.
-					char textureName[256];
-					for (s32 i = 0; i < textureCount; i++)
+			// Read texture names.
+			char textureName[256];
+			for (s32 i = 0; i < textureCount && line; i++)
+			{
+				line = parser.readLine(bufferPos);
+				if (line && sscanf(line, " TEXTURE: %s ", textureName) == 1)
+				{
+					addToLevelAssets(metadata->textures, textureName);
+				}
+			}
+			// Sometimes there are extra textures, just add them - they will be compacted later.
+			while (line && sscanf(line, " TEXTURE: %s ", textureName) == 1)
+			{
+				addToLevelAssets(metadata->textures, textureName);
+				line = parser.readLine(bufferPos);
+			}
+		}
+		metadata->valid = true;
+
+		// .O File
+		if (!source->obj.empty())
+		{
+			TFE_Parser parser;
+			size_t bufferPos = 0;
+			parser.init((char*)source->obj.data(), source->obj.size());
+			parser.addCommentString("#");
+			parser.convertToUpperCase(true);
+
+			enum ProcessFlags
+			{
+				PFLAG_POD = (1 << 0),
+				PFLAG_SPRITE = (1 << 1),
+				PFLAG_FRAME = (1 << 2),
+				PFLAG_PROCESS_DONE = PFLAG_POD | PFLAG_SPRITE | PFLAG_FRAME
+			};
+			u32 processFlags = 0;
+			const char* line;
+			while ((line = parser.readLine(bufferPos)) && (processFlags != PFLAG_PROCESS_DONE))
+			{
+				// Search for "PODS"
+				s32 count = 0;
+				char assetName[32];
+				if (sscanf(line, "PODS %d", &count) == 1)
+				{
+					for (s32 p = 0; p < count; p++)
 					{
 						line = parser.readLine(bufferPos);
-						if (sscanf(line, " TEXTURE: %s ", textureName) == 1)
+						if (line && sscanf(line, " POD: %s", assetName) == 1)
 						{
-							setAssetPalette(textureName, paletteId);
-							setAssetLevel(textureName, f);
-							addToLevelAssets(levelAssets.textures, textureName);
+							addToLevelAssets(metadata->pods, assetName);
 						}
 					}
-					// Sometimes there are extra textures, just add them - they will be compacted later.
-					bool readNext = true;
-					while (sscanf(line, " TEXTURE: %s ", textureName) == 1)
+					processFlags |= PFLAG_POD;
+				}
+				else if (sscanf(line, "SPRS %d", &count) == 1)
+				{
+					for (s32 p = 0; p < count; p++)
 					{
-						setAssetPalette(textureName, paletteId);
-						setAssetLevel(textureName, f);
-						addToLevelAssets(levelAssets.textures, textureName);
 						line = parser.readLine(bufferPos);
-						readNext = false;
+						if (line && sscanf(line, " SPR: %s", assetName) == 1)
+						{
+							addToLevelAssets(metadata->sprites, assetName);
+						}
 					}
+					processFlags |= PFLAG_SPRITE;
 				}
-
-				// .O File
-				char objFile[TFE_MAX_PATH];
-				FileUtil::replaceExtension(projAsset->name.c_str(), "O", objFile);
-				if (archive->openFile(objFile))
+				else if (sscanf(line, "FMES %d", &count) == 1)
 				{
-					size_t len = archive->getFileLength();
-					buffer.resize(len);
-					archive->readFile(buffer.data(), len);
-					archive->closeFile();
-
-					TFE_Parser parser;
-					size_t bufferPos = 0;
-					parser.init((char*)buffer.data(), buffer.size());
-					parser.addCommentString("#");
-					parser.convertToUpperCase(true);
-
-					enum ProcessFlags
+					for (s32 p = 0; p < count; p++)
 					{
-						PFLAG_POD = (1 << 0),
-						PFLAG_SPRITE = (1 << 1),
-						PFLAG_FRAME = (1 << 2),
-						PFLAG_PROCESS_DONE = PFLAG_POD | PFLAG_SPRITE | PFLAG_FRAME
-					};
-					u32 processFlags = 0;
-					const char* line;
-					while ((line = parser.readLine(bufferPos)) && (processFlags != PFLAG_PROCESS_DONE))
-					{
-						// Search for "PODS"
-						s32 count = 0;
-						char assetName[32];
-						if (sscanf(line, "PODS %d", &count) == 1)
-						{
-							for (s32 p = 0; p < count; p++)
-							{
-								line = parser.readLine(bufferPos);
-								if (line)
-								{
-									if (sscanf(line, " POD: %s", assetName) == 1)
-									{
-										setAssetPalette(assetName, paletteId);
-										addToLevelAssets(levelAssets.pods, assetName);
-									}
-								}
-							}
-							processFlags |= PFLAG_POD;
-						}
-						else if (sscanf(line, "SPRS %d", &count) == 1)
-						{
-							for (s32 p = 0; p < count; p++)
-							{
-								line = parser.readLine(bufferPos);
-								if (line)
-								{
-									if (sscanf(line, " SPR: %s", assetName) == 1)
-									{
-										setAssetPalette(assetName, paletteId);
-										addToLevelAssets(levelAssets.sprites, assetName);
-									}
-								}
-							}
-							processFlags |= PFLAG_SPRITE;
-						}
-						else if (sscanf(line, "FMES %d", &count) == 1)
+						line = parser.readLine(bufferPos);
+						if (line && sscanf(line, " FME: %s", assetName) == 1)
 						{
-							for (s32 p = 0; p < count; p++)
-							{
-								line = parser.readLine(bufferPos);
-								if (line)
-								{
-									if (sscanf(line, " FME: %s", assetName) == 1)
-									{
-										setAssetPalette(assetName, paletteId);
-										addToLevelAssets(levelAssets.frames, assetName);
-									}
-								}
-							}
-							processFlags |= PFLAG_FRAME;
+							addToLevelAssets(metadata->frames, assetName);
 						}
 					}
+					processFlags |= PFLAG_FRAME;
 				}
+			}
+		}
+	}
+
+	bool readArchiveFile(Archive* archive, const char* name, WorkBuffer& buffer)
+	{
+		buffer.clear();
+		if (!archive->openFile(name)) { return false; }
+		const size_t len = archive->getFileLength();
+		buffer.resize(len);
+		archive->readFile(buffer.data(), len);
+		archive->closeFile();
+		return true;
+	}
+
+	u64 getLevelMetadataKey(Archive* archive, const char* levName, const char* objName, u64 archiveTime)
+	{
+		const u32 levIndex = archive->getFileIndex(levName);
+		const u32 objIndex = archive->getFileIndex(objName);
+		const u64 levSize = levIndex != INVALID_FILE ? (u64)archive->getFileLength(levIndex) : 0;
+		const u64 objSize = objIndex != INVALID_FILE ? (u64)archive->getFileLength(objIndex) : ~0ull;
+
+		u64 key = TFE_Hash::fnv1a64(archive->getPath());
+		key = TFE_Hash::fnv1a64(levName, strlen(levName), key);
+		key = TFE_Hash::fnv1a64Value(levSize, key);
+		key = TFE_Hash::fnv1a64Value(objSize, key);
+		key = TFE_Hash::fnv1a64Value(archiveTime, key);
+		return key;
+	}
+
+	void preprocessAssets()
+	{
+		if (!s_assetsNeedProcess) { return; }
+		s_assetsNeedProcess = false;
+		s_levelAssets.clear();
+
+		const u32 count = (u32)s_projectAssetList[TYPE_PALETTE].size();
+
+		// First search for palettes.
+		const Asset* projAsset = s_projectAssetList[TYPE_PALETTE].data();
+		for (u32 f = 0; f < count; f++, projAsset++)
+		{
+			addPalette(projAsset->name.c_str(), projAsset->archive);
+		}
+
+		// Then for levels.
+		// The level files are read from the archives here, archives are not thread safe. Levels that are not
+		// in the cache are then parsed on worker threads and the results are applied in the original order.
+		const u64 startTime = TFE_System::getCurrentTimeInTicks();
+		loadLevelMetadataCache();
+
+		const u32 levelCount = (u32)s_projectAssetList[TYPE_LEVEL].size();
+		std::vector<LevelMetadata> metadata(levelCount);
+		std::vector<LevelSource> sources(levelCount);
+		std::vector<u64> keys(levelCount, 0);
+		std::vector<s32> parseList;
+		std::map<Archive*, u64> archiveTime;
+
+		projAsset = s_projectAssetList[TYPE_LEVEL].data();
+		for (u32 f = 0; f < levelCount; f++, projAsset++)
+		{
+			Archive* archive = projAsset->archive;
+			// TODO: Handle non-archive levels.
+			if (!archive) { continue; }
+
+			std::map<Archive*, u64>::iterator iTime = archiveTime.find(archive);
+			if (iTime == archiveTime.end())
+			{
+				iTime = archiveTime.insert({ archive, FileUtil::getModifiedTime(archive->getPath()) }).first;
+			}
+
+			char objFile[TFE_MAX_PATH];
+			FileUtil::replaceExtension(projAsset->name.c_str(), "O", objFile);
+			keys[f] = getLevelMetadataKey(archive, projAsset->name.c_str(), objFile, iTime->second);
+
+			std::map<u64, LevelMetadata>::iterator iCached = s_levelMetadataCache.find(keys[f]);
+			if (iCached != s_levelMetadataCache.end())
+			{
+				metadata[f] = iCached->second;
+			}
+			else if (readArchiveFile(archive, projAsset->name.c_str(), sources[f].lev))
+			{
+				readArchiveFile(archive, objFile, sources[f].obj);
+				sources[f].parse = true;
+				parseList.push_back(s32(f));
+			}
+		}
+
+		const s32 parseCount = (s32)parseList.size();
+		TFE_System::parallelFor(parseCount, [&](s32 i)
+		{
+			const s32 f = parseList[i];
+			parseLevelMetadata(&sources[f], &metadata[f]);
+			// Release the file data as soon as it is parsed.
+			sources[f] = LevelSource{};
+		});
+		for (s32 i = 0; i < parseCount; i++)
+		{
+			const s32 f = parseList[i];
+			s_levelMetadataCache[keys[f]] = metadata[f];
+		}
+
+		// Drop the entries for levels that were not seen (removed or changed), so the cache does not keep growing.
+		u32 prunedCount = 0;
+		const std::set<u64> seenKeys(keys.begin(), keys.end());
+		std::map<u64, LevelMetadata>::iterator iMetadata = s_levelMetadataCache.begin();
+		while (iMetadata != s_levelMetadataCache.end())
+		{
+			if (seenKeys.find(iMetadata->first) == seenKeys.end())
+			{
+				iMetadata = s_levelMetadataCache.erase(iMetadata);
+				prunedCount++;
+			}
+			else
+			{
+				++iMetadata;
+			}
+		}
+		if (parseCount || prunedCount)
+		{
+			saveLevelMetadataCache();
+		}
+
+		// Apply the results in level order, so later levels override the palettes of shared assets as before.
+		projAsset = s_projectAssetList[TYPE_LEVEL].data();
+		for (u32 f = 0; f < levelCount; f++, projAsset++)
+		{
+			const LevelMetadata& level = metadata[f];
+			if (!level.valid) { continue; }
+
+			s32 paletteId = getPaletteId(level.paletteName.c_str());
+			if (paletteId < 0) { paletteId = 0; }
+
+			LevelAssets levelAssets;
+			levelAssets.levelName = projAsset->name;
+			levelAssets.paletteName = level.paletteName;
+			levelAssets.textures = level.textures;
+			levelAssets.frames = level.frames;
+			levelAssets.sprites = level.sprites;
+			levelAssets.pods = level.pods;
 
-				s_levelAssets.push_back(levelAssets);
+			for (size_t i = 0; i < level.textures.size(); i++)
+			{
+				setAssetPalette(level.textures[i].c_str(), paletteId);
+				setAssetLevel(level.textures[i].c_str(), f);
+			}
+			for (size_t i = 0; i < level.pods.size(); i++)
+			{
+				setAssetPalette(level.pods[i].c_str(), paletteId);
+			}
+			for (size_t i = 0; i < level.sprites.size(); i++)
+			{
+				setAssetPalette(level.sprites[i].c_str(), paletteId);
 			}
+			for (size_t i = 0; i < level.frames.size(); i++)
+			{
+				setAssetPalette(level.frames[i].c_str(), paletteId);
+			}
+			s_levelAssets.push_back(levelAssets);
 		}
+
+		const f64 time = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - startTime);
+		TFE_System::logWrite(LOG_MSG, "Asset Browser", "Processed %u levels (%d parsed, %u cached, %u stale cache entries removed) in %0.2f ms.",
+			levelCount, parseCount, levelCount - u32(parseCount), prunedCount, time);
 	}
 
 	void reloadAsset(Asset* asset, s32 palId, s32 lightLevel)
@@ -1844,11 +2085,8 @@ namespace AssetBrowser
 		return loadAssetData(asset->type, asset->archive, &colorData, asset->name.c_str());
 	}
 
-	void loadAsset(const Asset* projAsset)
+	void addViewAsset(const Asset* projAsset, AssetHandle handle)
 	{
-		// Filter out vanilla assets if desired.
-		if ((projAsset->assetSource == ASRC_VANILLA) && resources_ignoreVanillaAssets()) { return; }
-
 		Asset asset;
 		asset.type = projAsset->type;
 		asset.name = projAsset->name;
@@ -1856,10 +2094,7 @@ namespace AssetBrowser
 		asset.archive = projAsset->archive;
 		asset.filePath = projAsset->filePath;
 		asset.assetSource = projAsset->assetSource;
-		s32 palId = getAssetPalette(projAsset->name.c_str());
-
-		AssetColorData colorData = { s_palettes[palId].data, nullptr, palId, 32 };
-		asset.handle = loadAssetData(projAsset->type, projAsset->archive, &colorData, projAsset->name.c_str());
+		asset.handle = handle;
 		// For now allow stubbed types to squeak through...
 		// TODO: Make this more strict once those are properly loaded.
 		if (asset.handle != NULL_ASSET || asset.type == TYPE_3DOBJ || asset.type == TYPE_LEVEL)
@@ -1867,6 +2102,364 @@ namespace AssetBrowser
 			s_viewAssetList.push_back(asset);
 		}
 	}
+
+	void loadAsset(const Asset* projAsset)
+	{
+		// Filter out vanilla assets if desired.
+		if ((projAsset->assetSource == ASRC_VANILLA) && resources_ignoreVanillaAssets()) { return; }
+
+		s32 palId = getAssetPalette(projAsset->name.c_str());
+		AssetColorData colorData = { s_palettes[palId].data, nullptr, palId, 32 };
+		addViewAsset(projAsset, loadAssetData(projAsset->type, projAsset->archive, &colorData, projAsset->name.c_str()));
+	}
+
+	enum ThumbnailCacheConst : u32
+	{
+		THUMBNAIL_CACHE_MAGIC     = 0x424d4854,	// "THMB"
+		THUMBNAIL_CACHE_VERSION   = 1,
+		THUMBNAIL_CACHE_MAX_FILES = 8192,
+		THUMBNAIL_MAX_SIZE        = 8192,
+		THUMBNAIL_MAX_COUNT       = 65536,
+		THUMBNAIL_BATCH_SIZE      = 64,
+	};
+
+	// An asset loaded by loadAssetBatch().
+	struct ThumbnailJob
+	{
+		const Asset* projAsset = nullptr;
+		AssetColorData colorData = {};
+		u64  key = 0;
+		bool decode = false;	// Decoded on a worker thread, otherwise the asset is loaded on the main thread.
+		bool cached = false;	// Read from the thumbnail cache rather than decoded from the source data.
+		bool result = false;
+		bool written = false;
+		WorkBuffer source;
+		DecodedAsset decoded;
+	};
+
+	// Decoded assets are cached on disk, one file per asset, keyed by archive path, entry name and size, archive timestamp
+	// and palette.
+	static std::set<u64> s_thumbnailCacheKeys;
+	static bool s_thumbnailCacheLoaded = false;
+
+	void getThumbnailCacheDir(char* path)
+	{
+		sprintf(path, "%sEditorCache/Thumbnails/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+	}
+
+	void getThumbnailCachePath(u64 key, char* path)
+	{
+		char cacheDir[TFE_MAX_PATH];
+		getThumbnailCacheDir(cacheDir);
+		sprintf(path, "%s%016llx.thumb", cacheDir, (unsigned long long)key);
+	}
+
+	// Read the keys of the cached thumbnails and remove the oldest files if there are too many.
+	void loadThumbnailCache()
+	{
+		if (s_thumbnailCacheLoaded) { return; }
+		s_thumbnailCacheLoaded = true;
+
+		char cacheDir[TFE_MAX_PATH];
+		getThumbnailCacheDir(cacheDir);
+		if (!FileUtil::directoryExits(cacheDir))
+		{
+			FileUtil::makeDirectory(cacheDir);
+			return;
+		}
+
+		FileList fileList;
+		FileUtil::readDirectory(cacheDir, "thumb", fileList);
+		std::vector<std::pair<u64, u64>> files;
+		for (size_t i = 0; i < fileList.size(); i++)
+		{
+			char path[TFE_MAX_PATH];
+			sprintf(path, "%s%s", cacheDir, fileList[i].c_str());
+			const u64 key = strtoull(fileList[i].c_str(), nullptr, 16);
+			files.push_back({ FileUtil::getModifiedTime(path), key });
+			s_thumbnailCacheKeys.insert(key);
+		}
+		if (files.size() <= THUMBNAIL_CACHE_MAX_FILES) { return; }
+
+		std::sort(files.begin(), files.end());
+		const size_t removeCount = files.size() - THUMBNAIL_CACHE_MAX_FILES;
+		for (size_t i = 0; i < removeCount; i++)
+		{
+			char path[TFE_MAX_PATH];
+			getThumbnailCachePath(files[i].second, path);
+			FileUtil::deleteFile(path);
+			s_thumbnailCacheKeys.erase(files[i].second);
+		}
+		TFE_System::logWrite(LOG_MSG, "Asset Browser", "Removed %u old thumbnail cache files.", u32(removeCount));
+	}
+
+	u64 getThumbnailKey(const Asset* projAsset, const u32* palette)
+	{
+		Archive* archive = projAsset->archive;
+		std::map<Archive*, u64>::iterator iTime = s_archiveTimes.find(archive);
+		if (iTime == s_archiveTimes.end())
+		{
+			iTime = s_archiveTimes.insert({ archive, FileUtil::getModifiedTime(archive->getPath()) }).first;
+		}
+
+		const char* name = projAsset->name.c_str();
+		const u32 index = archive->getFileIndex(name);
+		const u64 size = index != INVALID_FILE ? (u64)archive->getFileLength(index) : 0;
+
+		u64 key = TFE_Hash::fnv1a64(archive->getPath());
+		key = TFE_Hash::fnv1a64(name, strlen(name), key);
+		key = TFE_Hash::fnv1a64Value(size, key);
+		key = TFE_Hash::fnv1a64Value(iTime->second, key);
+		key = TFE_Hash::fnv1a64Value(u32(projAsset->type), key);
+		key = TFE_Hash::fnv1a64(palette, sizeof(u32) * 256, key);
+		return key;
+	}
+
+	void writeThumbnailImage(FileStream& file, u32 width, u32 height, const std::vector<u32>& pixels)
+	{
+		file.write(&width);
+		file.write(&height);
+		if (!pixels.empty()) { file.write(pixels.data(), (u32)pixels.size()); }
+	}
+
+	bool readThumbnailImage(FileStream& file, u32& width, u32& height, std::vector<u32>& pixels)
+	{
+		file.read(&width);
+		file.read(&height);
+		if (width > THUMBNAIL_MAX_SIZE || height > THUMBNAIL_MAX_SIZE) { return false; }
+		pixels.resize(width * height);
+		if (!pixels.empty()) { file.read(pixels.data(), (u32)pixels.size()); }
+		return true;
+	}
+
+	template<typename T>
+	void writeThumbnailList(FileStream& file, const std::vector<T>& list)
+	{
+		const u32 count = (u32)list.size();
+		file.write(&count);
+		if (count) { file.writeBuffer(list.data(), sizeof(T), count); }
+	}
+
+	template<typename T>
+	bool readThumbnailList(FileStream& file, std::vector<T>& list)
+	{
+		u32 count = 0;
+		file.read(&count);
+		if (count > THUMBNAIL_MAX_COUNT) { return false; }
+		list.resize(count);
+		if (count) { file.readBuffer(list.data(), sizeof(T), count); }
+		return true;
+	}
+
+	// Called from the worker threads, each thumbnail is a separate file.
+	bool writeThumbnail(u64 key, const DecodedAsset* decoded)
+	{
+		char path[TFE_MAX_PATH];
+		getThumbnailCachePath(key, path);
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE)) { return false; }
+
+		const u32 magic = THUMBNAIL_CACHE_MAGIC, version = THUMBNAIL_CACHE_VERSION, type = u32(decoded->type);
+		file.write(&magic);
+		file.write(&version);
+		file.write(&key);
+		file.write(&type);
+		switch (decoded->type)
+		{
+			case TYPE_TEXTURE:
+			case TYPE_PALETTE:
+			{
+				const DecodedTexture& texture = decoded->texture;
+				const u32 frameCount = (u32)texture.frames.size();
+				file.write(&texture.width);
+				file.write(&texture.height);
+				file.write(&frameCount);
+				for (u32 f = 0; f < frameCount; f++)
+				{
+					writeThumbnailImage(file, texture.frames[f].width, texture.frames[f].height, texture.frames[f].pixels);
+				}
+			} break;
+			case TYPE_FRAME:
+			{
+				const EditorFrame& frame = decoded->frame.frame;
+				file.write(&frame.worldWidth);
+				file.write(&frame.worldHeight);
+				file.write(&frame.offsetX);
+				file.write(&frame.offsetY);
+				writeThumbnailImage(file, frame.width, frame.height, decoded->frame.pixels);
+			} break;
+			case TYPE_SPRITE:
+			{
+				const EditorSprite& sprite = decoded->sprite.sprite;
+				file.write(sprite.rect, 4);
+				writeThumbnailList(file, sprite.anim);
+				writeThumbnailList(file, sprite.frame);
+				writeThumbnailList(file, sprite.cell);
+				writeThumbnailImage(file, decoded->sprite.width, decoded->sprite.height, decoded->sprite.pixels);
+			} break;
+			default:
+			{
+				file.close();
+				FileUtil::deleteFile(path);
+				return false;
+			}
+		}
+		// Written last, so truncated files are rejected.
+		file.write(&magic);
+		file.close();
+		return true;
+	}
+
+	// Called from the worker threads.
+	bool readThumbnail(u64 key, AssetType type, DecodedAsset* decoded)
+	{
+		char path[TFE_MAX_PATH];
+		getThumbnailCachePath(key, path);
+		FileStream file;
+		if (!file.open(path, Stream::MODE_READ)) { return false; }
+
+		u32 magic = 0, version = 0, fileType = 0;
+		u64 fileKey = 0;
+		file.read(&magic);
+		file.read(&version);
+		file.read(&fileKey);
+		file.read(&fileType);
+		if (magic != THUMBNAIL_CACHE_MAGIC || version != THUMBNAIL_CACHE_VERSION || fileKey != key || fileType != u32(type))
+		{
+			return false;
+		}
+
+		bool result = false;
+		decoded->type = type;
+		switch (type)
+		{
+			case TYPE_TEXTURE:
+			case TYPE_PALETTE:
+			{
+				DecodedTexture& texture = decoded->texture;
+				u32 frameCount = 0;
+				file.read(&texture.width);
+				file.read(&texture.height);
+				file.read(&frameCount);
+				if (frameCount > 256) { break; }
+
+				texture.frames.resize(frameCount);
+				result = true;
+				for (u32 f = 0; f < frameCount && result; f++)
+				{
+					result = readThumbnailImage(file, texture.frames[f].width, texture.frames[f].height, texture.frames[f].pixels);
+				}
+			} break;
+			case TYPE_FRAME:
+			{
+				EditorFrame& frame = decoded->frame.frame;
+				file.read(&frame.worldWidth);
+				file.read(&frame.worldHeight);
+				file.read(&frame.offsetX);
+				file.read(&frame.offsetY);
+				result = readThumbnailImage(file, frame.width, frame.height, decoded->frame.pixels);
+			} break;
+			case TYPE_SPRITE:
+			{
+				EditorSprite& sprite = decoded->sprite.sprite;
+				file.read(sprite.rect, 4);
+				result = readThumbnailList(file, sprite.anim) && readThumbnailList(file, sprite.frame) && readThumbnailList(file, sprite.cell) &&
+					readThumbnailImage(file, decoded->sprite.width, decoded->sprite.height, decoded->sprite.pixels);
+			} break;
+			default:
+				break;
+		}
+
+		magic = 0;
+		file.read(&magic);
+		return result && magic == THUMBNAIL_CACHE_MAGIC;
+	}
+
+	// Load a batch of queued assets. The source files are read on the main thread since the archives are not thread safe,
+	// then the assets are decoded - or read from the thumbnail cache - on worker threads. Finally the GPU textures are created
+	// on the main thread, in the original order. Asset types that cannot be decoded separately are loaded on the main thread.
+	void loadAssetBatch(const Asset* const* assets, s32 count)
+	{
+		loadThumbnailCache();
+		buildIdentityTable();
+
+		std::vector<ThumbnailJob> jobs(count);
+		for (s32 i = 0; i < count; i++)
+		{
+			ThumbnailJob& job = jobs[i];
+			const Asset* projAsset = assets[i];
+			const char* name = projAsset->name.c_str();
+			job.projAsset = projAsset;
+
+			if ((projAsset->assetSource == ASRC_VANILLA) && resources_ignoreVanillaAssets()) { continue; }
+			if (!projAsset->archive || !canDecodeAssetData(projAsset->type) || getLoadedAssetData(name) != NULL_ASSET) { continue; }
+
+			const s32 palId = getAssetPalette(name);
+			job.colorData = { s_palettes[palId].data, nullptr, palId, 32 };
+			job.key = getThumbnailKey(projAsset, s_palettes[palId].data);
+			job.cached = s_thumbnailCacheKeys.find(job.key) != s_thumbnailCacheKeys.end();
+			if (!job.cached && !readArchiveFile(projAsset->archive, name, job.source)) { continue; }
+			job.decode = true;
+		}
+
+		TFE_System::parallelFor(count, [&](s32 i)
+		{
+			ThumbnailJob& job = jobs[i];
+			if (!job.decode) { return; }
+
+			if (job.cached)
+			{
+				job.result = readThumbnail(job.key, job.projAsset->type, &job.decoded);
+			}
+			else
+			{
+				job.result = decodeAssetData(job.projAsset->type, job.source.data(), job.source.size(), &job.colorData, &job.decoded);
+				job.written = job.result && writeThumbnail(job.key, &job.decoded);
+				// Release the file data as soon as it is decoded.
+				job.source = WorkBuffer{};
+			}
+		});
+
+		for (s32 i = 0; i < count; i++)
+		{
+			ThumbnailJob& job = jobs[i];
+			if (job.written)
+			{
+				s_thumbnailCacheKeys.insert(job.key);
+			}
+			if (!job.decode || !job.result)
+			{
+				// A bad cache file is replaced the next time the asset is decoded.
+				if (job.cached) { s_thumbnailCacheKeys.erase(job.key); }
+				loadAsset(job.projAsset);
+				continue;
+			}
+			addViewAsset(job.projAsset, uploadAssetData(&job.decoded, &job.colorData, job.projAsset->name.c_str()));
+		}
+	}
+		
+	// Load queued assets in batches until the frame budget is used up, so large lists fill in over a few frames
+	// rather than stalling the editor.
+	void streamPendingAssets(bool loadAll)
+	{
+		if (s_pendingNext >= s_pendingAssets.size()) { return; }
+
+		const f64 budget = 0.008;
+		const f64 start = TFE_System::getTime();
+		while (s_pendingNext < s_pendingAssets.size())
+		{
+			const size_t batchCount = std::min(size_t(THUMBNAIL_BATCH_SIZE), s_pendingAssets.size() - s_pendingNext);
+			loadAssetBatch(&s_pendingAssets[s_pendingNext], s32(batchCount));
+			s_pendingNext += batchCount;
+			if (!loadAll && TFE_System::getTime() - start >= budget) { break; }
+		}
+
+		if (s_pendingNext >= s_pendingAssets.size())
+		{
+			s_pendingAssets.clear();
+			s_pendingNext = 0;
+		}
+	}
 		
 	// Returns true if it passes the filter.
 	bool editorFilter(const char* name)
@@ -1933,6 +2526,9 @@ namespace AssetBrowser
 
 		preprocessAssets();
 		s_viewAssetList.clear();
+		s_pendingAssets.clear();
+		s_pendingNext = 0;
+		s_archiveTimes.clear();
 		if (s_viewInfo.type == TYPE_TEXTURE)
 		{
 			const u32 count = (u32)s_projectAssetList[TYPE_TEXTURE].size();
@@ -1941,7 +2537,7 @@ namespace AssetBrowser
 			{
 				const char* name = projAsset->name.c_str();
 				if (!editorFilter(name) || !isLevelTexture(name)) { continue; }
-				loadAsset(projAsset);
+				s_pendingAssets.push_back(projAsset);
 			}
 		}
 		else if (s_viewInfo.type == TYPE_EXT_TEXTURE)
@@ -1952,7 +2548,7 @@ namespace AssetBrowser
 			{
 				const char* name = projAsset->name.c_str();
 				if (!editorFilter(name) || !isLevelTexture(name)) { continue; }
-				loadAsset(projAsset);
+				s_pendingAssets.push_back(projAsset);
 			}
 		}
 		else if (s_viewInfo.type == TYPE_FRAME)
@@ -1963,7 +2559,7 @@ namespace AssetBrowser
 			{
 				const char* name = projAsset->name.c_str();
 				if (!editorFilter(name) || !isLevelFrame(name)) { continue; }
-				loadAsset(projAsset);
+				s_pendingAssets.push_back(projAsset);
 			}
 		}
 		else if (s_viewInfo.type == TYPE_SPRITE)
@@ -1974,7 +2570,7 @@ namespace AssetBrowser
 			{
 				const char* name = projAsset->name.c_str();
 				if (!editorFilter(name) || !isLevelSprite(name)) { continue; }
-				loadAsset(projAsset);
+				s_pendingAssets.push_back(projAsset);
 			}
 		}
 		else if (s_viewInfo.type == TYPE_3DOBJ)
@@ -1985,7 +2581,7 @@ namespace AssetBrowser
 			{
 				const char* name = projAsset->name.c_str();
 				if (!editorFilter(name) || !isLevel3D(name)) { continue; }
-				loadAsset(projAsset);
+				s_pendingAssets.push_back(projAsset);
 			}
 		}
 		else if (s_viewInfo.type == TYPE_LEVEL)
@@ -2003,7 +2599,7 @@ namespace AssetBrowser
 					continue;
 				}
 
-				loadAsset(projAsset);
+				s_pendingAssets.push_back(projAsset);
 			}
 		}
 		else if (s_viewInfo.type == TYPE_PALETTE)
@@ -2065,7 +2661,7 @@ namespace AssetBrowser
 			{
 				const char* name = projAsset->name.c_str();
 				if (!editorFilter(name)) { continue; }
-				loadAsset(projAsset);
+				s_pendingAssets.push_back(projAsset);
 			}
 		}
 	}
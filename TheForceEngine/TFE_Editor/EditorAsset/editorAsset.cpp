@@ -93,6 +93,87 @@ namespace TFE_Editor
 		return handle;
 	}
 
+	AssetHandle getLoadedAssetData(const char* name)
+	{
+		return findAsset(name);
+	}
+
+	bool canDecodeAssetData(AssetType type)
+	{
+		return type == TYPE_TEXTURE || type == TYPE_PALETTE || type == TYPE_FRAME || type == TYPE_SPRITE;
+	}
+
+	bool decodeAssetData(AssetType type, const u8* data, size_t size, const AssetColorData* colorData, DecodedAsset* decoded)
+	{
+		decoded->type = type;
+		switch (type)
+		{
+			case TYPE_TEXTURE:
+			{
+				return decodeEditorTexture(data, size, colorData->palette, s_identityTable, &decoded->texture);
+			} break;
+			case TYPE_PALETTE:
+			{
+				return decodePaletteTexture(data, size, colorData->colormap, &decoded->texture);
+			} break;
+			case TYPE_FRAME:
+			{
+				return decodeEditorFrame(data, size, colorData->palette, s_identityTable, &decoded->frame);
+			} break;
+			case TYPE_SPRITE:
+			{
+				return decodeEditorSprite(data, size, colorData->palette, s_identityTable, &decoded->sprite);
+			} break;
+			default:
+			{
+				TFE_System::logWrite(LOG_WARNING, "Editor", "Asset data decoding not implemented, or bad type: %d", type);
+			}
+		}
+		return false;
+	}
+
+	AssetHandle uploadAssetData(const DecodedAsset* decoded, const AssetColorData* colorData, const char* name)
+	{
+		// The asset may have been loaded since it was decoded.
+		AssetHandle handle = findAsset(name);
+		if (handle != NULL_ASSET)
+		{
+			return handle;
+		}
+
+		s32 index = -1;
+		switch (decoded->type)
+		{
+			case TYPE_TEXTURE:
+			{
+				index = uploadEditorTexture(name, &decoded->texture, colorData->palIndex);
+			} break;
+			case TYPE_PALETTE:
+			{
+				index = uploadEditorTexture(name, &decoded->texture, 0);
+			} break;
+			case TYPE_FRAME:
+			{
+				index = uploadEditorFrame(name, &decoded->frame, colorData->palIndex);
+			} break;
+			case TYPE_SPRITE:
+			{
+				index = uploadEditorSprite(name, &decoded->sprite, colorData->palIndex);
+			} break;
+			default:
+			{
+				TFE_System::logWrite(LOG_WARNING, "Editor", "Asset data decoding not implemented, or bad type: %d", decoded->type);
+			}
+		}
+
+		if (index >= 0)
+		{
+			handle = buildHandle(decoded->type, index);
+			addAsset(handle, name);
+		}
+		return handle;
+	}
+
 	// Reload the full asset data.
 	void reloadAssetData(AssetHandle handle, Archive* archive, const AssetColorData* colorData)
 	{
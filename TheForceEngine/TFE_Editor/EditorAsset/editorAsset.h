@@ -84,12 +84,29 @@ namespace TFE_Editor
 		AssetHandle handle;
 	};
 	typedef std::vector<Asset> AssetList;
+
+	// Asset data decoded on a worker thread, the GPU textures are then created by uploadAssetData() on the main thread.
+	struct DecodedAsset
+	{
+		AssetType type = TYPE_NOT_SET;
+		DecodedTexture texture;		// TYPE_TEXTURE, TYPE_PALETTE
+		DecodedFrame frame;			// TYPE_FRAME
+		DecodedSprite sprite;		// TYPE_SPRITE
+	};
 		
 	AssetHandle loadAssetData(AssetType type, Archive* archive, const AssetColorData* colorData, const char* name);
 	AssetHandle loadAssetData(const Asset* asset);
 	void  reloadAssetData(AssetHandle handle, Archive* archive, const AssetColorData* colorData);
 	void  freeAssetData(AssetHandle handle);
 	void* getAssetData(AssetHandle handle);
+	// Returns the handle if the asset has already been loaded, otherwise NULL_ASSET.
+	AssetHandle getLoadedAssetData(const char* name);
+
+	// Split loading for asset types that support it: decodeAssetData() only reads the source data, so it can run on
+	// any thread - buildIdentityTable() must have been called first. uploadAssetData() must be called on the main thread.
+	bool canDecodeAssetData(AssetType type);
+	bool decodeAssetData(AssetType type, const u8* data, size_t size, const AssetColorData* colorData, DecodedAsset* decoded);
+	AssetHandle uploadAssetData(const DecodedAsset* decoded, const AssetColorData* colorData, const char* name);
 
 	void freeAllAssetData();
 	void freeAllThumbnails();
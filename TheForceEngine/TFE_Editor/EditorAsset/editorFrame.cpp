@@ -71,52 +71,72 @@ namespace TFE_Editor
 
 		if (type == FRAME_FME)
 		{
-			WaxFrame* frameData = TFE_Sprite_Jedi::loadFrameFromMemory(buffer.data(), len, false);
-			if (!frameData)
+			DecodedFrame decoded;
+			if (!decodeEditorFrame(buffer.data(), len, palette, s_remapTable, &decoded))
 			{
 				return -1;
 			}
+			id = uploadEditorFrame(filename, &decoded, palIndex, id);
+		}
+		return id;
+	}
+
+	// Only reads the source data, so it can be called from worker threads.
+	bool decodeEditorFrame(const u8* data, size_t size, const u32* palette, const u8* remapTable, DecodedFrame* decoded)
+	{
+		WaxFrame* frameData = TFE_Sprite_Jedi::loadFrameFromMemory(data, size, false);
+		if (!frameData)
+		{
+			return false;
+		}
 
-			const WaxCell* cell = WAX_CellPtr(frameData, frameData);
-			WorkBuffer& buffer = getWorkBuffer();
-			buffer.resize(cell->sizeX * cell->sizeY * 4);
-			u32* imageBuffer = (u32*)buffer.data();
+		const WaxCell* cell = WAX_CellPtr(frameData, frameData);
+		decoded->pixels.resize(cell->sizeX * cell->sizeY);
+		u32* imageBuffer = decoded->pixels.data();
 
-			u8* imageData = (u8*)cell + sizeof(WaxCell);
-			u8* image = (cell->compressed == 1) ? imageData + (cell->sizeX * sizeof(u32)) : imageData;
+		u8* imageData = (u8*)cell + sizeof(WaxCell);
+		u8* image = (cell->compressed == 1) ? imageData + (cell->sizeX * sizeof(u32)) : imageData;
 
-			u8 columnWorkBuffer[WAX_DECOMPRESS_SIZE];
-			const u32* columnOffset = (u32*)((u8*)frameData + cell->columnOffset);
+		u8 columnWorkBuffer[WAX_DECOMPRESS_SIZE];
+		const u32* columnOffset = (u32*)((u8*)frameData + cell->columnOffset);
 
-			for (s32 x = 0; x < cell->sizeX; x++)
+		for (s32 x = 0; x < cell->sizeX; x++)
+		{
+			u8* column = (u8*)image + columnOffset[x];
+			if (cell->compressed)
 			{
-				u8* column = (u8*)image + columnOffset[x];
-				if (cell->compressed)
-				{
-					const u8* colPtr = (u8*)cell + columnOffset[x];
-					sprite_decompressColumn(colPtr, columnWorkBuffer, cell->sizeY);
-					column = columnWorkBuffer;
-				}
-
-				for (s32 y = 0; y < cell->sizeY; y++)
-				{
-					imageBuffer[y*cell->sizeX + x] = column[y] ? palette[s_remapTable[column[y]]] : 0;
-				}
+				const u8* colPtr = (u8*)cell + columnOffset[x];
+				sprite_decompressColumn(colPtr, columnWorkBuffer, cell->sizeY);
+				column = columnWorkBuffer;
 			}
 
-			if (id < 0) { id = allocateFrame(filename); }
-			s_frameList[id].width = cell->sizeX;
-			s_frameList[id].height = cell->sizeY;
-			s_frameList[id].worldWidth = fixed16ToFloat(frameData->widthWS);
-			s_frameList[id].worldHeight = fixed16ToFloat(frameData->heightWS);
-			s_frameList[id].offsetX = (f32)frameData->offsetX;
-			s_frameList[id].offsetY = (f32)frameData->offsetY;
-			strcpy(s_frameList[id].name, filename);
-			s_frameList[id].paletteIndex = palIndex;
-			s_frameList[id].lightLevel = 32;
-			s_frameList[id].texGpu = TFE_RenderBackend::createTexture(cell->sizeX, cell->sizeY, imageBuffer);
-			free(frameData);
+			for (s32 y = 0; y < cell->sizeY; y++)
+			{
+				imageBuffer[y*cell->sizeX + x] = column[y] ? palette[remapTable[column[y]]] : 0;
+			}
 		}
+
+		EditorFrame* frame = &decoded->frame;
+		frame->width = cell->sizeX;
+		frame->height = cell->sizeY;
+		frame->worldWidth = fixed16ToFloat(frameData->widthWS);
+		frame->worldHeight = fixed16ToFloat(frameData->heightWS);
+		frame->offsetX = (f32)frameData->offsetX;
+		frame->offsetY = (f32)frameData->offsetY;
+		free(frameData);
+		return true;
+	}
+
+	// Creates the GPU texture, so this must be called from the main thread.
+	s32 uploadEditorFrame(const char* filename, const DecodedFrame* decoded, s32 palIndex, s32 id)
+	{
+		if (id < 0) { id = allocateFrame(filename); }
+		EditorFrame* frame = &s_frameList[id];
+		*frame = decoded->frame;
+		strcpy(frame->name, filename);
+		frame->paletteIndex = palIndex;
+		frame->lightLevel = 32;
+		frame->texGpu = TFE_RenderBackend::createTexture(frame->width, frame->height, decoded->pixels.data());
 		return id;
 	}
 
@@ -9,6 +9,7 @@
 #include <TFE_System/types.h>
 #include <TFE_Archive/archive.h>
 #include <TFE_RenderBackend/renderBackend.h>
+#include <vector>
 
 namespace TFE_Editor
 {
@@ -26,6 +27,12 @@ namespace TFE_Editor
 		u8   pad[2];
 		char name[64] = "";
 	};
+	// A frame decoded to 32-bit color, which can be done on worker threads.
+	struct DecodedFrame
+	{
+		EditorFrame frame;
+		std::vector<u32> pixels;
+	};
 	enum FrameSourceType
 	{
 		FRAME_FME,
@@ -38,4 +45,9 @@ namespace TFE_Editor
 	EditorFrame* getFrameData(u32 index);
 	s32 loadEditorFrame(FrameSourceType type, Archive* archive, const char* filename, const u32* palette, s32 palIndex, s32 id = -1);
 	bool loadEditorFrameLit(FrameSourceType type, Archive* archive, const u32* palette, s32 palIndex, const u8* colormap, s32 lightLevel, u32 index);
+
+	// Decode an FME frame from memory, this only reads the source data and can be called from any thread.
+	bool decodeEditorFrame(const u8* data, size_t size, const u32* palette, const u8* remapTable, DecodedFrame* decoded);
+	// Create the GPU texture for a decoded frame, on the main thread.
+	s32 uploadEditorFrame(const char* filename, const DecodedFrame* decoded, s32 palIndex, s32 id = -1);
 }
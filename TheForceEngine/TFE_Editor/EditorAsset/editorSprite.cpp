@@ -17,8 +17,6 @@ namespace TFE_Editor
 {
 	typedef std::vector<EditorSprite> SpriteList;
 	static SpriteList s_spriteList;
-	static std::map<WaxCell*, s32> s_waxDataMap;
-	static std::vector<WaxCell*> s_waxDataList;
 	
 	void freeSprite(const char* name)
 	{
@@ -53,10 +51,17 @@ namespace TFE_Editor
 		return index;
 	}
 
-	bool findWaxCellInMap(WaxCell* cell, s32& id)
+	// Unique cells of the sprite being decoded, local so sprites can be decoded on several threads.
+	struct WaxCellMap
 	{
-		std::map<WaxCell*, s32>::iterator iCell = s_waxDataMap.find(cell);
-		if (iCell != s_waxDataMap.end())
+		std::map<WaxCell*, s32> map;
+		std::vector<WaxCell*> list;
+	};
+
+	bool findWaxCellInMap(const WaxCellMap& cells, WaxCell* cell, s32& id)
+	{
+		std::map<WaxCell*, s32>::const_iterator iCell = cells.map.find(cell);
+		if (iCell != cells.map.end())
 		{
 			id = iCell->second;
 			return true;
@@ -64,13 +69,13 @@ namespace TFE_Editor
 		return false;
 	}
 
-	void insertWaxCellIntoMap(WaxCell* cell, s32 id)
+	void insertWaxCellIntoMap(WaxCellMap& cells, WaxCell* cell, s32 id)
 	{
-		s_waxDataMap[cell] = id;
-		s_waxDataList.push_back(cell);
+		cells.map[cell] = id;
+		cells.list.push_back(cell);
 	}
 
-	void writeCellToImage(s32 u, s32 v, s32 w, s32 h, s32 stride, const void* basePtr, const WaxCell* cell, const u32* palette, u32* imageBuffer)
+	void writeCellToImage(s32 u, s32 v, s32 w, s32 h, s32 stride, const void* basePtr, const WaxCell* cell, const u32* palette, const u8* remapTable, u32* imageBuffer)
 	{
 		u32* outImage = &imageBuffer[v * stride];
 
@@ -92,7 +97,7 @@ namespace TFE_Editor
 
 			for (s32 y = 0; y < cell->sizeY; y++)
 			{
-				outImage[y*stride + x + u] = column[y] ? palette[s_remapTable[column[y]]] : 0;
+				outImage[y*stride + x + u] = column[y] ? palette[remapTable[column[y]]] : 0;
 			}
 		}
 	}
@@ -119,132 +124,149 @@ namespace TFE_Editor
 
 		if (type == SPRITE_WAX)
 		{
-			JediWax* wax = TFE_Sprite_Jedi::loadWaxFromMemory(buffer.data(), len, false);
-			if (!wax) { return -1; }
-
-			// Allocate
-			if (id < 0) { id = allocateSprite(filename); }
-			EditorSprite* outSprite = &s_spriteList[id];
-			outSprite->anim.clear();
-			outSprite->frame.clear();
-			outSprite->cell.clear();
-			outSprite->texGpu = nullptr;
-
-			// First gather all of the cells.
-			s_waxDataMap.clear();
-			s_waxDataList.clear();
-
-			outSprite->rect[0] =  INT_MAX;
-			outSprite->rect[1] =  INT_MAX;
-			outSprite->rect[2] = -INT_MAX;
-			outSprite->rect[3] = -INT_MAX;
-
-			for (s32 animId = 0; animId < wax->animCount; animId++)
+			DecodedSprite decoded;
+			if (!decodeEditorSprite(buffer.data(), len, palette, s_remapTable, &decoded))
 			{
-				WaxAnim* anim = WAX_AnimPtr(wax, animId);
-				if (!anim) { continue; }
+				return -1;
+			}
+			id = uploadEditorSprite(filename, &decoded, palIndex, id);
+		}
+		return id;
+	}
+
+	// Only reads the source data, so it can be called from worker threads.
+	bool decodeEditorSprite(const u8* data, size_t size, const u32* palette, const u8* remapTable, DecodedSprite* decoded)
+	{
+		JediWax* wax = TFE_Sprite_Jedi::loadWaxFromMemory(data, size, false);
+		if (!wax) { return false; }
+
+		EditorSprite* outSprite = &decoded->sprite;
+		outSprite->anim.clear();
+		outSprite->frame.clear();
+		outSprite->cell.clear();
+		outSprite->texGpu = nullptr;
+
+		// First gather all of the cells.
+		WaxCellMap cells;
+
+		outSprite->rect[0] =  INT_MAX;
+		outSprite->rect[1] =  INT_MAX;
+		outSprite->rect[2] = -INT_MAX;
+		outSprite->rect[3] = -INT_MAX;
+
+		for (s32 animId = 0; animId < wax->animCount; animId++)
+		{
+			WaxAnim* anim = WAX_AnimPtr(wax, animId);
+			if (!anim) { continue; }
 								
-				SpriteAnim outAnim;
-				outAnim.frameRate   = anim->frameRate;
-				outAnim.frameCount  = anim->frameCount;
-				outAnim.worldWidth  = fixed16ToFloat(anim->worldWidth);
-				outAnim.worldHeight = fixed16ToFloat(anim->worldHeight);
-				for (s32 v = 0; v < WAX_MAX_VIEWS; v++)
+			SpriteAnim outAnim;
+			outAnim.frameRate   = anim->frameRate;
+			outAnim.frameCount  = anim->frameCount;
+			outAnim.worldWidth  = fixed16ToFloat(anim->worldWidth);
+			outAnim.worldHeight = fixed16ToFloat(anim->worldHeight);
+			for (s32 v = 0; v < WAX_MAX_VIEWS; v++)
+			{
+				WaxView* view = WAX_ViewPtr(wax, anim, v);
+				memset(outAnim.views[v].frameIndex, 0, sizeof(s32) * 32);
+				if (!view) { continue; }
+
+				for (s32 f = 0; f < anim->frameCount; f++)
 				{
-					WaxView* view = WAX_ViewPtr(wax, anim, v);
-					memset(outAnim.views[v].frameIndex, 0, sizeof(s32) * 32);
-					if (!view) { continue; }
+					outAnim.views[v].frameIndex[f] = (s32)outSprite->frame.size();
+
+					WaxFrame* frame = WAX_FramePtr(wax, view, f);
+					WaxCell* cell = frame ? WAX_CellPtr(wax, frame) : nullptr;
+
+					s32 id = -1;
+					if (cell && !findWaxCellInMap(cells, cell, id))
+					{
+						id = (s32)cells.list.size();
+						insertWaxCellIntoMap(cells, cell, id);
+					}
+					else if (!cell)
+					{
+						id = 0;
+					}
 
-					for (s32 f = 0; f < anim->frameCount; f++)
+					SpriteFrame outFrame = {};
+					outFrame.cellIndex = id;
+					outFrame.flip = frame ? frame->flip : 0;
+					outFrame.offsetX = frame ? frame->offsetX : 0;
+					outFrame.offsetY = frame ? frame->offsetY : 0;
+					outFrame.widthWS  = frame ? fixed16ToFloat(frame->widthWS) : 0;
+					outFrame.heightWS = frame ? fixed16ToFloat(frame->heightWS) : 0;
+					outSprite->frame.push_back(outFrame);
+
+					if (frame)
 					{
-						outAnim.views[v].frameIndex[f] = (s32)outSprite->frame.size();
-
-						WaxFrame* frame = WAX_FramePtr(wax, view, f);
-						WaxCell* cell = frame ? WAX_CellPtr(wax, frame) : nullptr;
-
-						s32 id = -1;
-						if (cell && !findWaxCellInMap(cell, id))
-						{
-							id = (s32)s_waxDataList.size();
-							insertWaxCellIntoMap(cell, id);
-						}
-						else if (!cell)
-						{
-							id = 0;
-						}
-
-						SpriteFrame outFrame = { 0 };
-						outFrame.cellIndex = id;
-						outFrame.flip = frame ? frame->flip : 0;
-						outFrame.offsetX = frame ? frame->offsetX : 0;
-						outFrame.offsetY = frame ? frame->offsetY : 0;
-						outFrame.widthWS  = frame ? fixed16ToFloat(frame->widthWS) : 0;
-						outFrame.heightWS = frame ? fixed16ToFloat(frame->heightWS) : 0;
-						outSprite->frame.push_back(outFrame);
-
-						if (frame)
-						{
-							outSprite->rect[0] = min(outSprite->rect[0], frame->offsetX);
-							outSprite->rect[1] = min(outSprite->rect[1], frame->offsetY);
-							outSprite->rect[2] = max(outSprite->rect[2], frame->offsetX + cell->sizeX);
-							outSprite->rect[3] = max(outSprite->rect[3], frame->offsetY + cell->sizeY);
-						}
+						outSprite->rect[0] = min(outSprite->rect[0], frame->offsetX);
+						outSprite->rect[1] = min(outSprite->rect[1], frame->offsetY);
+						outSprite->rect[2] = max(outSprite->rect[2], frame->offsetX + cell->sizeX);
+						outSprite->rect[3] = max(outSprite->rect[3], frame->offsetY + cell->sizeY);
 					}
 				}
-				outSprite->anim.push_back(outAnim);
 			}
+			outSprite->anim.push_back(outAnim);
+		}
 
-			// Now pack the cells into the texture...
-			const size_t cellCount = s_waxDataList.size();
-			WaxCell** waxCell = s_waxDataList.data();
-			s32 totalWidth = 0, maxHeight = 0;
-			for (size_t c = 0; c < cellCount; c++)
-			{
-				totalWidth += waxCell[c]->sizeX + 2;
-				maxHeight = max(maxHeight, waxCell[c]->sizeY + 2);
-			}
+		// Now pack the cells into the texture...
+		const size_t cellCount = cells.list.size();
+		WaxCell** waxCell = cells.list.data();
+		s32 totalWidth = 0, maxHeight = 0;
+		for (size_t c = 0; c < cellCount; c++)
+		{
+			totalWidth += waxCell[c]->sizeX + 2;
+			maxHeight = max(maxHeight, waxCell[c]->sizeY + 2);
+		}
 
-			// Super basic packing.
-			s32 rows = (totalWidth + 4095) / 4096;
-			s32 texW = totalWidth <= 4096 ? totalWidth : 4096;
-			s32 texH = min(8192, (rows + 1) * maxHeight);
+		// Super basic packing.
+		s32 rows = (totalWidth + 4095) / 4096;
+		s32 texW = totalWidth <= 4096 ? totalWidth : 4096;
+		s32 texH = min(8192, (rows + 1) * maxHeight);
 
-			// make sure the texture size is divisible by 4.
-			texW = ((texW + 3) >> 2) << 2;
-			texH = ((texH + 3) >> 2) << 2;
+		// make sure the texture size is divisible by 4.
+		texW = ((texW + 3) >> 2) << 2;
+		texH = ((texH + 3) >> 2) << 2;
 
-			WorkBuffer& buffer = getWorkBuffer();
-			buffer.resize(texW * texH * 4);
-			u32* imageBuffer = (u32*)buffer.data();
-			memset(imageBuffer, 0, texW * texH * 4);
+		decoded->width = texW;
+		decoded->height = texH;
+		decoded->pixels.assign(texW * texH, 0u);
+		u32* imageBuffer = decoded->pixels.data();
 
-			s32 u = 0, v = 0;
-			for (size_t c = 0; c < cellCount; c++)
+		s32 u = 0, v = 0;
+		for (size_t c = 0; c < cellCount; c++)
+		{
+			if (u + waxCell[c]->sizeX >= 4096)
 			{
-				if (u + waxCell[c]->sizeX >= 4096)
-				{
-					u = 0;
-					v += maxHeight;
-				}
-
-				SpriteCell outCell;
-				outCell.u = u;
-				outCell.v = v;
-				outCell.w = waxCell[c]->sizeX;
-				outCell.h = waxCell[c]->sizeY;
-				outSprite->cell.push_back(outCell);
-
-				writeCellToImage(u, v, waxCell[c]->sizeX, waxCell[c]->sizeY, texW, wax, waxCell[c], palette, imageBuffer);
-				u += waxCell[c]->sizeX + 2;
+				u = 0;
+				v += maxHeight;
 			}
 
-			outSprite->texGpu = TFE_RenderBackend::createTexture(texW, texH, imageBuffer);
-			outSprite->paletteIndex = palIndex;
-			outSprite->lightLevel = 32;
-			strcpy(outSprite->name, filename);
+			SpriteCell outCell;
+			outCell.u = u;
+			outCell.v = v;
+			outCell.w = waxCell[c]->sizeX;
+			outCell.h = waxCell[c]->sizeY;
+			outSprite->cell.push_back(outCell);
 
-			free(wax);
+			writeCellToImage(u, v, waxCell[c]->sizeX, waxCell[c]->sizeY, texW, wax, waxCell[c], palette, remapTable, imageBuffer);
+			u += waxCell[c]->sizeX + 2;
 		}
+
+		free(wax);
+		return true;
+	}
+
+	// Creates the GPU texture, so this must be called from the main thread.
+	s32 uploadEditorSprite(const char* filename, const DecodedSprite* decoded, s32 palIndex, s32 id)
+	{
+		if (id < 0) { id = allocateSprite(filename); }
+		EditorSprite* outSprite = &s_spriteList[id];
+		*outSprite = decoded->sprite;
+		outSprite->texGpu = TFE_RenderBackend::createTexture(decoded->width, decoded->height, decoded->pixels.data());
+		outSprite->paletteIndex = palIndex;
+		outSprite->lightLevel = 32;
+		strcpy(outSprite->name, filename);
 		return id;
 	}
 				
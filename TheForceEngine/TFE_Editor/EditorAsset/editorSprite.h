@@ -60,6 +60,14 @@ namespace TFE_Editor
 		u32  frameId = 0;
 		char name[64] = "";
 	};
+	// A sprite with its cells packed into a 32-bit color image, which can be done on worker threads.
+	struct DecodedSprite
+	{
+		EditorSprite sprite;
+		u32 width = 0;
+		u32 height = 0;
+		std::vector<u32> pixels;
+	};
 	enum SpriteSourceType
 	{
 		SPRITE_WAX,
@@ -72,4 +80,9 @@ namespace TFE_Editor
 	s32 loadEditorSprite(SpriteSourceType type, Archive* archive, const char* filename, const u32* palette, s32 palIndex, s32 id = -1);
 	bool loadEditorSpriteLit(SpriteSourceType type, Archive* archive, const u32* palette, s32 palIndex, const u8* colormap, s32 lightLevel, u32 index);
 	EditorSprite* getSpriteData(u32 index);
+
+	// Decode a WAX sprite from memory, this only reads the source data and can be called from any thread.
+	bool decodeEditorSprite(const u8* data, size_t size, const u32* palette, const u8* remapTable, DecodedSprite* decoded);
+	// Create the GPU texture for a decoded sprite, on the main thread.
+	s32 uploadEditorSprite(const char* filename, const DecodedSprite* decoded, s32 palIndex, s32 id = -1);
 }
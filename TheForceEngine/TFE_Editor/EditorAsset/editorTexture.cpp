@@ -73,13 +73,12 @@ namespace TFE_Editor
 		return -1;
 	}
 		
-	TextureGpu* loadBmFrame(u32 width, u32 height, const u8* image, const u32* palette)
+	void decodeBmFrame(u32 width, u32 height, const u8* image, const u32* palette, const u8* remapTable, DecodedImage* decoded)
 	{
-		buildIdentityTable();
-
-		WorkBuffer& buffer = getWorkBuffer();
-		buffer.resize(width * height * 4);
-		u32* imageBuffer = (u32*)buffer.data();
+		decoded->width = width;
+		decoded->height = height;
+		decoded->pixels.resize(width * height);
+		u32* imageBuffer = decoded->pixels.data();
 		const u8* srcImage = image;
 
 		for (u32 x = 0; x < width; x++, srcImage += height)
@@ -88,10 +87,9 @@ namespace TFE_Editor
 			for (u32 y = 0; y < height; y++)
 			{
 				u8 palIndex = column[y];
-				imageBuffer[y*width + x] = palette[s_remapTable[palIndex]];
+				imageBuffer[y*width + x] = palette[remapTable[palIndex]];
 			}
 		}
-		return TFE_RenderBackend::createTexture(width, height, imageBuffer);
 	}
 
 	TextureGpu* loadRawFrame(u32 width, u32 height, const u32* image)
@@ -135,70 +133,13 @@ namespace TFE_Editor
 
 		if (type == TEX_BM)
 		{
-			bool result = false;
-			TextureData* texData = bitmap_loadFromMemory(buffer.data(), len, 1);
-			if (texData)
+			buildIdentityTable();
+			DecodedTexture decoded;
+			if (!decodeEditorTexture(buffer.data(), len, palette, s_remapTable, &decoded))
 			{
-				// What about animated textures?
-				if (texData->uvWidth == BM_ANIMATED_TEXTURE)
-				{
-					u8 frameRate = texData->image[0];
-					u8 animatedId = texData->image[1];
-					u8 frameCount = (u8)texData->uvHeight;
-					if (animatedId != 2)
-					{
-						free(texData);
-						return -1;
-					}
-
-					if (id < 0) { id = allocateTexture(filename); }
-					s_textureList[id].frameCount = frameCount;
-
-					const u32* textureOffsets = (u32*)(texData->image + 2);
-					const u8* base = texData->image + 2;
-					s_textureList[id].frames.resize(frameCount);
-					for (s32 i = 0; i < frameCount; i++)
-					{
-						const TextureData* frame = (TextureData*)(base + textureOffsets[i]);
-						TextureData outFrame;
-
-						// Allocate an image buffer since everything no longer fits nicely.
-						u8* image = (u8*)frame + 0x1c;
-
-						// We have to make sure the structure offsets line up with DOS...
-						outFrame.flags = *((u8*)frame + 0x18);
-						outFrame.compressed = *((u8*)frame + 0x19);
-						outFrame.animIndex = 0;
-						outFrame.frameIdx = i;
-						outFrame.animPtr = nullptr;
-						outFrame.animSetup = 1;
-						outFrame.palIndex = 1;
-						outFrame.columns = nullptr;
-						s_textureList[id].frames[i] = loadBmFrame(frame->width, frame->height, image, palette);
-
-						if (i == 0)
-						{
-							s_textureList[id].width = frame->width;
-							s_textureList[id].height = frame->height;
-						}
-					}
-				}
-				else
-				{
-					if (id < 0) { id = allocateTexture(filename); }
-					s_textureList[id].width = texData->width;
-					s_textureList[id].height = texData->height;
-					s_textureList[id].frameCount = 1;
-
-					s_textureList[id].frames.resize(1);
-					s_textureList[id].frames[0] = loadBmFrame(texData->width, texData->height, texData->image, palette);
-				}
-				strcpy(s_textureList[id].name, filename);
-				s_textureList[id].paletteIndex = palIndex;
-				s_textureList[id].lightLevel = 32;
+				return -1;
 			}
-			if (texData) { free(texData->image); }
-			free(texData);
+			id = uploadEditorTexture(filename, &decoded, palIndex, id);
 		}
 		else if (type == TEX_RAW)
 		{
@@ -232,6 +173,113 @@ namespace TFE_Editor
 		return id;
 	}
 
+	// Only reads the source data, so it can be called from worker threads.
+	bool decodeEditorTexture(const u8* data, size_t size, const u32* palette, const u8* remapTable, DecodedTexture* decoded)
+	{
+		TextureData* texData = bitmap_loadFromMemory(data, size, 1);
+		if (!texData) { return false; }
+
+		bool result = true;
+		// What about animated textures?
+		if (texData->uvWidth == BM_ANIMATED_TEXTURE)
+		{
+			u8 animatedId = texData->image[1];
+			u8 frameCount = (u8)texData->uvHeight;
+			if (animatedId == 2)
+			{
+				const u32* textureOffsets = (u32*)(texData->image + 2);
+				const u8* base = texData->image + 2;
+				decoded->frames.resize(frameCount);
+				for (s32 i = 0; i < frameCount; i++)
+				{
+					const TextureData* frame = (TextureData*)(base + textureOffsets[i]);
+					// We have to make sure the structure offsets line up with DOS...
+					const u8* image = (u8*)frame + 0x1c;
+					decodeBmFrame(frame->width, frame->height, image, palette, remapTable, &decoded->frames[i]);
+				}
+			}
+			else
+			{
+				result = false;
+			}
+		}
+		else
+		{
+			decoded->frames.resize(1);
+			decodeBmFrame(texData->width, texData->height, texData->image, palette, remapTable, &decoded->frames[0]);
+		}
+		if (!decoded->frames.empty())
+		{
+			decoded->width = decoded->frames[0].width;
+			decoded->height = decoded->frames[0].height;
+		}
+
+		free(texData->image);
+		free(texData);
+		return result;
+	}
+
+	bool decodePaletteTexture(const u8* data, size_t size, const u8* colormapData, DecodedTexture* decoded)
+	{
+		if (size < 768) { return false; }
+		decoded->width = 16;
+		decoded->height = 16;
+		decoded->frames.resize(colormapData ? 2 : 1);
+
+		DecodedImage* image = &decoded->frames[0];
+		image->width = 16;
+		image->height = 16;
+		image->pixels.resize(16 * 16);
+		const u8* srcPal = data;
+		for (s32 i = 0; i < 256; i++, srcPal += 3)
+		{
+			s32 x = i & 15;
+			s32 y = 15 - (i >> 4);
+
+			image->pixels[(y << 4) + x] = 0xff000000 | CONV_6bitTo8bit(srcPal[0]) | (CONV_6bitTo8bit(srcPal[1]) << 8) | (CONV_6bitTo8bit(srcPal[2]) << 16);
+		}
+
+		// Create a second frame to hold the colormap data if it exists.
+		if (colormapData)
+		{
+			DecodedImage* colormap = &decoded->frames[1];
+			colormap->width = 256;
+			colormap->height = 32;
+			colormap->pixels.resize(256 * 32);
+			for (s32 y = 0; y < 32; y++)
+			{
+				const u8* ramp = &colormapData[y << 8];
+				for (s32 x = 0; x < 256; x++)
+				{
+					const u8* color = &data[ramp[x] * 3];
+					colormap->pixels[y * 256 + x] = 0xff000000 |
+						CONV_6bitTo8bit(color[0]) | (CONV_6bitTo8bit(color[1]) << 8) | (CONV_6bitTo8bit(color[2]) << 16);
+				}
+			}
+		}
+		return true;
+	}
+
+	// Creates the GPU textures, so this must be called from the main thread.
+	s32 uploadEditorTexture(const char* filename, const DecodedTexture* decoded, s32 palIndex, s32 id)
+	{
+		if (id < 0) { id = allocateTexture(filename); }
+		EditorTexture* texture = &s_textureList[id];
+		texture->width = decoded->width;
+		texture->height = decoded->height;
+		texture->frameCount = (u32)decoded->frames.size();
+		texture->frames.resize(texture->frameCount);
+		for (u32 f = 0; f < texture->frameCount; f++)
+		{
+			const DecodedImage* image = &decoded->frames[f];
+			texture->frames[f] = TFE_RenderBackend::createTexture(image->width, image->height, image->pixels.data());
+		}
+		strcpy(texture->name, filename);
+		texture->paletteIndex = palIndex;
+		texture->lightLevel = 32;
+		return id;
+	}
+
 	bool loadEditorTextureLit(SourceType type, Archive* archive, const u32* palette, s32 palIndex, const u8* colormap, s32 lightLevel, u32 index)
 	{
 		EditorTexture* texture = getTextureData(index);
@@ -270,45 +318,11 @@ namespace TFE_Editor
 		archive->readFile(buffer.data(), len);
 		archive->closeFile();
 
-		if (id < 0) { id = allocateTexture(filename); }
-		strcpy(s_textureList[id].name, filename);
-		s_textureList[id].width = 16;
-		s_textureList[id].height = 16;
-		s_textureList[id].frameCount = 1;
-		s_textureList[id].curFrame = 0;
-		s_textureList[id].lightLevel = 32;
-		s_textureList[id].paletteIndex = 0;
-
-		u32 image[16 * 16];
-		const u8* srcPal = buffer.data();
-		for (s32 i = 0; i < 256; i++, srcPal += 3)
-		{
-			s32 x = i & 15;
-			s32 y = 15 - (i >> 4);
-
-			image[(y << 4) + x] = 0xff000000 | CONV_6bitTo8bit(srcPal[0]) | (CONV_6bitTo8bit(srcPal[1]) << 8) | (CONV_6bitTo8bit(srcPal[2]) << 16);
-		}
-		s_textureList[id].frames.resize(colormapData ? 2 : 1);
-		s_textureList[id].frames[0] = TFE_RenderBackend::createTexture(16, 16, image);
-
-		// Create a second frame to hold the colormap data if it exists.
-		if (colormapData)
+		DecodedTexture decoded;
+		if (!decodePaletteTexture(buffer.data(), len, colormapData, &decoded))
 		{
-			s_textureList[id].frameCount = 2;
-			u32 colormapTrueColor[256 * 32];
-			srcPal = buffer.data();
-			for (s32 y = 0; y < 32; y++)
-			{
-				const u8* ramp = &colormapData[y << 8];
-				for (s32 x = 0; x < 256; x++)
-				{
-					const u8* color = &srcPal[ramp[x] * 3];
-					colormapTrueColor[y * 256 + x] = 0xff000000 |
-						CONV_6bitTo8bit(color[0]) | (CONV_6bitTo8bit(color[1]) << 8) | (CONV_6bitTo8bit(color[2]) << 16);
-				}
-			}
-			s_textureList[id].frames[1] = TFE_RenderBackend::createTexture(256, 32, colormapTrueColor);
+			return -1;
 		}
-		return id;
+		return uploadEditorTexture(filename, &decoded, 0, id);
 	}
 }
\ No newline at end of file
@@ -25,6 +25,19 @@ namespace TFE_Editor
 		u8   pad[2];
 		char name[64] = "";
 	};
+	struct DecodedImage
+	{
+		u32 width = 0;
+		u32 height = 0;
+		std::vector<u32> pixels;
+	};
+	// Texture frames decoded to 32-bit color, which can be done on worker threads.
+	struct DecodedTexture
+	{
+		u32 width = 0;
+		u32 height = 0;
+		std::vector<DecodedImage> frames;
+	};
 	enum SourceType
 	{
 		TEX_BM = 0,
@@ -40,4 +53,10 @@ namespace TFE_Editor
 	s32 loadPaletteAsTexture(Archive* archive, const char* filename, const u8* colormapData, s32 id = -1);
 	bool loadEditorTextureLit(SourceType type, Archive* archive, const u32* palette, s32 palIndex, const u8* colormap, s32 lightLevel, u32 index);
 	EditorTexture* getTextureData(u32 index);
+
+	// Decode a BM texture or a palette from memory, these only read the source data and can be called from any thread.
+	bool decodeEditorTexture(const u8* data, size_t size, const u32* palette, const u8* remapTable, DecodedTexture* decoded);
+	bool decodePaletteTexture(const u8* data, size_t size, const u8* colormapData, DecodedTexture* decoded);
+	// Create the GPU textures for decoded data, on the main thread.
+	s32 uploadEditorTexture(const char* filename, const DecodedTexture* decoded, s32 palIndex, s32 id = -1);
 }
@@ -4,7 +4,9 @@
 #include "grid3d.h"
 #include "gizmo.h"
 #include <TFE_System/math.h>
+#include <TFE_System/hash.h>
 #include <TFE_Editor/editor.h>
+#include <TFE_Editor/history.h>
 #include <TFE_Editor/editorMath.h>
 #include <TFE_Editor/editorConfig.h>
 #include <TFE_Editor/LevelEditor/editCommon.h>
@@ -29,6 +31,7 @@
 #include <TFE_RenderShared/triDraw3d.h>
 #include <TFE_RenderShared/modelDraw.h>
 #include <TFE_System/system.h>
+#include <TFE_Input/input.h>
 #include <TFE_RenderBackend/renderBackend.h>
 
 // Jedi GPU Renderer.
@@ -127,10 +130,26 @@ namespace LevelEditor
 		Vec3f dir[4] = { 0 };
 	};
 
+	// The camera independent 3D geometry of each sector is built once with triDraw3d and kept in GPU buffers between
+	// frames. Meshes are invalidated by edit and history events (see updateSectorMeshInvalidation()) rather than being
+	// validated against the level data each frame.
+	struct SectorMesh
+	{
+		TFE_RenderShared::Tri3dMesh* gpu = nullptr;
+		bool valid = false;
+		bool boundsValid = false;
+		Vec3f bounds[2];
+		// Hash of the sector data the mesh is built from, used to find the sectors a history change touched.
+		u64 contentKey = 0;
+	};
+
 	static RenderTargetHandle s_viewportRt = 0;
 	static std::vector<Vec2f> s_transformedVtx;
 	static std::vector<Vec2f> s_bufferVec2;
 	static std::vector<Vec3f> s_bufferVec3;
+	static std::vector<SectorMesh> s_sectorMesh;
+	static u64 s_sectorMeshFrameKey = 0;
+	static u32 s_sectorMeshHistoryChange = 0;
 
 	SectorDrawMode s_sectorDrawMode = SDM_WIREFRAME;
 	Vec2i s_viewportSize = { 0 };
@@ -180,6 +199,7 @@ namespace LevelEditor
 	void drawTransformGizmo();
 	bool computeSignCorners(const EditorSector* sector, const EditorWall* wall, Vec3f* corners);
 	void computeFlatUv(const Vec2f* pos, const Vec2f* offset, Vec2f* uv);
+	void resizeSectorMeshes(size_t count);
 
 	void viewport_init()
 	{
@@ -199,6 +219,7 @@ namespace LevelEditor
 		grid3d_destroy();
 		TFE_RenderShared::line3d_destroy();
 		s_viewportRt = 0;
+		resizeSectorMeshes(0);
 	}
 
 	void viewport_render(EditorView view, u32 flags)
@@ -2374,384 +2395,614 @@ namespace LevelEditor
 		return u32(colorSum.x * 255.0f) | (u32(colorSum.y * 255.0f) << 8) | (u32(colorSum.z * 255.0f) << 16) | (u32(alpha * 255.0f) << 24);
 	}
 
-	bool isCameraAboveFloor(EditorSector* sector)
+	// Global state that affects every sector mesh.
+	u64 getSectorMeshFrameKey()
 	{
-		const Vec3f& pos = s_camera.pos;
-		bool isAboveFloor = pos.y > sector->floorHeight;
-		if (sector->flags[0] & SEC_FLAGS1_SLOPEDFLOOR)
+		u64 key = TFE_Hash::fnv1a64Value(s_sectorDrawMode);
+		key = TFE_Hash::fnv1a64Value(u32(s_editFlags & LEF_FULLBRIGHT), key);
+		key = TFE_Hash::fnv1a64Value(u32(s_gridFlags & GFLAG_OVER), key);
+		key = TFE_Hash::fnv1a64Value(s_grid, key);
+
+		const u32 texCount = (u32)s_level.textures.size();
+		const LevelTextureAsset* tex = s_level.textures.data();
+		key = TFE_Hash::fnv1a64Value(texCount, key);
+		for (u32 t = 0; t < texCount; t++, tex++)
 		{
-			const Vec3f& pos   = s_camera.pos;
-			const Vec4f& plane = sector->floorPlane.plane;
-			const f32 dist = pos.x*plane.x + pos.y*plane.y + pos.z*plane.z + plane.w;
-			isAboveFloor = dist > 0.0f;
+			key = TFE_Hash::fnv1a64Value(tex->handle, key);
 		}
-		return isAboveFloor;
+
+		// Groups determine the locked state and group colors.
+		const u32 groupCount = (u32)s_groups.size();
+		const Group* group = s_groups.data();
+		key = TFE_Hash::fnv1a64Value(groupCount, key);
+		for (u32 g = 0; g < groupCount; g++, group++)
+		{
+			key = TFE_Hash::fnv1a64Value(group->flags, key);
+			key = TFE_Hash::fnv1a64Value(group->color, key);
+		}
+		return key;
 	}
 
-	bool isCameraBelowCeil(EditorSector* sector)
+	void resizeSectorMeshes(size_t count)
 	{
-		const Vec3f& pos = s_camera.pos;
-		bool isBelowCeil = pos.y < sector->ceilHeight;
-		if (sector->flags[0] & SEC_FLAGS1_SLOPEDCEILING)
+		for (size_t s = count; s < s_sectorMesh.size(); s++)
 		{
-			const Vec4f& plane = sector->ceilPlane.plane;
-			const f32 dist = pos.x*plane.x + pos.y*plane.y + pos.z*plane.z + plane.w;
-			isBelowCeil = dist < 0.0f;
+			TFE_RenderShared::triDraw3d_destroyMesh(s_sectorMesh[s].gpu);
 		}
-		return isBelowCeil;
+		s_sectorMesh.resize(count);
 	}
 
-	void renderLevel3D()
+	void viewport_invalidateSectorMeshes()
 	{
-		viewport_updateRail();
-
-		// Prepare for drawing.
-		TFE_RenderShared::lineDraw3d_begin(s_viewportSize.x, s_viewportSize.z);
-		TFE_RenderShared::triDraw3d_begin(&s_grid);
-		TFE_RenderShared::modelDraw_begin();
+		const size_t count = s_sectorMesh.size();
+		for (size_t s = 0; s < count; s++)
+		{
+			s_sectorMesh[s].valid = false;
+			s_sectorMesh[s].boundsValid = false;
+		}
+	}
 
-		if (!(s_gridFlags & GFLAG_OVER))
+	void viewport_invalidateSectorMesh(const EditorSector* sector)
+	{
+		const s32 meshCount = (s32)s_sectorMesh.size();
+		const s32 index = sector ? s32(sector - s_level.sectors.data()) : -1;
+		if (index < 0 || index >= meshCount) { return; }
+		s_sectorMesh[index].valid = false;
+		s_sectorMesh[index].boundsValid = false;
+
+		// Adjoined walls are built from the heights of the sector on the other side.
+		const s32 wallCount = (s32)sector->walls.size();
+		const EditorWall* wall = sector->walls.data();
+		for (s32 w = 0; w < wallCount; w++, wall++)
 		{
-			drawGrid3D(false);
+			if (wall->adjoinId < 0 || wall->adjoinId >= meshCount) { continue; }
+			s_sectorMesh[wall->adjoinId].valid = false;
+			s_sectorMesh[wall->adjoinId].boundsValid = false;
 		}
+	}
 
-		Vec3f cameraDirXZ = { s_camera.viewMtx.m2.x, 0.0f, s_camera.viewMtx.m2.z };
-		cameraDirXZ = TFE_Math::normalize(&cameraDirXZ);
-		Vec3f cameraRgtXZ = { -cameraDirXZ.z, 0.0f, cameraDirXZ.x };
+	// Edits in progress (dragging, transform tools) change the level every frame but only add a history
+	// command once they are finished, so the sectors they can touch are rebuilt every frame until then.
+	void invalidateEditedSectorMeshes()
+	{
+		const SelectionListId lists[] = { SEL_VERTEX, SEL_SURFACE, SEL_SECTOR };
+		const s32 listCount = (s32)TFE_ARRAYSIZE(lists);
+		for (s32 l = 0; l < listCount; l++)
+		{
+			FeatureId* list = nullptr;
+			const u32 count = selection_getList(list, lists[l]);
+			for (u32 i = 0; i < count; i++)
+			{
+				viewport_invalidateSectorMesh(unpackFeatureId(list[i]));
+			}
+		}
 
-		// Draw guidelines.
-		renderGuidelines3d();
+		EditorSector* hovered = nullptr;
+		s32 featureIndex;
+		if (selection_getVertex(SEL_INDEX_HOVERED, hovered, featureIndex)) { viewport_invalidateSectorMesh(hovered); }
+		if (selection_getSurface(SEL_INDEX_HOVERED, hovered, featureIndex)) { viewport_invalidateSectorMesh(hovered); }
+		if (selection_getSector(SEL_INDEX_HOVERED, hovered)) { viewport_invalidateSectorMesh(hovered); }
+	}
 
-		const EditorObject* visObj[1024];
-		const EditorSector* visObjSector[1024];
-		s32 visObjId[1024];
-		s32 visObjCount = 0;
+	// Hash the sector data that addSectorGeometry3D() reads, the polygon and slope planes are derived from it.
+	u64 getSectorMeshContentKey(const EditorSector* sector)
+	{
+		u64 key = TFE_Hash::fnv1a64Value(sector->id);
+		key = TFE_Hash::fnv1a64Value(sector->groupId, key);
+		key = TFE_Hash::fnv1a64Value(sector->layer, key);
+		key = TFE_Hash::fnv1a64Value(sector->floorTex, key);
+		key = TFE_Hash::fnv1a64Value(sector->ceilTex, key);
+		key = TFE_Hash::fnv1a64Value(sector->floorHeight, key);
+		key = TFE_Hash::fnv1a64Value(sector->ceilHeight, key);
+		key = TFE_Hash::fnv1a64Value(sector->secHeight, key);
+		key = TFE_Hash::fnv1a64Value(sector->ambient, key);
+		key = TFE_Hash::fnv1a64Value(sector->flags, key);
+		key = TFE_Hash::fnv1a64Value(sector->slope, key);
+		key = TFE_Hash::fnv1a64(sector->vtx.data(), sector->vtx.size() * sizeof(Vec2f), key);
+		key = TFE_Hash::fnv1a64(sector->walls.data(), sector->walls.size() * sizeof(EditorWall), key);
+		return key;
+	}
 
-		EditorSector* hoveredSector = nullptr;
-		EditorSector* curSector = nullptr;
-		s32 hoveredFeatureIndex = -1, curFeatureIndex = -1;
-		HitPart hoveredPart, curPart;
-		if (s_editMode == LEDIT_SECTOR)
+	// Called once per frame, this only looks at a few counters and the global draw state:
+	// - A history change (new command, undo/redo, history view) invalidates the sectors whose data changed, and their
+	//   adjoined sectors since adjoined walls use the heights on both sides.
+	// - Sector count, draw mode, grid, texture list and group changes invalidate every mesh.
+	// - Edits in progress invalidate the selected and hovered sectors.
+	void updateSectorMeshInvalidation()
+	{
+		const size_t count = s_level.sectors.size();
+		const u32 historyChange = history_getChangeCount();
+		const u64 frameKey = getSectorMeshFrameKey();
+		const bool countChanged = s_sectorMesh.size() != count;
+		if (countChanged || frameKey != s_sectorMeshFrameKey)
 		{
-			selection_getSector(SEL_INDEX_HOVERED, hoveredSector);
-			selection_getSector(0, curSector);
+			resizeSectorMeshes(count);
+			viewport_invalidateSectorMeshes();
+			s_sectorMeshFrameKey = frameKey;
 		}
-		else if (s_editMode == LEDIT_WALL)
+		if (countChanged || historyChange != s_sectorMeshHistoryChange)
 		{
-			selection_getSurface(SEL_INDEX_HOVERED, hoveredSector, hoveredFeatureIndex, &hoveredPart);
-			selection_getSurface(0, curSector, curFeatureIndex, &curPart);
+			const EditorSector* sector = s_level.sectors.data();
+			for (size_t s = 0; s < count; s++, sector++)
+			{
+				const u64 contentKey = getSectorMeshContentKey(sector);
+				if (contentKey == s_sectorMesh[s].contentKey) { continue; }
+
+				viewport_invalidateSectorMesh(sector);
+				s_sectorMesh[s].contentKey = contentKey;
+			}
+			s_sectorMeshHistoryChange = historyChange;
 		}
 
-		const f32 width = 2.5f;
-		const size_t count = s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (size_t s = 0; s < count; s++, sector++)
+		if (s_editMove || s_moveStarted || edit_isTransformToolActive() || TFE_Input::mouseDown(MBUTTON_LEFT))
 		{
-			// Skip other layers unless all layers is enabled.
-			if (!sector_onActiveLayer(sector)) { continue; }
-			if (sector_isHidden(sector)) { continue; }
+			invalidateEditedSectorMeshes();
+		}
+	}
 
-			// Add objects...
-			// TODO: Frustum and distance culling.
-			const s32 objCount = (s32)sector->obj.size();
-			const EditorObject* obj = sector->obj.data();
-			for (s32 o = 0; o < objCount && visObjCount < 1024; o++, obj++)
+	void computeSectorMeshBounds(EditorSector* sector, Vec3f* bounds)
+	{
+		bounds[0] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		bounds[1] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		// The wall lines are drawn at the floor and ceiling heights of both sides, so include them in the bounds.
+		// Sloped flats are planar, so their extents are at the wall vertices as well.
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		const s32 wallCount = (s32)sector->walls.size();
+		const EditorWall* wall = sector->walls.data();
+		for (s32 w = 0; w < wallCount; w++, wall++)
+		{
+			const EditorSector* next = (wall->adjoinId < 0 || wall->adjoinId >= sectorCount) ? nullptr : &s_level.sectors[wall->adjoinId];
+			const EditorSector* sides[] = { sector, next };
+			for (s32 i = 0; i < 2 && sides[i]; i++)
 			{
-				visObjSector[visObjCount] = sector;
-				visObjId[visObjCount] = o;
-				visObj[visObjCount++] = obj;
+				for (s32 v = 0; v < 2; v++)
+				{
+					const Vec2f& pos = sector->vtx[wall->idx[v]];
+					const f32 floorHeight = getFloorAtXZ(sides[i], pos);
+					const f32 ceilHeight = getCeilAtXZ(sides[i], pos);
+					bounds[0] = { std::min(bounds[0].x, pos.x), std::min(bounds[0].y, std::min(floorHeight, ceilHeight)), std::min(bounds[0].z, pos.z) };
+					bounds[1] = { std::max(bounds[1].x, pos.x), std::max(bounds[1].y, std::max(floorHeight, ceilHeight)), std::max(bounds[1].z, pos.z) };
+				}
 			}
+		}
+	}
 
-			Highlight highlight = sector_isLocked(sector) ? HL_LOCKED : HL_NONE;
+	// Submits the walls, floor and ceiling of the sector through the immediate triDraw3d functions.
+	// Nothing depends on the camera: backfacing walls and the far side of the floor and ceiling are removed
+	// by GPU backface culling, so the result can be captured into a retained mesh.
+	void addSectorGeometry3D(EditorSector* sector)
+	{
+		const bool textured = s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL;
+		const bool locked = sector_isLocked(sector);
+		const size_t count = s_level.sectors.size();
 
-			// Sector lighting.
-			const u32 colorIndex = (s_editFlags & LEF_FULLBRIGHT) && s_sectorDrawMode != SDM_LIGHTING ? 31 : sector->ambient;
+		// Sector lighting.
+		const u32 colorIndex = (s_editFlags & LEF_FULLBRIGHT) && s_sectorDrawMode != SDM_LIGHTING ? 31 : sector->ambient;
 
-			// Floor/ceiling line bias.
-			f32 bias = 1.0f / 1024.0f;
-			f32 floorBias = (s_camera.pos.y >= sector->floorHeight) ?  bias : -bias;
-			f32 ceilBias  = (s_camera.pos.y <= sector->ceilHeight)  ? -bias :  bias;
+		const s32 wallCount = (s32)sector->walls.size();
+		EditorWall* wall = sector->walls.data();
+		for (s32 w = 0; w < wallCount; w++, wall++)
+		{
+			const Vec2f& v0 = sector->vtx[wall->idx[0]];
+			const Vec2f& v1 = sector->vtx[wall->idx[1]];
 
-			// Draw lines.
-			const s32 wallCount = (s32)sector->walls.size();
-			const Vec2f* vtx = sector->vtx.data();
-			EditorWall* wall = sector->walls.data();
-			for (s32 w = 0; w < wallCount; w++, wall++)
+			s32 wallColorIndex = (s32)colorIndex;
+			if (wallColorIndex < 31)
 			{
-				// Skip hovered or selected walls.
-				bool skipLines = false;
-				if (s_editMode == LEDIT_WALL && ((hoveredSector == sector && hoveredFeatureIndex == w) ||
-					selection_action(SA_CHECK_INCLUSION, sector, w)))
-				{
-					skipLines = true;
-				}
+				wallColorIndex = std::max(0, std::min(31, wallColorIndex + wall->wallLight));
+			}
 
-				EditorSector* next = (wall->adjoinId < 0 || wall->adjoinId >= (s32)count) ? nullptr : &s_level.sectors[wall->adjoinId];
-				const Vec2f& v0 = sector->vtx[wall->idx[0]];
-				const Vec2f& v1 = sector->vtx[wall->idx[1]];
+			u32 wallColor = 0xff1a0f0d;
+			if (locked)
+			{
+				wallColor = textured ? SCOLOR_LOCKED_TEXTURE : SCOLOR_LOCKED;
+			}
+			else if (s_sectorDrawMode == SDM_GROUP_COLOR)
+			{
+				wallColor = sector_getGroupColor(sector);
+			}
+			else if (s_sectorDrawMode != SDM_WIREFRAME)
+			{
+				wallColor = c_sectorTexClr[wallColorIndex];
+			}
 
-				if (!skipLines)
-				{
-					drawWallLines3D(sector, next, wall, width, highlight, true);
-				}
+			// Wall Parts
+			const Vec2f wallOffset = { v1.x - v0.x, v1.z - v0.z };
+			const f32 wallLengthTexels = sqrtf(wallOffset.x*wallOffset.x + wallOffset.z*wallOffset.z) * 8.0f;
+			const f32 sectorHeight = sector->ceilHeight - sector->floorHeight;
+			const bool flipHorz = (wall->flags[0] & WF1_FLIP_HORIZ) != 0u;
+			Vec2f uvCorners[2];
 
-				s32 wallColorIndex = (s32)colorIndex;
-				if (wallColorIndex < 31)
+			if (wall->adjoinId < 0 || wall->adjoinId >= (s32)count)
+			{
+				Vec3f vtx[] =
 				{
-					wallColorIndex = std::max(0, std::min(31, wallColorIndex + wall->wallLight));
-				}
+					{ v0.x, getFloorAtXZ(sector, v0), v0.z },
+					{ v0.x, getCeilAtXZ(sector,  v0), v0.z },
+					{ v1.x, getCeilAtXZ(sector,  v1), v1.z },
+					{ v1.x, getFloorAtXZ(sector, v1), v1.z },
+				};
 
-				u32 wallColor = 0xff1a0f0d;
-				if (sector_isLocked(sector))
+				if (textured)
 				{
-					wallColor = (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL) ? SCOLOR_LOCKED_TEXTURE : SCOLOR_LOCKED;
+					Vec2f uvVtx[4];
+					f32 fh = sector->floorHeight;
+					const EditorTexture* tex = calculateTextureCoordsSlope(wall, &wall->tex[WP_MID], wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
+					triDraw3d_addDeformedQuadTextured(TRIMODE_OPAQUE, vtx, uvVtx, wallColor, tex ? tex->frames[0] : nullptr);
 				}
-				else if (s_sectorDrawMode == SDM_GROUP_COLOR)
+				else
 				{
-					wallColor = sector_getGroupColor(sector);
+					triDraw3d_addDeformedQuadColored(TRIMODE_OPAQUE, vtx, wallColor);
 				}
-				else if (s_sectorDrawMode != SDM_WIREFRAME)
+
+				// Sign?
+				if (wall->tex[WP_SIGN].texIndex >= 0 && textured)
 				{
-					wallColor = c_sectorTexClr[wallColorIndex];
+					const EditorTexture* tex = calculateSignTextureCoords(wall, &wall->tex[WP_MID], &wall->tex[WP_SIGN], wallLengthTexels, sectorHeight, false, uvCorners);
+					if (tex)
+					{
+						const Vec2f uvVtx[] = { {uvCorners[0].x, uvCorners[1].z}, {uvCorners[0].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[1].z} };
+						triDraw3d_addDeformedQuadTextured(TRIMODE_CLAMP, vtx, uvVtx, wallColor, tex->frames[0]);
+					}
 				}
-												
-				// Wall Parts
-				const Vec2f wallOffset = { v1.x - v0.x, v1.z - v0.z };
-				const f32 wallLengthTexels = sqrtf(wallOffset.x*wallOffset.x + wallOffset.z*wallOffset.z) * 8.0f;
-				const f32 sectorHeight = sector->ceilHeight - sector->floorHeight;
-				const bool flipHorz = (wall->flags[0] & WF1_FLIP_HORIZ) != 0u;
-				Vec2f uvCorners[2];
-
-				// Skip backfacing walls.
-				const Vec2f cameraOffset = { v0.x - s_camera.pos.x, v0.z - s_camera.pos.z };
-				const f32 facing = -wallOffset.z * cameraOffset.x + wallOffset.x * cameraOffset.z;
-				if (facing < 0.0f) { continue; }
-
-				if (wall->adjoinId < 0)
+			}
+			else
+			{
+				const u32 adjType = getAdjoinType(sector, wall);
+				EditorSector* next = &s_level.sectors[wall->adjoinId];
+				bool botSign = false;
+				// Bottom
+				if (adjType & ADJ_TYPE_BOT)
 				{
-					Vec3f corners[] = { {v0.x, sector->ceilHeight,  v0.z},
-										{v1.x, sector->floorHeight, v1.z} };
+					bool sky = (sector->flags[0] & SEC_FLAGS1_PIT) != 0 &&
+						       (next->flags[0] & SEC_FLAGS1_EXT_FLOOR_ADJ) != 0;
+
+					const f32 botHeight = next->floorHeight - sector->floorHeight;
 					Vec3f vtx[] =
 					{
 						{ v0.x, getFloorAtXZ(sector, v0), v0.z },
-						{ v0.x, getCeilAtXZ(sector,  v0), v0.z },
-						{ v1.x, getCeilAtXZ(sector,  v1), v1.z },
+						{ v0.x, getFloorAtXZ(next,   v0), v0.z },
+						{ v1.x, getFloorAtXZ(next,   v1), v1.z },
 						{ v1.x, getFloorAtXZ(sector, v1), v1.z },
 					};
 
-					if (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL)
+					if (textured)
 					{
+						LevelTexture* texPtr = sky ? &sector->floorTex : &wall->tex[WP_BOT];
+						if (texPtr->texIndex < 0) { texPtr->texIndex = getTextureIndex("DEFAULT.BM"); }
+
 						Vec2f uvVtx[4];
 						f32 fh = sector->floorHeight;
-						const EditorTexture* tex = calculateTextureCoordsSlope(wall, &wall->tex[WP_MID], wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
-						TFE_RenderShared::triDraw3d_addDeformedQuadTextured(TRIMODE_OPAQUE, vtx, uvVtx, wallColor, tex ? tex->frames[0] : nullptr);
+						const EditorTexture* tex = calculateTextureCoordsSlope(wall, texPtr, wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
+						triDraw3d_addDeformedQuadTextured(TRIMODE_OPAQUE, vtx, uvVtx, wallColor, tex ? tex->frames[0] : nullptr, sky);
 					}
 					else
 					{
-						TFE_RenderShared::triDraw3d_addDeformedQuadColored(TRIMODE_OPAQUE, vtx, wallColor);
+						triDraw3d_addDeformedQuadColored(TRIMODE_OPAQUE, vtx, wallColor);
 					}
 
 					// Sign?
-					if (wall->tex[WP_SIGN].texIndex >= 0 && (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL))
+					if (wall->tex[WP_SIGN].texIndex >= 0 && textured)
 					{
-						const EditorTexture* tex = calculateSignTextureCoords(wall, &wall->tex[WP_MID], &wall->tex[WP_SIGN], wallLengthTexels, sectorHeight, false, uvCorners);
+						const EditorTexture* tex = calculateSignTextureCoords(wall, &wall->tex[WP_BOT], &wall->tex[WP_SIGN], wallLengthTexels, botHeight, false, uvCorners);
 						if (tex)
 						{
 							const Vec2f uvVtx[] = { {uvCorners[0].x, uvCorners[1].z}, {uvCorners[0].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[1].z} };
-							TFE_RenderShared::triDraw3d_addDeformedQuadTextured(TRIMODE_CLAMP, vtx, uvVtx, wallColor, tex->frames[0]);
+							triDraw3d_addDeformedQuadTextured(TRIMODE_CLAMP, vtx, uvVtx, wallColor, tex->frames[0]);
+							botSign = true;
 						}
 					}
 				}
-				else
+				// Top
+				if (adjType & ADJ_TYPE_TOP)
 				{
-					const u32 adjType = getAdjoinType(sector, wall);
-					EditorSector* next = &s_level.sectors[wall->adjoinId];
-					bool botSign = false;
-					// Bottom
-					if (adjType & ADJ_TYPE_BOT)
-					{
-						bool sky = (sector->flags[0] & SEC_FLAGS1_PIT) != 0 &&
-							       (next->flags[0] & SEC_FLAGS1_EXT_FLOOR_ADJ) != 0;
+					bool sky = (sector->flags[0] & SEC_FLAGS1_EXTERIOR) != 0 &&
+						       (next->flags[0] & SEC_FLAGS1_EXT_ADJ) != 0;
 
-						const f32 botHeight = next->floorHeight - sector->floorHeight;
-						Vec3f corners[] = { {v0.x, next->floorHeight,   v0.z},
-											{v1.x, sector->floorHeight, v1.z} };
-						Vec3f vtx[] =
-						{
-							{ v0.x, getFloorAtXZ(sector, v0), v0.z },
-							{ v0.x, getFloorAtXZ(next,   v0), v0.z },
-							{ v1.x, getFloorAtXZ(next,   v1), v1.z },
-							{ v1.x, getFloorAtXZ(sector, v1), v1.z },
-						};
+					const f32 topHeight = sector->ceilHeight - next->ceilHeight;
+					Vec3f vtx[] =
+					{
+						{ v0.x, getCeilAtXZ(next,   v0), v0.z },
+						{ v0.x, getCeilAtXZ(sector, v0), v0.z },
+						{ v1.x, getCeilAtXZ(sector, v1), v1.z },
+						{ v1.x, getCeilAtXZ(next,   v1), v1.z },
+					};
 
-						if (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL)
-						{
-							LevelTexture* texPtr = sky ? &sector->floorTex : &wall->tex[WP_BOT];
-							if (texPtr->texIndex < 0) { texPtr->texIndex = getTextureIndex("DEFAULT.BM"); }
+					if (textured)
+					{
+						LevelTexture* texPtr = sky ? &sector->ceilTex : &wall->tex[WP_TOP];
+						if (texPtr->texIndex < 0) { texPtr->texIndex = getTextureIndex("DEFAULT.BM"); }
 
-							Vec2f uvVtx[4];
-							f32 fh = sector->floorHeight;
-							const EditorTexture* tex = calculateTextureCoordsSlope(wall, texPtr, wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
-							TFE_RenderShared::triDraw3d_addDeformedQuadTextured(TRIMODE_OPAQUE, vtx, uvVtx, wallColor, tex ? tex->frames[0] : nullptr, sky);
-						}
-						else
-						{
-							TFE_RenderShared::triDraw3d_addDeformedQuadColored(TRIMODE_OPAQUE, vtx, wallColor);
-						}
+						Vec2f uvVtx[4];
+						f32 fh = next->ceilHeight;
+						const EditorTexture* tex = calculateTextureCoordsSlope(wall, texPtr, wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
+						triDraw3d_addDeformedQuadTextured(TRIMODE_OPAQUE, vtx, uvVtx, wallColor, tex ? tex->frames[0] : nullptr, sky);
+					}
+					else
+					{
+						triDraw3d_addDeformedQuadColored(TRIMODE_OPAQUE, vtx, wallColor);
+					}
 
-						// Sign?
-						if (wall->tex[WP_SIGN].texIndex >= 0 && (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL))
+					// Sign?
+					if (!botSign && wall->tex[WP_SIGN].texIndex >= 0 && textured)
+					{
+						const EditorTexture* tex = calculateSignTextureCoords(wall, &wall->tex[WP_TOP], &wall->tex[WP_SIGN], wallLengthTexels, topHeight, false, uvCorners);
+						if (tex)
 						{
-							const EditorTexture* tex = calculateSignTextureCoords(wall, &wall->tex[WP_BOT], &wall->tex[WP_SIGN], wallLengthTexels, botHeight, false, uvCorners);
-							if (tex)
-							{
-								const Vec2f uvVtx[] = { {uvCorners[0].x, uvCorners[1].z}, {uvCorners[0].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[1].z} };
-								TFE_RenderShared::triDraw3d_addDeformedQuadTextured(TRIMODE_CLAMP, vtx, uvVtx, wallColor, tex->frames[0]);
-								botSign = true;
-							}
+							const Vec2f uvVtx[] = { {uvCorners[0].x, uvCorners[1].z}, {uvCorners[0].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[1].z} };
+							triDraw3d_addDeformedQuadTextured(TRIMODE_CLAMP, vtx, uvVtx, wallColor, tex->frames[0]);
 						}
 					}
-					// Top
-					if (adjType & ADJ_TYPE_TOP)
+				}
+				// Mid only for mask textures.
+				if ((wall->flags[0] & WF1_ADJ_MID_TEX) && textured)
+				{
+					Vec3f vtx[] =
 					{
-						bool sky = (sector->flags[0] & SEC_FLAGS1_EXTERIOR) != 0 &&
-							       (next->flags[0] & SEC_FLAGS1_EXT_ADJ) != 0;
+						{ v0.x, std::max(getFloorAtXZ(next, v0), getFloorAtXZ(sector, v0)), v0.z },
+						{ v0.x, std::min(getCeilAtXZ(next,  v0), getCeilAtXZ(sector,  v0)), v0.z },
+						{ v1.x, std::min(getCeilAtXZ(next,  v1), getCeilAtXZ(sector,  v1)), v1.z },
+						{ v1.x, std::max(getFloorAtXZ(next, v1), getFloorAtXZ(sector, v1)), v1.z },
+					};
+					Vec2f uvVtx[4];
+					f32 fh = max(next->floorHeight, sector->floorHeight);
+					const EditorTexture* tex = calculateTextureCoordsSlope(wall, &wall->tex[WP_MID], wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
+					if (tex) { triDraw3d_addDeformedQuadTextured(TRIMODE_BLEND, vtx, uvVtx, wallColor, tex->frames[0]); }
+				}
+			}
+		}
 
-						const f32 topHeight = sector->ceilHeight - next->ceilHeight;
-						Vec3f corners[] = { {v0.x, sector->ceilHeight, v0.z},
-										    {v1.x, next->ceilHeight,   v1.z} };
-						Vec3f vtx[] =
-						{
-							{ v0.x, getCeilAtXZ(next,   v0), v0.z },
-							{ v0.x, getCeilAtXZ(sector, v0), v0.z },
-							{ v1.x, getCeilAtXZ(sector, v1), v1.z },
-							{ v1.x, getCeilAtXZ(next,   v1), v1.z },
-						};
+		// Floor and ceiling.
+		u32 floorColor = 0xff402020;
+		if (locked)
+		{
+			floorColor = textured ? SCOLOR_LOCKED_TEXTURE : SCOLOR_LOCKED;
+		}
+		else if (s_sectorDrawMode == SDM_GROUP_COLOR)
+		{
+			floorColor = sector_getGroupColor(sector);
+		}
+		else if (textured || s_sectorDrawMode == SDM_LIGHTING)
+		{
+			floorColor = c_sectorTexClr[colorIndex];
+		}
 
-						if (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL)
-						{
-							LevelTexture* texPtr = sky ? &sector->ceilTex : &wall->tex[WP_TOP];
-							if (texPtr->texIndex < 0) { texPtr->texIndex = getTextureIndex("DEFAULT.BM"); }
+		const u32 idxCount = (u32)sector->poly.triIdx.size();
+		const u32 vtxCount = (u32)sector->poly.triVtx.size();
+		const s32* idx = sector->poly.triIdx.data();
+		const Vec2f* triVtx = sector->poly.triVtx.data();
 
-							Vec2f uvVtx[4];
-							f32 fh = next->ceilHeight;
-							const EditorTexture* tex = calculateTextureCoordsSlope(wall, texPtr, wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
-							TFE_RenderShared::triDraw3d_addDeformedQuadTextured(TRIMODE_OPAQUE, vtx, uvVtx, wallColor, tex ? tex->frames[0] : nullptr, sky);
-						}
-						else
-						{
-							TFE_RenderShared::triDraw3d_addDeformedQuadColored(TRIMODE_OPAQUE, vtx, wallColor);
-						}
+		s_bufferVec3.resize(vtxCount * 2);
+		Vec3f* vtxDataFlr = s_bufferVec3.data();
+		Vec3f* vtxDataCeil = vtxDataFlr + vtxCount;
+		for (u32 v = 0; v < vtxCount; v++)
+		{
+			vtxDataFlr[v] = { triVtx[v].x, getFloorAtXZ(sector, triVtx[v]), triVtx[v].z };
+			vtxDataCeil[v] = { triVtx[v].x, getCeilAtXZ(sector, triVtx[v]),  triVtx[v].z };
+		}
 
-						// Sign?
-						if (!botSign && wall->tex[WP_SIGN].texIndex >= 0 && (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL))
-						{
-							const EditorTexture* tex = calculateSignTextureCoords(wall, &wall->tex[WP_TOP], &wall->tex[WP_SIGN], wallLengthTexels, topHeight, false, uvCorners);
-							if (tex)
-							{
-								const Vec2f uvVtx[] = { {uvCorners[0].x, uvCorners[1].z}, {uvCorners[0].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[0].z}, {uvCorners[1].x, uvCorners[1].z} };
-								TFE_RenderShared::triDraw3d_addDeformedQuadTextured(TRIMODE_CLAMP, vtx, uvVtx, wallColor, tex->frames[0]);
-							}
-						}
-					}
-					// Mid only for mask textures.
-					if (next && (wall->flags[0] & WF1_ADJ_MID_TEX) && (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL))
-					{
-						Vec3f vtx[] =
-						{
-							{ v0.x, std::max(getFloorAtXZ(next, v0), getFloorAtXZ(sector, v0)), v0.z },
-							{ v0.x, std::min(getCeilAtXZ(next,  v0), getCeilAtXZ(sector,  v0)), v0.z },
-							{ v1.x, std::min(getCeilAtXZ(next,  v1), getCeilAtXZ(sector,  v1)), v1.z },
-							{ v1.x, std::max(getFloorAtXZ(next, v1), getFloorAtXZ(sector, v1)), v1.z },
-						};
-						Vec2f uvVtx[4];
-						f32 fh = max(next->floorHeight, sector->floorHeight);
-						const EditorTexture* tex = calculateTextureCoordsSlope(wall, &wall->tex[WP_MID], wallLengthTexels, fh, vtx[0].y, vtx[1].y, vtx[3].y, vtx[2].y, flipHorz, uvVtx);
-						if (tex) { TFE_RenderShared::triDraw3d_addDeformedQuadTextured(TRIMODE_BLEND, vtx, uvVtx, wallColor, tex->frames[0]); }
-					}
-				}
+		const bool showGridOnFlats = !(s_gridFlags & GFLAG_OVER);
+		if (textured)
+		{
+			s_bufferVec2.resize(vtxCount * 2);
+			Vec2f* uvFlr = s_bufferVec2.data();
+			Vec2f* uvCeil = uvFlr + vtxCount;
+			const Vec2f& floorOffset = sector->floorTex.offset;
+			const Vec2f& ceilOffset = sector->ceilTex.offset;
+			for (u32 v = 0; v < vtxCount; v++)
+			{
+				computeFlatUv(&triVtx[v], &floorOffset, &uvFlr[v]);
+				computeFlatUv(&triVtx[v], &ceilOffset, &uvCeil[v]);
 			}
 
-			// Draw the floor and ceiling.
-			u32 floorColor = 0xff402020;
-			if (sector_isLocked(sector))
+			EditorTexture* floorTex = getTexture(sector->floorTex.texIndex);
+			EditorTexture* ceilTex  = getTexture(sector->ceilTex.texIndex);
+			const bool floorSky = (sector->flags[0] & SEC_FLAGS1_PIT) != 0;
+			const bool ceilSky = (sector->flags[0] & SEC_FLAGS1_EXTERIOR) != 0;
+			triDraw3d_addTextured(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataFlr, uvFlr, idx, floorColor, false, floorTex ? floorTex->frames[0] : nullptr, showGridOnFlats, floorSky);
+			triDraw3d_addTextured(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataCeil, uvCeil, idx, floorColor, true, ceilTex ? ceilTex->frames[0] : nullptr, showGridOnFlats, ceilSky);
+		}
+		else
+		{
+			triDraw3d_addColored(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataFlr, idx, floorColor, false, showGridOnFlats);
+			triDraw3d_addColored(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataCeil, idx, floorColor, true, showGridOnFlats);
+		}
+	}
+
+	void buildSectorMesh(EditorSector* sector, SectorMesh* mesh)
+	{
+		if (!mesh->gpu)
+		{
+			mesh->gpu = triDraw3d_createMesh();
+		}
+		triDraw3d_beginMesh();
+		addSectorGeometry3D(sector);
+		triDraw3d_endMesh(mesh->gpu);
+		mesh->valid = true;
+	}
+
+	// Side planes of the view frustum, with positive distances outside. Returns the number of planes.
+	s32 computeViewFrustumPlanes(Vec4f* planes)
+	{
+		if (s_viewportSize.x <= 0 || s_viewportSize.z <= 0) { return 0; }
+
+		// Directions to the near-plane frustum corners.
+		const Vec3f d0 = edit_viewportCoordToWorldDir3d({ 0, 0 });
+		const Vec3f d1 = edit_viewportCoordToWorldDir3d({ s_viewportSize.x, 0 });
+		const Vec3f d2 = edit_viewportCoordToWorldDir3d({ s_viewportSize.x, s_viewportSize.z });
+		const Vec3f d3 = edit_viewportCoordToWorldDir3d({ 0, s_viewportSize.z });
+
+		Vec3f nrm[] =
+		{
+			TFE_Math::cross(&d3, &d0),
+			TFE_Math::cross(&d1, &d2),
+			TFE_Math::cross(&d0, &d1),
+			TFE_Math::cross(&d2, &d3),
+		};
+		for (s32 p = 0; p < 4; p++)
+		{
+			nrm[p] = TFE_Math::normalize(&nrm[p]);
+			planes[p] = { nrm[p].x, nrm[p].y, nrm[p].z, -TFE_Math::dot(&nrm[p], &s_camera.pos) };
+		}
+		return 4;
+	}
+
+	bool isSectorMeshVisible(const SectorMesh* mesh, const Vec4f* planes, s32 planeCount)
+	{
+		for (s32 p = 0; p < planeCount; p++)
+		{
+			// The box is outside if the corner furthest behind the plane is still in front of it.
+			const Vec3f corner =
 			{
-				floorColor = (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL) ? SCOLOR_LOCKED_TEXTURE : SCOLOR_LOCKED;
+				planes[p].x > 0.0f ? mesh->bounds[0].x : mesh->bounds[1].x,
+				planes[p].y > 0.0f ? mesh->bounds[0].y : mesh->bounds[1].y,
+				planes[p].z > 0.0f ? mesh->bounds[0].z : mesh->bounds[1].z,
+			};
+			if (planes[p].x*corner.x + planes[p].y*corner.y + planes[p].z*corner.z + planes[p].w > 0.0f)
+			{
+				return false;
 			}
-			else if (s_sectorDrawMode == SDM_GROUP_COLOR)
+		}
+		return true;
+	}
+
+	s32 viewport_verifySectorMeshCache()
+	{
+		// Apply pending invalidation first, only meshes that would be drawn as-is matter.
+		updateSectorMeshInvalidation();
+
+		// Generate each sector through the immediate triDraw3d path and compare it with the retained GPU mesh.
+		TFE_RenderShared::triDraw3d_begin(&s_grid);
+		const s32 count = (s32)s_sectorMesh.size();
+		s32 checkedCount = 0, mismatchCount = 0;
+		for (s32 s = 0; s < count; s++)
+		{
+			EditorSector* sector = &s_level.sectors[s];
+			const SectorMesh* mesh = &s_sectorMesh[s];
+			if (!mesh->valid || !mesh->gpu) { continue; }
+
+			triDraw3d_beginMesh();
+			addSectorGeometry3D(sector);
+			bool match = triDraw3d_endMeshCompare(mesh->gpu);
+
+			Vec3f bounds[2];
+			computeSectorMeshBounds(sector, bounds);
+			if (mesh->boundsValid && memcmp(bounds, mesh->bounds, sizeof(bounds)))
 			{
-				floorColor = sector_getGroupColor(sector);
+				match = false;
 			}
-			else if (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL || s_sectorDrawMode == SDM_LIGHTING)
+			if (!match)
 			{
-				floorColor = c_sectorTexClr[colorIndex];
+				TFE_System::logWrite(LOG_WARNING, "Viewport", "Cached 3D mesh for sector %d is out of date.", s);
+				mismatchCount++;
 			}
+			checkedCount++;
+		}
+		TFE_RenderShared::triDraw3d_begin(&s_grid);
 
-			const u32 idxCount = (u32)sector->poly.triIdx.size();
-			const u32 vtxCount = (u32)sector->poly.triVtx.size();
-			const Vec2f* triVtx = sector->poly.triVtx.data();
+		TFE_System::logWrite(LOG_MSG, "Viewport", "Verified %d cached sector meshes, %d out of date.", checkedCount, mismatchCount);
+		return mismatchCount;
+	}
 
-			s_bufferVec3.resize(vtxCount * 2);
-			Vec3f* vtxDataFlr = s_bufferVec3.data();
-			Vec3f* vtxDataCeil = vtxDataFlr + vtxCount;
+	void renderLevel3D()
+	{
+		viewport_updateRail();
 
-			s_bufferVec2.resize(vtxCount * 2);
-			Vec2f* uvFlr = s_bufferVec2.data();
-			Vec2f* uvCeil = uvFlr + vtxCount;
+		// Prepare for drawing.
+		TFE_RenderShared::lineDraw3d_begin(s_viewportSize.x, s_viewportSize.z);
+		TFE_RenderShared::triDraw3d_begin(&s_grid);
+		TFE_RenderShared::modelDraw_begin();
 
-			EditorTexture* floorTex = getTexture(sector->floorTex.texIndex);
-			EditorTexture* ceilTex  = getTexture(sector->ceilTex.texIndex);
-			const Vec2f& floorOffset = sector->floorTex.offset;
-			const Vec2f& ceilOffset = sector->ceilTex.offset;
+		if (!(s_gridFlags & GFLAG_OVER))
+		{
+			drawGrid3D(false);
+		}
 
-			for (u32 v = 0; v < vtxCount; v++)
+		Vec3f cameraDirXZ = { s_camera.viewMtx.m2.x, 0.0f, s_camera.viewMtx.m2.z };
+		cameraDirXZ = TFE_Math::normalize(&cameraDirXZ);
+		Vec3f cameraRgtXZ = { -cameraDirXZ.z, 0.0f, cameraDirXZ.x };
+
+		// Draw guidelines.
+		renderGuidelines3d();
+
+		const EditorObject* visObj[1024];
+		const EditorSector* visObjSector[1024];
+		s32 visObjId[1024];
+		s32 visObjCount = 0;
+
+		EditorSector* hoveredSector = nullptr;
+		EditorSector* curSector = nullptr;
+		s32 hoveredFeatureIndex = -1, curFeatureIndex = -1;
+		HitPart hoveredPart, curPart;
+		if (s_editMode == LEDIT_SECTOR)
+		{
+			selection_getSector(SEL_INDEX_HOVERED, hoveredSector);
+			selection_getSector(0, curSector);
+		}
+		else if (s_editMode == LEDIT_WALL)
+		{
+			selection_getSurface(SEL_INDEX_HOVERED, hoveredSector, hoveredFeatureIndex, &hoveredPart);
+			selection_getSurface(0, curSector, curFeatureIndex, &curPart);
+		}
+
+		// Keep one retained mesh per sector.
+		updateSectorMeshInvalidation();
+		Vec4f frustum[4];
+		const s32 frustumPlaneCount = computeViewFrustumPlanes(frustum);
+
+		const f32 width = 2.5f;
+		const size_t count = s_level.sectors.size();
+		EditorSector* sector = s_level.sectors.data();
+		for (size_t s = 0; s < count; s++, sector++)
+		{
+			// Skip other layers unless all layers is enabled.
+			if (!sector_onActiveLayer(sector)) { continue; }
+			if (sector_isHidden(sector)) { continue; }
+
+			// Add objects...
+			// TODO: Frustum and distance culling.
+			const s32 objCount = (s32)sector->obj.size();
+			const EditorObject* obj = sector->obj.data();
+			for (s32 o = 0; o < objCount && visObjCount < 1024; o++, obj++)
 			{
-				vtxDataFlr[v] = { triVtx[v].x, getFloorAtXZ(sector, triVtx[v]), triVtx[v].z };
-				vtxDataCeil[v] = { triVtx[v].x, getCeilAtXZ(sector, triVtx[v]),  triVtx[v].z };
+				visObjSector[visObjCount] = sector;
+				visObjId[visObjCount] = o;
+				visObj[visObjCount++] = obj;
 			}
-						
-			if (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL)
+
+			// Cull using the bounds, only visible sectors are (re)built.
+			SectorMesh* mesh = &s_sectorMesh[s];
+			if (!mesh->boundsValid)
 			{
-				for (u32 v = 0; v < vtxCount; v++)
-				{
-					computeFlatUv(&triVtx[v], &floorOffset, &uvFlr[v]);
-					computeFlatUv(&triVtx[v], &ceilOffset, &uvCeil[v]);
-				}
+				computeSectorMeshBounds(sector, mesh->bounds);
+				mesh->boundsValid = true;
 			}
-
-			bool showGridOnFlats = !(s_gridFlags & GFLAG_OVER);
-			if (isCameraAboveFloor(sector))
+			if (!isSectorMeshVisible(mesh, frustum, frustumPlaneCount)) { continue; }
+			if (!mesh->valid)
 			{
-				if (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL)
-				{
-					bool sky = (sector->flags[0] & SEC_FLAGS1_PIT) != 0;
-					triDraw3d_addTextured(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataFlr, uvFlr, sector->poly.triIdx.data(), floorColor, false, floorTex ? floorTex->frames[0] : nullptr, showGridOnFlats, sky);
-				}
-				else if (s_sectorDrawMode == SDM_LIGHTING)
-				{
-					triDraw3d_addColored(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataFlr, sector->poly.triIdx.data(), floorColor, false, showGridOnFlats);
-				}
-				else
-				{
-					triDraw3d_addColored(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataFlr, sector->poly.triIdx.data(), floorColor, false, showGridOnFlats);
-				}
+				buildSectorMesh(sector, mesh);
 			}
-			if (isCameraBelowCeil(sector))
+
+			Highlight highlight = sector_isLocked(sector) ? HL_LOCKED : HL_NONE;
+
+			// Draw lines, these depend on the hovered and selected walls so are not cached.
+			const s32 wallCount = (s32)sector->walls.size();
+			const EditorWall* wall = sector->walls.data();
+			for (s32 w = 0; w < wallCount; w++, wall++)
 			{
-				if (s_sectorDrawMode == SDM_TEXTURED_FLOOR || s_sectorDrawMode == SDM_TEXTURED_CEIL)
-				{
-					bool sky = (sector->flags[0] & SEC_FLAGS1_EXTERIOR) != 0;
-					triDraw3d_addTextured(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataCeil, uvCeil, sector->poly.triIdx.data(), floorColor, true, ceilTex ? ceilTex->frames[0]: nullptr, showGridOnFlats, sky);
-				}
-				else if (s_sectorDrawMode == SDM_LIGHTING)
-				{
-					triDraw3d_addColored(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataCeil, sector->poly.triIdx.data(), floorColor, true, showGridOnFlats);
-				}
-				else
+				// Skip hovered or selected walls.
+				if (s_editMode == LEDIT_WALL && ((hoveredSector == sector && hoveredFeatureIndex == w) ||
+					selection_action(SA_CHECK_INCLUSION, sector, w)))
 				{
-					triDraw3d_addColored(TRIMODE_OPAQUE, idxCount, vtxCount, vtxDataCeil, sector->poly.triIdx.data(), floorColor, true, showGridOnFlats);
+					continue;
 				}
+
+				EditorSector* next = (wall->adjoinId < 0 || wall->adjoinId >= (s32)count) ? nullptr : &s_level.sectors[wall->adjoinId];
+				drawWallLines3D(sector, next, wall, width, highlight, true);
 			}
+
+			triDraw3d_addMesh(mesh->gpu);
 		}
 
 		// Draw objects.
@@ -43,6 +43,14 @@ namespace LevelEditor
 	// Compute the bounding planes for an object based on the viewport and object transform.
 	void viewport_computeEntityBoundingPlanes(const EditorSector* sector, const EditorObject* obj, Vec4f* boundingPlanes);
 
+	// Retained 3D sector meshes, rebuilt the next time they are visible after being invalidated.
+	// History changes are picked up automatically, these are for changes made outside of the history.
+	void viewport_invalidateSectorMesh(const EditorSector* sector);
+	void viewport_invalidateSectorMeshes();
+	// Compare the retained 3D sector meshes with the geometry generated by the immediate triDraw3d path,
+	// returns the number of out of date sectors.
+	s32 viewport_verifySectorMeshCache();
+
 	extern SectorDrawMode s_sectorDrawMode;
 	extern Vec2i s_viewportSize;
 	extern Vec3f s_viewportPos;
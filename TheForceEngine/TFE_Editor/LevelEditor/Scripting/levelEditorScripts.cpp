@@ -86,7 +86,7 @@ namespace LevelEditor
 		strcat(s_scriptBuffer, line);
 		strcat(s_scriptBuffer, ";}\n");
 
-		TFE_ForceScript::ModuleHandle lineMod = TFE_ForceScript::createModule("LineMod", "LineMod", s_scriptBuffer, API_SHARED | API_LEVEL_EDITOR);
+		TFE_ForceScript::ModuleHandle lineMod = TFE_ForceScript::createModule("LineMod", "LineMod", s_scriptBuffer, API_SHARED | API_LEVEL_EDITOR, false);
 		if (lineMod)
 		{
 			TFE_ForceScript::FunctionHandle func = TFE_ForceScript::findScriptFuncByName(lineMod, "main");
@@ -2,6 +2,10 @@
 #include <TFE_System/system.h>
 #include <TFE_Editor/LevelEditor/infoPanel.h>
 #include <TFE_Editor/LevelEditor/sharedState.h>
+#include <TFE_Editor/LevelEditor/editGeometry.h>
+#include <TFE_Editor/LevelEditor/selection.h>
+#include <TFE_Editor/LevelEditor/sectorBvh.h>
+#include <TFE_Editor/LevelEditor/Rendering/viewport.h>
 #include <TFE_Jedi/Level/rwall.h>
 #include <TFE_Jedi/Level/rsector.h>
 #include <angelscript.h>
@@ -42,6 +46,49 @@ namespace LevelEditor
 		}
 	}
 
+	void LS_Level::benchmarkPicking(s32 gridSize)
+	{
+		level_benchmarkPicking(gridSize);
+	}
+
+	void LS_Level::benchmarkShapeInsert(s32 shapeCount)
+	{
+		edit_benchmarkShapeInsert(shapeCount);
+	}
+
+	void LS_Level::benchmarkBoxSelect()
+	{
+		selection_benchmarkBoxSelect();
+	}
+
+	s32 LS_Level::verifySectorMeshCache()
+	{
+		const s32 mismatchCount = viewport_verifySectorMeshCache();
+		if (mismatchCount)
+		{
+			infoPanelAddMsg(LE_MSG_WARNING, "%d cached sector meshes are out of date, see the log.", mismatchCount);
+		}
+		else
+		{
+			infoPanelAddMsg(LE_MSG_INFO, "Cached sector meshes match the level data.");
+		}
+		return mismatchCount;
+	}
+
+	s32 LS_Level::verifySectorBvh()
+	{
+		const s32 mismatchCount = sectorBvh_verify();
+		if (mismatchCount)
+		{
+			infoPanelAddMsg(LE_MSG_WARNING, "Sector BVH: %d overlap queries differ from the brute force result, see the log.", mismatchCount);
+		}
+		else
+		{
+			infoPanelAddMsg(LE_MSG_INFO, "Sector BVH matches the brute force result for all %d sectors.", (s32)s_level.sectors.size());
+		}
+		return mismatchCount;
+	}
+
 	bool LS_Level::scriptRegister(ScriptAPI api)
 	{
 		ScriptClassBegin("Level", "level", api);
@@ -103,6 +150,11 @@ namespace LevelEditor
 			// Functions
 			ScriptObjMethod("void findSector(const string &in)", findSector);
 			ScriptObjMethod("void findSectorById(int)", findSectorById);
+			ScriptObjMethod("void benchmarkPicking(int)", benchmarkPicking);
+			ScriptObjMethod("void benchmarkShapeInsert(int)", benchmarkShapeInsert);
+			ScriptObjMethod("void benchmarkBoxSelect()", benchmarkBoxSelect);
+			ScriptObjMethod("int verifySectorMeshCache()", verifySectorMeshCache);
+			ScriptObjMethod("int verifySectorBvh()", verifySectorBvh);
 			// -- Getters --
 			ScriptLambdaPropertyGet("string get_name()", std::string, { return s_level.name; });
 			ScriptLambdaPropertyGet("string get_slot()", std::string, { return s_level.slot; });
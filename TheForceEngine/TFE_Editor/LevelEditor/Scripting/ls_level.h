@@ -18,6 +18,11 @@ namespace LevelEditor
 	public:
 		void findSector(std::string& name);
 		void findSectorById(s32 id);
+		void benchmarkPicking(s32 gridSize);
+		void benchmarkShapeInsert(s32 shapeCount);
+		void benchmarkBoxSelect();
+		s32 verifySectorMeshCache();
+		s32 verifySectorBvh();
 		// System
 		bool scriptRegister(ScriptAPI api) override;
 
@@ -0,0 +1,38 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Editor
+// A system built to view and edit Dark Forces data files.
+// The viewing aspect needs to be put in place at the beginning
+// in order to properly test elements in isolation without having
+// to "play" the game as intended.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_System/system.h>
+
+namespace LevelEditor
+{
+	// Run a benchmark pass twice, first with the optimization flag cleared (the baseline) and then with it set.
+	// Only runPass(pass) is timed; finishPass(pass) can gather results and restore the level before the next pass.
+	// The flag is left set afterward.
+	template<typename RunPass, typename FinishPass>
+	void benchmark_flagPasses(bool* flag, f64* time, RunPass runPass, FinishPass finishPass)
+	{
+		for (s32 pass = 0; pass < 2; pass++)
+		{
+			*flag = pass != 0;
+
+			const u64 start = TFE_System::getCurrentTimeInTicks();
+			runPass(pass);
+			time[pass] = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+
+			finishPass(pass);
+		}
+		*flag = true;
+	}
+
+	template<typename RunPass>
+	void benchmark_flagPasses(bool* flag, f64* time, RunPass runPass)
+	{
+		benchmark_flagPasses(flag, time, runPass, [](s32) {});
+	}
+}
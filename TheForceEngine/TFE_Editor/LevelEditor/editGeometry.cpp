@@ -8,6 +8,9 @@
 #include "sharedState.h"
 #include "selection.h"
 #include "guidelines.h"
+#include "sectorBvh.h"
+#include "benchmark.h"
+#include <TFE_System/system.h>
 #include <TFE_System/math.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Editor/errorMessages.h>
@@ -21,6 +24,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 using namespace TFE_Editor;
 using namespace TFE_Jedi;
@@ -829,13 +833,165 @@ namespace LevelEditor
 		return !candidates->empty();
 	}
 
-	void fixupSectorAdjoins(std::vector<s32>& adjoinSectorsToFix)
+	/////////////////////////////////////////////////////
+	// Wall edge hash
+	/////////////////////////////////////////////////////
+	// Uniform grid of wall edges, used to find adjoin candidates without testing every pair of walls.
+	// Walls are referenced by their index in the sector list being processed.
+	struct WallRef
 	{
-		if (adjoinSectorsToFix.empty())
+		s32 listIndex;
+		s32 wallIndex;
+	};
+
+	struct WallEdgeHash
+	{
+		f32 scale = 1.0f;	// 1 / cell size
+		std::unordered_map<u64, std::vector<WallRef>> cells;
+		// Cells and wall count of each sector in the list, so changed sectors can be rehashed.
+		std::vector<std::vector<u64>> listCells;
+		std::vector<s32> listWallCount;
+	};
+
+	// Walls are expanded by this margin when hashed, it must be larger than the vtxEqual() tolerance.
+	const f32 c_edgeHashMargin = 0.01f;
+	static bool s_edgeHashEnabled = true;
+	static std::vector<WallRef> s_edgeCandidates;
+
+	bool sortWallRef(const WallRef& a, const WallRef& b)
+	{
+		return a.listIndex < b.listIndex || (a.listIndex == b.listIndex && a.wallIndex < b.wallIndex);
+	}
+
+	bool wallRefEqual(const WallRef& a, const WallRef& b)
+	{
+		return a.listIndex == b.listIndex && a.wallIndex == b.wallIndex;
+	}
+
+	u64 edgeHash_getKey(s32 x, s32 z)
+	{
+		return u64(u32(x)) | (u64(u32(z)) << 32ull);
+	}
+
+	void edgeHash_getCellRange(const WallEdgeHash* hash, const Vec2f& v0, const Vec2f& v1, s32* range)
+	{
+		range[0] = (s32)floorf((min(v0.x, v1.x) - c_edgeHashMargin) * hash->scale);
+		range[1] = (s32)floorf((min(v0.z, v1.z) - c_edgeHashMargin) * hash->scale);
+		range[2] = (s32)floorf((max(v0.x, v1.x) + c_edgeHashMargin) * hash->scale);
+		range[3] = (s32)floorf((max(v0.z, v1.z) + c_edgeHashMargin) * hash->scale);
+	}
+
+	void edgeHash_addSector(WallEdgeHash* hash, s32 listIndex, const EditorSector* sector)
+	{
+		std::vector<u64>& listCells = hash->listCells[listIndex];
+		const s32 wallCount = (s32)sector->walls.size();
+		const EditorWall* wall = sector->walls.data();
+		const Vec2f* vtx = sector->vtx.data();
+		for (s32 w = 0; w < wallCount; w++, wall++)
 		{
-			return;
+			s32 range[4];
+			edgeHash_getCellRange(hash, vtx[wall->idx[0]], vtx[wall->idx[1]], range);
+			for (s32 z = range[1]; z <= range[3]; z++)
+			{
+				for (s32 x = range[0]; x <= range[2]; x++)
+				{
+					const u64 key = edgeHash_getKey(x, z);
+					hash->cells[key].push_back({ listIndex, w });
+					listCells.push_back(key);
+				}
+			}
+		}
+		hash->listWallCount[listIndex] = wallCount;
+	}
+
+	void edgeHash_removeSector(WallEdgeHash* hash, s32 listIndex)
+	{
+		std::vector<u64>& listCells = hash->listCells[listIndex];
+		std::sort(listCells.begin(), listCells.end());
+		listCells.erase(std::unique(listCells.begin(), listCells.end()), listCells.end());
+
+		const s32 cellCount = (s32)listCells.size();
+		for (s32 c = 0; c < cellCount; c++)
+		{
+			std::unordered_map<u64, std::vector<WallRef>>::iterator iCell = hash->cells.find(listCells[c]);
+			if (iCell == hash->cells.end()) { continue; }
+
+			std::vector<WallRef>& refs = iCell->second;
+			refs.erase(std::remove_if(refs.begin(), refs.end(), [listIndex](const WallRef& ref) { return ref.listIndex == listIndex; }), refs.end());
+		}
+		listCells.clear();
+	}
+
+	void edgeHash_build(WallEdgeHash* hash, const std::vector<EditorSector*>& list)
+	{
+		const s32 listCount = (s32)list.size();
+		EditorSector* const* sectorList = list.data();
+
+		// Size the cells to the average wall length, so most walls only touch a few cells.
+		f32 totalLength = 0.0f;
+		s32 totalWalls = 0;
+		for (s32 s = 0; s < listCount; s++)
+		{
+			const EditorSector* sector = sectorList[s];
+			const s32 wallCount = (s32)sector->walls.size();
+			const EditorWall* wall = sector->walls.data();
+			for (s32 w = 0; w < wallCount; w++, wall++)
+			{
+				const Vec2f* v0 = &sector->vtx[wall->idx[0]];
+				const Vec2f* v1 = &sector->vtx[wall->idx[1]];
+				const Vec2f delta = { v1->x - v0->x, v1->z - v0->z };
+				totalLength += sqrtf(delta.x*delta.x + delta.z*delta.z);
+			}
+			totalWalls += wallCount;
+		}
+		const f32 cellSize = totalWalls ? max(4.0f, min(256.0f, totalLength / f32(totalWalls))) : 16.0f;
+		hash->scale = 1.0f / cellSize;
+
+		hash->cells.clear();
+		hash->listCells.clear();
+		hash->listCells.resize(listCount);
+		hash->listWallCount.resize(listCount);
+		for (s32 s = 0; s < listCount; s++)
+		{
+			edgeHash_addSector(hash, s, sectorList[s]);
+		}
+	}
+
+	// Walls are only added by splits, so a sector whose wall count changed has to be rehashed.
+	void edgeHash_updateChanged(WallEdgeHash* hash, const std::vector<EditorSector*>& list)
+	{
+		const s32 listCount = (s32)list.size();
+		EditorSector* const* sectorList = list.data();
+		for (s32 s = 0; s < listCount; s++)
+		{
+			if ((s32)sectorList[s]->walls.size() == hash->listWallCount[s]) { continue; }
+			edgeHash_removeSector(hash, s);
+			edgeHash_addSector(hash, s, sectorList[s]);
+		}
+	}
+
+	// Get the walls that may touch the edge v0 -> v1, sorted by list and wall index to match the order of a linear search.
+	void edgeHash_getCandidates(const WallEdgeHash* hash, const Vec2f& v0, const Vec2f& v1, std::vector<WallRef>& result)
+	{
+		result.clear();
+		s32 range[4];
+		edgeHash_getCellRange(hash, v0, v1, range);
+		for (s32 z = range[1]; z <= range[3]; z++)
+		{
+			for (s32 x = range[0]; x <= range[2]; x++)
+			{
+				std::unordered_map<u64, std::vector<WallRef>>::const_iterator iCell = hash->cells.find(edgeHash_getKey(x, z));
+				if (iCell == hash->cells.end()) { continue; }
+				result.insert(result.end(), iCell->second.begin(), iCell->second.end());
+			}
 		}
+		std::sort(result.begin(), result.end(), sortWallRef);
+		result.erase(std::unique(result.begin(), result.end(), wallRefEqual), result.end());
+	}
 
+	// The linear search, every wall of every other sector in the list is tested.
+	void fixupSectorAdjoins_linear(std::vector<s32>& adjoinSectorsToFix)
+	{
 		// Fix-up adjoins.
 		const s32 adjoinListCount = (s32)adjoinSectorsToFix.size();
 		const s32* adjoinListId = adjoinSectorsToFix.data();
@@ -881,6 +1037,78 @@ namespace LevelEditor
 		}
 	}
 
+	void fixupSectorAdjoins(std::vector<s32>& adjoinSectorsToFix)
+	{
+		if (adjoinSectorsToFix.empty())
+		{
+			return;
+		}
+		if (!s_edgeHashEnabled)
+		{
+			fixupSectorAdjoins_linear(adjoinSectorsToFix);
+			return;
+		}
+
+		const s32 adjoinListCount = (s32)adjoinSectorsToFix.size();
+		const s32* adjoinListId = adjoinSectorsToFix.data();
+		std::vector<EditorSector*> adjoinList(adjoinListCount);
+		for (s32 i = 0; i < adjoinListCount; i++)
+		{
+			adjoinList[i] = &s_level.sectors[adjoinListId[i]];
+		}
+
+		WallEdgeHash hash;
+		edgeHash_build(&hash, adjoinList);
+
+		// Fix-up adjoins.
+		for (s32 i = 0; i < adjoinListCount; i++)
+		{
+			EditorSector* src = adjoinList[i];
+			const s32 wallCountSrc = (s32)src->walls.size();
+			const Vec2f* vtxSrc = src->vtx.data();
+			EditorWall* wallSrc = src->walls.data();
+			for (s32 w0 = 0; w0 < wallCountSrc; w0++, wallSrc++)
+			{
+				if (wallSrc->adjoinId >= 0) { continue; }
+				const Vec2f v0 = vtxSrc[wallSrc->idx[0]];
+				const Vec2f v1 = vtxSrc[wallSrc->idx[1]];
+
+				// A matching wall must end at v0.
+				edgeHash_getCandidates(&hash, v0, v0, s_edgeCandidates);
+				const s32 candidateCount = (s32)s_edgeCandidates.size();
+				const WallRef* candidate = s_edgeCandidates.data();
+				s32 matchedIndex = -1;
+				for (s32 c = 0; c < candidateCount; c++)
+				{
+					// Only the first match in each sector is used.
+					const s32 j = candidate[c].listIndex;
+					if (i == j || j == matchedIndex) { continue; }
+
+					EditorSector* dst = adjoinList[j];
+					const s32 w1 = candidate[c].wallIndex;
+					EditorWall* wallDst = &dst->walls[w1];
+					if (wallDst->adjoinId >= 0) { continue; }
+
+					Vec2f* vtxDst = dst->vtx.data();
+					const Vec2f v2 = vtxDst[wallDst->idx[0]];
+					const Vec2f v3 = vtxDst[wallDst->idx[1]];
+					if (TFE_Polygon::vtxEqual(&v0, &v3) && TFE_Polygon::vtxEqual(&v1, &v2))
+					{
+						// Make sure the vertices are *exactly* the same.
+						vtxDst[wallDst->idx[0]] = v1;
+						vtxDst[wallDst->idx[1]] = v0;
+
+						wallSrc->adjoinId = dst->id;
+						wallSrc->mirrorId = w1;
+						wallDst->adjoinId = src->id;
+						wallDst->mirrorId = w0;
+						matchedIndex = j;
+					}
+				}
+			}
+		}
+	}
+
 	void addSectorToList(s32 id, std::vector<s32>& list)
 	{
 		const s32 count = (s32)list.size();
@@ -1437,6 +1665,95 @@ namespace LevelEditor
 		return sectorsDeleted;
 	}
 		
+	// Insert squares centered on walls spread through the level, once with a linear adjoin search and once with the edge hash.
+	// The timings and resulting geometry are compared and the level is restored afterward.
+	void edit_benchmarkShapeInsert(s32 shapeCount)
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		if (!sectorCount || shapeCount < 1)
+		{
+			infoPanelAddMsg(LE_MSG_WARNING, "Shape insert benchmark requires a level and a shape count of at least 1.");
+			return;
+		}
+
+		struct BenchmarkShape
+		{
+			Vec2f vtx[4];
+			f32 heights[2];
+		};
+		std::vector<BenchmarkShape> shapes;
+		const f32 halfSize = 4.0f;
+		for (s32 i = 0; i < shapeCount; i++)
+		{
+			const EditorSector* sector = &s_level.sectors[s32(s64(i) * sectorCount / shapeCount)];
+			if (sector->walls.empty()) { continue; }
+
+			const EditorWall* wall = &sector->walls[i % (s32)sector->walls.size()];
+			const Vec2f* v0 = &sector->vtx[wall->idx[0]];
+			const Vec2f* v1 = &sector->vtx[wall->idx[1]];
+			const Vec2f center = { (v0->x + v1->x) * 0.5f, (v0->z + v1->z) * 0.5f };
+
+			BenchmarkShape shape;
+			shape.vtx[0] = { center.x - halfSize, center.z - halfSize };
+			shape.vtx[1] = { center.x + halfSize, center.z - halfSize };
+			shape.vtx[2] = { center.x + halfSize, center.z + halfSize };
+			shape.vtx[3] = { center.x - halfSize, center.z + halfSize };
+			if (TFE_Polygon::signedArea(4, shape.vtx) < 0.0f)
+			{
+				std::swap(shape.vtx[0], shape.vtx[3]);
+				std::swap(shape.vtx[1], shape.vtx[2]);
+			}
+			shape.heights[0] = sector->floorHeight;
+			shape.heights[1] = sector->ceilHeight;
+			shapes.push_back(shape);
+		}
+
+		const std::vector<EditorSector> savedSectors = s_level.sectors;
+		const std::vector<Vec2f> savedShape = s_geoEdit.shape;
+		std::vector<s32> changedSectors;
+
+		const s32 insertCount = (s32)shapes.size();
+		f64 time[2];
+		s32 resultSectors[2], resultWalls[2], resultAdjoins[2];
+		benchmark_flagPasses(&s_edgeHashEnabled, time, [&](s32)
+		{
+			for (s32 i = 0; i < insertCount; i++)
+			{
+				s_geoEdit.shape.assign(shapes[i].vtx, shapes[i].vtx + 4);
+				edit_insertShape(shapes[i].heights, BMODE_MERGE, 0, false, changedSectors);
+			}
+		},
+		[&](s32 pass)
+		{
+			resultSectors[pass] = (s32)s_level.sectors.size();
+			resultWalls[pass] = 0;
+			resultAdjoins[pass] = 0;
+			for (s32 s = 0; s < resultSectors[pass]; s++)
+			{
+				const EditorSector* sector = &s_level.sectors[s];
+				const s32 wallCount = (s32)sector->walls.size();
+				for (s32 w = 0; w < wallCount; w++)
+				{
+					if (sector->walls[w].adjoinId >= 0) { resultAdjoins[pass]++; }
+				}
+				resultWalls[pass] += wallCount;
+			}
+
+			// Restore the level before the next pass.
+			s_level.sectors = savedSectors;
+			sectorBvh_invalidate();
+		});
+		s_geoEdit.shape = savedShape;
+		selection_clearHovered();
+		selection_clear(SEL_GEO | SEL_ENTITY_BIT);
+
+		const bool match = resultSectors[0] == resultSectors[1] && resultWalls[0] == resultWalls[1] && resultAdjoins[0] == resultAdjoins[1];
+		infoPanelAddMsg(match ? LE_MSG_INFO : LE_MSG_ERROR, "Shape insert benchmark: %d shapes, %d sectors. Linear: %0.2f ms, Edge hash: %0.2f ms, results %s.",
+			insertCount, sectorCount, time[0], time[1], match ? "match" : "differ");
+		TFE_System::logWrite(LOG_MSG, "LevelEditor", "Shape insert benchmark: %d shapes, %d sectors. Linear: %0.2f ms (%d sectors, %d walls, %d adjoins), Edge hash: %0.2f ms (%d sectors, %d walls, %d adjoins).",
+			insertCount, sectorCount, time[0], resultSectors[0], resultWalls[0], resultAdjoins[0], time[1], resultSectors[1], resultWalls[1], resultAdjoins[1]);
+	}
+
 	Vec3f extrudePoint2dTo3d(const Vec2f pt2d)
 	{
 		const Vec3f& S = s_geoEdit.extrudePlane.S;
@@ -1563,27 +1880,11 @@ namespace LevelEditor
 		return areColinear && !TFE_Polygon::vtxEqual(&points[newPoints[0] & 255], &points[newPoints[1] & 255]);
 	}
 
-	void mergeAdjoins(EditorSector* sector0)
+	// The linear search, every wall of every sector in the list is tested and the scan restarts from the first wall
+	// after each split.
+	void mergeAdjoins_linear(s32 id0, std::vector<EditorSector*>& mergeList)
 	{
-		const s32 levelSectorCount = (s32)s_level.sectors.size();
-		EditorSector* levelSectors = s_level.sectors.data();
-
-		s32 id0 = sector0->id;
-
-		// Build a list ahead of time, instead of traversing through all sectors multiple times.
-		std::vector<EditorSector*> mergeList;
-		for (s32 i = 0; i < levelSectorCount; i++)
-		{
-			EditorSector* sector1 = &levelSectors[i];
-			if (sector1 == sector0) { continue; }
-
-			// Cannot merge adjoins if the sectors don't overlap in 3D space.
-			if (!aabbOverlap3d(sector0->bounds, sector1->bounds))
-			{
-				continue;
-			}
-			mergeList.push_back(sector1);
-		}
+		EditorSector* sector0 = &s_level.sectors[id0];
 
 		// This loop needs to be more careful with overlaps.
 		// Loop through each wall of the new sector and see if it can be adjoined to another sector/wall in the list created above.
@@ -1697,6 +1998,157 @@ namespace LevelEditor
 				}
 			}
 		}
+	}
+
+	void mergeAdjoins_hashed(s32 id0, std::vector<EditorSector*>& mergeList)
+	{
+		EditorSector* sector0 = &s_level.sectors[id0];
+
+		EditorSector** sectorList = mergeList.data();
+		WallEdgeHash hash;
+		edgeHash_build(&hash, mergeList);
+
+		// This loop needs to be more careful with overlaps.
+		// Loop through each wall of the new sector and see if it can be adjoined to a candidate wall from the edge hash.
+		// Once colinear walls are found, properly splits are made, the split sectors are rehashed and the same wall is
+		// tested again. Passes are repeated until no more splits are made. Adjoins are only added when exact matches are found.
+		bool splitFound = true;
+		while (splitFound)
+		{
+			splitFound = false;
+			sector0 = &s_level.sectors[id0];
+
+			for (s32 w0 = 0; w0 < (s32)sector0->walls.size(); w0++)
+			{
+				EditorWall* wall0 = &sector0->walls[w0];
+				if (!canCreateNewAdjoin(wall0, sector0)) { continue; }
+				const Vec2f* v0 = &sector0->vtx[wall0->idx[0]];
+				const Vec2f* v1 = &sector0->vtx[wall0->idx[1]];
+
+				// Now check for overlaps with the candidate walls.
+				edgeHash_getCandidates(&hash, *v0, *v1, s_edgeCandidates);
+				const s32 candidateCount = (s32)s_edgeCandidates.size();
+				const WallRef* candidate = s_edgeCandidates.data();
+				bool wallSplit = false;
+				for (s32 c = 0; c < candidateCount; c++)
+				{
+					EditorSector* sector1 = sectorList[candidate[c].listIndex];
+					s32 w1 = candidate[c].wallIndex;
+					EditorWall* wall1 = &sector1->walls[w1];
+					if (!canCreateNewAdjoin(wall1, sector1)) { continue; }
+					const Vec2f* v2 = &sector1->vtx[wall1->idx[0]];
+					const Vec2f* v3 = &sector1->vtx[wall1->idx[1]];
+
+					// Do the vertices match exactly?
+					if (TFE_Polygon::vtxEqual(v0, v3) && TFE_Polygon::vtxEqual(v1, v2))
+					{
+						// Found an adjoin!
+						wall0->adjoinId = sector1->id;
+						wall0->mirrorId = w1;
+						wall1->adjoinId = sector0->id;
+						wall1->mirrorId = w0;
+						// For now, assume one adjoin per wall.
+						break;
+					}
+
+					// Are these edges co-linear?
+					s32 newPointCount;
+					s32 newPoints[4];
+					Vec2f points[] = { *v0, *v1, *v2, *v3 };
+					bool collinear = edgesColinear(points, newPointCount, newPoints);
+					if (collinear && newPointCount == 2)
+					{
+						// 4 Cases:
+						// 1. v0,v1 left of v2,v3
+						if ((newPoints[0] >> 8) == 0 && (newPoints[1] >> 8) == 1)
+						{
+							assert((newPoints[0] & 255) >= 2);
+							assert((newPoints[1] & 255) < 2);
+
+							// Insert newPoints[0] & 255 into wall0
+							wallSplit |= edit_splitWall(sector0->id, w0, points[newPoints[0] & 255]);
+							// Insert newPoints[1] & 255 into wall1
+							wallSplit |= edit_splitWall(sector1->id, w1, points[newPoints[1] & 255]);
+						}
+						// 2. v0,v1 right of v2,v3
+						else if ((newPoints[0] >> 8) == 1 && (newPoints[1] >> 8) == 0)
+						{
+							assert((newPoints[0] & 255) < 2);
+							assert((newPoints[1] & 255) >= 2);
+
+							// Insert newPoints[0] & 255 into wall1
+							wallSplit |= edit_splitWall(sector1->id, w1, points[newPoints[0] & 255]);
+							// Insert newPoints[1] & 255 into wall0
+							wallSplit |= edit_splitWall(sector0->id, w0, points[newPoints[1] & 255]);
+						}
+						// 3. v2,v3 inside of v0,v1
+						else if ((newPoints[0] >> 8) == 0 && (newPoints[1] >> 8) == 0)
+						{
+							assert((newPoints[0] & 255) >= 2);
+							assert((newPoints[1] & 255) >= 2);
+
+							// Insert newPoints[0] & 255 into wall0
+							// Insert newPoints[1] & 255 into wall0
+							if (edit_splitWall(sector0->id, w0, points[newPoints[1] & 255])) { w0++; wallSplit |= true; }
+							wallSplit |= edit_splitWall(sector0->id, w0, points[newPoints[0] & 255]);
+						}
+						// 4. v0,v1 inside of v2,v3
+						else if ((newPoints[0] >> 8) == 1 && (newPoints[1] >> 8) == 1)
+						{
+							assert((newPoints[0] & 255) < 2);
+							assert((newPoints[1] & 255) < 2);
+
+							// Insert newPoints[0] & 255 into wall1
+							// Insert newPoints[1] & 255 into wall1
+							if (edit_splitWall(sector1->id, w1, points[newPoints[1] & 255])) { w1++; wallSplit |= true; }
+							wallSplit |= edit_splitWall(sector1->id, w1, points[newPoints[0] & 255]);
+						}
+						if (wallSplit) { break; }
+					}
+				}
+
+				if (wallSplit)
+				{
+					// Only the split sectors need to be rehashed, then the current wall is tested again.
+					edgeHash_updateChanged(&hash, mergeList);
+					splitFound = true;
+					w0--;
+				}
+			}
+		}
+	}
+
+	void mergeAdjoins(EditorSector* sector0)
+	{
+		const s32 levelSectorCount = (s32)s_level.sectors.size();
+		EditorSector* levelSectors = s_level.sectors.data();
+
+		s32 id0 = sector0->id;
+
+		// Build a list ahead of time, instead of traversing through all sectors multiple times.
+		std::vector<EditorSector*> mergeList;
+		for (s32 i = 0; i < levelSectorCount; i++)
+		{
+			EditorSector* sector1 = &levelSectors[i];
+			if (sector1 == sector0) { continue; }
+
+			// Cannot merge adjoins if the sectors don't overlap in 3D space.
+			if (!aabbOverlap3d(sector0->bounds, sector1->bounds))
+			{
+				continue;
+			}
+			mergeList.push_back(sector1);
+		}
+
+		if (s_edgeHashEnabled)
+		{
+			mergeAdjoins_hashed(id0, mergeList);
+		}
+		else
+		{
+			mergeAdjoins_linear(id0, mergeList);
+		}
+		sector0 = &s_level.sectors[id0];
 
 		const s32 sectorCount = (s32)mergeList.size();
 		EditorSector** sectorList = mergeList.data();
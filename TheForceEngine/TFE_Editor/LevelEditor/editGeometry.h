@@ -62,6 +62,8 @@ namespace LevelEditor
 
 	void createSectorFromRect();
 	void createSectorFromShape();
+	// Compare shape insertion with and without the wall edge hash, the level is restored afterward.
+	void edit_benchmarkShapeInsert(s32 shapeCount);
 	s32 insertVertexIntoSector(EditorSector* sector, Vec2f newVtx);
 
 	bool gridCursorIntersection(Vec3f* pos);
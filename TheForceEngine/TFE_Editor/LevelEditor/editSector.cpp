@@ -13,6 +13,7 @@
 #include "sharedState.h"
 #include "selection.h"
 #include "guidelines.h"
+#include "sectorBvh.h"
 #include <TFE_System/math.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Editor/errorMessages.h>
@@ -200,6 +201,10 @@ namespace LevelEditor
 			// Move floors and ceilings.
 			sector->floorHeight += delta.y;
 			sector->ceilHeight += delta.y;
+			sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
+			sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+			sectorBvh_refit(sector);
+			assert(sectorBvh_verifySector(sector));
 
 			// Move objects.
 			const u32 objCount = (u32)sector->obj.size();
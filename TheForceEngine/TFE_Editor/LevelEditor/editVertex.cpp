@@ -12,6 +12,7 @@
 #include "sharedState.h"
 #include "selection.h"
 #include "guidelines.h"
+#include "sectorBvh.h"
 #include <TFE_System/math.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Editor/errorMessages.h>
@@ -705,6 +706,7 @@ namespace LevelEditor
 			// Get the ID and then erase it from the level.
 			s32 delId = sector->id;
 			s_level.sectors.erase(s_level.sectors.begin() + delId);
+			sectorBvh_invalidate();
 
 			// Update Sector IDs
 			const s32 levSectorCount = (s32)s_level.sectors.size();
@@ -9,6 +9,7 @@
 #include "camera.h"
 #include "infoPanel.h"
 #include "groups.h"
+#include "sectorBvh.h"
 #include "sharedState.h"
 #include "selection.h"
 #include <TFE_Input/input.h>
@@ -1225,6 +1226,13 @@ namespace LevelEditor
 			{
 				sector->ceilHeight = s_sectorChanges.ceilHeight;
 			}
+			if (s_sectorChanges.changes & (SCF_FLOOR_HEIGHT | SCF_CEIL_HEIGHT))
+			{
+				sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
+				sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+				sectorBvh_refit(sector);
+				assert(sectorBvh_verifySector(sector));
+			}
 			if (s_sectorChanges.changes & SCF_FLAG1_SET)
 			{
 				sector->flags[0] = s_sectorChanges.flags1_set;
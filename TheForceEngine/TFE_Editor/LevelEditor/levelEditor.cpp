@@ -25,6 +25,7 @@
 #include "shell.h"
 #include "userPreferences.h"
 #include "testOptions.h"
+#include "sectorBvh.h"
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_Editor/AssetBrowser/assetBrowser.h>
 #include <TFE_Asset/imageAsset.h>
@@ -372,6 +373,7 @@ namespace LevelEditor
 	void destroy()
 	{
 		s_level.sectors.clear();
+		sectorBvh_invalidate();
 		viewport_destroy();
 		TFE_RenderShared::destroy();
 
@@ -530,6 +532,7 @@ namespace LevelEditor
 
 		// Then erase the sector.
 		s_level.sectors.erase(s_level.sectors.begin() + sectorId);
+		sectorBvh_invalidate();
 
 		// Finally fix-up any references.
 		sectorCount = (s32)s_level.sectors.size();
@@ -3755,6 +3758,8 @@ namespace LevelEditor
 			EditorSector* sector = sectorList[i];
 			sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
 			sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+			sectorBvh_refit(sector);
+			assert(sectorBvh_verifySector(sector));
 		}
 	}
 	
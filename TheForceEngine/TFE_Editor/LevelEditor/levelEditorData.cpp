@@ -10,6 +10,9 @@
 #include "levelEditorInf.h"
 #include "sharedState.h"
 #include "guidelines.h"
+#include "sectorBvh.h"
+#include "infoPanel.h"
+#include "benchmark.h"
 #include <TFE_Editor/snapshotReaderWriter.h>
 #include <TFE_Editor/history.h>
 #include <TFE_Editor/errorMessages.h>
@@ -25,6 +28,7 @@
 #include <TFE_Editor/EditorAsset/editorSprite.h>
 #include <TFE_Editor/AssetBrowser/assetBrowser.h>
 #include <TFE_Editor/LevelEditor/Rendering/grid.h>
+#include <TFE_Editor/LevelEditor/Rendering/viewport.h>
 #include <TFE_Archive/zipArchive.h>
 #include <TFE_Jedi/Level/rwall.h>
 #include <TFE_Jedi/Level/rsector.h>
@@ -99,6 +103,11 @@ namespace LevelEditor
 	static s32 s_curSnapshotId = -1;
 	static EditorLevel s_curSnapshot;
 
+	// Sector candidates from the BVH for spatial queries.
+	static std::vector<s32> s_rayCandidates;
+	static std::vector<s32> s_sectorCandidates;
+	static bool s_sectorBvhEnabled = true;
+
 	EditorLevel s_level = {};
 
 	extern AssetList s_levelTextureList;
@@ -515,6 +524,7 @@ namespace LevelEditor
 		// Clear selection state.
 		selection_clear();
 		selection_clearHovered();
+		viewport_invalidateSectorMeshes();
 		s_featureTex = {};
 
 		// Clear notes.
@@ -536,6 +546,7 @@ namespace LevelEditor
 		// Clear selection state.
 		selection_clear();
 		selection_clearHovered();
+		viewport_invalidateSectorMeshes();
 		s_featureTex = {};
 
 		// Clear notes.
@@ -674,6 +685,7 @@ namespace LevelEditor
 			return false;
 		}
 		level->sectors.resize(sectorCount);
+		sectorBvh_invalidate();
 
 		u32 mainId = groups_getMainId();
 		EditorSector* sector = level->sectors.data();
@@ -976,6 +988,7 @@ namespace LevelEditor
 		u32 sectorCount;
 		file.read(&sectorCount);
 		s_level.sectors.resize(sectorCount);
+		sectorBvh_invalidate();
 		EditorSector* sector = s_level.sectors.data();
 		for (u32 i = 0; i < sectorCount; i++, sector++)
 		{
@@ -3634,6 +3647,7 @@ namespace LevelEditor
 		sector->bounds[1] = { poly.bounds[1].x, 0.0f, poly.bounds[1].z };
 		sector->bounds[0].y = min(sector->floorHeight, sector->ceilHeight);
 		sector->bounds[1].y = max(sector->floorHeight, sector->ceilHeight);
+		sectorBvh_refit(sector);
 	}
 
 	// Update the sector itself from the sector's polygon.
@@ -3934,8 +3948,20 @@ namespace LevelEditor
 	{
 		EditorLevel* level = &s_level;
 		if (level->sectors.empty()) { return false; }
-		const s32 sectorCount = (s32)level->sectors.size();
-		EditorSector* sector = level->sectors.data();
+
+		// Only sectors whose XZ bounds are crossed by the ray can be hit. Y is ignored since objects can extend
+		// past the sector heights and sloped planes past the sector bounds.
+		std::vector<s32>& candidates = s_rayCandidates;
+		if (s_sectorBvhEnabled)
+		{
+			sectorBvh_getRayCandidatesXZ(&ray->origin, &ray->dir, candidates);
+		}
+		else
+		{
+			candidates.resize(level->sectors.size());
+			for (size_t s = 0; s < candidates.size(); s++) { candidates[s] = s32(s); }
+		}
+		const s32 candidateCount = (s32)candidates.size();
 
 		f32 maxDist  = ray->maxDist;
 		Vec3f origin = ray->origin;
@@ -3951,14 +3977,12 @@ namespace LevelEditor
 		hitInfo->hitPos = { 0 };
 		hitInfo->dist = FLT_MAX;
 
-		// Loop through sectors in the world.
-		for (s32 s = 0; s < sectorCount; s++, sector++)
+		// Loop through the candidate sectors in level order.
+		for (s32 c = 0; c < candidateCount; c++)
 		{
+			EditorSector* sector = &level->sectors[candidates[c]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 
-			// Check the bounds.
-			//if (!rayHitAABB(ray, sector->bounds)) { continue; }
-
 			const bool isSectorSloped = (sector->flags[0] & SEC_FLAGS1_SLOPEDFLOOR) != 0 || (sector->flags[0] & SEC_FLAGS1_SLOPEDCEILING) != 0;
 
 			// Now check against the walls.
@@ -4397,16 +4421,17 @@ namespace LevelEditor
 		return closestId;
 	}
 
-	// TODO: Spatial data structure to handle cases where there are 10k, 100k, etc. sectors.
 	bool getOverlappingSectorsPt(const Vec3f* pos, SectorList* result, f32 padding)
 	{
 		if (!pos || !result) { return false; }
 
 		result->clear();
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < count; i++, sector++)
+		const Vec3f posBounds[2] = { *pos, *pos };
+		sectorBvh_getOverlapCandidates(posBounds, padding, s_sectorCandidates);
+		const s32 count = (s32)s_sectorCandidates.size();
+		for (s32 i = 0; i < count; i++)
 		{
+			EditorSector* sector = &s_level.sectors[s_sectorCandidates[i]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 			// The position has to be within the bounds of the sector.
 			// TODO: Increase the bounds range?
@@ -4429,10 +4454,11 @@ namespace LevelEditor
 
 		result->clear();
 		const f32 padding = 0.1f;
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < count; i++, sector++)
+		sectorBvh_getOverlapCandidates(bounds, padding, s_sectorCandidates);
+		const s32 count = (s32)s_sectorCandidates.size();
+		for (s32 i = 0; i < count; i++)
 		{
+			EditorSector* sector = &s_level.sectors[s_sectorCandidates[i]];
 			if (boundsOverlap3D(sector->bounds, bounds, padding)) // Add padding for sectors that are just touching.
 			{
 				result->push_back(sector);
@@ -4442,6 +4468,69 @@ namespace LevelEditor
 		return !result->empty();
 	}
 
+	// Trace a grid of rays over the level with and without the sector BVH and compare the results.
+	void level_benchmarkPicking(s32 gridSize)
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		if (!sectorCount || gridSize < 1)
+		{
+			infoPanelAddMsg(LE_MSG_WARNING, "Picking benchmark requires a level and a grid size of at least 1.");
+			return;
+		}
+
+		// Rays start above the level, one straight down and one angled toward the center per grid point.
+		const Vec3f* bounds = s_level.bounds;
+		const Vec3f center = { (bounds[0].x + bounds[1].x) * 0.5f, (bounds[0].y + bounds[1].y) * 0.5f, (bounds[0].z + bounds[1].z) * 0.5f };
+		const Vec3f ext = { bounds[1].x - bounds[0].x, bounds[1].y - bounds[0].y, bounds[1].z - bounds[0].z };
+		const f32 maxDist = 2.0f * sqrtf(ext.x*ext.x + ext.y*ext.y + ext.z*ext.z) + 100.0f;
+		std::vector<Ray> rays;
+		rays.reserve(gridSize * gridSize * 2);
+		for (s32 z = 0; z < gridSize; z++)
+		{
+			for (s32 x = 0; x < gridSize; x++)
+			{
+				const Vec3f origin = { bounds[0].x + ext.x * (x + 0.5f) / f32(gridSize), bounds[1].y + 10.0f, bounds[0].z + ext.z * (z + 0.5f) / f32(gridSize) };
+				rays.push_back({ origin, { 0.0f, -1.0f, 0.0f }, maxDist });
+
+				Vec3f dir = { center.x - origin.x, center.y - origin.y, center.z - origin.z };
+				if (TFE_Math::dot(&dir, &dir) > FLT_EPSILON)
+				{
+					rays.push_back({ origin, TFE_Math::normalize(&dir), maxDist });
+				}
+			}
+		}
+
+		const s32 rayCount = (s32)rays.size();
+		std::vector<RayHitInfo> hits[2];
+		hits[0].resize(rayCount);
+		hits[1].resize(rayCount);
+		f64 time[2];
+		benchmark_flagPasses(&s_sectorBvhEnabled, time, [&](s32 pass)
+		{
+			for (s32 r = 0; r < rayCount; r++)
+			{
+				traceRay(&rays[r], &hits[pass][r], false, true, true);
+			}
+		});
+
+		s32 mismatches = 0;
+		for (s32 r = 0; r < rayCount; r++)
+		{
+			const RayHitInfo* h0 = &hits[0][r];
+			const RayHitInfo* h1 = &hits[1][r];
+			if (h0->hitSectorId != h1->hitSectorId || h0->hitWallId != h1->hitWallId || h0->hitObjId != h1->hitObjId ||
+				h0->hitPart != h1->hitPart || h0->dist != h1->dist)
+			{
+				mismatches++;
+			}
+		}
+
+		infoPanelAddMsg(mismatches ? LE_MSG_ERROR : LE_MSG_INFO, "Picking benchmark: %d rays, %d sectors. Linear: %0.2f ms, BVH: %0.2f ms, %d mismatches.",
+			rayCount, sectorCount, time[0], time[1], mismatches);
+		TFE_System::logWrite(LOG_MSG, "LevelEditor", "Picking benchmark: %d rays, %d sectors. Linear: %0.2f ms, BVH: %0.2f ms, %d mismatches.",
+			rayCount, sectorCount, time[0], time[1], mismatches);
+	}
+
 	// Snapshot of a full entity list.
 	void level_createEntiyListSnapshot(SnapshotBuffer* buffer, s32 sectorId)
 	{
@@ -4816,6 +4905,7 @@ namespace LevelEditor
 
 		// Resize to post-snapshot sector total.
 		s_level.sectors.resize(newSectorCount);
+		sectorBvh_invalidate();
 
 		std::string texName;
 		std::vector<s32> remapTableTex(texCount);
@@ -5040,6 +5130,7 @@ namespace LevelEditor
 			for (s32 i = 0; i < 3; i++) { sector->flags[i] = attrib.flags[i]; }
 			sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
 			sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+			sectorBvh_refit(sector);
 			sector->floorTex = attrib.floorTex;
 			sector->ceilTex = attrib.ceilTex;
 		}
@@ -5186,6 +5277,7 @@ namespace LevelEditor
 		}
 		// Then copy the snapshot to the level data itself. Its the new state.
 		s_level = s_curSnapshot;
+		sectorBvh_invalidate();
 
 		// For now until the way snapshot memory is handled is refactored, to avoid duplicate code that will be removed later.
 		// TODO: Handle edit state properly here too.
@@ -358,6 +358,8 @@ namespace LevelEditor
 	bool getOverlappingSectorsPt(const Vec3f* pos, SectorList* result, f32 padding = 0.0f);
 	// Get all sectors that have bounds that overlap the input bounds.
 	bool getOverlappingSectorsBounds(const Vec3f bounds[2], SectorList* result);
+	// Trace a grid of rays over the level with and without the sector BVH, report the timings and any differences.
+	void level_benchmarkPicking(s32 gridSize);
 	void fixupLevel(bool createSnapshot = true);
 	// Helpers
 	bool aabbOverlap3d(const Vec3f* aabb0, const Vec3f* aabb1);
@@ -0,0 +1,251 @@
+#include "sectorBvh.h"
+#include "sharedState.h"
+#include <TFE_System/system.h>
+#include <algorithm>
+#include <cfloat>
+
+namespace LevelEditor
+{
+	// Extra space added to queries so that floating point differences never cull a sector
+	// that the exact tests would accept.
+	static const f32 c_bvhQueryMargin = 0.01f;
+
+	struct BvhNode
+	{
+		Vec3f bounds[2];
+		s32 child[2];
+		s32 parent;
+		s32 sectorId;	// >= 0 for leaves.
+	};
+
+	static std::vector<BvhNode> s_bvhNodes;
+	static std::vector<s32> s_bvhLeaf;		// Leaf node for each sector.
+	static std::vector<s32> s_bvhBuildList;
+	static std::vector<s32> s_bvhStack;
+	static bool s_bvhDirty = true;
+
+	void mergeBounds(Vec3f* dst, const Vec3f* a, const Vec3f* b)
+	{
+		dst[0] = { std::min(a[0].x, b[0].x), std::min(a[0].y, b[0].y), std::min(a[0].z, b[0].z) };
+		dst[1] = { std::max(a[1].x, b[1].x), std::max(a[1].y, b[1].y), std::max(a[1].z, b[1].z) };
+	}
+
+	// Build the subtree for sectors [first, last) of the build list, returns the node index.
+	s32 buildNode(s32 first, s32 last, s32 parent)
+	{
+		const s32 nodeId = (s32)s_bvhNodes.size();
+		s_bvhNodes.push_back({});
+		BvhNode* node = &s_bvhNodes[nodeId];
+		node->parent = parent;
+		node->child[0] = -1;
+		node->child[1] = -1;
+
+		if (last - first == 1)
+		{
+			const s32 sectorId = s_bvhBuildList[first];
+			const EditorSector* sector = &s_level.sectors[sectorId];
+			node->bounds[0] = sector->bounds[0];
+			node->bounds[1] = sector->bounds[1];
+			node->sectorId = sectorId;
+			s_bvhLeaf[sectorId] = nodeId;
+			return nodeId;
+		}
+		node->sectorId = -1;
+
+		// Split at the median of the sector centers along the longest axis.
+		Vec3f center[2] = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+		for (s32 i = first; i < last; i++)
+		{
+			const Vec3f* bounds = s_level.sectors[s_bvhBuildList[i]].bounds;
+			const Vec3f c = { (bounds[0].x + bounds[1].x) * 0.5f, (bounds[0].y + bounds[1].y) * 0.5f, (bounds[0].z + bounds[1].z) * 0.5f };
+			center[0] = { std::min(center[0].x, c.x), std::min(center[0].y, c.y), std::min(center[0].z, c.z) };
+			center[1] = { std::max(center[1].x, c.x), std::max(center[1].y, c.y), std::max(center[1].z, c.z) };
+		}
+		const Vec3f ext = { center[1].x - center[0].x, center[1].y - center[0].y, center[1].z - center[0].z };
+		const s32 axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+
+		const s32 mid = (first + last) / 2;
+		std::nth_element(s_bvhBuildList.begin() + first, s_bvhBuildList.begin() + mid, s_bvhBuildList.begin() + last, [axis](s32 a, s32 b)
+		{
+			const Vec3f* boundsA = s_level.sectors[a].bounds;
+			const Vec3f* boundsB = s_level.sectors[b].bounds;
+			const f32 ca = boundsA[0].m[axis] + boundsA[1].m[axis];
+			const f32 cb = boundsB[0].m[axis] + boundsB[1].m[axis];
+			return ca < cb || (ca == cb && a < b);
+		});
+
+		const s32 child0 = buildNode(first, mid, nodeId);
+		const s32 child1 = buildNode(mid, last, nodeId);
+		// The node array may have grown.
+		node = &s_bvhNodes[nodeId];
+		node->child[0] = child0;
+		node->child[1] = child1;
+		mergeBounds(node->bounds, s_bvhNodes[child0].bounds, s_bvhNodes[child1].bounds);
+		return nodeId;
+	}
+
+	void buildBvh()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		s_bvhNodes.clear();
+		s_bvhNodes.reserve(sectorCount * 2);
+		s_bvhLeaf.resize(sectorCount);
+		s_bvhBuildList.resize(sectorCount);
+		for (s32 s = 0; s < sectorCount; s++)
+		{
+			s_bvhBuildList[s] = s;
+		}
+		if (sectorCount)
+		{
+			buildNode(0, sectorCount, -1);
+		}
+		s_bvhDirty = false;
+	}
+
+	void updateBvh()
+	{
+		if (s_bvhDirty || s_bvhLeaf.size() != s_level.sectors.size())
+		{
+			buildBvh();
+		}
+	}
+
+	void sectorBvh_invalidate()
+	{
+		s_bvhDirty = true;
+	}
+
+	void sectorBvh_refit(const EditorSector* sector)
+	{
+		if (s_bvhDirty || s_level.sectors.empty()) { return; }
+		// Sectors outside of the level (snapshots, sectors being built) are not in the tree.
+		const EditorSector* base = s_level.sectors.data();
+		if (sector < base || sector >= base + s_level.sectors.size()) { return; }
+		const s32 sectorId = s32(sector - base);
+		if (sectorId >= (s32)s_bvhLeaf.size())
+		{
+			s_bvhDirty = true;
+			return;
+		}
+
+		s32 nodeId = s_bvhLeaf[sectorId];
+		BvhNode* node = &s_bvhNodes[nodeId];
+		node->bounds[0] = sector->bounds[0];
+		node->bounds[1] = sector->bounds[1];
+		for (nodeId = node->parent; nodeId >= 0; nodeId = node->parent)
+		{
+			node = &s_bvhNodes[nodeId];
+			mergeBounds(node->bounds, s_bvhNodes[node->child[0]].bounds, s_bvhNodes[node->child[1]].bounds);
+		}
+	}
+
+	// Returns true if the XZ projection of the ray (t >= 0) touches the XZ bounds.
+	bool rayOverlapsBoundsXZ(const Vec3f* origin, const Vec3f* dir, const Vec3f* bounds)
+	{
+		f32 tMin = 0.0f, tMax = FLT_MAX;
+		for (s32 i = 0; i < 3; i += 2)
+		{
+			const f32 b0 = bounds[0].m[i] - c_bvhQueryMargin;
+			const f32 b1 = bounds[1].m[i] + c_bvhQueryMargin;
+			if (dir->m[i] == 0.0f)
+			{
+				if (origin->m[i] < b0 || origin->m[i] > b1) { return false; }
+				continue;
+			}
+			const f32 scale = 1.0f / dir->m[i];
+			f32 t0 = (b0 - origin->m[i]) * scale;
+			f32 t1 = (b1 - origin->m[i]) * scale;
+			if (t0 > t1) { std::swap(t0, t1); }
+			tMin = std::max(tMin, t0);
+			tMax = std::min(tMax, t1);
+			if (tMin > tMax) { return false; }
+		}
+		return true;
+	}
+
+	bool boundsOverlapPadded(const Vec3f* a, const Vec3f* b, f32 padding)
+	{
+		for (s32 i = 0; i < 3; i++)
+		{
+			if (a[0].m[i] - padding > b[1].m[i] || b[0].m[i] > a[1].m[i] + padding) { return false; }
+		}
+		return true;
+	}
+
+	template<typename TestFunc>
+	void gatherCandidates(TestFunc test, std::vector<s32>& result)
+	{
+		result.clear();
+		updateBvh();
+		if (s_bvhNodes.empty()) { return; }
+
+		s_bvhStack.clear();
+		s_bvhStack.push_back(0);
+		while (!s_bvhStack.empty())
+		{
+			const BvhNode* node = &s_bvhNodes[s_bvhStack.back()];
+			s_bvhStack.pop_back();
+			if (!test(node->bounds)) { continue; }
+
+			if (node->sectorId >= 0)
+			{
+				result.push_back(node->sectorId);
+			}
+			else
+			{
+				s_bvhStack.push_back(node->child[1]);
+				s_bvhStack.push_back(node->child[0]);
+			}
+		}
+		// Keep the level order so the callers resolve ties exactly as a linear scan would.
+		std::sort(result.begin(), result.end());
+	}
+
+	void sectorBvh_getRayCandidatesXZ(const Vec3f* origin, const Vec3f* dir, std::vector<s32>& result)
+	{
+		gatherCandidates([origin, dir](const Vec3f* bounds) { return rayOverlapsBoundsXZ(origin, dir, bounds); }, result);
+	}
+
+	void sectorBvh_getOverlapCandidates(const Vec3f bounds[2], f32 padding, std::vector<s32>& result)
+	{
+		const f32 pad = padding + c_bvhQueryMargin;
+		gatherCandidates([bounds, pad](const Vec3f* nodeBounds) { return boundsOverlapPadded(nodeBounds, bounds, pad); }, result);
+	}
+
+	bool sectorBvh_verifySector(const EditorSector* sector)
+	{
+		const EditorSector* base = s_level.sectors.data();
+		if (!sector || sector < base || sector >= base + s_level.sectors.size()) { return true; }
+
+		std::vector<s32> candidates;
+		sectorBvh_getOverlapCandidates(sector->bounds, 0.0f, candidates);
+
+		std::vector<s32> expected;
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		for (s32 s = 0; s < sectorCount; s++)
+		{
+			if (boundsOverlapPadded(s_level.sectors[s].bounds, sector->bounds, c_bvhQueryMargin))
+			{
+				expected.push_back(s);
+			}
+		}
+		if (candidates != expected)
+		{
+			TFE_System::logWrite(LOG_WARNING, "SectorBvh", "Overlap query for sector %d returned %d sectors, brute force found %d.",
+				s32(sector - base), (s32)candidates.size(), (s32)expected.size());
+			return false;
+		}
+		return true;
+	}
+
+	s32 sectorBvh_verify()
+	{
+		s32 mismatchCount = 0;
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		for (s32 s = 0; s < sectorCount; s++)
+		{
+			if (!sectorBvh_verifySector(&s_level.sectors[s])) { mismatchCount++; }
+		}
+		return mismatchCount;
+	}
+}
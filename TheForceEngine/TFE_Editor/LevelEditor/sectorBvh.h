@@ -0,0 +1,38 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Editor
+// A system built to view and edit Dark Forces data files.
+// The viewing aspect needs to be put in place at the beginning
+// in order to properly test elements in isolation without having
+// to "play" the game as intended.
+//////////////////////////////////////////////////////////////////////
+// Bounding volume hierarchy over the level sector bounds, used to
+// narrow down ray picking and overlap queries to nearby sectors.
+// The tree is built lazily and leaves are refit when the sector bounds
+// change, it is rebuilt when sectors are added, removed or reordered.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "levelEditorData.h"
+#include <vector>
+
+namespace LevelEditor
+{
+	// Force a full rebuild on the next query.
+	void sectorBvh_invalidate();
+	// Update the sector leaf after its bounds have changed.
+	// Sectors that are not part of the level are ignored.
+	void sectorBvh_refit(const EditorSector* sector);
+
+	// The queries below return candidate sector indices in ascending order.
+	// Candidates are conservative, the caller still has to run the exact tests.
+	// Sectors whose XZ bounds may be crossed by the ray (dist >= 0), the Y axis is ignored.
+	void sectorBvh_getRayCandidatesXZ(const Vec3f* origin, const Vec3f* dir, std::vector<s32>& result);
+	// Sectors whose bounds may overlap the input bounds expanded by 'padding'.
+	void sectorBvh_getOverlapCandidates(const Vec3f bounds[2], f32 padding, std::vector<s32>& result);
+
+	// Debug checks, compare the tree queries with a brute force test against every sector.
+	// Returns true if the overlap query for the sector bounds matches the brute force result.
+	bool sectorBvh_verifySector(const EditorSector* sector);
+	// Verifies every sector, returns the number of mismatches.
+	s32 sectorBvh_verify();
+}
@@ -5,6 +5,10 @@
 #include "selection.h"
 #include "sharedState.h"
 #include "infoPanel.h"
+#include "benchmark.h"
+#include <TFE_System/system.h>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace TFE_Editor;
 
@@ -15,13 +19,32 @@ namespace LevelEditor
 	SelectionListId s_currentSelection = SEL_VERTEX;
 	FeatureId s_hovered = FEATUREID_NULL;
 	bool s_derivedBuildNeeded = false;
+	extern u32 s_viewFrame;
+
+	// Membership of each list is also tracked with a set of masked feature IDs so inclusion tests do not scan the lists.
+	// The vertex list is compared without the feature data (see featuresEqualNoData()), which is counted separately.
+	static std::unordered_set<FeatureId> s_selectionKeys[SEL_COUNT];
+	static std::unordered_map<FeatureId, s32> s_vertexKeys;
+	static bool s_selectionHashEnabled = true;
+
+	// Uniform grid of selected vertex positions, used to find overlapping vertices when inserting.
+	// Selected vertices can be moved, so the grid is rebuilt from the current positions when first used each frame.
+	// Cells are expanded by a margin that must be larger than the vtxEqual() tolerance.
+	const f32 c_vertexHashMargin = 0.01f;
+	static std::unordered_map<u64, std::vector<FeatureId>> s_vertexCells;
+	static u32 s_vertexCellsFrame = 0;
+	static bool s_vertexCellsValid = false;
 
 	bool selection_insertVertex(FeatureId id, Vec2f value, EditorSector* root = nullptr, HitPart part = HP_FLOOR);
 	bool selection_removeVertex(FeatureId id, Vec2f value);
 	bool selection_isVertexInSet(FeatureId id);
-	bool selection_insertFeatureId(SelectionList& list, FeatureId id);
-	bool selection_removeFeatureId(SelectionList& list, FeatureId id);
-	bool selection_isFeatureIdInSet(SelectionList& list, FeatureId id, s32* index = nullptr);
+	bool selection_isVertexOverlapped(Vec2f value);
+	bool selection_insertFeatureId(SelectionListId listId, FeatureId id);
+	bool selection_removeFeatureId(SelectionListId listId, FeatureId id);
+	bool selection_isFeatureIdInSet(SelectionListId listId, FeatureId id);
+	void selection_addToList(SelectionListId listId, FeatureId id);
+	void selection_clearList(SelectionListId listId);
+	void selection_rebuildKeys(SelectionListId listId);
 	bool selection_featureId(SelectAction action, FeatureId id);
 	void selection_buildDerived();
 	void selection_derivedBuildNeeded();
@@ -34,7 +57,7 @@ namespace LevelEditor
 		{
 			if ((1 << i) & selections)
 			{
-				s_selectionList2[i].clear();
+				selection_clearList(SelectionListId(i));
 			}
 		}
 		if (clearDragSelect)
@@ -151,6 +174,7 @@ namespace LevelEditor
 		{
 			s_selectionList2[i] = s_savedSelections[i];
 			s_savedSelections[i].clear();
+			selection_rebuildKeys(SelectionListId(i));
 		}
 	}
 		
@@ -166,7 +190,7 @@ namespace LevelEditor
 		{
 			case SA_SET:
 			{
-				s_selectionList2[SEL_VERTEX].clear();
+				selection_clearList(SEL_VERTEX);
 				actionDone = selection_insertVertex(id, sector->vtx[index], sector, part);
 				buildDerived = actionDone;
 				infoPanel_clearSelection();
@@ -469,26 +493,10 @@ namespace LevelEditor
 	bool selection_insertVertex(FeatureId id, Vec2f value, EditorSector* root/*=nullptr*/, HitPart part/*=HP_FLOOR*/)
 	{
 		// Insert the vertex if not found.
-		const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
-		const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
-		s32 matchId = -1;
-		for (s32 i = 0; i < count; i++)
-		{
-			if (featuresEqualNoData(featureId[i], id)) { return false; }
+		if (selection_isVertexInSet(id)) { return false; }
 
-			s32 index;
-			EditorSector* sector = unpackFeatureId(featureId[i], &index);
-			const Vec2f& srcValue = sector->vtx[index];
-
-			if (TFE_Polygon::vtxEqual(&value, &srcValue))
-			{
-				// Keep looking after this, the feature may still be in here...
-				matchId = i;
-			}
-		}
-
-		id = setIsOverlapped(id, matchId >= 0);
-		s_selectionList2[SEL_VERTEX].push_back(id);
+		id = setIsOverlapped(id, selection_isVertexOverlapped(value));
+		selection_addToList(SEL_VERTEX, id);
 
 		// If root is non-null, then start from this sector and include potential overlaps from other sectors.
 		if (root)
@@ -563,40 +571,47 @@ namespace LevelEditor
 	// Remove all vertices in the list at 'value'.
 	bool selection_removeVertex(FeatureId id, Vec2f value)
 	{
-		const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
-		const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
-		std::vector<s32> idxToRemove;
+		// Compact the list in a single pass, keeping the order of the remaining vertices.
+		SelectionList& list = s_selectionList2[SEL_VERTEX];
+		const s32 count = (s32)list.size();
+		FeatureId* featureId = list.data();
+		s32 outCount = 0;
 		for (s32 i = 0; i < count; i++)
 		{
-			if (featuresEqualNoData(featureId[i], id))
-			{
-				idxToRemove.push_back(i);
-			}
-			else
+			bool remove = featuresEqualNoData(featureId[i], id);
+			if (!remove)
 			{
 				s32 index;
 				EditorSector* sector = unpackFeatureId(featureId[i], &index);
 				const Vec2f& srcValue = sector->vtx[index];
+				remove = TFE_Polygon::vtxEqual(&value, &srcValue);
+			}
 
-				if (TFE_Polygon::vtxEqual(&value, &srcValue))
-				{
-					idxToRemove.push_back(i);
-				}
+			if (remove)
+			{
+				s_selectionKeys[SEL_VERTEX].erase(featureId[i] & FID_COMPARE_MASK);
+				std::unordered_map<FeatureId, s32>::iterator iKey = s_vertexKeys.find(featureId[i] & FID_COMPARE_MASK_NO_DATA);
+				if (iKey != s_vertexKeys.end() && --iKey->second <= 0) { s_vertexKeys.erase(iKey); }
+			}
+			else
+			{
+				featureId[outCount++] = featureId[i];
 			}
 		}
-		if (idxToRemove.empty()) { return false; }
-		const s32 delCount = (s32)idxToRemove.size();
-		const s32* idxList = idxToRemove.data();
-		for (s32 i = delCount - 1; i >= 0; i--)
-		{
-			s_selectionList2[SEL_VERTEX].erase(s_selectionList2[SEL_VERTEX].begin() + idxList[i]);
-		}
+		if (outCount == count) { return false; }
+
+		list.resize(outCount);
+		s_vertexCellsValid = false;
 		return true;
 	}
 
 	bool selection_isVertexInSet(FeatureId id)
 	{
-		// Insert the vertex if not found.
+		if (s_selectionHashEnabled)
+		{
+			return s_vertexKeys.find(id & FID_COMPARE_MASK_NO_DATA) != s_vertexKeys.end();
+		}
+
 		const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
 		const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
 		for (s32 i = 0; i < count; i++)
@@ -605,40 +620,167 @@ namespace LevelEditor
 		}
 		return false;
 	}
-		
-	bool selection_insertFeatureId(SelectionList& list, FeatureId id)
+
+	u64 vertexHash_getKey(s32 x, s32 z)
 	{
-		if (selection_isFeatureIdInSet(list, id)) { return false; }
-		list.push_back(id);
-		return true;
+		return u64(u32(x)) | (u64(u32(z)) << 32ull);
+	}
+
+	void vertexHash_add(FeatureId id, const Vec2f& pos)
+	{
+		const s32 x = (s32)floorf(pos.x);
+		const s32 z = (s32)floorf(pos.z);
+		s_vertexCells[vertexHash_getKey(x, z)].push_back(id);
+	}
+
+	void vertexHash_build()
+	{
+		s_vertexCells.clear();
+		const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
+		const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
+		for (s32 i = 0; i < count; i++)
+		{
+			s32 index;
+			EditorSector* sector = unpackFeatureId(featureId[i], &index);
+			vertexHash_add(featureId[i], sector->vtx[index]);
+		}
+		s_vertexCellsFrame = s_viewFrame;
+		s_vertexCellsValid = true;
+	}
+
+	// Returns true if a different vertex at the same position is already selected.
+	bool selection_isVertexOverlapped(Vec2f value)
+	{
+		if (!s_selectionHashEnabled)
+		{
+			const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
+			const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
+			for (s32 i = 0; i < count; i++)
+			{
+				s32 index;
+				EditorSector* sector = unpackFeatureId(featureId[i], &index);
+				if (TFE_Polygon::vtxEqual(&value, &sector->vtx[index])) { return true; }
+			}
+			return false;
+		}
+
+		if (!s_vertexCellsValid || s_vertexCellsFrame != s_viewFrame) { vertexHash_build(); }
+		const s32 x0 = (s32)floorf(value.x - c_vertexHashMargin), x1 = (s32)floorf(value.x + c_vertexHashMargin);
+		const s32 z0 = (s32)floorf(value.z - c_vertexHashMargin), z1 = (s32)floorf(value.z + c_vertexHashMargin);
+		for (s32 z = z0; z <= z1; z++)
+		{
+			for (s32 x = x0; x <= x1; x++)
+			{
+				std::unordered_map<u64, std::vector<FeatureId>>::const_iterator iCell = s_vertexCells.find(vertexHash_getKey(x, z));
+				if (iCell == s_vertexCells.end()) { continue; }
+
+				const s32 count = (s32)iCell->second.size();
+				const FeatureId* featureId = iCell->second.data();
+				for (s32 i = 0; i < count; i++)
+				{
+					s32 index;
+					EditorSector* sector = unpackFeatureId(featureId[i], &index);
+					if (TFE_Polygon::vtxEqual(&value, &sector->vtx[index])) { return true; }
+				}
+			}
+		}
+		return false;
+	}
+
+	void selection_addToList(SelectionListId listId, FeatureId id)
+	{
+		s_selectionList2[listId].push_back(id);
+		s_selectionKeys[listId].insert(id & FID_COMPARE_MASK);
+		if (listId == SEL_VERTEX)
+		{
+			s_vertexKeys[id & FID_COMPARE_MASK_NO_DATA]++;
+			if (s_vertexCellsValid)
+			{
+				s32 index;
+				EditorSector* sector = unpackFeatureId(id, &index);
+				vertexHash_add(id, sector->vtx[index]);
+			}
+		}
 	}
 
-	bool selection_removeFeatureId(SelectionList& list, FeatureId id)
+	void selection_clearList(SelectionListId listId)
 	{
-		s32 index;
-		selection_isFeatureIdInSet(list, id, &index);
-		if (index < 0) { return false; }
+		s_selectionList2[listId].clear();
+		s_selectionKeys[listId].clear();
+		if (listId == SEL_VERTEX)
+		{
+			s_vertexKeys.clear();
+			s_vertexCellsValid = false;
+		}
+	}
+
+	void selection_rebuildKeys(SelectionListId listId)
+	{
+		s_selectionKeys[listId].clear();
+		if (listId == SEL_VERTEX)
+		{
+			s_vertexKeys.clear();
+			s_vertexCellsValid = false;
+		}
 
-		list.erase(list.begin() + index);
+		const s32 count = (s32)s_selectionList2[listId].size();
+		const FeatureId* featureId = s_selectionList2[listId].data();
+		for (s32 i = 0; i < count; i++)
+		{
+			s_selectionKeys[listId].insert(featureId[i] & FID_COMPARE_MASK);
+			if (listId == SEL_VERTEX) { s_vertexKeys[featureId[i] & FID_COMPARE_MASK_NO_DATA]++; }
+		}
+	}
+		
+	bool selection_insertFeatureId(SelectionListId listId, FeatureId id)
+	{
+		if (selection_isFeatureIdInSet(listId, id)) { return false; }
+		selection_addToList(listId, id);
 		return true;
 	}
 
-	bool selection_isFeatureIdInSet(SelectionList& list, FeatureId id, s32* index)
+	bool selection_removeFeatureId(SelectionListId listId, FeatureId id)
 	{
+		if (!selection_isFeatureIdInSet(listId, id)) { return false; }
+
+		// The list order is kept, so removal still needs to find the entry.
+		SelectionList& list = s_selectionList2[listId];
 		const s32 count = (s32)list.size();
-		const FeatureId* listId = list.data();
-		if (index) { *index = -1; }
+		const FeatureId* entry = list.data();
 		for (s32 i = 0; i < count; i++)
 		{
-			if (featuresEqual(listId[i], id))
+			if (featuresEqual(entry[i], id))
 			{
-				if (index) { *index = i; }
+				if (listId == SEL_VERTEX)
+				{
+					std::unordered_map<FeatureId, s32>::iterator iKey = s_vertexKeys.find(entry[i] & FID_COMPARE_MASK_NO_DATA);
+					if (iKey != s_vertexKeys.end() && --iKey->second <= 0) { s_vertexKeys.erase(iKey); }
+					s_vertexCellsValid = false;
+				}
+				s_selectionKeys[listId].erase(id & FID_COMPARE_MASK);
+				list.erase(list.begin() + i);
 				return true;
 			}
 		}
 		return false;
 	}
 
+	bool selection_isFeatureIdInSet(SelectionListId listId, FeatureId id)
+	{
+		if (s_selectionHashEnabled)
+		{
+			return s_selectionKeys[listId].find(id & FID_COMPARE_MASK) != s_selectionKeys[listId].end();
+		}
+
+		const s32 count = (s32)s_selectionList2[listId].size();
+		const FeatureId* entry = s_selectionList2[listId].data();
+		for (s32 i = 0; i < count; i++)
+		{
+			if (featuresEqual(entry[i], id)) { return true; }
+		}
+		return false;
+	}
+
 	bool selection_featureId(SelectAction action, FeatureId id)
 	{
 		bool buildDerived = false;
@@ -647,39 +789,39 @@ namespace LevelEditor
 		{
 			case SA_SET:
 			{
-				s_selectionList2[s_currentSelection].clear();
-				actionDone = selection_insertFeatureId(s_selectionList2[s_currentSelection], id);
+				selection_clearList(s_currentSelection);
+				actionDone = selection_insertFeatureId(s_currentSelection, id);
 				buildDerived = actionDone;
 				infoPanel_clearSelection();
 			} break;
 			case SA_ADD:
 			{
-				actionDone = selection_insertFeatureId(s_selectionList2[s_currentSelection], id);
+				actionDone = selection_insertFeatureId(s_currentSelection, id);
 				buildDerived = actionDone;
 				infoPanel_clearSelection();
 			} break;
 			case SA_REMOVE:
 			{
-				actionDone = selection_removeFeatureId(s_selectionList2[s_currentSelection], id);
+				actionDone = selection_removeFeatureId(s_currentSelection, id);
 				buildDerived = actionDone;
 				infoPanel_clearSelection();
 			} break;
 			case SA_TOGGLE:
 			{
-				if (selection_isFeatureIdInSet(s_selectionList2[s_currentSelection], id))
+				if (selection_isFeatureIdInSet(s_currentSelection, id))
 				{
-					actionDone = selection_removeFeatureId(s_selectionList2[s_currentSelection], id);
+					actionDone = selection_removeFeatureId(s_currentSelection, id);
 				}
 				else
 				{
-					actionDone = selection_insertFeatureId(s_selectionList2[s_currentSelection], id);
+					actionDone = selection_insertFeatureId(s_currentSelection, id);
 				}
 				buildDerived = actionDone;
 				infoPanel_clearSelection();
 			} break;
 			case SA_CHECK_INCLUSION:
 			{
-				actionDone = selection_isFeatureIdInSet(s_selectionList2[s_currentSelection], id);
+				actionDone = selection_isFeatureIdInSet(s_currentSelection, id);
 			} break;
 			case SA_SET_HOVERED:
 			{
@@ -725,9 +867,9 @@ namespace LevelEditor
 			return;
 		}
 		// Clear any geometry selection that does not match the current selection.
-		if (s_currentSelection != SEL_VERTEX) { s_selectionList2[SEL_VERTEX].clear(); }
-		if (s_currentSelection != SEL_SURFACE) { s_selectionList2[SEL_SURFACE].clear(); }
-		if (s_currentSelection != SEL_SECTOR) { s_selectionList2[SEL_SECTOR].clear(); }
+		if (s_currentSelection != SEL_VERTEX) { selection_clearList(SEL_VERTEX); }
+		if (s_currentSelection != SEL_SURFACE) { selection_clearList(SEL_SURFACE); }
+		if (s_currentSelection != SEL_SECTOR) { selection_clearList(SEL_SECTOR); }
 
 		s_derivedBuildNeeded = true;
 	}
@@ -774,7 +916,7 @@ namespace LevelEditor
 				if (part != HP_FLOOR && part != HP_CEIL) { continue; }
 
 				FeatureId id = createFeatureId(sector);
-				selection_insertFeatureId(s_selectionList2[SEL_SECTOR], id);
+				selection_insertFeatureId(SEL_SECTOR, id);
 			}
 		}
 		else if (s_currentSelection == SEL_SECTOR)
@@ -792,10 +934,99 @@ namespace LevelEditor
 				for (s32 w = 0; w < wallCount; w++, wall++)
 				{
 					FeatureId id = createFeatureId(sector, w, HP_MID);
-					selection_insertFeatureId(s_selectionList2[SEL_SURFACE], id);
+					selection_insertFeatureId(SEL_SURFACE, id);
 					selection_insertWallVertices(sector, wall);
 				}
 			}
 		}
 	}
+
+	// Box select every vertex and then every sector in the level, checking inclusion of each as the viewport does when drawing.
+	// This runs once with linear list searches and once with the hashed sets, the timings and resulting selections are compared
+	// and the previous selection is restored afterward.
+	void selection_benchmarkBoxSelect()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		if (!sectorCount)
+		{
+			infoPanelAddMsg(LE_MSG_WARNING, "Box select benchmark requires a level.");
+			return;
+		}
+
+		SelectionList savedLists[SEL_COUNT];
+		for (s32 i = 0; i < SEL_COUNT; i++)
+		{
+			savedLists[i] = s_selectionList2[i];
+		}
+		const SelectionListId savedCurrent = s_currentSelection;
+		const bool savedDerivedBuildNeeded = s_derivedBuildNeeded;
+
+		f64 time[2];
+		s32 included[2];
+		std::vector<FeatureId> result[2];
+		benchmark_flagPasses(&s_selectionHashEnabled, time, [&](s32 pass)
+		{
+			included[pass] = 0;
+
+			// Vertices.
+			s_currentSelection = SEL_VERTEX;
+			selection_clear(SEL_GEO, false);
+			for (s32 s = 0; s < sectorCount; s++)
+			{
+				EditorSector* sector = &s_level.sectors[s];
+				if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
+
+				const s32 vtxCount = (s32)sector->vtx.size();
+				for (s32 v = 0; v < vtxCount; v++) { selection_vertex(SA_ADD, sector, v); }
+			}
+			for (s32 s = 0; s < sectorCount; s++)
+			{
+				EditorSector* sector = &s_level.sectors[s];
+				const s32 vtxCount = (s32)sector->vtx.size();
+				for (s32 v = 0; v < vtxCount; v++)
+				{
+					if (selection_vertex(SA_CHECK_INCLUSION, sector, v)) { included[pass]++; }
+				}
+			}
+			result[pass].insert(result[pass].end(), s_selectionList2[SEL_VERTEX].begin(), s_selectionList2[SEL_VERTEX].end());
+
+			// Sectors, which also select their walls and vertices.
+			s_currentSelection = SEL_SECTOR;
+			selection_clear(SEL_GEO, false);
+			for (s32 s = 0; s < sectorCount; s++)
+			{
+				EditorSector* sector = &s_level.sectors[s];
+				if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
+				selection_sector(SA_ADD, sector);
+			}
+			selection_buildDerived();
+			for (s32 s = 0; s < sectorCount; s++)
+			{
+				if (selection_sector(SA_CHECK_INCLUSION, &s_level.sectors[s])) { included[pass]++; }
+			}
+		},
+		[&](s32 pass)
+		{
+			for (s32 i = 0; i < SEL_GEO_COUNT; i++)
+			{
+				result[pass].insert(result[pass].end(), s_selectionList2[i].begin(), s_selectionList2[i].end());
+			}
+		});
+
+		for (s32 i = 0; i < SEL_COUNT; i++)
+		{
+			s_selectionList2[i] = savedLists[i];
+			selection_rebuildKeys(SelectionListId(i));
+		}
+		s_currentSelection = savedCurrent;
+		s_derivedBuildNeeded = savedDerivedBuildNeeded;
+		edit_setTransformChange();
+		infoPanel_clearSelection();
+
+		const bool match = included[0] == included[1] && result[0] == result[1];
+		infoPanelAddMsg(match ? LE_MSG_INFO : LE_MSG_ERROR, "Box select benchmark: %d sectors, %d features selected. Linear: %0.2f ms, Hashed: %0.2f ms, results %s.",
+			sectorCount, (s32)result[1].size(), time[0], time[1], match ? "match" : "differ");
+		TFE_System::logWrite(LOG_MSG, "LevelEditor", "Box select benchmark: %d sectors. Linear: %0.2f ms (%d features, %d included), Hashed: %0.2f ms (%d features, %d included).",
+			sectorCount, time[0], (s32)result[0].size(), included[0], time[1], (s32)result[1].size(), included[1]);
+	}
 }
@@ -100,4 +100,7 @@ namespace LevelEditor
 
 	// List interface.
 	u32  selection_getList(FeatureId*& list, SelectionListId id = SEL_CURRENT);
+
+	// Time box selecting the whole level with linear and hashed membership tests, the results are reported in the info panel.
+	void selection_benchmarkBoxSelect();
 }
@@ -6,13 +6,24 @@
 #include <algorithm>
 #include <cstring>
 #include <string>
+#include <map>
 
 namespace TFE_Editor
 {
 	enum
 	{
 		CMD_MAX_DEPTH = 64,
+		// Checkpoints are hidden snapshots attached to regular commands so that undo/redo does not
+		// have to replay every command back to the last real snapshot.
+		CHECKPOINT_MAX_COMMANDS = 16,					// Maximum commands replayed before a checkpoint is added.
+		CHECKPOINT_MEMORY_BUDGET = 64 * 1024 * 1024,	// Least recently used checkpoints are evicted past this.
+		CHECKPOINT_ID_BASE = 0x40000000,				// Snapshot IDs passed to the client for checkpoints.
+		SNAPSHOT_CACHE_SIZE = 4,						// Recently decompressed snapshots and checkpoints.
 	};
+	// Estimated replay time before a checkpoint is added, in seconds.
+	static const f64 c_checkpointReplayBudget = 0.020;
+	// Assumed command cost until a command has been timed.
+	static const f64 c_defaultCmdCost = 0.001;
 
 	struct Snapshot
 	{
@@ -22,6 +33,20 @@ namespace TFE_Editor
 		std::vector<u8> compressedData;
 	};
 
+	struct Checkpoint
+	{
+		s32 id;
+		u64 lastUse;
+		Snapshot snapshot;
+	};
+
+	struct SnapshotCacheEntry
+	{
+		s32 id;
+		u64 lastUse;
+		std::vector<u8> data;
+	};
+
 	struct CommandHeader
 	{
 		u16 cmdId;
@@ -45,6 +70,20 @@ namespace TFE_Editor
 	u32 s_curBufferAddr = 0;
 	u32 s_curSnapshot = 0;
 
+	// Checkpoints by history position.
+	static std::map<u32, Checkpoint> s_checkpoints;
+	static size_t s_checkpointMemory = 0;
+	static s32 s_nextCheckpointId = 0;
+	static u64 s_useCounter = 0;
+	static bool s_merging = false;
+	static u32 s_changeCount = 0;
+	// Measured replay time per command ID.
+	static std::vector<f64> s_cmdCost;
+	static SnapshotCacheEntry s_snapshotCache[SNAPSHOT_CACHE_SIZE];
+
+	void clearCheckpoints();
+	void compressSnapshot(Snapshot* snapshot, u32 size, const void* data);
+
 	void history_init(UnpackSnapshotFunc snapshotUnpackFunc, CreateSnapshotFunc createSnapshotFunc)
 	{
 		s_snapshotUnpack = snapshotUnpackFunc;
@@ -60,17 +99,20 @@ namespace TFE_Editor
 
 	void history_destroy()
 	{
+		clearCheckpoints();
 	}
 
 	void history_clear()
 	{
 		// Clear the history, historyBuffer, and snapshots.
+		clearCheckpoints();
 		s_snapShots.clear();
 		s_history.clear();
 		s_historyBuffer.clear();
 		s_curPosInHistory = 0;
 		s_curBufferAddr = 0;
 		s_curSnapshot = 0;
+		s_changeCount++;
 		// Clear the previous snapshot index.
 		if (s_snapshotUnpack)
 		{
@@ -93,6 +135,7 @@ namespace TFE_Editor
 			}
 		}
 		s_cmdFunc[id] = func;
+		s_cmdCost.resize(s_cmdFunc.size(), 0.0);
 	}
 
 	void history_registerName(u16 id, const char* name)
@@ -150,29 +193,199 @@ namespace TFE_Editor
 		s_curBufferAddr = bufferAddr;
 	}
 		
-	// Create new commands and snapshots.
-	s32 history_createSnapshotInternal(u32 size, void* data, const char* name/*=nullptr*/)
+	void compressSnapshot(Snapshot* snapshot, u32 size, const void* data)
 	{
-		u16 parentId = u16(s_curPosInHistory);
-
-		Snapshot snapshot = {};
-		snapshot.uncompressedSize = size;
+		snapshot->uncompressedSize = size;
 
 		bool useUncompressed = true;
-		if (zstd_compress(snapshot.compressedData, (u8*)data, size, 4))
+		if (zstd_compress(snapshot->compressedData, (u8*)data, size, 4))
 		{
-			if (snapshot.compressedData.size() < size)
+			if (snapshot->compressedData.size() < size)
 			{
 				useUncompressed = false;
-				snapshot.compressedSize = (u32)snapshot.compressedData.size();
+				snapshot->compressedSize = (u32)snapshot->compressedData.size();
 			}
 		}
 		if (useUncompressed)
 		{
-			snapshot.compressedSize = size;
-			snapshot.compressedData.resize(size);
-			memcpy(snapshot.compressedData.data(), data, size);
+			snapshot->compressedSize = size;
+			snapshot->compressedData.resize(size);
+			memcpy(snapshot->compressedData.data(), data, size);
+		}
+	}
+
+	//////////////////////////////////////
+	// Snapshot cache
+	//////////////////////////////////////
+	void snapshotCache_clear()
+	{
+		for (s32 i = 0; i < SNAPSHOT_CACHE_SIZE; i++)
+		{
+			s_snapshotCache[i].id = -1;
+			s_snapshotCache[i].lastUse = 0;
+			s_snapshotCache[i].data.clear();
+		}
+	}
+
+	// Returns the least recently used entry if the ID is not in the cache.
+	SnapshotCacheEntry* snapshotCache_find(s32 id, bool& found)
+	{
+		SnapshotCacheEntry* oldest = &s_snapshotCache[0];
+		for (s32 i = 0; i < SNAPSHOT_CACHE_SIZE; i++)
+		{
+			if (s_snapshotCache[i].id == id)
+			{
+				found = true;
+				s_snapshotCache[i].lastUse = ++s_useCounter;
+				return &s_snapshotCache[i];
+			}
+			if (s_snapshotCache[i].lastUse < oldest->lastUse)
+			{
+				oldest = &s_snapshotCache[i];
+			}
+		}
+		found = false;
+		oldest->id = id;
+		oldest->lastUse = ++s_useCounter;
+		return oldest;
+	}
+
+	void snapshotCache_remove(s32 id)
+	{
+		for (s32 i = 0; i < SNAPSHOT_CACHE_SIZE; i++)
+		{
+			if (s_snapshotCache[i].id == id)
+			{
+				s_snapshotCache[i].id = -1;
+				s_snapshotCache[i].lastUse = 0;
+			}
+		}
+	}
+
+	// Unpack a snapshot or checkpoint, decompressing it only if it is not in the cache.
+	void unpackSnapshot(s32 id, Snapshot* snapshot)
+	{
+		if (snapshot->uncompressedSize <= snapshot->compressedSize)
+		{
+			s_snapshotUnpack(id, snapshot->compressedSize, snapshot->compressedData.data());
+			return;
+		}
+
+		bool found;
+		SnapshotCacheEntry* entry = snapshotCache_find(id, found);
+		if (!found)
+		{
+			entry->data.resize(snapshot->uncompressedSize);
+			if (!zstd_decompress(entry->data.data(), snapshot->uncompressedSize, snapshot->compressedData.data(), snapshot->compressedSize))
+			{
+				entry->id = -1;
+				entry->lastUse = 0;
+				return;
+			}
+		}
+		s_snapshotUnpack(id, snapshot->uncompressedSize, entry->data.data());
+	}
+
+	//////////////////////////////////////
+	// Checkpoints
+	//////////////////////////////////////
+	void clearCheckpoints()
+	{
+		s_checkpoints.clear();
+		s_checkpointMemory = 0;
+		snapshotCache_clear();
+		s_merging = false;
+	}
+
+	void removeCheckpoint(std::map<u32, Checkpoint>::iterator iCheckpoint)
+	{
+		snapshotCache_remove(iCheckpoint->second.id);
+		s_checkpointMemory -= iCheckpoint->second.snapshot.compressedData.size();
+		s_checkpoints.erase(iCheckpoint);
+	}
+
+	void removeCheckpointsFrom(u32 pos)
+	{
+		while (!s_checkpoints.empty())
+		{
+			std::map<u32, Checkpoint>::iterator iLast = std::prev(s_checkpoints.end());
+			if (iLast->first < pos) { break; }
+			removeCheckpoint(iLast);
 		}
+	}
+
+	// Evict the least recently used checkpoints until the memory use is back in budget.
+	// This only makes replaying more expensive, the real snapshots are always kept.
+	void evictCheckpoints()
+	{
+		while (s_checkpointMemory > CHECKPOINT_MEMORY_BUDGET && !s_checkpoints.empty())
+		{
+			std::map<u32, Checkpoint>::iterator iOldest = s_checkpoints.begin();
+			for (std::map<u32, Checkpoint>::iterator iCheckpoint = s_checkpoints.begin(); iCheckpoint != s_checkpoints.end(); ++iCheckpoint)
+			{
+				if (iCheckpoint->second.lastUse < iOldest->second.lastUse)
+				{
+					iOldest = iCheckpoint;
+				}
+			}
+			removeCheckpoint(iOldest);
+		}
+	}
+
+	// Capture the current state as a checkpoint for the history position.
+	void createCheckpoint(u32 pos)
+	{
+		s_snapshotBuffer.clear();
+		s_snapshotCreate(&s_snapshotBuffer);
+		if (s_snapshotBuffer.empty()) { return; }
+
+		Checkpoint& checkpoint = s_checkpoints[pos];
+		checkpoint.id = CHECKPOINT_ID_BASE + s_nextCheckpointId;
+		checkpoint.lastUse = ++s_useCounter;
+		s_nextCheckpointId = (s_nextCheckpointId + 1) & (CHECKPOINT_ID_BASE - 1);
+		compressSnapshot(&checkpoint.snapshot, (u32)s_snapshotBuffer.size(), s_snapshotBuffer.data());
+		s_checkpointMemory += checkpoint.snapshot.compressedData.size();
+
+		// The uncompressed data is already available, so add it to the cache.
+		if (checkpoint.snapshot.uncompressedSize > checkpoint.snapshot.compressedSize)
+		{
+			bool found;
+			SnapshotCacheEntry* entry = snapshotCache_find(checkpoint.id, found);
+			entry->data = s_snapshotBuffer;
+		}
+		evictCheckpoints();
+	}
+
+	Checkpoint* getCheckpoint(u32 pos)
+	{
+		std::map<u32, Checkpoint>::iterator iCheckpoint = s_checkpoints.find(pos);
+		return iCheckpoint != s_checkpoints.end() ? &iCheckpoint->second : nullptr;
+	}
+
+	// Estimate the cost of restoring the state at 'pos', from the nearest snapshot or checkpoint.
+	void getReplayCost(u32 pos, f64& cost, s32& count)
+	{
+		cost = 0.0;
+		count = 0;
+		while (count <= CMD_MAX_DEPTH)
+		{
+			const CommandHeader* header = (const CommandHeader*)(s_historyBuffer.data() + s_history[pos]);
+			if (header->cmdId == CMD_SNAPSHOT || getCheckpoint(pos)) { break; }
+
+			const f64 cmdCost = header->cmdId < s_cmdCost.size() ? s_cmdCost[header->cmdId] : 0.0;
+			cost += cmdCost > 0.0 ? cmdCost : c_defaultCmdCost;
+			count++;
+			pos = header->parentId;
+		}
+	}
+
+	// Create new commands and snapshots.
+	s32 history_createSnapshotInternal(u32 size, void* data, const char* name/*=nullptr*/)
+	{
+		u16 parentId = u16(s_curPosInHistory);
+
+		Snapshot snapshot = {};
+		compressSnapshot(&snapshot, size, data);
 
 		if (name)
 		{
@@ -197,6 +410,7 @@ namespace TFE_Editor
 		assert(s_history.size() > 0 && parentId >= 0);
 		s_curPosInHistory = u16(s_history.size() - 1);
 		hideRange(parentId + 1, s_curPosInHistory);
+		s_changeCount++;
 
 		return id;
 	}
@@ -233,7 +447,23 @@ namespace TFE_Editor
 		assert(s_history.size() > 0);
 		s_curPosInHistory = u16(s_history.size() - 1);
 		hideRange(parentId + 1, s_curPosInHistory);
-
+		s_changeCount++;
+
+		// The command has already been applied, so the current state can be used as a checkpoint.
+		// Commands replacing a merged command are skipped since they tend to be replaced again right away,
+		// the next regular command picks up the checkpoint instead.
+		const bool merging = s_merging;
+		s_merging = false;
+		if (!merging)
+		{
+			f64 cost;
+			s32 count;
+			getReplayCost(s_curPosInHistory, cost, count);
+			if (cost >= c_checkpointReplayBudget || count >= CHECKPOINT_MAX_COMMANDS)
+			{
+				createCheckpoint(s_curPosInHistory);
+			}
+		}
 		return true;
 	}
 
@@ -331,9 +561,13 @@ namespace TFE_Editor
 	{
 		assert(pos >= 0 && pos < (s32)s_history.size());
 		s_curPosInHistory = pos;
+		s_changeCount++;
+
+		s_merging = false;
 
-		// 1. Traverse backward through the parentIds until a snapshot is reached.
+		// 1. Traverse backward through the parentIds until a snapshot or checkpoint is reached.
 		u16 cmdList[257], listCount = 0;
+		Checkpoint* checkpoint = nullptr;
 		while (listCount <= 256)
 		{
 			cmdList[listCount++] = pos;
@@ -342,39 +576,51 @@ namespace TFE_Editor
 			if (header->cmdId == CMD_SNAPSHOT) { break; }
 			assert(header->cmdId < s_cmdFunc.size());
 
+			checkpoint = getCheckpoint(pos);
+			if (checkpoint) { break; }
+
 			pos = header->parentId;
 		}
 		assert(listCount <= 256);
 
 		// 2. Go backward towards the snapshot...
+		const u64 startTick = TFE_System::getCurrentTimeInTicks();
 		for (s32 i = (s32)listCount - 1; i >= 0; i--)
 		{
 			const CommandHeader* cmdHeader = hBuffer_getHeader(cmdList[i]);
-			assert(i != (s32)listCount - 1 || cmdHeader->cmdId == CMD_SNAPSHOT);
+			assert(i != (s32)listCount - 1 || cmdHeader->cmdId == CMD_SNAPSHOT || checkpoint);
 
-			if (cmdHeader->cmdId == CMD_SNAPSHOT)
+			if (i == (s32)listCount - 1 && checkpoint)
+			{
+				// The checkpoint holds the state after the command was applied.
+				checkpoint->lastUse = ++s_useCounter;
+				unpackSnapshot(checkpoint->id, &checkpoint->snapshot);
+			}
+			else if (cmdHeader->cmdId == CMD_SNAPSHOT)
 			{
 				const s32 id = cmdHeader->cmdName;
-				Snapshot* snapshot = &s_snapShots[id];
-				if (snapshot->uncompressedSize > snapshot->compressedSize)
-				{
-					s_snapshotBuffer.resize(snapshot->uncompressedSize);
-					if (zstd_decompress(s_snapshotBuffer.data(), snapshot->uncompressedSize, snapshot->compressedData.data(), snapshot->compressedSize))
-					{
-						s_snapshotUnpack(id, snapshot->uncompressedSize, s_snapshotBuffer.data());
-					}
-				}
-				else
-				{
-					s_snapshotUnpack(id, snapshot->compressedSize, snapshot->compressedData.data());
-				}
+				unpackSnapshot(id, &s_snapShots[id]);
 			}
 			else
 			{
 				assert(cmdHeader->cmdId < s_cmdFunc.size() && s_cmdFunc[cmdHeader->cmdId]);
-				s_cmdFunc[cmdHeader->cmdId]();
+				const u16 cmdId = cmdHeader->cmdId;
+				const u64 cmdStart = TFE_System::getCurrentTimeInTicks();
+				s_cmdFunc[cmdId]();
+
+				// Keep a running average of the command cost, used to decide when to add checkpoints.
+				const f64 cmdCost = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - cmdStart);
+				s_cmdCost[cmdId] = s_cmdCost[cmdId] > 0.0 ? s_cmdCost[cmdId] * 0.75 + cmdCost * 0.25 : cmdCost;
 			}
 		}
+
+		// Restoring this position was expensive, keep the result as a checkpoint for next time.
+		const f64 replayTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - startTick);
+		const CommandHeader* posHeader = hBuffer_getHeader(s_curPosInHistory);
+		if (replayTime >= c_checkpointReplayBudget && posHeader->cmdId != CMD_SNAPSHOT && !getCheckpoint(s_curPosInHistory))
+		{
+			createCheckpoint(s_curPosInHistory);
+		}
 	}
 
 	u32 history_getItemCount()
@@ -382,9 +628,16 @@ namespace TFE_Editor
 		return (u32)s_history.size();
 	}
 
+	u32 history_getChangeCount()
+	{
+		return s_changeCount;
+	}
+
 	void history_removeLast()
 	{
 		const u32 prevAddr = s_history.back();
+		removeCheckpointsFrom((u32)s_history.size() - 1);
+		s_merging = true;
 		s_history.pop_back();
 		s_historyBuffer.resize(prevAddr);
 
@@ -392,6 +645,7 @@ namespace TFE_Editor
 		s_curPosInHistory--;
 
 		s_curBufferAddr = (u32)s_historyBuffer.size();
+		s_changeCount++;
 	}
 
 	void history_collapse()
@@ -421,10 +675,13 @@ namespace TFE_Editor
 		}
 
 		// Resize the history buffer.
+		removeCheckpointsFrom(pos + 1);
+		snapshotCache_clear();
 		s_historyBuffer.resize(s_history[pos+1]);
 		s_history.resize(pos + 1);
 		s_curBufferAddr = (u32)s_historyBuffer.size();
 		s_curPosInHistory = pos;
+		s_changeCount++;
 
 		// Then resize the snapshots.
 		if (snapShotMin < 0xffff)
@@ -474,6 +731,7 @@ namespace TFE_Editor
 			size += sizeof(Snapshot);
 		}
 		size += (u32)s_history.size() * sizeof(u32);
+		size += (u32)s_checkpointMemory;
 		return size;
 	}
 
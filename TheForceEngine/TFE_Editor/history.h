@@ -52,6 +52,8 @@ namespace TFE_Editor
 	s32  history_getPos();
 	u32  history_getSize();
 	u32  history_getItemCount();
+	// Incremented whenever the history or the current position changes (new commands, undo/redo, clearing).
+	u32  history_getChangeCount();
 	void history_collapseToPos(s32 pos);
 	void history_collapse();
 	const char* history_getItemNameAndState(u32 index, u32& parentId, bool& isHidden);
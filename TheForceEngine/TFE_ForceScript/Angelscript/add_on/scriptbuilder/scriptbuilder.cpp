@@ -1,4 +1,5 @@
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_System/hash.h>
 #include "scriptbuilder.h"
 #include <vector>
 #include <assert.h>
@@ -35,6 +36,7 @@ CScriptBuilder::CScriptBuilder()
 	pragmaParam = 0;
 
 	readStd = true;
+	sourceHash = TFE_Hash::FNV_OFFSET_BASIS;
 }
 
 void CScriptBuilder::SetIncludeCallback(INCLUDECALLBACK_t callback, void *userParam)
@@ -68,6 +70,11 @@ void CScriptBuilder::SetReadMode(bool _readStd)
 	readStd = _readStd;
 }
 
+unsigned long long CScriptBuilder::GetSourceHash() const
+{
+	return sourceHash;
+}
+
 asIScriptEngine *CScriptBuilder::GetEngine()
 {
 	return engine;
@@ -159,6 +166,7 @@ void CScriptBuilder::DefineWord(const char *word)
 void CScriptBuilder::ClearAll()
 {
 	includedScripts.clear();
+	sourceHash = TFE_Hash::FNV_OFFSET_BASIS;
 
 #if AS_PROCESS_METADATA == 1
 	currentClass = "";
@@ -585,6 +593,8 @@ int CScriptBuilder::ProcessScriptSection(const char *script, unsigned int length
 
 	// Build the actual script
 	engine->SetEngineProperty(asEP_COPY_SCRIPT_SECTIONS, true);
+	sourceHash = TFE_Hash::fnv1a64(sectionname, sourceHash);
+	sourceHash = TFE_Hash::fnv1a64(modifiedScript.c_str(), modifiedScript.size(), sourceHash);
 	module->AddScriptSection(sectionname, modifiedScript.c_str(), modifiedScript.size(), lineOffset);
 
 	if( includes.size() > 0 )
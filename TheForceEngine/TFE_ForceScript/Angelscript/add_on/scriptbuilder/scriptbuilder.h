@@ -101,6 +101,10 @@ public:
 	unsigned int GetSectionCount() const;
 	std::string  GetSectionName(unsigned int idx) const;
 
+	// TFE: Hash of all of the (pre-processed) script sections added since the module was started,
+	// used to key the bytecode cache.
+	unsigned long long GetSourceHash() const;
+
 #if AS_PROCESS_METADATA == 1
 	// Get metadata declared for classes, interfaces, and enums
 	std::vector<std::string> GetMetadataForType(int typeId);
@@ -131,6 +135,7 @@ protected:
 	void OverwriteCode(int start, int len);
 
 	bool readStd;
+	unsigned long long         sourceHash;
 	asIScriptEngine           *engine;
 	asIScriptModule           *module;
 	std::string                modifiedScript;
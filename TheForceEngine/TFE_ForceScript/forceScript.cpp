@@ -6,6 +6,10 @@
 #include "float3x3.h"
 #include "float4x4.h"
 #include <TFE_System/system.h>
+#include <TFE_System/hash.h>
+#include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_Jedi/Serialization/serialization.h>
 #include <stdint.h>
@@ -43,6 +47,10 @@ namespace TFE_ForceScript
 	std::vector<ModuleDef> s_modules;
 
 	static asIScriptEngine* s_engine = nullptr;
+	// The registered API only grows until the engine is destroyed, so the bytecode cache computes its hash
+	// once per registration state instead of on every build. See getApiHash().
+	static u64 s_apiHash = 0;
+	static u32 s_apiHashCounts[6] = { 0 };
 	static std::vector<ScriptThread> s_scriptThreads;
 	static std::vector<s32> s_freeThreads;
 	ScriptMessageCallback s_msgCallback = nullptr;
@@ -136,6 +144,8 @@ namespace TFE_ForceScript
 		s_typeId[FSTYPE_FLOAT4x4] = getFloat4x4ObjectId();
 
 		s_modules.clear();
+		s_apiHash = 0;
+		memset(s_apiHashCounts, 0, sizeof(s_apiHashCounts));
 	}
 
 	void destroy()
@@ -707,6 +717,11 @@ namespace TFE_ForceScript
 		return s_engine->GetModule(moduleName);
 	}
 
+	s32 getModuleCount()
+	{
+		return (s32)s_modules.size();
+	}
+
 	void deleteModule(const char* moduleName)
 	{
 		asIScriptModule* mod = s_engine->GetModule(moduleName);
@@ -724,6 +739,336 @@ namespace TFE_ForceScript
 		}
 	}
 				
+	/////////////////////////////////////////////////////////
+	// Bytecode Cache
+	// Compiled modules are saved to PATH_PROGRAM_DATA/ScriptCache/
+	// and reloaded instead of compiling from source, as long as the
+	// source, engine version and registered script API match.
+	// File names are the hash of the source and the build state, so
+	// modules that share a name (such as every "LevelScript") each keep
+	// their own entry. The oldest files are removed past a fixed count.
+	/////////////////////////////////////////////////////////
+	enum BytecodeCacheConst : u32
+	{
+		BYTECODE_CACHE_MAGIC   = 0x43534654,	// "TFSC"
+		BYTECODE_CACHE_VERSION = 1,
+		BYTECODE_CACHE_MAX_FILES = 64,
+	};
+
+	struct BytecodeCacheHeader
+	{
+		u32 magic;
+		u32 version;
+		u64 sourceHash;
+		u64 engineHash;
+		u64 apiHash;
+		u32 accessMask;
+		u32 bytecodeSize;
+	};
+
+	// Write bytecode into a memory buffer, it is written to disk once complete.
+	class BytecodeWriteStream : public asIBinaryStream
+	{
+	public:
+		std::vector<u8> buffer;
+
+		int Read(void*, asUINT) override { return -1; }
+		int Write(const void* ptr, asUINT size) override
+		{
+			if (!size) { return 0; }
+			const size_t offset = buffer.size();
+			buffer.resize(offset + size);
+			memcpy(buffer.data() + offset, ptr, size);
+			return 0;
+		}
+	};
+
+	// Read bytecode from a memory buffer.
+	class BytecodeReadStream : public asIBinaryStream
+	{
+	public:
+		BytecodeReadStream(const u8* data, u32 size) : m_data(data), m_size(size), m_offset(0) {}
+
+		int Write(const void*, asUINT) override { return -1; }
+		int Read(void* ptr, asUINT size) override
+		{
+			if (m_offset + size > m_size) { return -1; }
+			memcpy(ptr, m_data + m_offset, size);
+			m_offset += size;
+			return 0;
+		}
+
+	private:
+		const u8* m_data;
+		u32 m_size;
+		u32 m_offset;
+	};
+
+	// Engine and AngelScript version, a new build always invalidates the cache.
+	u64 computeEngineHash()
+	{
+		u64 hash = TFE_Hash::fnv1a64(TFE_System::getVersionString());
+		hash = TFE_Hash::fnv1a64(ANGELSCRIPT_VERSION_STRING, hash);
+		hash = TFE_Hash::fnv1a64Value((u32)sizeof(void*), hash);
+		return hash;
+	}
+
+	// The bytecode references application registered functions, types and properties,
+	// so the cache is only valid if the registered API is unchanged.
+	u64 computeApiHash()
+	{
+		u64 hash = TFE_Hash::FNV_OFFSET_BASIS;
+		const u32 funcCount = s_engine->GetGlobalFunctionCount();
+		for (u32 f = 0; f < funcCount; f++)
+		{
+			const asIScriptFunction* func = s_engine->GetGlobalFunctionByIndex(f);
+			hash = TFE_Hash::fnv1a64(func->GetDeclaration(true, true, true), hash);
+			hash = TFE_Hash::fnv1a64Value(func->GetAccessMask(), hash);
+		}
+
+		const u32 propCount = s_engine->GetGlobalPropertyCount();
+		for (u32 p = 0; p < propCount; p++)
+		{
+			const char* name = nullptr;
+			const char* nameSpace = nullptr;
+			s32 typeId = 0;
+			bool isConst = false;
+			asDWORD accessMask = 0;
+			s_engine->GetGlobalPropertyByIndex(p, &name, &nameSpace, &typeId, &isConst, nullptr, nullptr, &accessMask);
+			hash = TFE_Hash::fnv1a64(name, hash);
+			hash = TFE_Hash::fnv1a64(nameSpace, hash);
+			hash = TFE_Hash::fnv1a64(s_engine->GetTypeDeclaration(typeId, true), hash);
+			hash = TFE_Hash::fnv1a64Value(isConst, hash);
+			hash = TFE_Hash::fnv1a64Value(accessMask, hash);
+		}
+
+		const u32 typeCount = s_engine->GetObjectTypeCount();
+		for (u32 t = 0; t < typeCount; t++)
+		{
+			const asITypeInfo* type = s_engine->GetObjectTypeByIndex(t);
+			hash = TFE_Hash::fnv1a64(type->GetNamespace(), hash);
+			hash = TFE_Hash::fnv1a64(type->GetName(), hash);
+			hash = TFE_Hash::fnv1a64Value(type->GetFlags(), hash);
+			hash = TFE_Hash::fnv1a64Value(type->GetSize(), hash);
+			hash = TFE_Hash::fnv1a64Value(type->GetAccessMask(), hash);
+
+			const u32 factoryCount = type->GetFactoryCount();
+			for (u32 i = 0; i < factoryCount; i++)
+			{
+				hash = TFE_Hash::fnv1a64(type->GetFactoryByIndex(i)->GetDeclaration(false, true, true), hash);
+			}
+			const u32 behaviourCount = type->GetBehaviourCount();
+			for (u32 i = 0; i < behaviourCount; i++)
+			{
+				asEBehaviours behaviour;
+				const asIScriptFunction* func = type->GetBehaviourByIndex(i, &behaviour);
+				hash = TFE_Hash::fnv1a64Value((s32)behaviour, hash);
+				hash = TFE_Hash::fnv1a64(func->GetDeclaration(false, true, true), hash);
+			}
+			const u32 methodCount = type->GetMethodCount();
+			for (u32 i = 0; i < methodCount; i++)
+			{
+				hash = TFE_Hash::fnv1a64(type->GetMethodByIndex(i, false)->GetDeclaration(false, true, true), hash);
+			}
+			const u32 typePropCount = type->GetPropertyCount();
+			for (u32 i = 0; i < typePropCount; i++)
+			{
+				s32 offset = 0;
+				type->GetProperty(i, nullptr, nullptr, nullptr, nullptr, &offset);
+				hash = TFE_Hash::fnv1a64(type->GetPropertyDeclaration(i, true), hash);
+				hash = TFE_Hash::fnv1a64Value(offset, hash);
+			}
+		}
+
+		const u32 enumCount = s_engine->GetEnumCount();
+		for (u32 e = 0; e < enumCount; e++)
+		{
+			const asITypeInfo* type = s_engine->GetEnumByIndex(e);
+			hash = TFE_Hash::fnv1a64(type->GetNamespace(), hash);
+			hash = TFE_Hash::fnv1a64(type->GetName(), hash);
+			const u32 valueCount = type->GetEnumValueCount();
+			for (u32 v = 0; v < valueCount; v++)
+			{
+				s32 value = 0;
+				hash = TFE_Hash::fnv1a64(type->GetEnumValueByIndex(v, &value), hash);
+				hash = TFE_Hash::fnv1a64Value(value, hash);
+			}
+		}
+
+		const u32 funcdefCount = s_engine->GetFuncdefCount();
+		for (u32 f = 0; f < funcdefCount; f++)
+		{
+			const asITypeInfo* type = s_engine->GetFuncdefByIndex(f);
+			hash = TFE_Hash::fnv1a64(type->GetFuncdefSignature()->GetDeclaration(true, true, true), hash);
+		}
+
+		const u32 typedefCount = s_engine->GetTypedefCount();
+		for (u32 t = 0; t < typedefCount; t++)
+		{
+			const asITypeInfo* type = s_engine->GetTypedefByIndex(t);
+			hash = TFE_Hash::fnv1a64(type->GetNamespace(), hash);
+			hash = TFE_Hash::fnv1a64(type->GetName(), hash);
+			hash = TFE_Hash::fnv1a64Value(type->GetTypedefTypeId(), hash);
+		}
+		return hash;
+	}
+
+	// Only recompute the API hash if something was registered since the last time.
+	u64 getApiHash()
+	{
+		const u32 counts[] =
+		{
+			s_engine->GetGlobalFunctionCount(), s_engine->GetGlobalPropertyCount(), s_engine->GetObjectTypeCount(),
+			s_engine->GetEnumCount(), s_engine->GetFuncdefCount(), s_engine->GetTypedefCount()
+		};
+		if (!s_apiHash || memcmp(counts, s_apiHashCounts, sizeof(counts)) != 0)
+		{
+			s_apiHash = computeApiHash();
+			memcpy(s_apiHashCounts, counts, sizeof(counts));
+		}
+		return s_apiHash;
+	}
+
+	void getBytecodeCachePath(const char* moduleName, const BytecodeCacheHeader& header, char* path)
+	{
+		u64 key = TFE_Hash::fnv1a64Value(header.sourceHash);
+		key = TFE_Hash::fnv1a64(moduleName, key);
+		key = TFE_Hash::fnv1a64Value(header.engineHash, key);
+		key = TFE_Hash::fnv1a64Value(header.apiHash, key);
+		key = TFE_Hash::fnv1a64Value(header.accessMask, key);
+		sprintf(path, "%sScriptCache/%016llx.fsc", TFE_Paths::getPath(PATH_PROGRAM_DATA), (unsigned long long)key);
+	}
+
+	// Keep at most BYTECODE_CACHE_MAX_FILES entries, removing the oldest first.
+	// Files named by older versions of the cache are always removed.
+	void pruneBytecodeCache(const char* cacheDir)
+	{
+		const size_t nameLen = 20;	// 16 hex digits + ".fsc"
+
+		FileList fileList;
+		FileUtil::readDirectory(cacheDir, "fsc", fileList);
+		std::vector<std::pair<u64, std::string>> files;
+		for (size_t i = 0; i < fileList.size(); i++)
+		{
+			char path[TFE_MAX_PATH];
+			sprintf(path, "%s%s", cacheDir, fileList[i].c_str());
+			if (fileList[i].length() != nameLen)
+			{
+				FileUtil::deleteFile(path);
+				continue;
+			}
+			files.push_back({ FileUtil::getModifiedTime(path), path });
+		}
+		if (files.size() <= BYTECODE_CACHE_MAX_FILES) { return; }
+		std::sort(files.begin(), files.end());
+
+		const size_t removeCount = files.size() - BYTECODE_CACHE_MAX_FILES;
+		for (size_t i = 0; i < removeCount; i++)
+		{
+			FileUtil::deleteFile(files[i].second.c_str());
+		}
+	}
+
+	// Returns true if the module was loaded from the cache.
+	bool loadModuleFromCache(asIScriptModule* mod, const char* cachePath, const BytecodeCacheHeader& expected)
+	{
+		if (!FileUtil::exists(cachePath)) { return false; }
+
+		u8* data = nullptr;
+		const u32 size = FileStream::readContents(cachePath, (void**)&data);
+		if (!data) { return false; }
+
+		bool loaded = false;
+		const BytecodeCacheHeader* header = (const BytecodeCacheHeader*)data;
+		if (size >= sizeof(BytecodeCacheHeader) && header->magic == expected.magic && header->version == expected.version &&
+			header->sourceHash == expected.sourceHash && header->engineHash == expected.engineHash && header->apiHash == expected.apiHash &&
+			header->accessMask == expected.accessMask && header->bytecodeSize == size - sizeof(BytecodeCacheHeader))
+		{
+			BytecodeReadStream stream(data + sizeof(BytecodeCacheHeader), header->bytecodeSize);
+			loaded = mod->LoadByteCode(&stream) >= 0;
+			if (!loaded)
+			{
+				TFE_System::logWrite(LOG_WARNING, "Force Script", "Bytecode cache '%s' for module '%s' is invalid, recompiling.", cachePath, mod->GetName());
+			}
+		}
+		free(data);
+		return loaded;
+	}
+
+	void saveModuleToCache(asIScriptModule* mod, const char* cachePath, BytecodeCacheHeader& header)
+	{
+		char cacheDir[TFE_MAX_PATH];
+		sprintf(cacheDir, "%sScriptCache/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		if (!FileUtil::directoryExits(cacheDir))
+		{
+			FileUtil::makeDirectory(cacheDir);
+		}
+
+		// Keep debug info, it is required to serialize running scripts.
+		BytecodeWriteStream stream;
+		if (mod->SaveByteCode(&stream, false) < 0)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Force Script", "Cannot save bytecode for module '%s'.", mod->GetName());
+			return;
+		}
+		header.bytecodeSize = (u32)stream.buffer.size();
+
+		FileStream file;
+		if (!file.open(cachePath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Force Script", "Cannot write bytecode cache '%s'.", cachePath);
+			return;
+		}
+		file.writeBuffer(&header, sizeof(BytecodeCacheHeader));
+		file.writeBuffer(stream.buffer.data(), header.bytecodeSize);
+		file.close();
+
+		pruneBytecodeCache(cacheDir);
+	}
+
+	// Build the sections added to the builder, or load the matching bytecode from the cache.
+	// Transient modules, such as console lines, skip the cache.
+	asIScriptModule* buildModule(CScriptBuilder& builder, const char* moduleName, u32 accessMask, bool useCache)
+	{
+		const u64 startTime = TFE_System::getCurrentTimeInTicks();
+		asIScriptModule* mod = builder.GetModule();
+		if (!useCache)
+		{
+			return builder.BuildModule() < 0 ? nullptr : builder.GetModule();
+		}
+
+		char cachePath[TFE_MAX_PATH];
+		BytecodeCacheHeader header = {};
+		header.magic = BYTECODE_CACHE_MAGIC;
+		header.version = BYTECODE_CACHE_VERSION;
+		header.sourceHash = builder.GetSourceHash();
+		header.engineHash = computeEngineHash();
+		header.apiHash = getApiHash();
+		header.accessMask = accessMask;
+		getBytecodeCachePath(moduleName, header, cachePath);
+
+		if (loadModuleFromCache(mod, cachePath, header))
+		{
+			const f64 loadTime = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - startTime);
+			TFE_System::logWrite(LOG_MSG, "Force Script", "Module '%s' loaded from the bytecode cache in %0.2f ms.", moduleName, loadTime);
+			return mod;
+		}
+
+		if (builder.BuildModule() < 0)
+		{
+			return nullptr;
+		}
+		mod = builder.GetModule();
+		const f64 compileTime = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - startTime);
+		TFE_System::logWrite(LOG_MSG, "Force Script", "Module '%s' compiled in %0.2f ms.", moduleName, compileTime);
+
+		if (mod)
+		{
+			saveModuleToCache(mod, cachePath, header);
+		}
+		return mod;
+	}
+				
 	ModuleHandle createModule(const char* moduleName, const char* filePath, bool allowReadFromArchive, u32 accessMask)
 	{
 		CScriptBuilder builder;
@@ -746,12 +1091,7 @@ namespace TFE_ForceScript
 		{
 			return nullptr;
 		}
-		res = builder.BuildModule();
-		if (res < 0)
-		{
-			return nullptr;
-		}
-		mod = builder.GetModule();
+		mod = buildModule(builder, moduleName, accessMask, true);
 		if (mod)
 		{
 			s_modules.push_back({ moduleName, filePath, allowReadFromArchive, accessMask, mod });
@@ -759,7 +1099,7 @@ namespace TFE_ForceScript
 		return mod;
 	}
 					
-	ModuleHandle createModule(const char* moduleName, const char* sectionName, const char* srcCode, u32 accessMask)
+	ModuleHandle createModule(const char* moduleName, const char* sectionName, const char* srcCode, u32 accessMask, bool useBytecodeCache)
 	{
 		CScriptBuilder builder;
 		s32 res = builder.StartNewModule(s_engine, moduleName);
@@ -780,12 +1120,7 @@ namespace TFE_ForceScript
 		{
 			return nullptr;
 		}
-		res = builder.BuildModule();
-		if (res < 0)
-		{
-			return nullptr;
-		}
-		return builder.GetModule();
+		return buildModule(builder, moduleName, accessMask, useBytecodeCache);
 	}
 
 	FunctionHandle findScriptFuncByDecl(ModuleHandle modHandle, const char* funcDecl)
@@ -78,9 +78,12 @@ namespace TFE_ForceScript
 
 	// Compile module.
 	ModuleHandle getModule(const char* moduleName);
-	ModuleHandle createModule(const char* moduleName, const char* sectionName, const char* srcCode, u32 accessMask);
+	// Modules built from memory can skip the bytecode cache if they are transient (e.g. console lines).
+	ModuleHandle createModule(const char* moduleName, const char* sectionName, const char* srcCode, u32 accessMask, bool useBytecodeCache = true);
 	ModuleHandle createModule(const char* moduleName, const char* filePath, bool allowReadFromArchive, u32 accessMask);
 	void deleteModule(const char* moduleName);
+	// Number of modules currently loaded, script state is not part of in-place snapshots.
+	s32 getModuleCount();
 	// Find a specific script function in a module.
 	FunctionHandle findScriptFuncByDecl(ModuleHandle modHandle, const char* funcDecl);
 	FunctionHandle findScriptFuncByName(ModuleHandle modHandle, const char* funcName);
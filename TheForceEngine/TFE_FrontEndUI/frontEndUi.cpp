@@ -13,6 +13,7 @@
 #include <TFE_System/system.h>
 #include <TFE_System/parser.h>
 #include <TFE_System/frameLimiter.h>
+#include <TFE_System/framePipeline.h>
 #include <TFE_Jedi/IMuse/imuse.h>
 #include <TFE_FileSystem/fileutil.h>
 #include <TFE_FileSystem/paths.h>
@@ -1247,6 +1248,22 @@ namespace TFE_FrontEndUI
 			gameSettings->df_showKeyColors = showKeyColors;
 		}
 
+		bool enableRewind = gameSettings->df_enableRewind;
+		if (ImGui::Checkbox("Enable rewind", &enableRewind))
+		{
+			gameSettings->df_enableRewind = enableRewind;
+		}
+		if (gameSettings->df_enableRewind)
+		{
+			ImGui::LabelText("##ConfigLabel", "Rewind Interval (sec):"); ImGui::SameLine(200 * s_uiScale);
+			ImGui::SetNextItemWidth(196 * s_uiScale);
+			ImGui::SliderInt("##RewindInterval", &gameSettings->df_rewindInterval, 1, 10, "%d");
+
+			ImGui::LabelText("##ConfigLabel", "Rewind Memory (MB):"); ImGui::SameLine(200 * s_uiScale);
+			ImGui::SetNextItemWidth(196 * s_uiScale);
+			ImGui::SliderInt("##RewindBudget", &gameSettings->df_rewindBudgetMB, 16, 512, "%d");
+		}
+
 		ImGui::Separator();
 
 		ImGui::PushFont(s_versionFont);
@@ -2124,9 +2141,9 @@ namespace TFE_FrontEndUI
 
 			size.x = 420 * s_uiScale;
 			#ifdef _WIN32
-			size.y = 85 * s_uiScale;
+			size.y = 110 * s_uiScale;
 			#else
-			size.y = 100 * s_uiScale;
+			size.y = 125 * s_uiScale;
 			#endif		
 			
 			ImGui::BeginChild("##InfoWithBorderRecord", size, true);
@@ -2171,6 +2188,11 @@ namespace TFE_FrontEndUI
 				ImGui::SameLine(160 * s_uiScale);
 				ImGui::SetNextItemWidth(64.0f);
 				ImGui::Combo("##frameRecordingText", &gameSettings->df_recordFrameRate, c_frameRecording, IM_ARRAYSIZE(c_frameRecording));
+
+				ImGui::LabelText("##KeyframeRecord", "Seek Keyframe (sec)");
+				ImGui::SameLine(160 * s_uiScale);
+				ImGui::SetNextItemWidth(140.0f);
+				ImGui::SliderInt("##keyframeInterval", &gameSettings->df_demoKeyframeInterval, 0, 300, "%d");
 				ImGui::Spacing();
 
 			}
@@ -2697,6 +2719,7 @@ namespace TFE_FrontEndUI
 				inputMapping("System Menu", IAS_SYSTEM_MENU);
 				inputMapping("Quick Save",  IAS_QUICK_SAVE);
 				inputMapping("Quick Load",  IAS_QUICK_LOAD);
+				inputMapping("Rewind",      IAS_REWIND);
 
 				ImGui::Separator();
 
@@ -3113,6 +3136,11 @@ namespace TFE_FrontEndUI
 			ImGui::SliderInt("##FPSLimitSlider", &frameRateLimit, 30, 360, "%d");
 			ImGui::SetNextItemWidth(128 * s_uiScale);
 			ImGui::InputInt("##FPSLimitEdit", &frameRateLimit, 1, 10);
+			if (ImGui::Checkbox("Precise Frame Pacing", &graphics->precisePacing))
+			{
+				TFE_System::frameLimiter_setPacing(graphics->precisePacing ? TFE_System::FRAME_PACING_PRECISE : TFE_System::FRAME_PACING_SLEEP);
+			}
+			Tooltip("Spin for the last part of each frame to hit the frame limit exactly, at the cost of some extra CPU use.");
 		}
 		else
 		{
@@ -3135,6 +3163,11 @@ namespace TFE_FrontEndUI
 			graphics->asyncFramebuffer = true;
 			graphics->gpuColorConvert = true;
 			ImGui::Checkbox("Extend Adjoin/Portal Limits", &graphics->extendAjoinLimits);
+			if (ImGui::Checkbox("Pipelined Frames", &graphics->pipelinedFrames))
+			{
+				TFE_System::framePipeline_enable(graphics->pipelinedFrames);
+			}
+			Tooltip("Simulate the next frame on a worker thread while the previous frame is presented. Adds one frame of latency.");
 		}
 		else if (graphics->rendererIndex == 1)
 		{
@@ -3477,6 +3510,13 @@ namespace TFE_FrontEndUI
 			sound->disableSoundInMenus = disableSoundInMenus;
 		}
 
+		ImGui::LabelText("##ConfigLabel", "Midi Render-Ahead (ms):"); ImGui::SameLine(200 * s_uiScale);
+		ImGui::SetNextItemWidth(196 * s_uiScale);
+		if (ImGui::SliderInt("##MidiRenderAhead", &sound->midiRenderAheadMs, 30, 250, "%d"))
+		{
+			TFE_MidiPlayer::setRenderAhead(sound->midiRenderAheadMs);
+		}
+
 		TFE_Audio::setVolume(sound->soundFxVolume * sound->masterVolume);
 		TFE_MidiPlayer::setVolume(sound->musicVolume * sound->masterVolume);
 	}
@@ -7,6 +7,7 @@
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_System/system.h>
 #include <TFE_System/parser.h>
+#include <TFE_System/hash.h>
 #include <TFE_FileSystem/fileutil.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_FileSystem/filestream.h>
@@ -14,6 +15,7 @@
 #include <TFE_Settings/settings.h>
 #include <TFE_Asset/imageAsset.h>
 #include <TFE_Archive/zipArchive.h>
+#include <TFE_Archive/gobArchive.h>
 #include <TFE_Archive/gobMemoryArchive.h>
 #include <TFE_Input/inputMapping.h>
 #include <TFE_Asset/imageAsset.h>
@@ -23,7 +25,11 @@
 #include <TFE_DarkForces/mission.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 #include <map>
+#include <set>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 using namespace TFE_Input;
 
@@ -35,7 +41,17 @@ namespace TFE_FrontEndUI
 		QREAD_ZIP,
 		QREAD_COUNT
 	};
-	const u32 c_itemsPerFrame = 1;
+	// Mods are read on worker threads, this limits the poster textures created per frame.
+	const u32 c_itemsPerFrame = 4;
+	// Posters are cached at the largest size the mod UI draws them.
+	const u32 c_posterWidth  = 320;
+	const u32 c_posterHeight = 200;
+
+	enum ModCacheConst : u32
+	{
+		MOD_CACHE_MAGIC   = 0x43444f4d,	// "MODC"
+		MOD_CACHE_VERSION = 1,
+	};
 
 	struct QueuedRead
 	{
@@ -57,16 +73,60 @@ namespace TFE_FrontEndUI
 
 		bool invertImage = true;
 	};
+
+	// Worker output for a single queued read.
+	struct ModReadResult
+	{
+		ModData mod;
+		bool valid = false;
+		bool cached = false;
+		u64 key = 0;
+
+		// Decoded poster, the texture is created on the main thread.
+		u32 posterWidth = 0;
+		u32 posterHeight = 0;
+		std::vector<u32> poster;
+		// Encoded poster for the cache, only for mods that were not already cached.
+		std::vector<u8> posterPng;
+	};
+
+	struct ModCacheEntry
+	{
+		bool valid = false;
+		bool invertImage = true;
+		std::string name;
+		std::string text;
+		std::vector<u8> poster;		// PNG
+	};
+
+	struct ModScan
+	{
+		std::vector<std::thread> workers;
+		std::atomic<s32> next{ 0 };
+		std::atomic<bool> cancel{ false };
+		u64 startTick = 0;
+
+		// Results are indexed by the read queue, 'done' is set once a result is complete.
+		std::mutex mutex;
+		std::vector<u8> done;
+		std::vector<ModReadResult> results;
+	};
+
 	static std::vector<ModData> s_mods;
 	static std::vector<ModData*> s_filteredMods;
-
-	static std::vector<char> s_fileBuffer;
-	static std::vector<u8> s_readBuffer[2];
 	static s32 s_selectedMod;
 
 	static std::vector<QueuedRead> s_readQueue;
-	static std::vector<u8> s_imageBuffer;
 	static size_t s_readIndex = 0;
+	static ModScan s_modScan;
+
+	static std::map<u64, ModCacheEntry> s_modCache;
+	static bool s_modCacheLoaded = false;
+
+	// Fallback poster from the base game data.
+	static std::once_flag s_basePosterRead;
+	static std::vector<u8> s_baseWaitBm;
+	static std::vector<u8> s_baseWaitPal;
 
 	static ViewMode s_viewMode = VIEW_IMAGES;
 
@@ -79,9 +139,11 @@ namespace TFE_FrontEndUI
 
 	void fixupName(char* name);
 	void readFromQueue(size_t itemsPerFrame);
+	void startModScan();
+	void stopModScan();
 	bool parseNameFromText(const char* textFileName, const char* path, char* name, std::string* fullText);
-	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, UiTexture* poster);
-	bool extractPosterFromMod(const char* baseDir, const char* archiveFileName, UiTexture* poster);
+	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, ModReadResult* result);
+	bool extractPosterFromMod(const char* baseDir, const char* archiveFileName, ModReadResult* result);
 	void filterMods(bool filterByName, bool sort = true);
 
 	bool sortQueueByName(QueuedRead& a, QueuedRead& b)
@@ -105,6 +167,7 @@ namespace TFE_FrontEndUI
 		if (s_modsRead && (s_mods.size() > 0 || !isModUI())) { return; }
 		s_modsRead = true;
 
+		stopModScan();
 		s_mods.clear();
 		s_filteredMods.clear();
 		s_selectedMod = -1;
@@ -231,10 +294,12 @@ namespace TFE_FrontEndUI
 		}
 
 		std::sort(s_readQueue.begin(), s_readQueue.end(), sortQueueByName);
+		startModScan();
 	}
 
 	void modLoader_cleanupResources()
 	{
+		stopModScan();
 		for (size_t i = 0; i < s_mods.size(); i++)
 		{
 			if (s_mods[i].image.texture)
@@ -645,6 +710,8 @@ namespace TFE_FrontEndUI
 		const size_t len = strlen(textFileName);
 		const char* ext = &textFileName[len - 3];
 		size_t textLen = 0;
+		// Local, this is called from the mod scan workers.
+		std::vector<char> fileBuffer;
 		if (strcasecmp(ext, "zip") == 0)
 		{
 			ZipArchive zipArchive;
@@ -669,9 +736,9 @@ namespace TFE_FrontEndUI
 				if (txtIndex >= 0 && zipArchive.openFile(txtIndex))
 				{
 					textLen = zipArchive.getFileLength();
-					s_fileBuffer.resize(textLen + 1);
-					s_fileBuffer[0] = 0;
-					zipArchive.readFile(s_fileBuffer.data(), textLen);
+					fileBuffer.resize(textLen + 1);
+					fileBuffer[0] = 0;
+					zipArchive.readFile(fileBuffer.data(), textLen);
 					zipArchive.closeFile();
 				}
 			}
@@ -687,12 +754,12 @@ namespace TFE_FrontEndUI
 				return false;
 			}
 			textLen = textFile.getSize();
-			s_fileBuffer.resize(textLen + 1);
-			s_fileBuffer[0] = 0;
-			textFile.readBuffer(s_fileBuffer.data(), (u32)textLen);
+			fileBuffer.resize(textLen + 1);
+			fileBuffer[0] = 0;
+			textFile.readBuffer(fileBuffer.data(), (u32)textLen);
 			textFile.close();
 		}
-		if (!textLen || s_fileBuffer[0] == 0)
+		if (!textLen || fileBuffer[0] == 0)
 		{
 			return false;
 		}
@@ -700,9 +767,9 @@ namespace TFE_FrontEndUI
 		// Some files start with garbage at the beginning...
 		// So try a small probe first to see if such fixup is reqiured.
 		bool needsFixup = false;
-		for (size_t i = 0; i < 10 && i < s_fileBuffer.size(); i++)
+		for (size_t i = 0; i < 10 && i < fileBuffer.size(); i++)
 		{
-			if (s_fileBuffer[i] == 0)
+			if (fileBuffer[i] == 0)
 			{
 				needsFixup = true;
 				break;
@@ -712,8 +779,8 @@ namespace TFE_FrontEndUI
 		size_t lastZero = 0;
 		if (needsFixup)
 		{
-			size_t len = s_fileBuffer.size();
-			const char* text = s_fileBuffer.data();
+			size_t len = fileBuffer.size();
+			const char* text = fileBuffer.data();
 			for (size_t i = 0; i < len - 1 && i < 128; i++)
 			{
 				if (text[i] == 0)
@@ -723,7 +790,7 @@ namespace TFE_FrontEndUI
 			}
 			if (lastZero) { lastZero++; }
 		}
-		*fullText = std::string(s_fileBuffer.data() + lastZero, s_fileBuffer.data() + s_fileBuffer.size());
+		*fullText = std::string(fileBuffer.data() + lastZero, fileBuffer.data() + fileBuffer.size());
 
 		TFE_Parser parser;
 		parser.init(fullText->c_str(), fullText->length());
@@ -919,153 +986,513 @@ namespace TFE_FrontEndUI
 		}
 	}
 
-	void readFromQueue(size_t itemsPerFrame)
+	////////////////////////////////////////////////////////////
+	// Mod cache
+	// Parsed names and downscaled posters, keyed by the mod
+	// files' paths, sizes and modification times.
+	////////////////////////////////////////////////////////////
+	void getModCachePath(char* path)
 	{
-		FileList gobFiles, txtFiles, imgFiles;
-		const size_t readEnd = min(s_readIndex + itemsPerFrame, s_readQueue.size());
-		const QueuedRead* reads = s_readQueue.data();
-		bool updateFilter = false;
-		for (size_t i = s_readIndex; i < readEnd; i++, s_readIndex++)
+		sprintf(path, "%sModCache/mods.cache", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+	}
+
+	void loadModCache()
+	{
+		if (s_modCacheLoaded) { return; }
+		s_modCacheLoaded = true;
+
+		char cachePath[TFE_MAX_PATH];
+		getModCachePath(cachePath);
+		FileStream file;
+		if (!FileUtil::exists(cachePath) || !file.open(cachePath, Stream::MODE_READ)) { return; }
+
+		u32 magic = 0, version = 0, count = 0;
+		file.read(&magic);
+		file.read(&version);
+		file.read(&count);
+		if (magic != MOD_CACHE_MAGIC || version != MOD_CACHE_VERSION)
 		{
-			updateFilter = true;
-			if (reads[i].type == QREAD_DIR)
-			{
-				// Clear doesn't deallocate in most implementations, so doing it this way should reduce memory allocations.
-				gobFiles.clear();
-				txtFiles.clear();
-				imgFiles.clear();
-
-				const char* subDir = reads[i].path.c_str();
-				FileUtil::readDirectory(subDir, "gob", gobFiles);
-				FileUtil::readDirectory(subDir, "txt", txtFiles);
-				FileUtil::readDirectory(subDir, "jpg", imgFiles);
-
-				// No gob files = no mod.
-				if (gobFiles.size() != 1)
-				{
-					continue;
-				}
-				s_mods.push_back({});
-				ModData& mod = s_mods.back();
+			file.close();
+			return;
+		}
+		for (u32 i = 0; i < count; i++)
+		{
+			u64 key = 0;
+			u8 valid = 0, invertImage = 0;
+			u32 posterSize = 0;
+			file.read(&key);
+			file.read(&valid);
+			file.read(&invertImage);
+
+			ModCacheEntry& entry = s_modCache[key];
+			entry.valid = valid != 0;
+			entry.invertImage = invertImage != 0;
+			file.read(&entry.name);
+			file.read(&entry.text);
+			file.read(&posterSize);
+			entry.poster.resize(posterSize);
+			if (posterSize) { file.readBuffer(entry.poster.data(), posterSize); }
+		}
+		file.close();
+	}
 
-				mod.gobFiles = gobFiles;
-				mod.textFile = txtFiles.empty() ? "" : txtFiles[0];
-				mod.imageFile = imgFiles.empty() ? "" : imgFiles[0];
-				mod.text = "";
+	void saveModCache()
+	{
+		char cacheDir[TFE_MAX_PATH];
+		sprintf(cacheDir, "%sModCache/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		if (!FileUtil::directoryExits(cacheDir))
+		{
+			FileUtil::makeDirectory(cacheDir);
+		}
 
-				size_t fullDirLen = strlen(subDir);
-				for (size_t i = 0; i < fullDirLen; i++)
-				{
-					if (strncasecmp("Mods", &subDir[i], 4) == 0)
-					{
-						mod.relativePath = &subDir[i + 5];
-						break;
-					}
-				}
+		char cachePath[TFE_MAX_PATH];
+		getModCachePath(cachePath);
+		FileStream file;
+		if (!file.open(cachePath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "ModLoader", "Cannot write the mod cache '%s'.", cachePath);
+			return;
+		}
+
+		const u32 magic = MOD_CACHE_MAGIC, version = MOD_CACHE_VERSION;
+		const u32 count = (u32)s_modCache.size();
+		file.write(&magic);
+		file.write(&version);
+		file.write(&count);
+		std::map<u64, ModCacheEntry>::const_iterator iEntry = s_modCache.begin();
+		for (; iEntry != s_modCache.end(); ++iEntry)
+		{
+			const ModCacheEntry& entry = iEntry->second;
+			const u8 valid = entry.valid ? 1 : 0;
+			const u8 invertImage = entry.invertImage ? 1 : 0;
+			const u32 posterSize = (u32)entry.poster.size();
+			file.write(&iEntry->first);
+			file.write(&valid);
+			file.write(&invertImage);
+			file.write(&entry.name);
+			file.write(&entry.text);
+			file.write(&posterSize);
+			if (posterSize) { file.writeBuffer(entry.poster.data(), posterSize); }
+		}
+		file.close();
+	}
+
+	// Add a file to the cache key, a missing file still changes the key.
+	u64 hashModFile(const char* dir, const std::string& fileName, u64 key)
+	{
+		if (fileName.empty())
+		{
+			return TFE_Hash::fnv1a64Value(u8(0), key);
+		}
+		char path[TFE_MAX_PATH];
+		sprintf(path, "%s%s", dir, fileName.c_str());
+
+		u64 size = 0, modTime = 0;
+		FileStream file;
+		if (file.open(path, Stream::MODE_READ))
+		{
+			size = (u64)file.getSize();
+			file.close();
+			modTime = FileUtil::getModifiedTime(path);
+		}
+		key = TFE_Hash::fnv1a64(path, key);
+		key = TFE_Hash::fnv1a64Value(size, key);
+		key = TFE_Hash::fnv1a64Value(modTime, key);
+		return key;
+	}
+
+	////////////////////////////////////////////////////////////
+	// Mod scanning
+	// Mods are read and their posters decoded on worker threads,
+	// the main thread only creates the poster textures.
+	////////////////////////////////////////////////////////////
+	void setModName(ModReadResult* result, const char* path, const char* textFile)
+	{
+		ModData& mod = result->mod;
+		char name[TFE_MAX_PATH];
+		if (!parseNameFromText(textFile, path, name, &mod.text))
+		{
+			const char* gobFileName = mod.gobFiles[0].c_str();
+			memcpy(name, gobFileName, strlen(gobFileName) - 4);
+			name[strlen(gobFileName) - 4] = 0;
+			fixupName(name);
+		}
+		mod.name = name;
+	}
+
+	// Box filter the poster down to the largest size it is displayed at.
+	void downscalePoster(ModReadResult* result)
+	{
+		const u32 srcWidth = result->posterWidth, srcHeight = result->posterHeight;
+		const u32 dstWidth = min(srcWidth, c_posterWidth), dstHeight = min(srcHeight, c_posterHeight);
+		if (dstWidth == srcWidth && dstHeight == srcHeight) { return; }
+
+		std::vector<u32> scaled(dstWidth * dstHeight);
+		const u32* src = result->poster.data();
+		for (u32 y = 0; y < dstHeight; y++)
+		{
+			const u32 y0 = y * srcHeight / dstHeight;
+			const u32 y1 = max(y0 + 1, (y + 1) * srcHeight / dstHeight);
+			for (u32 x = 0; x < dstWidth; x++)
+			{
+				const u32 x0 = x * srcWidth / dstWidth;
+				const u32 x1 = max(x0 + 1, (x + 1) * srcWidth / dstWidth);
 
-				if (mod.imageFile.empty())
+				u32 sum[4] = { 0 };
+				for (u32 sy = y0; sy < y1; sy++)
 				{
-					if (!extractPosterFromMod(subDir, mod.gobFiles[0].c_str(), &mod.image))
+					for (u32 sx = x0; sx < x1; sx++)
 					{
-						s_mods.pop_back();
-						continue;
+						const u32 color = src[sy * srcWidth + sx];
+						sum[0] += color & 0xff;
+						sum[1] += (color >> 8u) & 0xff;
+						sum[2] += (color >> 16u) & 0xff;
+						sum[3] += color >> 24u;
 					}
-					mod.invertImage = true;
-				}
-				else
-				{
-					extractPosterFromImage(subDir, nullptr, mod.imageFile.c_str(), &mod.image);
-					mod.invertImage = false;
 				}
+				const u32 sampleCount = (x1 - x0) * (y1 - y0);
+				scaled[y * dstWidth + x] = (sum[0] / sampleCount) | ((sum[1] / sampleCount) << 8u) |
+					((sum[2] / sampleCount) << 16u) | ((sum[3] / sampleCount) << 24u);
+			}
+		}
+		result->poster.swap(scaled);
+		result->posterWidth = dstWidth;
+		result->posterHeight = dstHeight;
+	}
 
-				char name[TFE_MAX_PATH];
-				if (!parseNameFromText(mod.textFile.c_str(), subDir, name, &mod.text))
-				{
-					const char* gobFileName = mod.gobFiles[0].c_str();
-					memcpy(name, gobFileName, strlen(gobFileName) - 4);
-					name[strlen(gobFileName) - 4] = 0;
-					fixupName(name);
-				}
+	bool copyPoster(SDL_Surface* image, ModReadResult* result)
+	{
+		if (!image) { return false; }
+		result->posterWidth = image->w;
+		result->posterHeight = image->h;
+		result->poster.resize(image->w * image->h);
+		for (s32 y = 0; y < image->h; y++)
+		{
+			memcpy(&result->poster[y * image->w], (u8*)image->pixels + y * image->pitch, image->w * sizeof(u32));
+		}
+		// Do not use TFE_Image::free(), the image cache is not thread safe.
+		SDL_FreeSurface(image);
+		return true;
+	}
+
+	void readModFromCache(const ModCacheEntry& entry, ModReadResult* result)
+	{
+		result->valid = entry.valid;
+		result->cached = true;
+		result->mod.name = entry.name;
+		result->mod.text = entry.text;
+		result->mod.invertImage = entry.invertImage;
+		if (!entry.poster.empty())
+		{
+			copyPoster(TFE_Image::loadFromMemory(entry.poster.data(), entry.poster.size()), result);
+		}
+	}
+
+	// Build the cache entry for a mod that was read from its files.
+	void encodeModCacheEntry(ModReadResult* result)
+	{
+		downscalePoster(result);
+		if (!result->valid || result->poster.empty()) { return; }
+
+		const u32 width = result->posterWidth, height = result->posterHeight;
+		result->posterPng.resize(width * height * sizeof(u32));
+		const size_t size = TFE_Image::writeImageToMemory(result->posterPng.data(), width, height, width, height, result->poster.data());
+		result->posterPng.resize(size);
+		// Do not cache an entry without its poster.
+		if (!size) { result->key = 0; }
+	}
+
+	const ModCacheEntry* findModCacheEntry(u64 key)
+	{
+		// The cache is only modified on the main thread, once all of the workers are done.
+		std::map<u64, ModCacheEntry>::const_iterator iEntry = s_modCache.find(key);
+		return iEntry != s_modCache.end() ? &iEntry->second : nullptr;
+	}
+
+	void readModDirectory(const QueuedRead& read, ModReadResult* result)
+	{
+		FileList gobFiles, txtFiles, imgFiles;
+		const char* subDir = read.path.c_str();
+		FileUtil::readDirectory(subDir, "gob", gobFiles);
+		FileUtil::readDirectory(subDir, "txt", txtFiles);
+		FileUtil::readDirectory(subDir, "jpg", imgFiles);
+
+		// No gob files = no mod.
+		if (gobFiles.size() != 1)
+		{
+			return;
+		}
+		ModData& mod = result->mod;
+		mod.gobFiles = gobFiles;
+		mod.textFile = txtFiles.empty() ? "" : txtFiles[0];
+		mod.imageFile = imgFiles.empty() ? "" : imgFiles[0];
+		mod.text = "";
+
+		size_t fullDirLen = strlen(subDir);
+		for (size_t i = 0; i < fullDirLen; i++)
+		{
+			if (strncasecmp("Mods", &subDir[i], 4) == 0)
+			{
+				mod.relativePath = &subDir[i + 5];
+				break;
+			}
+		}
+
+		u64 key = hashModFile(subDir, mod.gobFiles[0], TFE_Hash::FNV_OFFSET_BASIS);
+		key = hashModFile(subDir, mod.textFile, key);
+		key = hashModFile(subDir, mod.imageFile, key);
+		result->key = key;
+
+		const ModCacheEntry* entry = findModCacheEntry(key);
+		if (entry)
+		{
+			readModFromCache(*entry, result);
+			return;
+		}
+
+		result->valid = true;
+		if (mod.imageFile.empty())
+		{
+			if (!extractPosterFromMod(subDir, mod.gobFiles[0].c_str(), result))
+			{
+				result->valid = false;
+			}
+			mod.invertImage = true;
+		}
+		else
+		{
+			extractPosterFromImage(subDir, nullptr, mod.imageFile.c_str(), result);
+			mod.invertImage = false;
+		}
+		if (result->valid)
+		{
+			setModName(result, subDir, mod.textFile.c_str());
+		}
+		encodeModCacheEntry(result);
+	}
+
+	void readModZip(const QueuedRead& read, ModReadResult* result)
+	{
+		const char* modPath = read.path.c_str();
+		const char* zipName = read.fileName.c_str();
+		ModData& mod = result->mod;
+		mod.gobFiles.push_back(zipName);
+		mod.text = "";
+
+		result->key = hashModFile(modPath, read.fileName, TFE_Hash::FNV_OFFSET_BASIS);
+
+		const ModCacheEntry* entry = findModCacheEntry(result->key);
+		if (entry)
+		{
+			readModFromCache(*entry, result);
+			return;
+		}
+
+		char zipPath[TFE_MAX_PATH];
+		sprintf(zipPath, "%s%s", modPath, zipName);
+		ZipArchive zipArchive;
+		if (!zipArchive.open(zipPath)) { return; }
+
+		s32 gobFileIndex = -1;
+		s32 txtFileIndex = -1;
+		s32 jpgFileIndex = -1;
+
+		// Look for the following:
+		// 1. Gob File.
+		// 2. Text File.
+		// 3. JPG
+		for (u32 f = 0; f < zipArchive.getFileCount(); f++)
+		{
+			const char* fileName = zipArchive.getFileName(f);
+			size_t len = strlen(fileName);
+			if (len <= 4)
+			{
+				continue;
+			}
+			const char* ext = &fileName[len - 3];
+			if (strcasecmp(ext, "gob") == 0)
+			{
+				gobFileIndex = s32(f);
+			}
+			else if (strcasecmp(ext, "txt") == 0)
+			{
+				txtFileIndex = s32(f);
+			}
+			else if (strcasecmp(ext, "jpg") == 0)
+			{
+				jpgFileIndex = s32(f);
+			}
+		}
+		if (gobFileIndex >= 0)
+		{
+			result->valid = true;
+			setModName(result, modPath, zipName);
 
-				mod.name = name;
+			if (jpgFileIndex < 0)
+			{
+				result->valid = extractPosterFromMod(modPath, zipName, result);
+				mod.invertImage = true;
 			}
 			else
 			{
-				ZipArchive zipArchive;
-				const char* modPath = reads[i].path.c_str();
-				const char* zipName = reads[i].fileName.c_str();
-
-				char zipPath[TFE_MAX_PATH];
-				sprintf(zipPath, "%s%s", modPath, zipName);
-				if (!zipArchive.open(zipPath)) { continue; }
-
-				s32 gobFileIndex = -1;
-				s32 txtFileIndex = -1;
-				s32 jpgFileIndex = -1;
-
-				// Look for the following:
-				// 1. Gob File.
-				// 2. Text File.
-				// 3. JPG
-				for (u32 f = 0; f < zipArchive.getFileCount(); f++)
-				{
-					const char* fileName = zipArchive.getFileName(f);
-					size_t len = strlen(fileName);
-					if (len <= 4)
-					{
-						continue;
-					}
-					const char* ext = &fileName[len - 3];
-					if (strcasecmp(ext, "gob") == 0)
-					{
-						gobFileIndex = s32(f);
-					}
-					else if (strcasecmp(ext, "txt") == 0)
-					{
-						txtFileIndex = s32(f);
-					}
-					else if (strcasecmp(ext, "jpg") == 0)
-					{
-						jpgFileIndex = s32(f);
-					}
-				}
-				if (gobFileIndex >= 0)
-				{
-					s_mods.push_back({});
-					ModData& mod = s_mods.back();
-					mod.gobFiles.push_back(zipName);
-					mod.text = "";
+				extractPosterFromImage(modPath, zipName, zipArchive.getFileName(jpgFileIndex), result);
+				mod.invertImage = false;
+			}
+		}
+		zipArchive.close();
+		encodeModCacheEntry(result);
+	}
 
-					char name[TFE_MAX_PATH];
-					if (!parseNameFromText(mod.gobFiles[0].c_str(), modPath, name, &mod.text))
-					{
-						const char* gobFileName = mod.gobFiles[0].c_str();
-						memcpy(name, gobFileName, strlen(gobFileName) - 4);
-						name[strlen(gobFileName) - 4] = 0;
-						fixupName(name);
-					}
-					mod.name = name;
+	void modScanWorker()
+	{
+		const s32 count = (s32)s_readQueue.size();
+		while (!s_modScan.cancel)
+		{
+			const s32 index = s_modScan.next++;
+			if (index >= count) { break; }
 
-					if (jpgFileIndex < 0)
-					{
-						if (!extractPosterFromMod(modPath, mod.gobFiles[0].c_str(), &mod.image))
-						{
-							s_mods.pop_back();
-						}
-						else
-						{
-							mod.invertImage = true;
-						}
-					}
-					else
-					{
-						extractPosterFromImage(modPath, mod.gobFiles[0].c_str(), zipArchive.getFileName(jpgFileIndex), &mod.image);
-						mod.invertImage = false;
-					}
-				}
+			if (s_readQueue[index].type == QREAD_DIR)
+			{
+				readModDirectory(s_readQueue[index], &s_modScan.results[index]);
+			}
+			else
+			{
+				readModZip(s_readQueue[index], &s_modScan.results[index]);
+			}
 
-				zipArchive.close();
+			std::lock_guard<std::mutex> lock(s_modScan.mutex);
+			s_modScan.done[index] = 1;
+		}
+	}
+
+	void startModScan()
+	{
+		const size_t count = s_readQueue.size();
+		if (!count) { return; }
+		loadModCache();
+
+		s_modScan.results.clear();
+		s_modScan.results.resize(count);
+		s_modScan.done.assign(count, 0);
+		s_modScan.next = 0;
+		s_modScan.cancel = false;
+		s_modScan.startTick = TFE_System::getCurrentTimeInTicks();
+
+		// Leave a core for the main thread, so the UI stays responsive while scanning.
+		const u32 hardwareThreads = std::thread::hardware_concurrency();
+		const u32 threadCount = min((u32)count, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+		for (u32 i = 0; i < threadCount; i++)
+		{
+			s_modScan.workers.push_back(std::thread(modScanWorker));
+		}
+	}
+
+	void joinModScan()
+	{
+		for (size_t i = 0; i < s_modScan.workers.size(); i++)
+		{
+			s_modScan.workers[i].join();
+		}
+		s_modScan.workers.clear();
+	}
+
+	void stopModScan()
+	{
+		s_modScan.cancel = true;
+		joinModScan();
+		s_modScan.results.clear();
+		s_modScan.done.clear();
+	}
+
+	// Called once all of the results have been picked up, new entries are added to the cache and
+	// entries for mods that were not seen by this scan (removed or changed) are dropped.
+	void finishModScan()
+	{
+		joinModScan();
+
+		u32 cachedCount = 0, readCount = 0;
+		std::set<u64> seenKeys;
+		const size_t count = s_modScan.results.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			const ModReadResult& result = s_modScan.results[i];
+			if (result.key) { seenKeys.insert(result.key); }
+			if (result.cached)
+			{
+				cachedCount++;
+				continue;
+			}
+			if (!result.key) { continue; }
+
+			ModCacheEntry& entry = s_modCache[result.key];
+			entry.valid = result.valid;
+			entry.invertImage = result.mod.invertImage;
+			entry.name = result.mod.name;
+			entry.text = result.mod.text;
+			entry.poster = result.posterPng;
+			readCount++;
+		}
+		s_modScan.results.clear();
+		s_modScan.done.clear();
+
+		u32 prunedCount = 0;
+		std::map<u64, ModCacheEntry>::iterator iEntry = s_modCache.begin();
+		while (iEntry != s_modCache.end())
+		{
+			if (seenKeys.find(iEntry->first) == seenKeys.end())
+			{
+				iEntry = s_modCache.erase(iEntry);
+				prunedCount++;
+			}
+			else
+			{
+				++iEntry;
+			}
+		}
+		if (readCount || prunedCount)
+		{
+			saveModCache();
+		}
+
+		const f64 time = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - s_modScan.startTick);
+		TFE_System::logWrite(LOG_MSG, "ModLoader", "Read %u mods (%u cached, %u stale cache entries removed) in %0.2f ms.", u32(count), cachedCount, prunedCount, time);
+	}
+
+	void readFromQueue(size_t itemsPerFrame)
+	{
+		const size_t count = s_modScan.results.size();
+		if (s_readIndex >= count) { return; }
+
+		// Pick up the finished results in queue order, so the mod list does not depend on worker timing.
+		bool updateFilter = false;
+		size_t uploadCount = 0;
+		while (s_readIndex < count && uploadCount < itemsPerFrame)
+		{
+			{
+				std::lock_guard<std::mutex> lock(s_modScan.mutex);
+				if (!s_modScan.done[s_readIndex]) { break; }
 			}
+			ModReadResult& result = s_modScan.results[s_readIndex];
+			s_readIndex++;
+			updateFilter = true;
+			if (!result.valid) { continue; }
+
+			s_mods.push_back(result.mod);
+			if (!result.poster.empty())
+			{
+				UiTexture& poster = s_mods.back().image;
+				poster.texture = TFE_RenderBackend::createTexture(result.posterWidth, result.posterHeight, result.poster.data(), MAG_FILTER_LINEAR);
+				poster.width = result.posterWidth;
+				poster.height = result.posterHeight;
+				uploadCount++;
+			}
+			// The pixels are no longer needed, only the cache data is kept until the scan is finished.
+			std::vector<u32>().swap(result.poster);
+		}
+
+		if (s_readIndex == count)
+		{
+			finishModScan();
 		}
 
 		// Update the filtered list.
@@ -1077,8 +1504,9 @@ namespace TFE_FrontEndUI
 		}
 	}
 
-	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, UiTexture* poster)
+	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, ModReadResult* result)
 	{
+		std::vector<u8> imageBuffer;
 		if (zipFile && zipFile[0])
 		{
 			char zipPath[TFE_MAX_PATH];
@@ -1088,21 +1516,9 @@ namespace TFE_FrontEndUI
 			if (!zipArchive.open(zipPath)) { return; }
 			if (zipArchive.openFile(imageFileName))
 			{
-				size_t imageSize = zipArchive.getFileLength();
-				s_imageBuffer.resize(imageSize);
-				zipArchive.readFile(s_imageBuffer.data(), imageSize);
+				imageBuffer.resize(zipArchive.getFileLength());
+				zipArchive.readFile(imageBuffer.data(), imageBuffer.size());
 				zipArchive.closeFile();
-
-				SDL_Surface* image = TFE_Image::loadFromMemory((u8*)s_imageBuffer.data(), imageSize);
-				if (image)
-				{
-					TextureGpu* gpuImage = TFE_RenderBackend::createTexture(image->w, image->h, (u32*)image->pixels, MAG_FILTER_LINEAR);
-					poster->texture = gpuImage;
-					poster->width = image->w;
-					poster->height = image->h;
-
-					TFE_Image::free(image);
-				}
 			}
 			zipArchive.close();
 		}
@@ -1111,36 +1527,68 @@ namespace TFE_FrontEndUI
 			char imagePath[TFE_MAX_PATH];
 			sprintf(imagePath, "%s%s", baseDir, imageFileName);
 
-			SDL_Surface* image = TFE_Image::get(imagePath);
-			if (image)
+			FileStream imageFile;
+			if (!imageFile.open(imagePath, Stream::MODE_READ))
 			{
-				TextureGpu* gpuImage = TFE_RenderBackend::createTexture(image->w, image->h, (u32*)image->pixels, MAG_FILTER_LINEAR);
-				poster->texture = gpuImage;
-				poster->width = image->w;
-				poster->height = image->h;
+				TFE_System::logWrite(LOG_ERROR, "ModLoader", "Cannot load image from '%s'", imagePath);
+				return;
 			}
+			imageBuffer.resize(imageFile.getSize());
+			imageFile.readBuffer(imageBuffer.data(), (u32)imageBuffer.size());
+			imageFile.close();
+		}
+
+		if (!imageBuffer.empty())
+		{
+			copyPoster(TFE_Image::loadFromMemory(imageBuffer.data(), imageBuffer.size()), result);
 		}
 	}
 
-	bool extractPosterFromMod(const char* baseDir, const char* archiveFileName, UiTexture* poster)
+	bool readArchiveFile(Archive* archive, const char* fileName, std::vector<u8>& buffer)
 	{
-		// Extract a "poster", if possible, from the GOB file.
-		// And then save it as a JPG in /ProgramData/TheForceEngine/ModPosters/NAME.jpg
-		char modPath[TFE_MAX_PATH], srcPath[TFE_MAX_PATH], srcPathTex[TFE_MAX_PATH];
-		sprintf(modPath, "%s%s", baseDir, archiveFileName);
+		if (!archive || !archive->fileExists(fileName) || !archive->openFile(fileName)) { return false; }
+		buffer.resize(archive->getFileLength());
+		archive->readFile(buffer.data(), buffer.size());
+		archive->closeFile();
+		return true;
+	}
+
+	// The base game poster data, used when a mod does not provide its own.
+	// This is read once on whichever worker needs it first.
+	void readBasePosterData()
+	{
+		char srcPath[TFE_MAX_PATH], srcPathTex[TFE_MAX_PATH];
 		sprintf(srcPath, "%s%s", TFE_Paths::getPath(PATH_SOURCE_DATA), "DARK.GOB");
 		sprintf(srcPathTex, "%s%s", TFE_Paths::getPath(PATH_SOURCE_DATA), "TEXTURES.GOB");
 
+		// The shared archives are not thread safe, so open private copies.
+		GobArchive archiveTex, archiveBase;
+		if (archiveTex.open(srcPathTex))
+		{
+			readArchiveFile(&archiveTex, "wait.bm", s_baseWaitBm);
+			archiveTex.close();
+		}
+		if (archiveBase.open(srcPath))
+		{
+			readArchiveFile(&archiveBase, "wait.pal", s_baseWaitPal);
+			archiveBase.close();
+		}
+	}
+
+	bool extractPosterFromMod(const char* baseDir, const char* archiveFileName, ModReadResult* result)
+	{
+		// Extract a "poster", if possible, from the GOB file.
+		char modPath[TFE_MAX_PATH];
+		sprintf(modPath, "%s%s", baseDir, archiveFileName);
+
 		GobMemoryArchive gobMemArchive;
+		GobArchive gobArchive;
 		const size_t len = strlen(archiveFileName);
 		const char* archiveExt = &archiveFileName[len - 3];
 		Archive* archiveMod = nullptr;
-		bool archiveIsGob = true;
 		bool validGob = false;
 		if (strcasecmp(archiveExt, "zip") == 0)
 		{
-			archiveIsGob = false;
-
 			ZipArchive zipArchive;
 			if (zipArchive.open(modPath))
 			{
@@ -1167,6 +1615,7 @@ namespace TFE_FrontEndUI
 					const size_t lengthRead = zipArchive.readFile(buffer, bufferLen);
 					zipArchive.closeFile();
 
+					// The memory archive takes ownership of the buffer once it is open.
 					bool archiveRead = false;
 					if (lengthRead > 0)
 					{
@@ -1177,9 +1626,10 @@ namespace TFE_FrontEndUI
 							validGob = true;
 						}
 					}
-					
+
 					if (!archiveRead)
 					{
+						free(buffer);
 						TFE_System::logWrite(LOG_ERROR, "ModLoader", "Cannot open zip: '%s'", modPath);
 					}
 				}
@@ -1187,58 +1637,40 @@ namespace TFE_FrontEndUI
 				zipArchive.close();
 			}
 		}
-		else
+		else if (gobArchive.open(modPath))
 		{
-			archiveMod = Archive::getArchive(ARCHIVE_GOB, archiveFileName, modPath);
-			validGob = archiveMod != nullptr;
+			archiveMod = &gobArchive;
+			validGob = true;
 		}
-		Archive* archiveTex = Archive::getArchive(ARCHIVE_GOB, "TEXTURES.GOB", srcPathTex);
-		Archive* archiveBase = Archive::getArchive(ARCHIVE_GOB, "DARK.GOB", srcPath);
 
-		s_readBuffer[0].clear();
-		s_readBuffer[1].clear();
-		if (archiveMod || archiveBase)
+		std::vector<u8> waitBm, waitPal;
+		readArchiveFile(archiveMod, "wait.bm", waitBm);
+		readArchiveFile(archiveMod, "wait.pal", waitPal);
+		if (waitBm.empty() || waitPal.empty())
 		{
-			if (archiveMod && archiveMod->fileExists("wait.bm") && archiveMod->openFile("wait.bm"))
-			{
-				s_readBuffer[0].resize(archiveMod->getFileLength());
-				archiveMod->readFile(s_readBuffer[0].data(), archiveMod->getFileLength());
-				archiveMod->closeFile();
-			}
-			else if (archiveTex->openFile("wait.bm"))
-			{
-				s_readBuffer[0].resize(archiveTex->getFileLength());
-				archiveTex->readFile(s_readBuffer[0].data(), archiveTex->getFileLength());
-				archiveTex->closeFile();
-			}
-
-			if (archiveMod && archiveMod->fileExists("wait.pal") && archiveMod->openFile("wait.pal"))
-			{
-				s_readBuffer[1].resize(archiveMod->getFileLength());
-				archiveMod->readFile(s_readBuffer[1].data(), archiveMod->getFileLength());
-				archiveMod->closeFile();
-			}
-			else if (archiveBase->openFile("wait.pal"))
-			{
-				s_readBuffer[1].resize(archiveBase->getFileLength());
-				archiveBase->readFile(s_readBuffer[1].data(), archiveBase->getFileLength());
-				archiveBase->closeFile();
-			}
+			std::call_once(s_basePosterRead, readBasePosterData);
 		}
+		const std::vector<u8>& bm  = waitBm.empty()  ? s_baseWaitBm  : waitBm;
+		const std::vector<u8>& pal = waitPal.empty() ? s_baseWaitPal : waitPal;
 
-		if (!s_readBuffer[0].empty() && !s_readBuffer[1].empty())
+		if (!bm.empty() && pal.size() >= 768)
 		{
-			TextureData* imageData = bitmap_loadFromMemory(s_readBuffer[0].data(), s_readBuffer[0].size(), 1);
-			u32 palette[256];
-			convertPalette(s_readBuffer[1].data(), palette);
-			createTexture(imageData, palette, poster, MAG_FILTER_LINEAR);
-		}
+			TextureData* imageData = bitmap_loadFromMemory(bm.data(), bm.size(), 1);
+			if (imageData)
+			{
+				u32 palette[256];
+				convertPalette(pal.data(), palette);
 
-		if (archiveMod && archiveIsGob)
-		{
-			Archive::freeArchive(archiveMod);
-		}
+				result->posterWidth = imageData->width;
+				result->posterHeight = imageData->height;
+				result->poster.resize(imageData->width * imageData->height);
+				convertDfTextureToTrueColor(imageData, palette, result->poster.data());
 
+				free(imageData->image);
+				free(imageData->columns);
+				free(imageData);
+			}
+		}
 		return validGob;
 	}
-}
\ No newline at end of file
+}
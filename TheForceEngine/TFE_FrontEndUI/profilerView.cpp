@@ -3,12 +3,15 @@
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_System/system.h>
 #include <TFE_System/profiler.h>
+#include <TFE_System/frameLimiter.h>
+#include <TFE_System/framePipeline.h>
 #include <TFE_FileSystem/fileutil.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_Archive/archive.h>
 #include <TFE_Ui/ui.h>
 #include <TFE_Ui/markdown.h>
 #include <TFE_System/parser.h>
+#include <TFE_FrontEndUI/console.h>
 
 #include <algorithm>
 
@@ -16,8 +19,43 @@ namespace TFE_ProfilerView
 {
 	static bool s_open = false;
 
+	void frameStatsConsole(const std::vector<std::string>& args)
+	{
+		TFE_System::FrameTimeStats stats;
+		TFE_System::frameLimiter_getStats(&stats);
+
+		char res[256];
+		sprintf(res, "Frames: %u, average: %0.3fms, p50: %0.3fms, p99: %0.3fms, max: %0.3fms", stats.frameCount,
+			stats.average * 1000.0, stats.p50 * 1000.0, stats.p99 * 1000.0, stats.max * 1000.0);
+		TFE_Console::addToHistory(res);
+
+		if (args.size() >= 2 && strcasecmp(args[1].c_str(), "reset") == 0)
+		{
+			TFE_System::frameLimiter_resetStats();
+		}
+	}
+
+	void pipelineStatsConsole(const std::vector<std::string>& args)
+	{
+		TFE_System::FramePipelineStats stats;
+		TFE_System::framePipeline_getStats(&stats);
+
+		char res[256];
+		sprintf(res, "Pipelined frames: %u (%s), simulation: %0.3fms average, %0.3fms max, present: %0.3fms, wait: %0.3fms", stats.frameCount,
+			TFE_System::framePipeline_isEnabled() ? "enabled" : "disabled", stats.simAverage * 1000.0, stats.simMax * 1000.0,
+			stats.presentAverage * 1000.0, stats.waitAverage * 1000.0);
+		TFE_Console::addToHistory(res);
+
+		if (args.size() >= 2 && strcasecmp(args[1].c_str(), "reset") == 0)
+		{
+			TFE_System::framePipeline_resetStats();
+		}
+	}
+
 	bool init()
 	{
+		CCMD("frameStats", frameStatsConsole, 0, "Shows the frame time percentiles since the last reset. 'frameStats reset' also clears them.");
+		CCMD("pipelineStats", pipelineStatsConsole, 0, "Shows the pipelined frame timings since the last reset. 'pipelineStats reset' also clears them.");
 		return true;
 	}
 
@@ -46,6 +84,32 @@ namespace TFE_ProfilerView
 		}
 		ImGui::Unindent();
 
+		ImGui::Spacing();
+		ImGui::LabelText("##Label", "Frame Times");
+		ImGui::Separator();
+		TFE_System::FrameTimeStats stats;
+		TFE_System::frameLimiter_getStats(&stats);
+		ImGui::Indent();
+		ImGui::Text("p50 %0.3fms  p99 %0.3fms  max %0.3fms  average %0.3fms  (%u frames)", stats.p50 * 1000.0, stats.p99 * 1000.0,
+			stats.max * 1000.0, stats.average * 1000.0, stats.frameCount);
+		if (TFE_System::frameLimiter_get() > 0.0)
+		{
+			ImGui::Text("Limiter accuracy %0.2f%%", TFE_System::frameLimiter_getAccuracy() * 100.0);
+		}
+		if (TFE_System::framePipeline_isEnabled())
+		{
+			TFE_System::FramePipelineStats pipeline;
+			TFE_System::framePipeline_getStats(&pipeline);
+			ImGui::Text("Pipelined: simulation %0.3fms (max %0.3fms)  present %0.3fms  wait %0.3fms  (%u frames)", pipeline.simAverage * 1000.0,
+				pipeline.simMax * 1000.0, pipeline.presentAverage * 1000.0, pipeline.waitAverage * 1000.0, pipeline.frameCount);
+		}
+		if (ImGui::Button("Reset"))
+		{
+			TFE_System::frameLimiter_resetStats();
+			TFE_System::framePipeline_resetStats();
+		}
+		ImGui::Unindent();
+
 		ImGui::Spacing();
 		ImGui::LabelText("##Label", "Zones");
 		ImGui::Separator();
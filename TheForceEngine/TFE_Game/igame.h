@@ -29,6 +29,12 @@ struct IGame
 	virtual bool serializeGameState(Stream* stream, const char* filename, bool writeState) { return false; };
 	virtual bool canSave() { return false; }
 	virtual bool isPaused() { return false; }
+	// Can the next simulation step run on a worker thread while the previous frame is presented?
+	virtual bool canPipelineFrame() { return false; }
+	// Capture or restore the running level in place, without going through the load path.
+	// Returns false if the game cannot snapshot its current state or the snapshot no longer matches it.
+	virtual bool captureSnapshot(Stream* stream) { return false; }
+	virtual bool restoreSnapshot(Stream* stream) { return false; }
 	virtual void getLevelName(char* name) {};
 	virtual void getLevelId(char* name) {};
 	virtual void getModList(char* modList) {};
@@ -1,15 +1,23 @@
 #include "saveSystem.h"
 #include <TFE_Asset/imageAsset.h>
 #include <TFE_DarkForces/hud.h>
+#include <TFE_DarkForces/time.h>
 #include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/memorystream.h>
+#include <TFE_FrontEndUI/console.h>
 #include <TFE_Input/inputMapping.h>
+#include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Memory/snapshotRing.h>
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Settings/gameSourceData.h>
+#include <TFE_Settings/settings.h>
 #include <TFE_System/system.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
 using namespace TFE_Input;
+using namespace TFE_Memory;
 
 namespace TFE_SaveSystem
 {
@@ -27,6 +35,19 @@ namespace TFE_SaveSystem
 		SVER_CUR = SVER_REPLAY
 	};
 
+	enum RewindConst
+	{
+		REWIND_SLOT_COUNT = 64,
+		REWIND_MIN_AGE    = TICKS_PER_SECOND,	// Rewinding skips snapshots younger than this.
+	};
+
+	// Each rewind snapshot starts with its kind.
+	enum RewindEntry : u32
+	{
+		REWIND_ENTRY_STATE = 0,	// Serialized game state, restored through the load path.
+		REWIND_ENTRY_IN_PLACE,	// Memory region images restored in place, see IGame::captureSnapshot().
+	};
+
 	const int TFE_MAX_SAVES = 1024; 
 
 	static SaveRequest s_req = SF_REQ_NONE;
@@ -39,6 +60,27 @@ namespace TFE_SaveSystem
 	static u32* s_imageBuffer[2] = { nullptr, nullptr };
 	static size_t s_imageBufferSize[2] = { 0 };
 
+	// In-memory game states: the rewind snapshots and the last quicksave of this session.
+	static SnapshotRing* s_rewindRing = nullptr;
+	static size_t s_rewindBudget = 0;
+	static Tick s_nextSnapshotTick = 0;
+	static MemoryStream s_stateStream;
+	static MemoryStream s_loadStream;
+	static MemoryStream s_verifyStream;
+	static MemoryStream s_quickState;
+	static bool s_quickStateValid = false;
+	static f64 s_lastCaptureMs = 0.0;
+	static f64 s_lastRestoreMs = 0.0;
+	static bool s_lastRestoreInPlace = false;
+
+	// In-memory state to load instead of a save file, see postLoadRequest().
+	static MemoryStream* s_reqState = nullptr;
+	static s32 s_reqReplayCounter = -1;
+	static u64 s_restoreStart = 0;
+	static bool s_restorePending = false;
+
+	void rewindStatsConsole(const ConsoleArgList& args);
+
 	bool versionValid(s32 version)
 	{
 		return version == SVER_CUR;
@@ -208,6 +250,7 @@ namespace TFE_SaveSystem
 
 	void init()
 	{
+		CCMD("rewindStats", rewindStatsConsole, 0, "Shows the rewind snapshot count, memory use and the last capture and restore times.");
 	}
 
 	void destroy()
@@ -218,6 +261,226 @@ namespace TFE_SaveSystem
 			s_imageBufferSize[i] = 0;
 			s_imageBuffer[i] = nullptr;
 		}
+		snapshotRing_destroy(s_rewindRing);
+		s_rewindRing = nullptr;
+		s_quickStateValid = false;
+	}
+
+	bool writeStateToMemory(MemoryStream* stream, const char* filename)
+	{
+		stream->clear();
+		if (!stream->open(Stream::MODE_WRITE)) { return false; }
+		const bool ret = s_game->serializeGameState(stream, filename, true);
+		stream->close();
+		return ret;
+	}
+
+	// Read a game state from memory; the game must have just been created, as when loading a save file.
+	bool readStateFromMemory(MemoryStream* stream)
+	{
+		if (!stream->open(Stream::MODE_READ)) { return false; }
+		const bool ret = s_game->serializeGameState(stream, nullptr, false);
+		stream->close();
+		return ret;
+	}
+
+	bool verifyRestoredState(const void* expected, size_t size)
+	{
+		if (!writeStateToMemory(&s_verifyStream, nullptr)) { return false; }
+
+		const u8* cur = (const u8*)s_verifyStream.data();
+		const u8* ref = (const u8*)expected;
+		const size_t curSize = s_verifyStream.getSize();
+		const size_t count = std::min(size, curSize);
+		size_t firstDiff = 0;
+		while (firstDiff < count && cur[firstDiff] == ref[firstDiff]) { firstDiff++; }
+
+		if (firstDiff == count && size == curSize)
+		{
+			TFE_System::logWrite(LOG_MSG, "SaveSystem", "Snapshot restore verified, %u bytes match.", (u32)size);
+			return true;
+		}
+		TFE_System::logWrite(LOG_ERROR, "SaveSystem", "Snapshot restore mismatch: expected %u bytes, serialized %u, first difference at %u.",
+			(u32)size, (u32)curSize, (u32)firstDiff);
+		return false;
+	}
+
+	// Capture a rewind snapshot, in place if the game supports it for the current state.
+	bool writeRewindEntry(MemoryStream* stream)
+	{
+		stream->clear();
+		if (!stream->open(Stream::MODE_WRITE)) { return false; }
+
+		u32 kind = REWIND_ENTRY_IN_PLACE;
+		stream->write(&kind);
+		bool ret = s_game->captureSnapshot(stream);
+		if (ret)
+		{
+			// With verification enabled, the serialized state is kept with the snapshot to check the restore against.
+			u32 verifySize = 0;
+			if (TFE_Settings::getTempSettings()->verifySnapshots && writeStateToMemory(&s_verifyStream, nullptr))
+			{
+				verifySize = (u32)s_verifyStream.getSize();
+				// Serializing cleared the block marks of the snapshot.
+				TFE_Jedi::serialization_clearBlocks();
+			}
+			stream->write(&verifySize);
+			if (verifySize)
+			{
+				stream->writeBuffer(s_verifyStream.data(), verifySize);
+			}
+		}
+		else
+		{
+			stream->clear();
+			stream->open(Stream::MODE_WRITE);
+			kind = REWIND_ENTRY_STATE;
+			stream->write(&kind);
+			ret = s_game->serializeGameState(stream, nullptr, true);
+		}
+		stream->close();
+		return ret;
+	}
+
+	void saveQuickState()
+	{
+		s_quickStateValid = writeStateToMemory(&s_quickState, c_quickSaveName);
+		if (!s_quickStateValid) { return; }
+
+		char filePath[TFE_MAX_PATH];
+		sprintf(filePath, "%s%s", s_gameSavePath, c_quickSaveName);
+		FileStream stream;
+		if (stream.open(filePath, Stream::MODE_WRITE))
+		{
+			saveHeader(&stream, "Quicksave");
+			stream.writeBuffer(s_quickState.data(), (u32)s_quickState.getSize());
+			stream.close();
+		}
+	}
+
+	void updateRewind()
+	{
+		const TFE_Settings_Game* gameSettings = TFE_Settings::getGameSettings();
+		if (!gameSettings->df_enableRewind)
+		{
+			snapshotRing_destroy(s_rewindRing);
+			s_rewindRing = nullptr;
+			return;
+		}
+
+		const size_t budget = size_t(std::max(gameSettings->df_rewindBudgetMB, 1)) << 20;
+		if (!s_rewindRing || budget != s_rewindBudget)
+		{
+			snapshotRing_destroy(s_rewindRing);
+			s_rewindRing = snapshotRing_create("Rewind", REWIND_SLOT_COUNT, budget);
+			s_rewindBudget = budget;
+			s_nextSnapshotTick = TFE_DarkForces::s_curTick;
+			if (!s_rewindRing) { return; }
+		}
+
+		// Time only moves backwards when a different state was loaded, so older snapshots no longer apply.
+		const Tick curTick = TFE_DarkForces::s_curTick;
+		if (snapshotRing_getCount(s_rewindRing) && curTick < snapshotRing_getTag(s_rewindRing, 0))
+		{
+			snapshotRing_clear(s_rewindRing);
+			s_nextSnapshotTick = curTick;
+		}
+		if (curTick < s_nextSnapshotTick) { return; }
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		if (writeRewindEntry(&s_stateStream))
+		{
+			const u32* blockEnds = nullptr;
+			const u32 blockCount = TFE_Jedi::serialization_getBlocks(&blockEnds);
+			snapshotRing_push(s_rewindRing, s_stateStream.data(), s_stateStream.getSize(), curTick, blockEnds, blockCount);
+		}
+		s_lastCaptureMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+		s_nextSnapshotTick = curTick + std::max(gameSettings->df_rewindInterval, 1) * TICKS_PER_SECOND;
+	}
+
+	bool rewind()
+	{
+		const Tick curTick = TFE_DarkForces::s_curTick;
+		while (snapshotRing_getCount(s_rewindRing) > 1 && snapshotRing_getTag(s_rewindRing, 0) + REWIND_MIN_AGE > curTick)
+		{
+			snapshotRing_pop(s_rewindRing);
+		}
+
+		while (snapshotRing_getCount(s_rewindRing))
+		{
+			const Tick tick = snapshotRing_getTag(s_rewindRing, 0);
+			const size_t size = snapshotRing_getSize(s_rewindRing, 0);
+			if (size < sizeof(u32) || !s_stateStream.allocate(size) || !snapshotRing_read(s_rewindRing, 0, s_stateStream.data()))
+			{
+				return false;
+			}
+			// Remove the snapshot so that rewinding again goes further back.
+			snapshotRing_pop(s_rewindRing);
+
+			u32 kind = REWIND_ENTRY_STATE;
+			memcpy(&kind, s_stateStream.data(), sizeof(u32));
+			if (kind == REWIND_ENTRY_IN_PLACE)
+			{
+				if (!s_stateStream.open(Stream::MODE_READ)) { return false; }
+				s_stateStream.read(&kind);
+
+				const u64 start = TFE_System::getCurrentTimeInTicks();
+				const bool restored = s_game->restoreSnapshot(&s_stateStream);
+				if (restored)
+				{
+					s_lastRestoreMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+					s_lastRestoreInPlace = true;
+					TFE_System::logWrite(LOG_MSG, "SaveSystem", "Rewound to tick %u in place in %0.2f ms.", tick, s_lastRestoreMs);
+
+					u32 verifySize = 0;
+					s_stateStream.read(&verifySize);
+					if (verifySize)
+					{
+						verifyRestoredState((const u8*)s_stateStream.data() + s_stateStream.getLoc(), verifySize);
+					}
+				}
+				s_stateStream.close();
+				if (!restored)
+				{
+					// The level or the loaded assets changed since the snapshot, try an older one.
+					TFE_System::logWrite(LOG_WARNING, "SaveSystem", "The rewind snapshot at tick %u no longer matches the game, skipping it.", tick);
+					continue;
+				}
+
+				s_nextSnapshotTick = TFE_DarkForces::s_curTick + std::max(TFE_Settings::getGameSettings()->df_rewindInterval, 1) * TICKS_PER_SECOND;
+				return true;
+			}
+
+			// The load path reads the state after this returns, so it needs its own copy without the entry kind.
+			if (!s_loadStream.load(size - sizeof(u32), (const u8*)s_stateStream.data() + sizeof(u32)))
+			{
+				return false;
+			}
+			TFE_System::logWrite(LOG_MSG, "SaveSystem", "Rewinding to tick %u.", tick);
+			postLoadRequest(&s_loadStream, "Rewind");
+			return true;
+		}
+
+		TFE_DarkForces::hud_sendTextMessage("Nothing to Rewind", 0, false);
+		return false;
+	}
+
+	void rewindStatsConsole(const ConsoleArgList& args)
+	{
+		char res[256];
+		if (!s_rewindRing)
+		{
+			sprintf(res, "Rewind is disabled.");
+		}
+		else
+		{
+			sprintf(res, "Rewind: %u snapshots, %0.2f / %0.2f MB, last capture %0.2f ms, last restore %0.2f ms (%s).",
+				snapshotRing_getCount(s_rewindRing),
+				f64(snapshotRing_getMemoryUsed(s_rewindRing)) / (1024.0 * 1024.0),
+				f64(snapshotRing_getMemoryBudget(s_rewindRing)) / (1024.0 * 1024.0),
+				s_lastCaptureMs, s_lastRestoreMs, s_lastRestoreInPlace ? "in place" : "load path");
+		}
+		TFE_Console::addToHistory(res);
 	}
 
 	bool saveGame(const char* filename, const char* saveName)
@@ -238,6 +501,22 @@ namespace TFE_SaveSystem
 
 	bool loadGame(const char* filename)
 	{
+		if (s_reqState)
+		{
+			// The game has been recreated, read the requested in-memory state instead of a file.
+			MemoryStream* state = s_reqState;
+			s_reqState = nullptr;
+			if (!readStateFromMemory(state)) { return false; }
+			if (s_reqReplayCounter >= 0)
+			{
+				inputMapping_setReplayCounter(s_reqReplayCounter);
+			}
+			// The restore time is measured once the mission is running again, see update().
+			s_restorePending = true;
+			s_nextSnapshotTick = TFE_DarkForces::s_curTick + std::max(TFE_Settings::getGameSettings()->df_rewindInterval, 1) * TICKS_PER_SECOND;
+			return true;
+		}
+
 		char filePath[TFE_MAX_PATH];
 		sprintf(filePath, "%s%s", s_gameSavePath, filename);
 
@@ -274,6 +553,14 @@ namespace TFE_SaveSystem
 	{
 		s_req = SF_REQ_LOAD;
 		strcpy(s_reqFilename, filename);
+		s_reqState = nullptr;
+	}
+
+	void postLoadRequest(MemoryStream* state, const char* name, s32 replayCounter)
+	{
+		postLoadRequest(name);
+		s_reqState = state;
+		s_reqReplayCounter = replayCounter;
 	}
 
 	void postSaveRequest(const char* filename, const char* saveName, s32 delay)
@@ -289,6 +576,9 @@ namespace TFE_SaveSystem
 		if (s_req == SF_REQ_LOAD)
 		{
 			s_req = SF_REQ_NONE;
+			// The caller tears down and recreates the game before calling loadGame(), so this is when a restore starts.
+			s_restoreStart = TFE_System::getCurrentTimeInTicks();
+			s_restorePending = false;
 			return s_reqFilename;
 		}
 		return nullptr;
@@ -339,6 +629,12 @@ namespace TFE_SaveSystem
 	void setCurrentGame(IGame* game)
 	{
 		s_game = game;
+		// In-memory states belong to the previous game instance, unless one of them is being loaded into the new one.
+		if (!s_reqState)
+		{
+			s_quickStateValid = false;
+			snapshotRing_clear(s_rewindRing);
+		}
 		setCurrentGame(game->id);
 	}
 
@@ -354,10 +650,20 @@ namespace TFE_SaveSystem
 		static s32 lastState = 0;
 		const char* saveFilename = saveRequestFilename();
 
+		if (s_restorePending && s_game->canSave())
+		{
+			// Full cost of an in-memory restore: game teardown and recreation, reading the state and reloading the level.
+			s_restorePending = false;
+			s_lastRestoreInPlace = false;
+			s_lastRestoreMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - s_restoreStart);
+			TFE_System::logWrite(LOG_MSG, "SaveSystem", "Restored the in-memory state in %0.2f ms.", s_lastRestoreMs);
+		}
+
 		bool canSave = !lastState && s_game->canSave();
 		if (isReplaySystemLive())
 		{
-			// no saving or loading during replay system
+			// no saving or loading during replay system, only the demo keyframes.
+			updateReplayKeyframes();
 			return;
 		}
 		else if (saveFilename && canSave)
@@ -367,14 +673,20 @@ namespace TFE_SaveSystem
 		}
 		else if (inputMapping_getActionState(IAS_QUICK_SAVE) == STATE_PRESSED && canSave)
 		{
-			saveGame(c_quickSaveName, "Quicksave");
+			saveQuickState();
 			lastState = 1;
 		}
 		else if (inputMapping_getActionState(IAS_QUICK_LOAD) == STATE_PRESSED && !lastState)
 		{
 			char filePath[TFE_MAX_PATH];
 			sprintf(filePath, "%s%s", s_gameSavePath, c_quickSaveName);
-			if (FileUtil::exists(filePath))
+			if (s_quickStateValid && canSave)
+			{
+				// The quicksave from this session is still in memory, load it without reading the file.
+				postLoadRequest(&s_quickState, c_quickSaveName);
+				lastState = 1;
+			}
+			else if (FileUtil::exists(filePath))
 			{
 				postLoadRequest(c_quickSaveName);
 				lastState = 1;
@@ -385,9 +697,15 @@ namespace TFE_SaveSystem
 				lastState = 0;
 			}
 		}
+		else if (inputMapping_getActionState(IAS_REWIND) == STATE_PRESSED && canSave && s_rewindRing)
+		{
+			rewind();
+			lastState = 1;
+		}
 		else
 		{
 			lastState = 0;
+			if (canSave) { updateRewind(); }
 		}
 	}
 
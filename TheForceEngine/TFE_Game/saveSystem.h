@@ -5,6 +5,8 @@
 #include "igame.h"
 #include <TFE_Asset/imageAsset.h>
 
+class MemoryStream;
+
 namespace TFE_SaveSystem
 {
 	static const char* c_quickSaveName = "quicksave.tfe";
@@ -45,7 +47,12 @@ namespace TFE_SaveSystem
 	void loadHeader(Stream* stream, SaveHeader* header, const char* fileName);
 
 	void postLoadRequest(const char* filename);
+	// Load a game state held in memory through the same path as a save file, so the game is torn down and recreated first.
+	// 'state' must stay valid until the load is done; 'replayCounter' is restored for demo playback if not negative.
+	void postLoadRequest(MemoryStream* state, const char* name, s32 replayCounter = -1);
 	void postSaveRequest(const char* filename, const char* saveName, s32 delay = 0);
+	// Serialize the current game state and compare it with 'expected', used to check states restored in place.
+	bool verifyRestoredState(const void* expected, size_t size);
 	const char* loadRequestFilename();
 	const char* saveRequestFilename();
 
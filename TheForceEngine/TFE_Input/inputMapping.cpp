@@ -19,7 +19,8 @@ namespace TFE_Input
 		INPUT_ADD_DEADZONE  = 0x00020002,
 		INPUT_ADD_HIGH_DEF  = 0x00020003,
 		INPUT_DEMO_CONFIG   = 0x00020004,
-		INPUT_CUR_VERSION = INPUT_DEMO_CONFIG
+		INPUT_ADD_REWIND    = 0x00020005,
+		INPUT_CUR_VERSION = INPUT_ADD_REWIND
 	};
 
 	static const char* c_inputRemappingName = "tfe_input_remapping.bin";
@@ -103,6 +104,9 @@ namespace TFE_Input
 		// DEMO handling
 		{ IADF_DEMO_SPEEDUP, ITYPE_KEYBOARD, KEY_KP_PLUS },
 		{ IADF_DEMO_SLOWDOWN, ITYPE_KEYBOARD, KEY_KP_MINUS },
+
+		// Rewind
+		{ IAS_REWIND, ITYPE_KEYBOARD, KEY_F10, KEYMOD_ALT },
 	};
 
 	static InputBinding s_defaultControllerBinds[] =
@@ -301,6 +305,11 @@ namespace TFE_Input
 			inputMapping_addBinding(&s_defaultKeyboardBinds[IADF_DEMO_SLOWDOWN]);
 		}
 
+		if (version < INPUT_ADD_REWIND)
+		{
+			inputMapping_addBinding(&s_defaultKeyboardBinds[IAS_REWIND]);
+		}
+
 		return true;
 	}
 
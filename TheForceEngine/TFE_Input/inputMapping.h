@@ -90,6 +90,9 @@ namespace TFE_Input
 		IADF_DEMO_SPEEDUP,
 		IADF_DEMO_SLOWDOWN,
 
+		// Rewind
+		IAS_REWIND,
+
 		IA_COUNT,
 		IAS_COUNT = IAS_SYSTEM_MENU + 1,
 	};
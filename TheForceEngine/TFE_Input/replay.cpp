@@ -14,11 +14,15 @@
 #include <TFE_DarkForces/Actor/mousebot.h>
 #include <TFE_DarkForces/Actor/turret.h>
 #include <TFE_DarkForces/GameUI/agentMenu.h>
+#include <TFE_DarkForces/GameUI/escapeMenu.h>
 #include <TFE_DarkForces/GameUI/pda.h>
 #include <TFE_DarkForces/mission.h>
 #include <TFE_DarkForces/time.h>
 #include <TFE_FileSystem/fileutil.h>
+#include <TFE_Archive/zstdCompression.h>
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/memorystream.h>
+#include <TFE_FrontEndUI/console.h>
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_FrontEndUI/modLoader.h>
 #include <TFE_Game/saveSystem.h>
@@ -82,12 +86,41 @@ namespace TFE_Input
 	
 	std::vector<char> settingBuffer;
 
+	// Compressed game state captured while recording, so playback can seek without
+	// simulating from the start of the demo.
+	struct ReplayKeyframe
+	{
+		s32 counter;	// Input counter when the keyframe was captured.
+		Tick tick;
+		u32 rawSize;
+		std::vector<u8> data;
+		// Memory region snapshot restored in place while it still matches the game, only kept for this session.
+		u32 snapshotRawSize = 0;
+		std::vector<u8> snapshot;
+	};
+	static std::vector<ReplayKeyframe> s_keyframes;
+	static MemoryStream s_keyframeStream;
+	static MemoryStream s_restoreStream;	// Must stay valid until the save system has loaded it.
+	static Tick s_nextKeyframeTick = 0;
+	// Demos recorded without keyframes capture them during playback, so seeking back works after the first pass.
+	static bool s_playbackKeyframes = false;
+	static bool s_seekTestDone = false;
+
+	// Seeking state, s_seekCounter is the target input counter while fast-forwarding.
+	static bool s_seekRequest = false;
+	static Tick s_seekTick = 0;
+	static s32  s_seekCounter = -1;
+	static u64  s_seekStartTime = 0;
+
 	enum ReplayVersion : u32
 	{
 		ReplayVersionInit = 1,
-		ReplayVersionCur = ReplayVersionInit
+		ReplayVersionKeyframes,
+		ReplayVersionCur = ReplayVersionKeyframes
 	};
 
+	void demoSeekConsole(const ConsoleArgList& args);
+
 	void initReplays()
 	{
 		// TO DO - combine replays from both sources. 
@@ -116,6 +149,8 @@ namespace TFE_Input
 		{
 			TFE_Settings::getGameSettings()->df_enableRecording = true;
 		}
+
+		CCMD("demoSeek", demoSeekConsole, 1, "Seek demo playback to the given time in seconds from the start of the demo.");
 	}
 
 	bool shouldLogReplay()
@@ -216,7 +251,7 @@ namespace TFE_Input
 		// When recording, normally ignore the escape key unless the PDA is open
 		// Don't allow saving/reloading either as the state will become messed up.
 		if (isRecording() && (keyCode != KEY_ESCAPE || TFE_DarkForces::pda_isOpen()) 
-			&& !(isBindingPressed(IAS_QUICK_SAVE) || isBindingPressed(IAS_QUICK_LOAD)))
+			&& !(isBindingPressed(IAS_QUICK_SAVE) || isBindingPressed(IAS_QUICK_LOAD) || isBindingPressed(IAS_REWIND)))
 		{
 			int updateCounter = inputMapping_getCounter();
 			if (isPress)
@@ -470,7 +505,7 @@ namespace TFE_Input
 				TFE_SaveSystem::SaveHeader* header = new TFE_SaveSystem::SaveHeader();
 				TFE_SaveSystem::loadHeader(stream, header, s_headerName);
 			}
-			SERIALIZE_VERSION(ReplayVersionInit);
+			SERIALIZE_VERSION(ReplayVersionCur);
 
 			// AGENT INFORMATION
 			
@@ -505,6 +540,45 @@ namespace TFE_Input
 		return fileHandler;
 	}
 
+	// The keyframe index table is stored first, followed by the compressed game state for each keyframe.
+	void serializeKeyframes(Stream* stream, bool writeFlag)
+	{
+		s32 keyframeCount = (s32)s_keyframes.size();
+		SERIALIZE(ReplayVersionKeyframes, keyframeCount, 0);
+		if (!writeFlag)
+		{
+			s_keyframes.resize(keyframeCount);
+		}
+
+		for (s32 i = 0; i < keyframeCount; i++)
+		{
+			ReplayKeyframe& keyframe = s_keyframes[i];
+			u32 dataSize = (u32)keyframe.data.size();
+			SERIALIZE(ReplayVersionKeyframes, keyframe.counter, 0);
+			SERIALIZE(ReplayVersionKeyframes, keyframe.tick, 0);
+			SERIALIZE(ReplayVersionKeyframes, keyframe.rawSize, 0);
+			SERIALIZE(ReplayVersionKeyframes, dataSize, 0);
+			if (!writeFlag)
+			{
+				keyframe.data.resize(dataSize);
+			}
+		}
+
+		for (s32 i = 0; i < keyframeCount; i++)
+		{
+			std::vector<u8>& data = s_keyframes[i].data;
+			if (!data.empty())
+			{
+				SERIALIZE_BUF(ReplayVersionKeyframes, data.data(), (u32)data.size());
+			}
+		}
+
+		if (!writeFlag && keyframeCount)
+		{
+			TFE_System::logWrite(LOG_MSG, "Replay", "Loaded %d seek keyframes.", keyframeCount);
+		}
+	}
+
 	// Main replay serialization function
 	// The demo file contains all the information needed to replay the game
 	// -----------------------------------------------------------
@@ -514,6 +588,7 @@ namespace TFE_Input
 	// 3. It will contain the input events for the replay
 	// 4. It will contain the game and graphical settings 
 	// 5. It will contain the seed and tick timing data
+	// 6. It will contain compressed game state keyframes used for seeking
 	// 
 	// -----------------------------------------------------------
 	void serializeDemo(FileStream* stream, bool writeFlag)
@@ -677,6 +752,7 @@ namespace TFE_Input
 				TFE_System::setStartTime(replayStartTime);
 			}
 
+			serializeKeyframes(stream, writeFlag);
 			s_replayFile.close();
 		}
 		// Resume the game
@@ -922,6 +998,10 @@ namespace TFE_Input
 		saveTick();
 		saveInitTime();
 
+		s_keyframes.clear();
+		s_playbackKeyframes = false;
+		s_nextKeyframeTick = TFE_DarkForces::s_curTick + TFE_Settings::getGameSettings()->df_demoKeyframeInterval * TICKS_PER_SECOND;
+
 		if (shouldLogReplay())
 		{
 			TFE_System::logClose();
@@ -945,6 +1025,7 @@ namespace TFE_Input
 		{
 			serializeDemo(&s_replayFile, true);
 		}
+		s_keyframes.clear();
 
 		// Re-enable cutscenes while recording
 		enableCutscenes(JTRUE);
@@ -1110,7 +1191,11 @@ namespace TFE_Input
 			}
 			replayLogCounter++;
 			TFE_System::logTimeToggle();
-		}		
+		}
+
+		s_playbackKeyframes = s_keyframes.empty() && TFE_Settings::getGameSettings()->df_demoKeyframeInterval > 0;
+		s_nextKeyframeTick = 0;
+		s_seekTestDone = false;
 	}
 
 	void restoreAgent()
@@ -1145,6 +1230,10 @@ namespace TFE_Input
 		replayFilehandler = -1;
 		setDemoPlayback(false);
 
+		s_keyframes.clear();
+		s_seekRequest = false;
+		s_seekCounter = -1;
+
 		restoreAgent();
 		restoreGameSettings();
 		restoreInputs();
@@ -1168,4 +1257,252 @@ namespace TFE_Input
 			TFE_FrontEndUI::exitToMenu();
 		}
 	}
+
+	// Seeking uses the snapshot to skip the game teardown and reload, so it is compressed for speed.
+	void attachSnapshot(IGame* game, ReplayKeyframe* keyframe)
+	{
+		s_keyframeStream.clear();
+		if (!s_keyframeStream.open(Stream::MODE_WRITE)) { return; }
+		const bool captured = game->captureSnapshot(&s_keyframeStream);
+		s_keyframeStream.close();
+		if (!captured) { return; }
+
+		keyframe->snapshotRawSize = (u32)s_keyframeStream.getSize();
+		if (!zstd_compress(keyframe->snapshot, (const u8*)s_keyframeStream.data(), keyframe->snapshotRawSize, 1))
+		{
+			keyframe->snapshot.clear();
+			keyframe->snapshotRawSize = 0;
+		}
+	}
+
+	void captureKeyframe(IGame* game)
+	{
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		s_keyframeStream.clear();
+		if (!s_keyframeStream.open(Stream::MODE_WRITE)) { return; }
+		game->serializeGameState(&s_keyframeStream, nullptr, true);
+		s_keyframeStream.close();
+
+		ReplayKeyframe keyframe;
+		keyframe.counter = inputMapping_getCounter();
+		keyframe.tick = TFE_DarkForces::s_curTick;
+		keyframe.rawSize = (u32)s_keyframeStream.getSize();
+		if (!zstd_compress(keyframe.data, (const u8*)s_keyframeStream.data(), keyframe.rawSize, 6))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Replay", "Failed to compress the keyframe at tick %u.", keyframe.tick);
+			return;
+		}
+		attachSnapshot(game, &keyframe);
+
+		if (shouldLogReplay())
+		{
+			const f64 timeMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+			TFE_System::logWrite(LOG_MSG, "Replay", "Keyframe %d at update %d, tick %u: %u bytes compressed to %u in %0.2f ms.",
+				(s32)s_keyframes.size(), keyframe.counter, keyframe.tick, keyframe.rawSize, (u32)keyframe.data.size(), timeMs);
+		}
+		s_keyframes.push_back(std::move(keyframe));
+	}
+
+	bool restoreKeyframeInPlace(IGame* game, const ReplayKeyframe* keyframe)
+	{
+		if (!s_keyframeStream.allocate(keyframe->snapshotRawSize) ||
+			!zstd_decompress((u8*)s_keyframeStream.data(), keyframe->snapshotRawSize, keyframe->snapshot.data(), (u32)keyframe->snapshot.size()) ||
+			!s_keyframeStream.open(Stream::MODE_READ))
+		{
+			return false;
+		}
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		const bool restored = game->restoreSnapshot(&s_keyframeStream);
+		s_keyframeStream.close();
+		if (!restored) { return false; }
+
+		inputMapping_setReplayCounter(keyframe->counter);
+		const f64 timeMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+		TFE_System::logWrite(LOG_MSG, "Replay", "Restored the keyframe at tick %u in place in %0.2f ms.", keyframe->tick, timeMs);
+
+		if (TFE_Settings::getTempSettings()->verifySnapshots && s_restoreStream.allocate(keyframe->rawSize) &&
+			zstd_decompress((u8*)s_restoreStream.data(), keyframe->rawSize, keyframe->data.data(), (u32)keyframe->data.size()))
+		{
+			TFE_SaveSystem::verifyRestoredState(s_restoreStream.data(), keyframe->rawSize);
+		}
+		return true;
+	}
+
+	bool restoreKeyframe(IGame* game, const ReplayKeyframe* keyframe)
+	{
+		// The snapshot only applies while the same level and assets are loaded, otherwise use the load path.
+		if (!keyframe->snapshot.empty() && restoreKeyframeInPlace(game, keyframe))
+		{
+			return true;
+		}
+
+		if (!s_restoreStream.allocate(keyframe->rawSize) ||
+			!zstd_decompress((u8*)s_restoreStream.data(), keyframe->rawSize, keyframe->data.data(), (u32)keyframe->data.size()))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Replay", "Failed to decompress the keyframe at tick %u.", keyframe->tick);
+			return false;
+		}
+
+		// The keyframe is loaded like a save, the game is recreated before the state is read.
+		// Both recording and playback keep inputEvents[counter].curTick == s_curTick at this point in the frame,
+		// so the counter from the recording lines up with the restored game time.
+		TFE_SaveSystem::postLoadRequest(&s_restoreStream, "Seek", keyframe->counter);
+		return true;
+	}
+
+	// Game time of the first input update, demo times are relative to it.
+	bool getReplayStartTick(Tick* tick)
+	{
+		std::unordered_map<int, ReplayEvent>::const_iterator iEvent = inputEvents.find(0);
+		if (iEvent == inputEvents.end()) { return false; }
+		*tick = iEvent->second.curTick;
+		return true;
+	}
+
+	void startSeek(IGame* game)
+	{
+		s_seekRequest = false;
+
+		// Find the first update at or after the requested tick.
+		const s32 eventCount = (s32)inputEvents.size();
+		s32 targetCounter = eventCount - 1;
+		for (s32 i = 0; i < eventCount; i++)
+		{
+			std::unordered_map<int, ReplayEvent>::const_iterator iEvent = inputEvents.find(i);
+			if (iEvent != inputEvents.end() && iEvent->second.curTick >= s_seekTick)
+			{
+				targetCounter = i;
+				break;
+			}
+		}
+
+		// Keyframes are stored in recording order, so the last one before the target is the closest.
+		const ReplayKeyframe* keyframe = nullptr;
+		for (size_t i = 0; i < s_keyframes.size() && s_keyframes[i].counter <= targetCounter; i++)
+		{
+			keyframe = &s_keyframes[i];
+		}
+
+		const s32 curCounter = inputMapping_getCounter();
+		const bool restore = keyframe && (keyframe->counter > curCounter || targetCounter < curCounter);
+		if (!restore && targetCounter < curCounter)
+		{
+			TFE_DarkForces::hud_sendTextMessage("No keyframe before the seek position.", 1, false);
+			return;
+		}
+
+		s_seekStartTime = TFE_System::getCurrentTimeInTicks();
+		if (restore && !restoreKeyframe(game, keyframe))
+		{
+			return;
+		}
+
+		// Simulate forward as fast as possible, the world is not drawn until the target is reached.
+		s_seekCounter = targetCounter;
+		pauseReplay = false;
+		TFE_System::frameLimiter_set(0);
+		TFE_System::setVsync(false);
+		TFE_DarkForces::hud_sendTextMessage("Seeking...", 1, false);
+	}
+
+	void endSeek()
+	{
+		const f64 timeMs = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - s_seekStartTime);
+		TFE_System::logWrite(LOG_MSG, "Replay", "Seek to update %d finished in %0.2f ms.", s_seekCounter, timeMs);
+
+		s_seekCounter = -1;
+		handleFrameRate();
+		TFE_DarkForces::hud_sendTextMessage("Seek complete.", 1, false);
+	}
+
+	// Called at the start of the game frame, where saving and loading is safe.
+	void updateReplayKeyframes()
+	{
+		IGame* game = TFE_SaveSystem::getCurrentGame();
+		if (!game || !game->canSave() || !TFE_DarkForces::s_playerEye) { return; }
+		if (TFE_DarkForces::pda_isOpen() || TFE_DarkForces::escapeMenu_isOpen()) { return; }
+
+		if (isRecording())
+		{
+			const s32 interval = TFE_Settings::getGameSettings()->df_demoKeyframeInterval;
+			if (interval > 0 && TFE_DarkForces::s_curTick >= s_nextKeyframeTick)
+			{
+				captureKeyframe(game);
+				s_nextKeyframeTick = TFE_DarkForces::s_curTick + interval * TICKS_PER_SECOND;
+			}
+		}
+		else if (isDemoPlayback())
+		{
+			if (s_seekRequest)
+			{
+				startSeek(game);
+			}
+			else if (s_seekCounter >= 0 && inputMapping_getCounter() >= s_seekCounter)
+			{
+				endSeek();
+			}
+			else if (s_seekCounter < 0)
+			{
+				// Only capture past the newest keyframe so the list stays in recording order after seeking back.
+				const s32 interval = TFE_Settings::getGameSettings()->df_demoKeyframeInterval;
+				const s32 counter = inputMapping_getCounter();
+				if (s_playbackKeyframes && interval > 0 && TFE_DarkForces::s_curTick >= s_nextKeyframeTick &&
+					(s_keyframes.empty() || counter > s_keyframes.back().counter))
+				{
+					captureKeyframe(game);
+					s_nextKeyframeTick = TFE_DarkForces::s_curTick + interval * TICKS_PER_SECOND;
+				}
+				else
+				{
+					// Keyframes loaded from the demo get their snapshot when playback reaches them.
+					std::vector<ReplayKeyframe>::iterator keyframe = std::lower_bound(s_keyframes.begin(), s_keyframes.end(), counter,
+						[](const ReplayKeyframe& k, s32 c) { return k.counter < c; });
+					if (keyframe != s_keyframes.end() && keyframe->counter == counter && keyframe->snapshot.empty())
+					{
+						attachSnapshot(game, &*keyframe);
+					}
+				}
+
+				// --demo_seek_test: seek back to half the given time once, then play on to the end.
+				const f32 seekTestTime = TFE_Settings::getTempSettings()->demoSeekTest;
+				Tick startTick;
+				if (seekTestTime > 0.0f && !s_seekTestDone && getReplayStartTick(&startTick) &&
+					TFE_DarkForces::s_curTick >= startTick + Tick(seekTestTime * TICKS_PER_SECOND))
+				{
+					s_seekTestDone = true;
+					TFE_System::logWrite(LOG_MSG, "Replay", "Seek test: seeking back from %0.2f to %0.2f seconds.", seekTestTime, seekTestTime * 0.5f);
+					seekReplay(seekTestTime * 0.5f);
+				}
+			}
+		}
+	}
+
+	void seekReplay(f32 seconds)
+	{
+		Tick startTick;
+		if (!isDemoPlayback()) { return; }
+		if (!getReplayStartTick(&startTick))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Replay", "Cannot seek, the demo has no first input update.");
+			return;
+		}
+		s_seekRequest = true;
+		s_seekTick = startTick + Tick(std::max(seconds, 0.0f) * TICKS_PER_SECOND);
+	}
+
+	bool isReplaySeeking()
+	{
+		return s_seekCounter >= 0;
+	}
+
+	void demoSeekConsole(const ConsoleArgList& args)
+	{
+		if (!isDemoPlayback())
+		{
+			TFE_Console::addToHistory("demoSeek only works during demo playback.");
+			return;
+		}
+		seekReplay(TFE_Console::getFloatArg(args[1]));
+	}
 }
\ No newline at end of file
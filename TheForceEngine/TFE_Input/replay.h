@@ -89,6 +89,11 @@ namespace TFE_Input
 	void sendEndPlaybackMsg();
 	void sendEndRecordingMsg();
 
+	// Game state keyframes, captured while recording and used to seek during playback.
+	void updateReplayKeyframes();
+	void seekReplay(f32 seconds);
+	bool isReplaySeeking();
+
 	void recordEvent(int action, KeyboardCode keyCode, bool isPress);
 	void replayEvent();
 
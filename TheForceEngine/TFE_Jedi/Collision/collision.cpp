@@ -6,6 +6,7 @@
 #include <TFE_Jedi/Level/rtexture.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 // Merge player collision into collision
 #include <TFE_DarkForces/playerCollision.h>
 using namespace TFE_DarkForces;
@@ -64,6 +65,7 @@ namespace TFE_Jedi
 	// Internal State
 	////////////////////////////////////////////////////////
 	s32 s_collisionFrameWall;
+	SNAPSHOT_STATE(s_collisionFrameWall);
 	JBool s_collision_wallHit = JFALSE;
 	u32 s_collision_excludeEntityFlags = 0;
 	static ColPath s_col_path;
@@ -3,6 +3,7 @@
 #include "infSystem.h"
 #include <TFE_DarkForces/sound.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/levelData.h>
@@ -22,6 +23,9 @@ namespace TFE_Jedi
 	InfSerializableState s_infSerState = { };
 	InfState s_infState = { };
 
+	SNAPSHOT_STATE(s_infSerState);
+	SNAPSHOT_STATE(s_infState);
+
 	/////////////////////////////////////////////
 	// Forward Declarations
 	/////////////////////////////////////////////
@@ -33,6 +37,8 @@ namespace TFE_Jedi
 	void inf_computeElevValuePointer(InfElevator* elev);
 	extern void inf_deleteElevator(InfElevator* elev);
 	extern void inf_deleteTrigger(InfTrigger* trigger);
+	extern void inf_clearElevatorSchedule();
+	extern void inf_rebuildElevatorSchedule();
 
 	/////////////////////////////////////////////
 	// Implementation
@@ -41,6 +47,7 @@ namespace TFE_Jedi
 	{
 		s_infSerState = { 0 };
 		s_infState = { 0 };
+		inf_clearElevatorSchedule();
 	}
 
 	void inf_serializeElevator(Stream* stream, InfElevator* elev)
@@ -530,6 +537,8 @@ namespace TFE_Jedi
 					return;
 				inf_serializeElevator(stream, elev);
 			}
+			// The update schedule is not serialized.
+			inf_rebuildElevatorSchedule();
 		}
 
 		// Teleports
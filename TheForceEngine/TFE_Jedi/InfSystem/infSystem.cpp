@@ -25,12 +25,14 @@
 #include <TFE_System/math.h>
 #include <TFE_Jedi/Level/rtexture.h>
 #include <TFE_Jedi/Task/task.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 // TODO: This will make adding Outlaws harder, fix the abstraction.
 #include <TFE_DarkForces/player.h>
 #include <TFE_DarkForces/time.h>
 #include "infTypesInternal.h"
 // Include update functions
 #include "infElevatorUpdateFunc.h"
+#include <map>
 
 using namespace TFE_Jedi;
 using namespace TFE_DarkForces;
@@ -71,6 +73,42 @@ namespace TFE_Jedi
 	// DOS hack... this is required since elevators with an invalid delay use the previous valid delay.
 	static Tick s_prevStopDelay = 0;
 
+	// Elevator update schedule, this is rebuilt from the elevators on load.
+	// Active elevators are keyed by creation order so they update in the same order as the elevator allocator,
+	// waiting elevators are keyed by their wake tick.
+	static std::map<u32, InfElevator*> s_elevActive;
+	static std::map<std::pair<Tick, u32>, InfElevator*> s_elevTimers;
+	static u32 s_elevSeq = 0;
+	SNAPSHOT_STATE(s_prevStopDelay);
+	SNAPSHOT_STATE(s_elevSeq);
+
+	// The schedule lives outside of the level region, so rebuild it from the restored elevators without reordering them.
+	static void inf_snapshotState(Stream* stream, bool writeState)
+	{
+		if (writeState) { return; }
+
+		s_elevActive.clear();
+		s_elevTimers.clear();
+		if (!s_infSerState.infElevators) { return; }
+
+		allocator_saveIter(s_infSerState.infElevators);
+		InfElevator* elev = (InfElevator*)allocator_getHead(s_infSerState.infElevators);
+		while (elev)
+		{
+			if (elev->schedState == ELEV_SCHED_ACTIVE)
+			{
+				s_elevActive[elev->schedSeq] = elev;
+			}
+			else if (elev->schedState == ELEV_SCHED_TIMER)
+			{
+				s_elevTimers[{ elev->schedTick, elev->schedSeq }] = elev;
+			}
+			elev = (InfElevator*)allocator_getNext(s_infSerState.infElevators);
+		}
+		allocator_restoreIter(s_infSerState.infElevators);
+	}
+	SNAPSHOT_STATE_FUNC(inf_snapshotState);
+
 	// Forward Declarations.
 	void inf_elevatorTaskFunc(MessageType msg);
 	void inf_telelporterTaskFunc(MessageType msg);
@@ -98,6 +136,9 @@ namespace TFE_Jedi
 	void inf_handleMsgLights();
 	void inf_elevatorStart(InfElevator* elev);
 	vec3_fixed inf_getElevSoundPos(InfElevator* elev);
+	void inf_scheduleElevator(InfElevator* elev);
+	void inf_unscheduleElevator(InfElevator* elev);
+	void inf_clearElevatorSchedule();
 
 	void inf_teleporterTaskLocal(MessageType msg);
 	void inf_elevatorTaskLocal(MessageType msg);
@@ -122,6 +163,7 @@ namespace TFE_Jedi
 
 	void inf_createElevatorTask()
 	{
+		inf_clearElevatorSchedule();
 		s_infSerState.infElevators = allocator_create(sizeof(InfElevator));
 		s_infState.infElevTask = createSubTask("elevator", inf_elevatorTaskFunc, inf_elevatorTaskLocal);
 	}
@@ -201,7 +243,11 @@ namespace TFE_Jedi
 	{
 		if (!elev || !elev->stops)
 		{
-			if (elev) { elev->nextTick = s_curTick; }
+			if (elev)
+			{
+				elev->nextTick = s_curTick;
+				inf_scheduleElevator(elev);
+			}
 			return;
 		}
 
@@ -241,6 +287,7 @@ namespace TFE_Jedi
 		{
 			elev->nextTick = s_curTick + next->delay;
 		}
+		inf_scheduleElevator(elev);
 
 		// Setup the next stop.
 		elev->nextStop = inf_advanceStops(elev->stops, 0, 1);
@@ -275,6 +322,10 @@ namespace TFE_Jedi
 		elev->sound1 = NULL_SOUND;
 		elev->sound2 = NULL_SOUND;
 
+		elev->schedSeq = s_elevSeq++;
+		elev->schedState = ELEV_SCHED_NONE;
+		inf_scheduleElevator(elev);
+
 		switch (type)
 		{
 		case IELEV_MOVE_CEILING:
@@ -1469,6 +1520,99 @@ namespace TFE_Jedi
 		infElevatorMsgFunc(msg);
 	}
 
+	/////////////////////////////////////////////////////
+	// Elevator Scheduling
+	// Instead of scanning every elevator each tick, the elevator task only visits
+	// the active set. Elevators move between the active set, the timers and neither
+	// whenever their master state or next tick changes.
+	/////////////////////////////////////////////////////
+	void inf_unscheduleElevator(InfElevator* elev)
+	{
+		if (elev->schedState == ELEV_SCHED_ACTIVE)
+		{
+			s_elevActive.erase(elev->schedSeq);
+		}
+		else if (elev->schedState == ELEV_SCHED_TIMER)
+		{
+			s_elevTimers.erase({ elev->schedTick, elev->schedSeq });
+		}
+		elev->schedState = ELEV_SCHED_NONE;
+	}
+
+	void inf_scheduleElevator(InfElevator* elev)
+	{
+		if (!elev) { return; }
+
+		ElevSchedState state = ELEV_SCHED_NONE;
+		if (!elev->deleted && (elev->updateFlags & ELEV_MASTER_ON) && elev->nextTick != DELAY_SLEEP)
+		{
+			state = elev->nextTick < s_curTick ? ELEV_SCHED_ACTIVE : ELEV_SCHED_TIMER;
+		}
+		if (state == elev->schedState && (state != ELEV_SCHED_TIMER || elev->schedTick == elev->nextTick))
+		{
+			return;
+		}
+
+		inf_unscheduleElevator(elev);
+		if (state == ELEV_SCHED_ACTIVE)
+		{
+			s_elevActive[elev->schedSeq] = elev;
+		}
+		else if (state == ELEV_SCHED_TIMER)
+		{
+			elev->schedTick = elev->nextTick;
+			s_elevTimers[{ elev->schedTick, elev->schedSeq }] = elev;
+		}
+		elev->schedState = state;
+	}
+
+	// Move elevators whose wait is over into the active set.
+	void inf_wakeElevators()
+	{
+		while (!s_elevTimers.empty())
+		{
+			std::map<std::pair<Tick, u32>, InfElevator*>::iterator iTimer = s_elevTimers.begin();
+			if (iTimer->first.first >= s_curTick) { break; }
+
+			InfElevator* elev = iTimer->second;
+			s_elevTimers.erase(iTimer);
+			elev->schedState = ELEV_SCHED_ACTIVE;
+			s_elevActive[elev->schedSeq] = elev;
+		}
+	}
+
+	// Returns the first active elevator created at or after 'seq'.
+	// Elevators added or removed while iterating are handled the same way as the allocator list.
+	InfElevator* inf_getActiveElevator(u32 seq)
+	{
+		std::map<u32, InfElevator*>::iterator iElev = s_elevActive.lower_bound(seq);
+		return iElev != s_elevActive.end() ? iElev->second : nullptr;
+	}
+
+	void inf_clearElevatorSchedule()
+	{
+		s_elevActive.clear();
+		s_elevTimers.clear();
+		s_elevSeq = 0;
+	}
+
+	void inf_rebuildElevatorSchedule()
+	{
+		inf_clearElevatorSchedule();
+		if (!s_infSerState.infElevators) { return; }
+
+		allocator_saveIter(s_infSerState.infElevators);
+		InfElevator* elev = (InfElevator*)allocator_getHead(s_infSerState.infElevators);
+		while (elev)
+		{
+			elev->schedSeq = s_elevSeq++;
+			elev->schedState = ELEV_SCHED_NONE;
+			inf_scheduleElevator(elev);
+			elev = (InfElevator*)allocator_getNext(s_infSerState.infElevators);
+		}
+		allocator_restoreIter(s_infSerState.infElevators);
+	}
+
 	void inf_startElevator(InfElevator* elev)
 	{
 		if (!(elev->updateFlags & ELEV_MOVING))
@@ -1489,6 +1633,7 @@ namespace TFE_Jedi
 
 			// Flag the elevator as moving.
 			elev->updateFlags |= ELEV_MOVING;
+			inf_scheduleElevator(elev);
 		}
 	}
 
@@ -1524,15 +1669,11 @@ namespace TFE_Jedi
 			}
 			else  // id == MSG_RUN_TASK
 			{
-				taskCtx->elev = (InfElevator*)allocator_getHead(s_infSerState.infElevators);
+				// TFE: Only moving and due elevators are visited, in the same order as the full allocator scan.
+				inf_wakeElevators();
+				taskCtx->elev = inf_getActiveElevator(0);
 				while (taskCtx->elev)
 				{
-					if (taskCtx->elev->deleted)
-					{
-						taskCtx->elev = (InfElevator*)allocator_getNext(s_infSerState.infElevators);
-						continue;
-					}
-
 					taskCtx->elevDeleted = 0;
 					if ((taskCtx->elev->updateFlags & ELEV_MASTER_ON) && taskCtx->elev->nextTick < s_curTick)
 					{
@@ -1621,9 +1762,11 @@ namespace TFE_Jedi
 							} // (!elevDeleted)
 						}
 					} // ((elev->updateFlags & ELEV_MASTER_ON) && elev->nextTick < s_curTick)
+					// Move the elevator to the timers if it is waiting or remove it if it went to sleep.
+					inf_scheduleElevator(taskCtx->elev);
 
 					// Next elevator.
-					taskCtx->elev = (InfElevator*)allocator_getNext(s_infSerState.infElevators);
+					taskCtx->elev = inf_getActiveElevator(taskCtx->elev->schedSeq + 1);
 				} // while (elev)
 			}  // id == 0 (main elevator update loop)
 			task_yield(TASK_NO_DELAY);
@@ -2171,6 +2314,7 @@ namespace TFE_Jedi
 			{
 				// KW_MASTER (this seems to always turn master off)
 				elev->updateFlags &= ~ELEV_MASTER_ON;
+				inf_scheduleElevator(elev);
 			} break;
 			case KW_ANGLE:
 			{
@@ -2604,6 +2748,7 @@ namespace TFE_Jedi
 			}
 			elev->nextTick = s_curTick;
 			elev->updateFlags |= ELEV_MOVING;
+			inf_scheduleElevator(elev);
 		}
 	}
 
@@ -2746,7 +2891,7 @@ namespace TFE_Jedi
 		}
 	}
 
-	void infElevatorMessageInternal(MessageType msgType)
+	void inf_elevatorHandleMessage(MessageType msgType)
 	{
 		u32 event = s_msgEvent;
 		InfElevator* elev = (InfElevator*)s_msgTarget;
@@ -2927,6 +3072,14 @@ namespace TFE_Jedi
 		}
 	}
 
+	void infElevatorMessageInternal(MessageType msgType)
+	{
+		InfElevator* elev = (InfElevator*)s_msgTarget;
+		inf_elevatorHandleMessage(msgType);
+		// Messages can start, stop or wake up the elevator.
+		inf_scheduleElevator(elev);
+	}
+
 	void infElevatorMsgFunc(MessageType msgType)
 	{
 		if (msgType == MSG_FREE)
@@ -3097,6 +3250,7 @@ namespace TFE_Jedi
 			elev->stops = nullptr;
 		}
 		inf_deleteSectorElevatorLink(elev->sector, elev);
+		inf_unscheduleElevator(elev);
 		elev->deleted = JTRUE;
 		//allocator_deleteItem(s_infSerState.infElevators, elev);
 	}
@@ -3151,6 +3305,9 @@ namespace TFE_Jedi
 
 				sector_setupWallDrawFlags(sector0);
 				sector_setupWallDrawFlags(sector1);
+				// Let the renderers know the adjoins have changed.
+				sector0->dirtyFlags |= SDF_WALL_SHAPE;
+				sector1->dirtyFlags |= SDF_WALL_SHAPE;
 
 				cmd = (AdjoinCmd*)allocator_getNext(adjoinCmds);
 			}
@@ -32,6 +32,13 @@ namespace TFE_Jedi
 		ELEV_CRUSH      = FLAG_BIT(2),	// the elevator is moving in reverse.
 	};
 
+	enum ElevSchedState
+	{
+		ELEV_SCHED_NONE = 0,	// sleeping or master off, only a message can wake it.
+		ELEV_SCHED_ACTIVE,		// moving or due, visited by the elevator task every tick.
+		ELEV_SCHED_TIMER,		// waiting for 'schedTick'.
+	};
+
 	enum InfDelay
 	{
 		// IDELAY_SECONDS < IDELAY_COMPLETE
@@ -210,5 +217,9 @@ namespace TFE_Jedi
 		// TFE
 		fixed16_16 prevValue;
 		JBool deleted;
+		// Update scheduling, rebuilt on load rather than serialized.
+		u32 schedSeq;		// creation order, matches the order of the elevator allocator.
+		s32 schedState;		// ElevSchedState
+		Tick schedTick;		// wake tick while waiting on a timer.
 	};
 }
\ No newline at end of file
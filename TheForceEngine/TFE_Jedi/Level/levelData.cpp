@@ -9,6 +9,7 @@
 #include <TFE_System/system.h>
 #include <TFE_Asset/spriteAsset_Jedi.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 
 // TODO: coupling between Dark Forces and Jedi.
 using namespace TFE_DarkForces;
@@ -30,6 +31,9 @@ namespace TFE_Jedi
 
 	LevelState s_levelState = {};
 	LevelInternalState s_levelIntState = {};
+
+	SNAPSHOT_STATE(s_levelState);
+	SNAPSHOT_STATE(s_levelIntState);
 	
 	void level_serializeSector(Stream* stream, RSector* sector);
 	void level_serializeSafe(Stream* stream, Safe* safe);
@@ -131,6 +135,8 @@ namespace TFE_Jedi
 
 		// This is needed because level textures are pointers to the list itself, rather than the texture.
 		level_serializeTextureList(stream);
+		// The asset names only change when the level changes, so keep them apart from the sectors in memory snapshots.
+		serialization_markBlock(stream);
 				
 		if (serialization_getMode() == SMODE_READ)
 		{
@@ -145,6 +151,7 @@ namespace TFE_Jedi
 		{
 			level_serializeSector(stream, sector);
 		}
+		serialization_markBlock(stream);
 
 		serialization_serializeSectorPtr(stream, LevelState_InitVersion, s_levelState.bossSector);
 		serialization_serializeSectorPtr(stream, LevelState_InitVersion, s_levelState.mohcSector);
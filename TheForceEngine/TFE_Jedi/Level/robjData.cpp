@@ -4,6 +4,7 @@
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_DarkForces/logic.h>
 #include <TFE_DarkForces/generator.h>
 #include <TFE_Memory/chunkedArray.h>
@@ -28,6 +29,28 @@ namespace TFE_Jedi
 	// TFE - immutable reference list of objects for scripting
 	// Entries are never deleted from this list so objects will keep a unique ID based on their position in the list
 	std::vector<ObjectRef> s_objectRefList;
+	SNAPSHOT_STATE(s_objData);
+
+	static void objRefList_snapshotState(Stream* stream, bool writeState)
+	{
+		u32 count = (u32)s_objectRefList.size();
+		if (writeState)
+		{
+			stream->write(&count);
+		}
+		else
+		{
+			stream->read(&count);
+			s_objectRefList.resize(count);
+		}
+
+		if (count)
+		{
+			if (writeState) { stream->writeBuffer(s_objectRefList.data(), u32(sizeof(ObjectRef) * count)); }
+			else { stream->readBuffer(s_objectRefList.data(), u32(sizeof(ObjectRef) * count)); }
+		}
+	}
+	SNAPSHOT_STATE_FUNC(objRefList_snapshotState);
 	
 	// Forward declarations
 	void obj_refListClear();
@@ -1,6 +1,9 @@
 #include <cstring>
+#include <vector>
 
+#include <TFE_System/system.h>
 #include <TFE_System/profiler.h>
+#include <TFE_FrontEndUI/console.h>
 #include <TFE_Jedi/Math/fixedPoint.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/Level/rtexture.h>
@@ -20,6 +23,8 @@ namespace TFE_Jedi
 namespace RClassic_Fixed
 {
 	#define SKY_BASE_HEIGHT 200
+	// Columns are drawn in texel runs when each texel covers at least two pixels.
+	#define TEXEL_RUN_MAX_STEP HALF_16
 
 	enum SegSide
 	{
@@ -2076,7 +2081,9 @@ namespace RClassic_Fixed
 		return z;
 	}
 
-	void drawColumn_Fullbright()
+	// Per pixel column drawing, this matches the original DOS code and is used when texels are not magnified.
+	template<bool lit, bool trans>
+	void drawColumn_PerPixel()
 	{
 		fixed16_16 vCoordFixed = s_vCoordFixed;
 		u8* tex = s_texImage;
@@ -2090,62 +2097,166 @@ namespace RClassic_Fixed
 			const u8 c = tex[v];
 			vCoordFixed += s_vCoordStep;
 			v = floor16(vCoordFixed) & s_texHeightMask;
-			s_columnOut[offset] = c;
+			if (trans && !c) { continue; }
+			s_columnOut[offset] = lit ? s_columnLight[c] : c;
 		}
 	}
 
-	void drawColumn_Lit()
+	// Returns the number of pixels, up to 'count', that sample the same texel as 'vCoord'.
+	inline s32 getTexelRun(fixed16_16 vCoord, fixed16_16 vStep, s32 count)
 	{
-		fixed16_16 vCoordFixed = s_vCoordFixed;
-		u8* tex = s_texImage;
+		const s32 texel = floor16(vCoord);
+		// Avoid overflowing the coordinate at the end of the fixed point range.
+		if (texel >= 0x7fff) { return 1; }
+		const fixed16_16 nextTexel = intToFixed16(texel + 1);
+		const s32 run = (nextTexel - vCoord + vStep - 1) / vStep;
+		return min(run, count);
+	}
 
-		s32 v = floor16(vCoordFixed) & s_texHeightMask;
-		s32 end = s_yPixelCount - 1;
+	// Magnified columns are drawn as runs of pixels that sample the same texel, so the texel fetch and
+	// colormap lookup happen once per run instead of once per pixel. The result is identical to the
+	// per pixel version since the pixels in a run are exactly those that would have sampled that texel.
+	template<bool lit, bool trans>
+	void drawColumn()
+	{
+		const fixed16_16 vStep = s_vCoordStep;
+		if (vStep <= 0 || vStep > TEXEL_RUN_MAX_STEP)
+		{
+			drawColumn_PerPixel<lit, trans>();
+			return;
+		}
 
-		s32 offset = end * s_width;
-		for (s32 i = end; i >= 0; i--, offset -= s_width)
+		const u8* tex = s_texImage;
+		const u8* light = s_columnLight;
+		const s32 texHeightMask = s_texHeightMask;
+		const s32 stride = s_width;
+
+		fixed16_16 vCoordFixed = s_vCoordFixed;
+		s32 count = s_yPixelCount;
+		if (count <= 0) { return; }
+		u8* out = s_columnOut + (count - 1) * stride;
+		while (count > 0)
 		{
-			const u8 c = s_columnLight[tex[v]];
-			vCoordFixed += s_vCoordStep;
-			v = floor16(vCoordFixed) & s_texHeightMask;
-			s_columnOut[offset] = c;
+			s32 run = getTexelRun(vCoordFixed, vStep, count);
+			const u8 c = tex[floor16(vCoordFixed) & texHeightMask];
+			vCoordFixed += run * vStep;
+			count -= run;
+
+			if (trans && !c)
+			{
+				out -= run * stride;
+				continue;
+			}
+			const u8 color = lit ? light[c] : c;
+			for (; run > 0; run--, out -= stride)
+			{
+				*out = color;
+			}
 		}
 	}
 
-	void drawColumn_Fullbright_Trans()
+	void drawColumn_Fullbright()
 	{
-		fixed16_16 vCoordFixed = s_vCoordFixed;
-		u8* tex = s_texImage;
+		drawColumn<false, false>();
+	}
 
-		s32 v = floor16(vCoordFixed) & s_texHeightMask;
-		s32 end = s_yPixelCount - 1;
+	void drawColumn_Lit()
+	{
+		drawColumn<true, false>();
+	}
 
-		s32 offset = end * s_width;
-		for (s32 i = end; i >= 0; i--, offset -= s_width)
-		{
-			const u8 c = tex[v];
-			vCoordFixed += s_vCoordStep;
-			v = floor16(vCoordFixed) & s_texHeightMask;
-			if (c) { s_columnOut[offset] = c; }
-		}
+	void drawColumn_Fullbright_Trans()
+	{
+		drawColumn<false, true>();
 	}
 
 	void drawColumn_Lit_Trans()
 	{
-		fixed16_16 vCoordFixed = s_vCoordFixed;
-		u8* tex = s_texImage;
+		drawColumn<true, true>();
+	}
 
-		s32 v = floor16(vCoordFixed) & s_texHeightMask;
-		s32 end = s_yPixelCount - 1;
+	// Draw columns at a range of texel scales with both the per pixel and run based kernels,
+	// verify that the output matches and log the timings.
+	void wall_benchmarkColumns(s32 height, s32 columnCount)
+	{
+		height = max(1, height);
+		columnCount = max(1, columnCount);
+
+		// Random texture column and colormap, so the output depends on every lookup.
+		const s32 texHeight = 128;
+		u8 texColumn[texHeight];
+		u8 colormap[256];
+		u32 seed = 0x1234567u;
+		for (s32 i = 0; i < texHeight; i++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			// Include transparent texels.
+			texColumn[i] = (i & 7) ? u8(seed >> 24) : 0;
+		}
+		for (s32 i = 0; i < 256; i++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			colormap[i] = u8(seed >> 24);
+		}
+
+		const s32 stride = s_width;
+		std::vector<u8> refBuffer(size_t(stride) * height);
+		std::vector<u8> runBuffer(size_t(stride) * height);
+
+		struct ColumnKernel
+		{
+			const char* name;
+			ColumnFunction ref;
+			ColumnFunction run;
+		};
+		const ColumnKernel kernels[] =
+		{
+			{ "Fullbright",       drawColumn_PerPixel<false, false>, drawColumn<false, false> },
+			{ "Lit",              drawColumn_PerPixel<true, false>,  drawColumn<true, false> },
+			{ "Fullbright_Trans", drawColumn_PerPixel<false, true>,  drawColumn<false, true> },
+			{ "Lit_Trans",        drawColumn_PerPixel<true, true>,   drawColumn<true, true> },
+		};
+		// Texels per pixel.
+		const f32 scales[] = { 2.0f, 1.0f, 0.5f, 0.25f, 0.1f };
+
+		s_texImage = texColumn;
+		s_texHeightMask = texHeight - 1;
+		s_columnLight = colormap;
+		s_yPixelCount = height;
+		for (s32 s = 0; s < (s32)TFE_ARRAYSIZE(scales); s++)
+		{
+			s_vCoordStep = fixed16_16(scales[s] * f32(ONE_16));
+			for (s32 k = 0; k < (s32)TFE_ARRAYSIZE(kernels); k++)
+			{
+				f64 time[2];
+				for (s32 pass = 0; pass < 2; pass++)
+				{
+					std::vector<u8>& buffer = pass ? runBuffer : refBuffer;
+					const ColumnFunction func = pass ? kernels[k].run : kernels[k].ref;
+					memset(buffer.data(), 0, buffer.size());
 
-		s32 offset = end * s_width;
-		for (s32 i = end; i >= 0; i--, offset -= s_width)
-		{
-			const u8 c = tex[v];
-			vCoordFixed += s_vCoordStep;
-			v = floor16(vCoordFixed) & s_texHeightMask;
-			if (c) { s_columnOut[offset] = s_columnLight[c]; }
+					const u64 start = TFE_System::getCurrentTimeInTicks();
+					for (s32 c = 0; c < columnCount; c++)
+					{
+						// Vary the sub-texel offset and column so every run alignment is covered.
+						s_vCoordFixed = (c * 0x1357) & 0x3fffff;
+						s_columnOut = buffer.data() + (c % stride);
+						func();
+					}
+					time[pass] = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - start);
+				}
+				const bool match = memcmp(refBuffer.data(), runBuffer.data(), refBuffer.size()) == 0;
+
+				char result[256];
+				sprintf(result, "%s, %0.2f texels/pixel: per pixel %0.3f ms, runs %0.3f ms (%0.2fx)%s", kernels[k].name, scales[s],
+					time[0], time[1], time[1] > 0.0 ? time[0] / time[1] : 0.0, match ? "" : " - OUTPUT MISMATCH");
+				TFE_System::logWrite(match ? LOG_MSG : LOG_ERROR, "Column Benchmark", "%s", result);
+				TFE_Console::addToHistory(result);
+			}
 		}
+		s_columnOut = nullptr;
+		s_texImage = nullptr;
+		s_columnLight = nullptr;
 	}
 
 	void wall_addAdjoinSegment(s32 length, s32 x0, fixed16_16 top_dydx, fixed16_16 y1, fixed16_16 bot_dydx, fixed16_16 y0, RWallSegmentFixed* wallSegment)
@@ -36,6 +36,9 @@ namespace TFE_Jedi
 
 		void wall_addAdjoinSegment(s32 length, s32 x0, fixed16_16 top_dydx, fixed16_16 y1, fixed16_16 bot_dydx, fixed16_16 y0, RWallSegmentFixed* wallSegment);
 
+		// Compare the run based column kernels against per pixel drawing, logs timings and any output mismatch.
+		void wall_benchmarkColumns(s32 height, s32 columnCount);
+
 		// Sprite code for now because so much is shared.
 		void sprite_drawFrame(u8* basePtr, WaxFrame* frame, SecObject* obj);
 	}
@@ -1,6 +1,8 @@
 #include <cstring>
 
 #include <TFE_System/profiler.h>
+#include <TFE_System/hash.h>
+#include <TFE_System/parallel.h>
 #include <TFE_System/math.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
@@ -28,7 +30,6 @@
 #include "../rcommon.h"
 
 #include <algorithm>
-#include <map>
 #include <vector>
 
 using namespace TFE_RenderBackend;
@@ -152,18 +153,23 @@ namespace TFE_Jedi
 		u8 planeMode;
 	};
 
-	typedef std::map<u32, std::vector<u32>> ModelVertexMap;
 	typedef std::vector<CompositeVertex> CompositeVertexList;
 
 	// Building state.
+	// Models are built independently, so they can be built in parallel, and then appended
+	// to the shared vertex and index data in model order.
 	struct ModelBuildCtx
 	{
 		JediModel *model;
-		s32 *curIndexStart;
-		s32 *curVertexStart;
 		bool modelTrans;
-		ModelVertexMap modelVertexMap;
 		CompositeVertexList modelVertexList;
+		// Open addressing hash table of the unique vertices, entries are the vertex index + 1 (0 = empty).
+		std::vector<u32> vertexTable;
+		u32 vertexTableMask;
+
+		// Output, indices are relative to the first vertex of the model.
+		std::vector<ModelVertex> vertices;
+		std::vector<u32> indices;
 	};
 
 	bool model_updateShaders(bool initialize);
@@ -354,33 +360,36 @@ namespace TFE_Jedi
 		return true;
 	}
 		
-	static void startModel(struct ModelBuildCtx *ctx, JediModel* model, s32* indexStart, s32* vertexStart)
+	static void startModel(struct ModelBuildCtx *ctx, JediModel* model)
 	{
 		ctx->model = model;
-		ctx->curIndexStart = indexStart;
-		ctx->curVertexStart = vertexStart;
 		ctx->modelTrans = false;
-		ctx->modelVertexMap.clear();
 		ctx->modelVertexList.clear();
+		ctx->vertices.clear();
+		ctx->indices.clear();
+
+		// Size the table for the worst case (no shared vertices), so it stays at most half full.
+		u32 maxVertexCount = 0;
+		for (s32 p = 0; p < model->polygonCount; p++)
+		{
+			maxVertexCount += model->polygons[p].vertexCount;
+		}
+		u32 tableSize = 16;
+		while (tableSize < maxVertexCount * 2) { tableSize <<= 1; }
+		ctx->vertexTable.assign(tableSize, 0);
+		ctx->vertexTableMask = tableSize - 1;
+		ctx->modelVertexList.reserve(maxVertexCount);
+		ctx->indices.reserve(maxVertexCount * 3 / 2);
 	}
 
 	static void endModel(struct ModelBuildCtx *ctx)
 	{
-		// Create the entry.
-		ModelGPU* mgpu = newModelGPU();
-		if (!mgpu) { return; } 
-
-		mgpu->indexStart = *(ctx->curIndexStart);
-		mgpu->polyCount = ((s32)s_indexData.size() - (*(ctx->curIndexStart))) / 3;
-		mgpu->shader = ctx->modelTrans ? MGPU_SHADER_TRANS : MGPU_SHADER_SOLID;
-		ctx->model->drawId = (void *)mgpu;
-
-		// Add vertices.
+		// Convert the vertices.
 		const u32 vtxCount = (u32)ctx->modelVertexList.size();
 		const CompositeVertex* srcVtx = ctx->modelVertexList.data();
 
-		s_vertexData.resize((*(ctx->curVertexStart)) + vtxCount);
-		ModelVertex* outVtx = s_vertexData.data() + (*(ctx->curVertexStart));
+		ctx->vertices.resize(vtxCount);
+		ModelVertex* outVtx = ctx->vertices.data();
 		for (u32 v = 0; v < vtxCount; v++, outVtx++, srcVtx++)
 		{
 			outVtx->pos.x = fixed16ToFloat(srcVtx->pos.x);
@@ -401,13 +410,44 @@ namespace TFE_Jedi
 			outColor[3] = srcVtx->planeMode ? 0xff : 0x00;
 		}
 
-		*(ctx->curIndexStart)  = (s32)s_indexData.size();
-		*(ctx->curVertexStart) = (s32)s_vertexData.size();
+		// The building data is no longer needed.
+		CompositeVertexList().swap(ctx->modelVertexList);
+		std::vector<u32>().swap(ctx->vertexTable);
 	}
 
-	static u32 getVertexKey(vec3* pos)
+	// Append the model to the vertex and index data and create its entry.
+	static bool addModel(struct ModelBuildCtx *ctx, s32* indexStart, s32* vertexStart)
 	{
-		return u32(floor16(pos->x) + floor16(pos->y)*256 + floor16(pos->z)*65536);
+		ModelGPU* mgpu = newModelGPU();
+		if (!mgpu) { return false; }
+
+		mgpu->indexStart = *indexStart;
+		mgpu->polyCount = (s32)ctx->indices.size() / 3;
+		mgpu->shader = ctx->modelTrans ? MGPU_SHADER_TRANS : MGPU_SHADER_SOLID;
+		ctx->model->drawId = (void *)mgpu;
+
+		const size_t vtxCount = ctx->vertices.size();
+		s_vertexData.insert(s_vertexData.end(), ctx->vertices.begin(), ctx->vertices.end());
+
+		const size_t idxCount = ctx->indices.size();
+		const size_t curIdxSize = s_indexData.size();
+		s_indexData.resize(curIdxSize + idxCount);
+		u32* outIdx = s_indexData.data() + curIdxSize;
+		const u32* srcIdx = ctx->indices.data();
+		for (size_t i = 0; i < idxCount; i++)
+		{
+			outIdx[i] = srcIdx[i] + u32(*vertexStart);
+		}
+
+		*indexStart  += (s32)idxCount;
+		*vertexStart += (s32)vtxCount;
+		return true;
+	}
+
+	static u64 getVertexHash(vec3* pos, vec2* uv, vec3* nrml, u8 color, u8 planeMode, s32 textureId)
+	{
+		const s32 key[] = { pos->x, pos->y, pos->z, uv->x, uv->y, nrml->x, nrml->y, nrml->z, textureId, s32(color) | (s32(planeMode) << 8) };
+		return TFE_Hash::hashBlock64(key, sizeof(key));
 	}
 
 	static bool isCompositeVtxEqual(const CompositeVertex* srcVtx, vec3* pos, vec2* uv, vec3* nrml, u8 color, u8 planeMode, s32 textureId)
@@ -421,24 +461,15 @@ namespace TFE_Jedi
 	static u32 getVertex(struct ModelBuildCtx *ctx, vec3* pos, vec2* uv, vec3* nrml, u8 color, u8 planeMode, s32 textureId)
 	{
 		// If the vertex already exists, then return it.
-		const u32 key = getVertexKey(pos);
-		bool keyFound = false;
-		ModelVertexMap::iterator iBucket = ctx->modelVertexMap.find(key);
-		if (iBucket != ctx->modelVertexMap.end())
+		u32* table = ctx->vertexTable.data();
+		u32 slot = u32(getVertexHash(pos, uv, nrml, color, planeMode, textureId)) & ctx->vertexTableMask;
+		const CompositeVertex* listVtx = ctx->modelVertexList.data();
+		for (; table[slot]; slot = (slot + 1) & ctx->vertexTableMask)
 		{
-			keyFound = true;
-
-			std::vector<u32>& vtxList = iBucket->second;
-			const size_t count = vtxList.size();
-			const u32* listIndices = vtxList.data();
-			const CompositeVertex* listVtx = ctx->modelVertexList.data();
-			for (size_t i = 0; i < count; i++)
+			const CompositeVertex* vtx = &listVtx[table[slot] - 1];
+			if (isCompositeVtxEqual(vtx, pos, uv, nrml, color, planeMode, textureId))
 			{
-				const CompositeVertex* vtx = &listVtx[listIndices[i]];
-				if (isCompositeVtxEqual(vtx, pos, uv, nrml, color, planeMode, textureId))
-				{
-					return vtx->index;
-				}
+				return vtx->index;
 			}
 		}
 
@@ -454,16 +485,7 @@ namespace TFE_Jedi
 		newVtx.textureId = textureId;
 		newVtx.index = newId;
 
-		if (!keyFound)
-		{
-			std::vector<u32> newList;
-			newList.push_back(newId);
-			ctx->modelVertexMap[key] = newList;
-		}
-		else
-		{
-			ctx->modelVertexMap[key].push_back(newId);
-		}
+		table[slot] = newId + 1;
 		ctx->modelVertexList.push_back(newVtx);
 
 		return newId;
@@ -480,10 +502,9 @@ namespace TFE_Jedi
 		vec3 nrmDir = { nrml->x - v1->x, nrml->y - v1->y, nrml->z - v1->z };
 
 		const u8 planeMode = 0;
-		const s32 vertexStart = *(ctx->curVertexStart);
-		s_indexData.push_back(getVertex(ctx, v0, &srcUV[0], &nrmDir, color, planeMode, textureId) + vertexStart);
-		s_indexData.push_back(getVertex(ctx, v1, &srcUV[1], &nrmDir, color, planeMode, textureId) + vertexStart);
-		s_indexData.push_back(getVertex(ctx, v2, &srcUV[2], &nrmDir, color, planeMode, textureId) + vertexStart);
+		ctx->indices.push_back(getVertex(ctx, v0, &srcUV[0], &nrmDir, color, planeMode, textureId));
+		ctx->indices.push_back(getVertex(ctx, v1, &srcUV[1], &nrmDir, color, planeMode, textureId));
+		ctx->indices.push_back(getVertex(ctx, v2, &srcUV[2], &nrmDir, color, planeMode, textureId));
 	}
 
 	static void addFlatQuad(ModelBuildCtx *ctx, s32* indices, u8 color, vec2* uv, vec3* nrml, s32 textureId)
@@ -504,14 +525,13 @@ namespace TFE_Jedi
 		outIndices[2] = getVertex(ctx, v2, &srcUV[2], &nrmDir, color, planeMode, textureId);
 		outIndices[3] = getVertex(ctx, v3, &srcUV[3], &nrmDir, color, planeMode, textureId);
 
-		const s32 vertexStart = *(ctx->curVertexStart);
-		s_indexData.push_back(outIndices[0] + vertexStart);
-		s_indexData.push_back(outIndices[1] + vertexStart);
-		s_indexData.push_back(outIndices[2] + vertexStart);
+		ctx->indices.push_back(outIndices[0]);
+		ctx->indices.push_back(outIndices[1]);
+		ctx->indices.push_back(outIndices[2]);
 
-		s_indexData.push_back(outIndices[0] + vertexStart);
-		s_indexData.push_back(outIndices[2] + vertexStart);
-		s_indexData.push_back(outIndices[3] + vertexStart);
+		ctx->indices.push_back(outIndices[0]);
+		ctx->indices.push_back(outIndices[2]);
+		ctx->indices.push_back(outIndices[3]);
 	}
 
 	static void addSmoothTriangle(ModelBuildCtx *ctx, s32* indices, u8 color, vec2* uv, s32 textureId)
@@ -532,10 +552,9 @@ namespace TFE_Jedi
 		vec2* srcUV = (uv && textureId >= 0) ? uv : zero;
 		const u8 planeMode = 0;
 
-		const s32 vertexStart = *(ctx->curVertexStart);
-		s_indexData.push_back(getVertex(ctx, v0, &srcUV[0], &nDir0, color, planeMode, textureId) + vertexStart);
-		s_indexData.push_back(getVertex(ctx, v1, &srcUV[1], &nDir1, color, planeMode, textureId) + vertexStart);
-		s_indexData.push_back(getVertex(ctx, v2, &srcUV[2], &nDir2, color, planeMode, textureId) + vertexStart);
+		ctx->indices.push_back(getVertex(ctx, v0, &srcUV[0], &nDir0, color, planeMode, textureId));
+		ctx->indices.push_back(getVertex(ctx, v1, &srcUV[1], &nDir1, color, planeMode, textureId));
+		ctx->indices.push_back(getVertex(ctx, v2, &srcUV[2], &nDir2, color, planeMode, textureId));
 	}
 
 	static void addSmoothQuad(ModelBuildCtx *ctx, s32* indices, u8 color, vec2* uv, s32 textureId)
@@ -565,14 +584,13 @@ namespace TFE_Jedi
 		outIndices[2] = getVertex(ctx, v2, &srcUV[2], &nDir2, color, planeMode, textureId);
 		outIndices[3] = getVertex(ctx, v3, &srcUV[3], &nDir3, color, planeMode, textureId);
 
-		const s32 vertexStart = *(ctx->curVertexStart);
-		s_indexData.push_back(outIndices[0] + vertexStart);
-		s_indexData.push_back(outIndices[1] + vertexStart);
-		s_indexData.push_back(outIndices[2] + vertexStart);
+		ctx->indices.push_back(outIndices[0]);
+		ctx->indices.push_back(outIndices[1]);
+		ctx->indices.push_back(outIndices[2]);
 
-		s_indexData.push_back(outIndices[0] + vertexStart);
-		s_indexData.push_back(outIndices[2] + vertexStart);
-		s_indexData.push_back(outIndices[3] + vertexStart);
+		ctx->indices.push_back(outIndices[0]);
+		ctx->indices.push_back(outIndices[2]);
+		ctx->indices.push_back(outIndices[3]);
 	}
 
 	static void addPlaneTriangle(ModelBuildCtx *ctx, s32* indices, vec3* nrml, s32 textureId)
@@ -588,10 +606,9 @@ namespace TFE_Jedi
 		const u8 planeMode = 1;
 		const u8 color = 255;
 
-		const s32 vertexStart = *(ctx->curVertexStart);
-		s_indexData.push_back(getVertex(ctx, v0, &uv, &planeNrm, color, planeMode, textureId) + vertexStart);
-		s_indexData.push_back(getVertex(ctx, v1, &uv, &planeNrm, color, planeMode, textureId) + vertexStart);
-		s_indexData.push_back(getVertex(ctx, v2, &uv, &planeNrm, color, planeMode, textureId) + vertexStart);
+		ctx->indices.push_back(getVertex(ctx, v0, &uv, &planeNrm, color, planeMode, textureId));
+		ctx->indices.push_back(getVertex(ctx, v1, &uv, &planeNrm, color, planeMode, textureId));
+		ctx->indices.push_back(getVertex(ctx, v2, &uv, &planeNrm, color, planeMode, textureId));
 	}
 
 	static void addPlaneQuad(ModelBuildCtx *ctx, s32* indices, vec3* nrml, s32 textureId)
@@ -614,19 +631,95 @@ namespace TFE_Jedi
 		outIndices[2] = getVertex(ctx, v2, &uv, &planeNrm, color, planeMode, textureId);
 		outIndices[3] = getVertex(ctx, v3, &uv, &planeNrm, color, planeMode, textureId);
 
-		const s32 vertexStart = *(ctx->curVertexStart);
-		s_indexData.push_back(outIndices[0] + vertexStart);
-		s_indexData.push_back(outIndices[1] + vertexStart);
-		s_indexData.push_back(outIndices[2] + vertexStart);
+		ctx->indices.push_back(outIndices[0]);
+		ctx->indices.push_back(outIndices[1]);
+		ctx->indices.push_back(outIndices[2]);
+
+		ctx->indices.push_back(outIndices[0]);
+		ctx->indices.push_back(outIndices[2]);
+		ctx->indices.push_back(outIndices[3]);
+	}
+
+	static void buildModel(ModelBuildCtx* ctx, JediModel* model)
+	{
+		startModel(ctx, model);
+		for (s32 p = 0; p < model->polygonCount; p++)
+		{
+			JmPolygon* poly = &model->polygons[p];
+			if (poly->texture && (poly->texture->flags & OPACITY_TRANS) && poly->shading == PSHADE_PLANE)
+			{
+				ctx->modelTrans = true;
+			}
 
-		s_indexData.push_back(outIndices[0] + vertexStart);
-		s_indexData.push_back(outIndices[2] + vertexStart);
-		s_indexData.push_back(outIndices[3] + vertexStart);
+			switch (poly->shading)
+			{
+				case PSHADE_FLAT:
+				{
+					// Flat shaded polygon
+					if (poly->vertexCount == 3)
+					{
+						addFlatTriangle(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], -1);
+					}
+					else
+					{
+						addFlatQuad(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], -1);
+					}
+				} break;
+				case PSHADE_GOURAUD:
+				{
+					// Smooth shaded polygon
+					if (poly->vertexCount == 3)
+					{
+						addSmoothTriangle(ctx, poly->indices, poly->color, poly->uv, -1);
+					}
+					else
+					{
+						addSmoothQuad(ctx, poly->indices, poly->color, poly->uv, -1);
+					}
+				} break;
+				case PSHADE_TEXTURE:
+				{
+					// Flat shaded textured polygon
+					if (poly->vertexCount == 3)
+					{
+						addFlatTriangle(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], poly->texture->textureId);
+					}
+					else
+					{
+						addFlatQuad(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], poly->texture->textureId);
+					}
+				} break;
+				case PSHADE_GOURAUD_TEXTURE:
+				{
+					// Smooth shaded textured polygon
+					if (poly->vertexCount == 3)
+					{
+						addSmoothTriangle(ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
+					}
+					else
+					{
+						addSmoothQuad(ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
+					}
+				} break;
+				case PSHADE_PLANE:
+				{
+					// "Plane" shaded textured polygon
+					if (poly->vertexCount == 3)
+					{
+						addPlaneTriangle(ctx, poly->indices, &model->polygonNormals[p], poly->texture->textureId);
+					}
+					else
+					{
+						addPlaneQuad(ctx, poly->indices, &model->polygonNormals[p], poly->texture->textureId);
+					}
+				} break;
+			};
+		}
+		endModel(ctx);
 	}
 
 	void model_loadGpuModels()
 	{
-		ModelBuildCtx ctx;
 		s32 indexStart  = 0;
 		s32 vertexStart = 0;
 		s_vertexData.clear();
@@ -636,99 +729,36 @@ namespace TFE_Jedi
 		s_modelIndexBuffer.destroy();
 
 		// For now handle both pools here.
+		std::vector<JediModel*> models;
 		for (s32 pool = 0; pool < POOL_COUNT; pool++)
 		{
 			const std::vector<JediModel*>& modelList = TFE_Model_Jedi::getModelList(AssetPool(pool));
-			const size_t modelCount = modelList.size();
-			JediModel*const* model = modelList.data();
-			for (size_t i = 0; i < modelCount; i++)
-			{
-				if (model[i]->flags & MFLAG_DRAW_VERTICES)
-				{
-					if (!buildModelDrawVertices(model[i], &indexStart, &vertexStart))
-					{
-						// Too many unique models!
-						break;
-					}
-					continue;
-				}
+			models.insert(models.end(), modelList.begin(), modelList.end());
+		}
 
-				// This model has solid polygons.
-				startModel(&ctx, model[i], &indexStart, &vertexStart);
-				for (s32 p = 0; p < model[i]->polygonCount; p++)
-				{
-					JmPolygon* poly = &model[i]->polygons[p];
-					if (poly->texture && (poly->texture->flags & OPACITY_TRANS) && poly->shading == PSHADE_PLANE)
-					{
-						ctx.modelTrans = true;
-					}
+		// Build the models with solid polygons in parallel, each model only touches its own build context.
+		const s32 modelCount = (s32)models.size();
+		std::vector<ModelBuildCtx> builds(modelCount);
+		TFE_System::parallelFor(modelCount, [&](s32 i)
+		{
+			if (!(models[i]->flags & MFLAG_DRAW_VERTICES))
+			{
+				buildModel(&builds[i], models[i]);
+			}
+		});
 
-					switch (poly->shading)
-					{
-						case PSHADE_FLAT:
-						{
-							// Flat shaded polygon
-							if (poly->vertexCount == 3)
-							{
-								addFlatTriangle(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], -1);
-							}
-							else
-							{
-								addFlatQuad(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], -1);
-							}
-						} break;
-						case PSHADE_GOURAUD:
-						{
-							// Smooth shaded polygon
-							if (poly->vertexCount == 3)
-							{
-								addSmoothTriangle(&ctx, poly->indices, poly->color, poly->uv, -1);
-							}
-							else
-							{
-								addSmoothQuad(&ctx, poly->indices, poly->color, poly->uv, -1);
-							}
-						} break;
-						case PSHADE_TEXTURE:
-						{
-							// Flat shaded textured polygon
-							if (poly->vertexCount == 3)
-							{
-								addFlatTriangle(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-							else
-							{
-								addFlatQuad(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-						} break;
-						case PSHADE_GOURAUD_TEXTURE:
-						{
-							// Smooth shaded textured polygon
-							if (poly->vertexCount == 3)
-							{
-								addSmoothTriangle(&ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
-							}
-							else
-							{
-								addSmoothQuad(&ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
-							}
-						} break;
-						case PSHADE_PLANE:
-						{
-							// "Plane" shaded textured polygon
-							if (poly->vertexCount == 3)
-							{
-								addPlaneTriangle(&ctx, poly->indices, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-							else
-							{
-								addPlaneQuad(&ctx, poly->indices, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-						} break;
-					};
-				}
-				endModel(&ctx);
+		// Then append them in model order, so the vertex and index data are the same as building them one at a time.
+		for (s32 i = 0; i < modelCount; i++)
+		{
+			const bool added = (models[i]->flags & MFLAG_DRAW_VERTICES) ? buildModelDrawVertices(models[i], &indexStart, &vertexStart) :
+				addModel(&builds[i], &indexStart, &vertexStart);
+			if (!added)
+			{
+				// Too many unique models!
+				break;
 			}
+			std::vector<ModelVertex>().swap(builds[i].vertices);
+			std::vector<u32>().swap(builds[i].indices);
 		}
 
 		s_modelVertexBuffer.create((u32)s_vertexData.size(), sizeof(ModelVertex), c_modelAttrCount, c_modelAttrMapping, false, s_vertexData.data());
@@ -750,6 +780,24 @@ namespace TFE_Jedi
 	{
 	}
 
+	u64 model_getDrawListHash()
+	{
+		u64 hash = TFE_Hash::FNV_OFFSET_BASIS;
+		for (s32 s = 0; s < MGPU_SHADER_COUNT; s++)
+		{
+			const size_t listCount = s_modelDrawList[s].size();
+			const ModelDraw* drawItem = s_modelDrawList[s].data();
+			hash = TFE_Hash::fnv1a64Value(listCount, hash);
+			for (size_t i = 0; i < listCount; i++, drawItem++)
+			{
+				hash = TFE_Hash::fnv1a64Value(drawItem->obj, hash);
+				hash = TFE_Hash::fnv1a64Value(drawItem->posWS, hash);
+				hash = TFE_Hash::fnv1a64Value(drawItem->portalInfo, hash);
+			}
+		}
+		return hash;
+	}
+
 	// This will only reallocate the array if size > capacity.
 	// At some point the system will settle on a maximum capacity and no more allocations will be needed.
 	ModelDraw* getDrawItem(ModelShader shader)
@@ -18,6 +18,8 @@ namespace TFE_Jedi
 
 	void model_drawListClear();
 	void model_drawListFinish();
+	// Hash of the models added to the draw list, used to compare the results of different traversals.
+	u64  model_getDrawListHash();
 
 	void model_add(void* obj, JediModel* model, Vec3f posWS, fixed16_16* transform, f32 ambient, Vec2f floorOffset, Vec2f ceilOffset, u32 portalInfo);
 	void model_drawList();
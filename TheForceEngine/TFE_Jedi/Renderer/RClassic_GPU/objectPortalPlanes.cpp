@@ -1,6 +1,7 @@
 #include <cstring>
 
 #include <TFE_System/profiler.h>
+#include <TFE_System/hash.h>
 #include <TFE_System/math.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
@@ -84,4 +85,10 @@ namespace TFE_Jedi
 		s_objectPlaneCount += count;
 		return planeInfo;
 	}
+
+	u64 objectPortalPlanes_getHash()
+	{
+		const u64 hash = TFE_Hash::fnv1a64Value(s_objectPlaneCount);
+		return TFE_Hash::hashBlock64(s_objectPlanes, sizeof(Vec4f) * s_objectPlaneCount, hash);
+	}
 }  // TFE_Jedi
\ No newline at end of file
@@ -18,4 +18,5 @@ namespace TFE_Jedi
 	void objectPortalPlanes_unbind(s32 index);
 
 	u32  objectPortalPlanes_add(u32 count, const Vec4f* planes);
+	u64  objectPortalPlanes_getHash();
 }  // TFE_Jedi
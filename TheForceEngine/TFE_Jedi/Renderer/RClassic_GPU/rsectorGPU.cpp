@@ -1,6 +1,8 @@
 #include <cstring>
 
 #include <TFE_System/profiler.h>
+#include <TFE_System/system.h>
+#include <TFE_System/hash.h>
 #include <TFE_System/math.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
@@ -42,6 +44,8 @@
 // TODO: FIx
 #include "../RClassic_Float/rclassicFloatSharedState.h"
 
+#include <vector>
+
 #define SHOW_TRUE_COLOR_COMPARISION 0
 #define ACCURATE_MAPPING_ENABLE 0	// TODO: Still work in progress - more accurate mapping without color errors...
 
@@ -79,6 +83,76 @@ namespace TFE_Jedi
 		Frustum  frustum;
 		RWall*   wall;
 	};
+	// Frame-coherent traversal cache.
+	// The full traversal is recorded as a list of steps, which are replayed while the camera stays within
+	// a tolerance of the recorded camera. Replaying skips building, sorting and clipping the wall segments
+	// and clipping the portals, but the display list items and sector objects are still rebuilt since textures,
+	// lighting and objects change every frame.
+	// Each sector visit records the sectors its segments depend on. When some of them change - a moving door or
+	// elevator, for example - only the portal subtrees of the affected visits are traversed again, the rest of
+	// the traversal is still replayed.
+	enum TraversalStepType
+	{
+		TSTEP_SEGMENTS = 0,	// Restore the segment buffer and add the segments to the display list.
+		TSTEP_OBJECTS,		// Add the sector objects.
+		TSTEP_PORTAL,		// Push the portal frustum and add the portal to the display list.
+		TSTEP_PORTAL_END,	// Pop the portal frustum.
+	};
+	struct TraversalStep
+	{
+		TraversalStepType type;
+		RSector* sector;
+		RSector* prevSector;
+		RWall* wall;		// Portal, Portal End: the portal wall.
+		s32 portalId;		// Objects: the previous portal ID; Portal: the parent portal ID.
+		s32 start;			// Segments: the first segment; Portal: the first frustum plane; Portal End: the portal step.
+		s32 count;			// Segments: the segment count; Portal: the frustum plane count.
+		s32 endStep;		// Portal: the index of the matching end step.
+		s32 parentStep;		// Portal: the portal step of the enclosing sector visit, -1 for the root sector.
+		s32 sectorStart;	// Portal: the first sector recorded by the sector visit.
+		s32 portalsBefore;	// Portal: s_portalsTraversed before and after the sector visit.
+		s32 portalsAfter;
+		bool forceTreatAsSolid;
+		Vec3f corner0, corner1;
+		s32 rangeCount;
+		Vec2f range[2];
+		Vec2f rangeSrc[2];
+	};
+	struct TraversalSector
+	{
+		RSector* sector;
+		u32 flags1;
+		s32 visit;			// The portal step of the sector visit that recorded the sector, -1 for the root sector.
+	};
+	struct TraversalCache
+	{
+		bool valid;
+		RSector* root;
+		Vec3f cameraPos;
+		Mat3  cameraMtx;
+		Mat4  cameraProj;
+		s32 maxPortals;
+		s32 maxWallSeg;
+		s32 portalsTraversed;
+
+		std::vector<TraversalStep> steps;
+		std::vector<Segment> segments;
+		std::vector<SegmentClipped> clipped;
+		std::vector<Vec4f> planes;
+		std::vector<TraversalSector> sectors;
+	};
+	struct TraversalVerify
+	{
+		s32 frameCount;
+		s32 mismatchCount;
+		s32 reuseCount;			// Frames that would have replayed the previous frame's traversal.
+		s32 partialCount;		// Reused frames where some portal subtrees were traversed again.
+		s32 toleranceCount;		// Reused frames where the camera only matched within the tolerances.
+		s32 toleranceMismatchCount;
+		f64 fullTime;
+		f64 cachedTime;
+	};
+
 	struct ShaderInputsGPU
 	{
 		s32 cameraPosId;
@@ -148,6 +222,28 @@ namespace TFE_Jedi
 	static JBool s_flushCache = JFALSE;
 	u32 s_textureSettings = 1u;
 
+	enum TraversalReuse
+	{
+		TREUSE_NONE = 0,	// Traverse the full scene.
+		TREUSE_REPLAY,		// Replay the cached traversal.
+		TREUSE_PARTIAL,		// Replay the cached traversal, but traverse the changed portal subtrees again.
+	};
+
+	static TraversalCache s_traversalCache = {};
+	static TraversalCache s_traversalNext = {};
+	static TraversalCache* s_traversalTarget = &s_traversalCache;
+	static TraversalVerify s_traversalVerify = {};
+	static std::vector<u8> s_traversalRebuild;
+	static Frustum s_replayFrustum;
+	static bool s_traversalCacheEnabled = true;
+	static bool s_traversalRecord = false;
+	static s32 s_traversalVisit = -1;
+	static f32 s_traversalPosTolerance = 0.001f;
+	static f32 s_traversalDirTolerance = 0.0001f;
+	static s32 s_traversalVerifyFrames = 0;
+
+	void traversalCache_invalidate();
+
 	extern Mat3  s_cameraMtx;
 	extern Mat4  s_cameraProj;
 	extern Vec3f s_cameraPos;
@@ -258,17 +354,20 @@ namespace TFE_Jedi
 		model_destroy();
 
 		s_flushCache = JFALSE;
+		traversalCache_invalidate();
 	}
 
 	void TFE_Sectors_GPU::reset()
 	{
 		m_levelInit = false;
 		s_flushCache = JFALSE;
+		traversalCache_invalidate();
 	}
 
 	void TFE_Sectors_GPU::flushCache()
 	{
 		s_flushCache = JTRUE;
+		traversalCache_invalidate();
 	}
 
 	void TFE_Sectors_GPU::flushTextureCache()
@@ -814,6 +913,12 @@ namespace TFE_Jedi
 			
 			m_gpuInit = true;
 			s_gpuFrame = 1;
+			// --verify_traversal <frames> checks the traversal cache from the first rendered frames on.
+			const s32 verifyFrames = TFE_Settings::getTempSettings()->verifyTraversalFrames;
+			if (verifyFrames > 0)
+			{
+				traversalCache_verify(verifyFrames);
+			}
 			if (!s_portalList)
 			{
 				s_portalList = (Portal*)malloc(sizeof(Portal) * MAX_DISP_ITEMS);
@@ -855,6 +960,7 @@ namespace TFE_Jedi
 
 			// Let's just cache the current data.
 			s_cachedSectors = (GPUCachedSector*)level_alloc(sizeof(GPUCachedSector) * s_levelState.sectorCount);
+			traversalCache_invalidate();
 			memset(s_cachedSectors, 0, sizeof(GPUCachedSector) * s_levelState.sectorCount);
 
 			s_gpuSourceData.sectorSize = sizeof(Vec4f) * s_levelState.sectorCount * 2;
@@ -1099,6 +1205,148 @@ namespace TFE_Jedi
 		srcSector->dirtyFlags = SDF_NONE;
 	}
 
+	void traversalCache_invalidate()
+	{
+		s_traversalCache.valid = false;
+		s_traversalCache.root = nullptr;
+	}
+
+	void traversalCache_clear(TraversalCache* cache)
+	{
+		cache->steps.clear();
+		cache->segments.clear();
+		cache->clipped.clear();
+		cache->planes.clear();
+		cache->sectors.clear();
+	}
+
+	// The segment arrays no longer grow, so the clipped segments can now point at their segments.
+	void traversalCache_fixupSegments(TraversalCache* cache)
+	{
+		const size_t segCount = cache->segments.size();
+		for (size_t i = 0; i < segCount; i++)
+		{
+			cache->clipped[i].seg = &cache->segments[i];
+		}
+	}
+
+	void traversalCache_beginRecord(bool record)
+	{
+		traversalCache_invalidate();
+		traversalCache_clear(&s_traversalCache);
+		s_traversalTarget = &s_traversalCache;
+		s_traversalVisit = -1;
+		s_traversalRecord = record;
+	}
+
+	void traversalCache_endRecord(RSector* root)
+	{
+		if (!s_traversalRecord) { return; }
+		s_traversalRecord = false;
+
+		TraversalCache& cache = s_traversalCache;
+		traversalCache_fixupSegments(&cache);
+		cache.root = root;
+		cache.cameraPos = s_cameraPos;
+		cache.cameraMtx = s_cameraMtx;
+		cache.cameraProj = s_cameraProj;
+		cache.maxPortals = s_maxPortals;
+		cache.maxWallSeg = s_maxWallSeg;
+		cache.portalsTraversed = s_portalsTraversed;
+		cache.valid = true;
+	}
+
+	// Sectors whose changes can affect the traversal: the visited sectors and their adjoins.
+	// The traversal itself only sets SEC_FLAGS1_RENDERED, which is ignored, so the flags can be read right away.
+	void traversalCache_addSector(RSector* sector)
+	{
+		if (!s_traversalRecord) { return; }
+		s_traversalTarget->sectors.push_back({ sector, sector->flags1 & ~SEC_FLAGS1_RENDERED, s_traversalVisit });
+	}
+
+	// Record the current segment buffer, which is restored when replayed.
+	void traversalCache_addSegments(RSector* curSector, bool forceTreatAsSolid)
+	{
+		if (!s_traversalRecord) { return; }
+		TraversalCache& cache = *s_traversalTarget;
+
+		TraversalStep step = {};
+		step.type = TSTEP_SEGMENTS;
+		step.sector = curSector;
+		step.start = (s32)cache.segments.size();
+		step.forceTreatAsSolid = forceTreatAsSolid;
+		step.rangeCount = s_rangeCount;
+		for (s32 i = 0; i < 2; i++)
+		{
+			step.range[i] = s_range[i];
+			step.rangeSrc[i] = s_rangeSrc[i];
+		}
+
+		SegmentClipped* segment = sbuffer_get();
+		while (segment)
+		{
+			cache.segments.push_back(*segment->seg);
+			cache.clipped.push_back(*segment);
+			segment = segment->next;
+		}
+		step.count = (s32)cache.segments.size() - step.start;
+		cache.steps.push_back(step);
+	}
+
+	void traversalCache_addObjects(RSector* curSector, RSector* prevSector, s32 prevPortalId)
+	{
+		if (!s_traversalRecord) { return; }
+		TraversalStep step = {};
+		step.type = TSTEP_OBJECTS;
+		step.sector = curSector;
+		step.prevSector = prevSector;
+		step.portalId = prevPortalId;
+		s_traversalTarget->steps.push_back(step);
+	}
+
+	// Records the portal and enough of the traversal state to traverse the sector beyond it again.
+	// Returns the step index, which is passed to traversalCache_endPortal() once the portal has been traversed.
+	s32 traversalCache_beginPortal(const Portal* portal, RSector* curSector, Vec3f corner0, Vec3f corner1, s32 parentPortalId)
+	{
+		if (!s_traversalRecord) { return -1; }
+		TraversalCache& cache = *s_traversalTarget;
+
+		TraversalStep step = {};
+		step.type = TSTEP_PORTAL;
+		step.sector = portal->next;
+		step.prevSector = curSector;
+		step.wall = portal->wall;
+		step.portalId = parentPortalId;
+		step.start = (s32)cache.planes.size();
+		step.count = (s32)portal->frustum.planeCount;
+		step.parentStep = s_traversalVisit;
+		step.sectorStart = (s32)cache.sectors.size();
+		step.portalsBefore = s_portalsTraversed;
+		step.corner0 = corner0;
+		step.corner1 = corner1;
+		cache.planes.insert(cache.planes.end(), portal->frustum.planes, portal->frustum.planes + portal->frustum.planeCount);
+		cache.steps.push_back(step);
+
+		s_traversalVisit = (s32)cache.steps.size() - 1;
+		return s_traversalVisit;
+	}
+
+	void traversalCache_endPortal(s32 stepIndex)
+	{
+		if (!s_traversalRecord || stepIndex < 0) { return; }
+		TraversalCache& cache = *s_traversalTarget;
+		TraversalStep* portalStep = &cache.steps[stepIndex];
+		portalStep->portalsAfter = s_portalsTraversed;
+		s_traversalVisit = portalStep->parentStep;
+
+		TraversalStep step = {};
+		step.type = TSTEP_PORTAL_END;
+		step.wall = portalStep->wall;
+		step.start = stepIndex;
+		cache.steps.push_back(step);
+		cache.steps[stepIndex].endStep = (s32)cache.steps.size() - 1;
+	}
+
 	s32 traversal_addPortals(RSector* curSector)
 	{
 		// Add portals to the list to process for the sector.
@@ -1144,17 +1392,8 @@ namespace TFE_Jedi
 		return count;
 	}
 
-	void buildSegmentBuffer(bool initSector, RSector* curSector, u32 segCount, Segment* wallSegments, bool forceTreatAsSolid)
+	void addSegmentsToDisplayList(RSector* curSector, bool forceTreatAsSolid)
 	{
-		// Next insert solid segments into the segment buffer one at a time.
-		sbuffer_clear();
-		for (u32 i = 0; i < segCount; i++)
-		{
-			sbuffer_insertSegment(&wallSegments[i]);
-		}
-		sbuffer_mergeSegments();
-
-		// Build the display list.
 		SegmentClipped* segment = sbuffer_get();
 		while (segment && s_wallSegGenerated < s_maxWallSeg)
 		{
@@ -1171,6 +1410,21 @@ namespace TFE_Jedi
 		}
 	}
 
+	void buildSegmentBuffer(bool initSector, RSector* curSector, u32 segCount, Segment* wallSegments, bool forceTreatAsSolid)
+	{
+		// Next insert solid segments into the segment buffer one at a time.
+		sbuffer_clear();
+		for (u32 i = 0; i < segCount; i++)
+		{
+			sbuffer_insertSegment(&wallSegments[i]);
+		}
+		sbuffer_mergeSegments();
+		traversalCache_addSegments(curSector, forceTreatAsSolid);
+
+		// Build the display list.
+		addSegmentsToDisplayList(curSector, forceTreatAsSolid);
+	}
+
 	bool createNewSegment(Segment* seg, s32 id, bool isPortal, Vec2f v0, Vec2f v1, Vec2f heights, Vec2f portalHeights, Vec3f normal)
 	{
 		seg->id = id;
@@ -1299,6 +1553,7 @@ namespace TFE_Jedi
 		segCount = 0;
 		GPUCachedSector* cached = &s_cachedSectors[curSector->index];
 		cached->builtFrame = s_gpuFrame;
+		traversalCache_addSector(curSector);
 
 		// Compute the "minimum Z" of the portal in 2D for culling in order to emulate the software renderer.
 		// This is the "loose" portal near plane culling that Dark Forces uses - without emulating it the visuals
@@ -1388,6 +1643,7 @@ namespace TFE_Jedi
 				// Update any potential adjoins even if they are not traversed to make sure the
 				// heights and walls settings are handled correctly.
 				updateCachedSector(next, uploadFlags);
+				traversalCache_addSector(next);
 
 				fixed16_16 openTop, openBot;
 				// Sky handling
@@ -1702,6 +1958,7 @@ namespace TFE_Jedi
 		}
 
 		// Determine which objects are visible and add them.
+		traversalCache_addObjects(curSector, prevSector, prevPortalId);
 		addSectorObjects(curSector, prevSector, s_displayCurrentPortalId, prevPortalId);
 
 		// Traverse through visible portals.
@@ -1721,9 +1978,11 @@ namespace TFE_Jedi
 			Vec3f corner1 = { portal->v1.x, portal->y1, portal->v1.z };
 			if (sdisplayList_addPortal(corner0, corner1, parentPortalId))
 			{
+				const s32 stepIndex = traversalCache_beginPortal(portal, curSector, corner0, corner1, parentPortalId);
 				portal->wall->drawFrame = s_gpuFrame;
 				traverseSector(portal->next, curSector, portal->wall, parentPortalId, level, uploadFlags, portal->v0, portal->v1);
 				portal->wall->drawFrame = 0;
+				traversalCache_endPortal(stepIndex);
 			}
 
 			frustum_pop();
@@ -1731,6 +1990,356 @@ namespace TFE_Jedi
 		}
 	}
 						
+	bool traversalCache_cameraMatches()
+	{
+		const TraversalCache& cache = s_traversalCache;
+		for (s32 i = 0; i < 3; i++)
+		{
+			if (fabsf(s_cameraPos.m[i] - cache.cameraPos.m[i]) > s_traversalPosTolerance) { return false; }
+		}
+		for (s32 i = 0; i < 9; i++)
+		{
+			if (fabsf(s_cameraMtx.data[i] - cache.cameraMtx.data[i]) > s_traversalDirTolerance) { return false; }
+		}
+		for (s32 i = 0; i < 16; i++)
+		{
+			if (fabsf(s_cameraProj.data[i] - cache.cameraProj.data[i]) > s_traversalDirTolerance) { return false; }
+		}
+		return true;
+	}
+
+	TraversalReuse traversalCache_getReuse(RSector* sector)
+	{
+		const TraversalCache& cache = s_traversalCache;
+		if (!s_traversalCacheEnabled || !cache.valid || cache.root != sector) { return TREUSE_NONE; }
+		if (cache.maxPortals != s_maxPortals || cache.maxWallSeg != s_maxWallSeg) { return TREUSE_NONE; }
+		if (!traversalCache_cameraMatches()) { return TREUSE_NONE; }
+
+		// Objects moving between sectors do not affect the traversal, they are added again every frame anyway.
+		TraversalReuse reuse = TREUSE_REPLAY;
+		const size_t sectorCount = cache.sectors.size();
+		const TraversalSector* cachedSector = cache.sectors.data();
+		for (size_t i = 0; i < sectorCount; i++, cachedSector++)
+		{
+			const RSector* curSector = cachedSector->sector;
+			if (!(curSector->dirtyFlags & ~SDF_CHANGE_OBJ) && (curSector->flags1 & ~SEC_FLAGS1_RENDERED) == cachedSector->flags1)
+			{
+				continue;
+			}
+			// A change to the root sector visit affects the whole traversal.
+			if (cachedSector->visit < 0) { return TREUSE_NONE; }
+			if (reuse == TREUSE_REPLAY)
+			{
+				s_traversalRebuild.assign(cache.steps.size(), 0);
+				reuse = TREUSE_PARTIAL;
+			}
+			s_traversalRebuild[cachedSector->visit] = 1;
+		}
+		// The portal limit cuts the traversal short, so a subtree traversed again might change which portals
+		// are traversed after it.
+		if (reuse == TREUSE_PARTIAL && cache.portalsTraversed >= cache.maxPortals) { return TREUSE_NONE; }
+		return reuse;
+	}
+
+	void traversalCache_restoreSegments(const TraversalCache& cache, const TraversalStep* step)
+	{
+		s_rangeCount = step->rangeCount;
+		for (s32 r = 0; r < 2; r++)
+		{
+			s_range[r] = step->range[r];
+			s_rangeSrc[r] = step->rangeSrc[r];
+		}
+		sbuffer_restore(step->count, &cache.clipped[step->start]);
+	}
+
+	void traversalCache_pushFrustum(const TraversalCache& cache, const TraversalStep* step)
+	{
+		s_replayFrustum.planeCount = step->count;
+		memcpy(s_replayFrustum.planes, &cache.planes[step->start], sizeof(Vec4f) * step->count);
+		frustum_push(s_replayFrustum);
+	}
+
+	void traversalCache_replay()
+	{
+		const TraversalCache& cache = s_traversalCache;
+		const s32 stepCount = (s32)cache.steps.size();
+		for (s32 i = 0; i < stepCount; i++)
+		{
+			const TraversalStep* step = &cache.steps[i];
+			switch (step->type)
+			{
+				case TSTEP_SEGMENTS:
+				{
+					traversalCache_restoreSegments(cache, step);
+					addSegmentsToDisplayList(step->sector, step->forceTreatAsSolid);
+				} break;
+				case TSTEP_OBJECTS:
+				{
+					addSectorObjects(step->sector, step->prevSector, s_displayCurrentPortalId, step->portalId);
+				} break;
+				case TSTEP_PORTAL:
+				{
+					traversalCache_pushFrustum(cache, step);
+					// Skip the portal contents if the portal no longer has an opening.
+					if (!sdisplayList_addPortal(step->corner0, step->corner1, step->portalId))
+					{
+						frustum_pop();
+						i = step->endStep;
+					}
+				} break;
+				case TSTEP_PORTAL_END:
+				{
+					frustum_pop();
+				} break;
+			}
+		}
+		s_portalsTraversed = cache.portalsTraversed;
+	}
+
+	// Replay the cached traversal, but traverse the portal subtrees of the sector visits marked in s_traversalRebuild
+	// again. The result is recorded into a new cache, with the replayed steps copied over, which then replaces the
+	// current cache. Returns false if the traversal hit the portal limit, in which case the full traversal is required.
+	bool traversalCache_replayPartial(u32& uploadFlags)
+	{
+		const TraversalCache& cache = s_traversalCache;
+		TraversalCache& next = s_traversalNext;
+		traversalCache_clear(&next);
+		s_traversalTarget = &next;
+		s_traversalVisit = -1;
+		s_traversalRecord = true;
+
+		// The root sector visit did not change, so its sectors are copied over as-is.
+		const s32 sectorCount = (s32)cache.sectors.size();
+		for (s32 s = 0; s < sectorCount && cache.sectors[s].visit < 0; s++)
+		{
+			traversalCache_addSector(cache.sectors[s].sector);
+		}
+
+		// The portal count of each sector visit is offset by the change in the portal counts of the subtrees traversed again.
+		s32 portalDelta = 0;
+		s32 level = 0;
+		const s32 stepCount = (s32)cache.steps.size();
+		for (s32 i = 0; i < stepCount; i++)
+		{
+			const TraversalStep* step = &cache.steps[i];
+			switch (step->type)
+			{
+				case TSTEP_SEGMENTS:
+				{
+					traversalCache_restoreSegments(cache, step);
+					traversalCache_addSegments(step->sector, step->forceTreatAsSolid);
+					addSegmentsToDisplayList(step->sector, step->forceTreatAsSolid);
+				} break;
+				case TSTEP_OBJECTS:
+				{
+					traversalCache_addObjects(step->sector, step->prevSector, step->portalId);
+					addSectorObjects(step->sector, step->prevSector, s_displayCurrentPortalId, step->portalId);
+				} break;
+				case TSTEP_PORTAL:
+				{
+					traversalCache_pushFrustum(cache, step);
+					if (!sdisplayList_addPortal(step->corner0, step->corner1, step->portalId))
+					{
+						// The full traversal would not have traversed the portal contents either.
+						frustum_pop();
+						portalDelta -= step->portalsAfter - step->portalsBefore;
+						i = step->endStep;
+						break;
+					}
+					level++;
+
+					Portal portal;
+					portal.v0 = { step->corner0.x, step->corner0.z };
+					portal.v1 = { step->corner1.x, step->corner1.z };
+					portal.y0 = step->corner0.y;
+					portal.y1 = step->corner1.y;
+					portal.next = step->sector;
+					portal.frustum = s_replayFrustum;
+					portal.wall = step->wall;
+
+					s_portalsTraversed = step->portalsBefore + portalDelta;
+					const s32 stepIndex = traversalCache_beginPortal(&portal, step->prevSector, step->corner0, step->corner1, step->portalId);
+					step->wall->drawFrame = s_gpuFrame;
+					if (s_traversalRebuild[i])
+					{
+						traverseSector(step->sector, step->prevSector, step->wall, step->portalId, level, uploadFlags, portal.v0, portal.v1);
+						portalDelta = s_portalsTraversed - step->portalsAfter;
+						traversalCache_endPortal(stepIndex);
+						step->wall->drawFrame = 0;
+
+						frustum_pop();
+						level--;
+						i = step->endStep;
+					}
+					else
+					{
+						for (s32 s = step->sectorStart; s < sectorCount && cache.sectors[s].visit == i; s++)
+						{
+							traversalCache_addSector(cache.sectors[s].sector);
+						}
+					}
+				} break;
+				case TSTEP_PORTAL_END:
+				{
+					const TraversalStep* portalStep = &cache.steps[step->start];
+					s_portalsTraversed = portalStep->portalsAfter + portalDelta;
+					traversalCache_endPortal(s_traversalVisit);
+					step->wall->drawFrame = 0;
+
+					frustum_pop();
+					level--;
+				} break;
+			}
+		}
+		s_traversalRecord = false;
+		s_traversalTarget = &s_traversalCache;
+
+		s_portalsTraversed = cache.portalsTraversed + portalDelta;
+		if (s_portalsTraversed >= s_maxPortals)
+		{
+			traversalCache_invalidate();
+			return false;
+		}
+
+		// The replayed segments were recorded with the cached camera, so it stays the reference for the tolerances.
+		traversalCache_fixupSegments(&next);
+		next.root = cache.root;
+		next.cameraPos = cache.cameraPos;
+		next.cameraMtx = cache.cameraMtx;
+		next.cameraProj = cache.cameraProj;
+		next.maxPortals = cache.maxPortals;
+		next.maxWallSeg = cache.maxWallSeg;
+		next.portalsTraversed = s_portalsTraversed;
+		next.valid = true;
+		std::swap(s_traversalCache, s_traversalNext);
+		return true;
+	}
+
+	// Returns false if the cached traversal could not be used after all.
+	bool traversalCache_reuse(TraversalReuse reuse, u32& uploadFlags)
+	{
+		if (reuse == TREUSE_PARTIAL)
+		{
+			return traversalCache_replayPartial(uploadFlags);
+		}
+		traversalCache_replay();
+		return true;
+	}
+
+	void traverseSceneFull(RSector* sector, u32& uploadFlags)
+	{
+		s32 level = 0;
+		Vec2f startView[] = { {0,0}, {0,0} };
+
+		traversalCache_beginRecord(s_traversalCacheEnabled || s_traversalVerifyFrames > 0);
+		updateCachedSector(sector, uploadFlags);
+		traverseSector(sector, nullptr, nullptr, 0, level, uploadFlags, startView[0], startView[1]);
+		traversalCache_endRecord(sector);
+	}
+
+	void clearDrawLists()
+	{
+		s_portalsTraversed = 0;
+		s_portalListCount = 0;
+		s_wallSegGenerated = 0;
+
+		sdisplayList_clear();
+		sprdisplayList_clear();
+		model_drawListClear();
+		objectPortalPlanes_clear();
+	}
+
+	u64 getDrawListHash()
+	{
+		u64 hash = sdisplayList_getHash();
+		hash = TFE_Hash::fnv1a64Value(sprdisplayList_getHash(), hash);
+		hash = TFE_Hash::fnv1a64Value(model_getDrawListHash(), hash);
+		hash = TFE_Hash::fnv1a64Value(objectPortalPlanes_getHash(), hash);
+		return hash;
+	}
+
+	bool traversalCache_cameraExact()
+	{
+		const TraversalCache& cache = s_traversalCache;
+		return memcmp(&s_cameraPos, &cache.cameraPos, sizeof(Vec3f)) == 0 && memcmp(&s_cameraMtx, &cache.cameraMtx, sizeof(Mat3)) == 0 &&
+			memcmp(&s_cameraProj, &cache.cameraProj, sizeof(Mat4)) == 0;
+	}
+
+	// Build the draw lists using both the full traversal and the replayed traversal and compare them.
+	// If the previous frame's traversal would be reused this frame - including when the camera only matches within
+	// the position and direction tolerances or when some portal subtrees are traversed again - that cached traversal
+	// is replayed and checked against a fresh traversal.
+	// Otherwise the traversal recorded this frame is replayed, which checks the record and replay code.
+	void traversalCache_verifyFrame(RSector* sector, u32& uploadFlags)
+	{
+		const TraversalReuse reuseType = traversalCache_getReuse(sector);
+		bool reuse = reuseType != TREUSE_NONE;
+		u64 cachedHash = 0;
+		s32 cachedSize = 0, cachedSprites = 0;
+		f64 start;
+		if (reuse)
+		{
+			start = TFE_System::getTime();
+			reuse = traversalCache_reuse(reuseType, uploadFlags);
+			s_traversalVerify.cachedTime += TFE_System::getTime() - start;
+		}
+		const bool tolerance = reuse && !traversalCache_cameraExact();
+		const bool partial = reuse && reuseType == TREUSE_PARTIAL;
+		if (reuse)
+		{
+			cachedHash = getDrawListHash();
+			cachedSize = sdisplayList_getSize(SECTOR_PASS_OPAQUE) + sdisplayList_getSize(SECTOR_PASS_TRANS);
+			cachedSprites = sprdisplayList_getSize();
+		}
+		clearDrawLists();
+
+		// A reused traversal is checked against the fresh traversal, which is then used to render the frame.
+		start = TFE_System::getTime();
+		traverseSceneFull(sector, uploadFlags);
+		s_traversalVerify.fullTime += TFE_System::getTime() - start;
+
+		const u64 fullHash = getDrawListHash();
+		const s32 fullSize = sdisplayList_getSize(SECTOR_PASS_OPAQUE) + sdisplayList_getSize(SECTOR_PASS_TRANS);
+		const s32 fullSprites = sprdisplayList_getSize();
+
+		if (!reuse)
+		{
+			clearDrawLists();
+			start = TFE_System::getTime();
+			traversalCache_replay();
+			s_traversalVerify.cachedTime += TFE_System::getTime() - start;
+
+			cachedHash = getDrawListHash();
+			cachedSize = sdisplayList_getSize(SECTOR_PASS_OPAQUE) + sdisplayList_getSize(SECTOR_PASS_TRANS);
+			cachedSprites = sprdisplayList_getSize();
+		}
+
+		if (cachedHash != fullHash)
+		{
+			TFE_System::logWrite(LOG_WARNING, "GPU Renderer", "Traversal cache mismatch in frame %d (%s): %d/%d display items, %d/%d sprites (full/cached).",
+				s_traversalVerify.frameCount, tolerance ? "camera within tolerance" : (partial ? "partial traversal" : (reuse ? "same camera" : "replay of this frame")),
+				fullSize, cachedSize, fullSprites, cachedSprites);
+			s_traversalVerify.mismatchCount++;
+			if (tolerance) { s_traversalVerify.toleranceMismatchCount++; }
+		}
+		s_traversalVerify.frameCount++;
+		if (reuse) { s_traversalVerify.reuseCount++; }
+		if (partial) { s_traversalVerify.partialCount++; }
+		if (tolerance) { s_traversalVerify.toleranceCount++; }
+
+		s_traversalVerifyFrames--;
+		if (!s_traversalVerifyFrames)
+		{
+			const f64 frameCount = f64(s_traversalVerify.frameCount);
+			char result[256];
+			sprintf(result, "Traversal cache: %d frames verified, %d mismatches. %d reused frames, %d partially traversed, %d within tolerance (%d mismatches). Full: %.3fms, cached: %.3fms per frame.",
+				s_traversalVerify.frameCount, s_traversalVerify.mismatchCount, s_traversalVerify.reuseCount, s_traversalVerify.partialCount, s_traversalVerify.toleranceCount,
+				s_traversalVerify.toleranceMismatchCount, 1000.0 * s_traversalVerify.fullTime / frameCount, 1000.0 * s_traversalVerify.cachedTime / frameCount);
+			TFE_Console::addToHistory(result);
+			TFE_System::logWrite(LOG_MSG, "GPU Renderer", "%s", result);
+		}
+	}
+
 	bool traverseScene(RSector* sector)
 	{
 #if 0
@@ -1740,12 +2349,7 @@ namespace TFE_Jedi
 		// First build the camera frustum and push it onto the stack.
 		frustum_buildFromCamera();
 
-		s32 level = 0;
 		u32 uploadFlags = UPLOAD_NONE;
-		s_portalsTraversed = 0;
-		s_portalListCount = 0;
-		s_wallSegGenerated = 0;
-		Vec2f startView[] = { {0,0}, {0,0} };
 
 		// Compute an XZ direction for sprite culling.
 		const f32 cameraDirMag = s_cameraDir.x*s_cameraDir.x + s_cameraDir.z*s_cameraDir.z;
@@ -1761,13 +2365,20 @@ namespace TFE_Jedi
 			s_cameraDirXZ.z = 0.0f;
 		}
 
-		sdisplayList_clear();
-		sprdisplayList_clear();
-		model_drawListClear();
-		objectPortalPlanes_clear();
-
-		updateCachedSector(sector, uploadFlags);
-		traverseSector(sector, nullptr, nullptr, 0, level, uploadFlags, startView[0], startView[1]);
+		clearDrawLists();
+		if (s_traversalVerifyFrames > 0)
+		{
+			traversalCache_verifyFrame(sector, uploadFlags);
+		}
+		else
+		{
+			const TraversalReuse reuse = traversalCache_getReuse(sector);
+			if (reuse == TREUSE_NONE || !traversalCache_reuse(reuse, uploadFlags))
+			{
+				clearDrawLists();
+				traverseSceneFull(sector, uploadFlags);
+			}
+		}
 		frustum_pop();
 
 		// Fixup the transparencies if using bilinear filtering.
@@ -2124,6 +2735,27 @@ namespace TFE_Jedi
 		return s_colormapTex;
 	}
 
+	void traversalCache_setEnabled(bool enable, f32 posTolerance, f32 dirTolerance)
+	{
+		s_traversalCacheEnabled = enable;
+		s_traversalPosTolerance = max(0.0f, posTolerance);
+		s_traversalDirTolerance = max(0.0f, dirTolerance);
+		traversalCache_invalidate();
+	}
+
+	void traversalCache_getSettings(bool* enabled, f32* posTolerance, f32* dirTolerance)
+	{
+		*enabled = s_traversalCacheEnabled;
+		*posTolerance = s_traversalPosTolerance;
+		*dirTolerance = s_traversalDirTolerance;
+	}
+
+	void traversalCache_verify(s32 frameCount)
+	{
+		s_traversalVerify = {};
+		s_traversalVerifyFrames = max(1, frameCount);
+	}
+
 	void TFE_Sectors_GPU::subrendererChanged()
 	{
 	}
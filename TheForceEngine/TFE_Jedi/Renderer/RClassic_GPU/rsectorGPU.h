@@ -43,4 +43,11 @@ namespace TFE_Jedi
 
 	public:
 	};
+
+	// The GPU renderer caches the portal traversal and replays it while the camera stays within the tolerances
+	// (position in world units, view and projection matrix components). Portal subtrees whose sectors changed are traversed again.
+	void traversalCache_setEnabled(bool enable, f32 posTolerance, f32 dirTolerance);
+	void traversalCache_getSettings(bool* enabled, f32* posTolerance, f32* dirTolerance);
+	// Compare the cached traversal with the full traversal over the next 'frameCount' frames, the result is written to the console.
+	void traversalCache_verify(s32 frameCount);
 }  // TFE_Jedi
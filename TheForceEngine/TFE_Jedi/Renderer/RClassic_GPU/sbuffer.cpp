@@ -321,6 +321,31 @@ namespace TFE_Jedi
 		return s_segClippedHead;
 	}
 
+	void sbuffer_restore(s32 count, const SegmentClipped* segs)
+	{
+		sbuffer_clear();
+		for (s32 i = 0; i < count; i++)
+		{
+			SegmentClipped* segClipped = sbuffer_getClippedSeg(segs[i].seg);
+			if (!segClipped) { break; }
+
+			segClipped->x0 = segs[i].x0;
+			segClipped->x1 = segs[i].x1;
+			segClipped->v0 = segs[i].v0;
+			segClipped->v1 = segs[i].v1;
+			segClipped->prev = s_segClippedTail;
+			if (s_segClippedTail)
+			{
+				s_segClippedTail->next = segClipped;
+			}
+			else
+			{
+				s_segClippedHead = segClipped;
+			}
+			s_segClippedTail = segClipped;
+		}
+	}
+
 	SegmentClipped* sbuffer_getClippedSeg(Segment* seg, SegmentClipped* dstSegs, s32 maxOutputSegs, s32& dstSegCount)
 	{
 		if (dstSegCount >= maxOutputSegs)
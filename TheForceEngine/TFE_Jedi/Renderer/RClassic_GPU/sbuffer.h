@@ -46,6 +46,8 @@ namespace TFE_Jedi
 	void sbuffer_mergeSegments();
 	void sbuffer_insertSegment(Segment* seg);
 	SegmentClipped* sbuffer_get();
+	// Rebuild the buffer from a list of clipped segments previously read from it, in order.
+	void sbuffer_restore(s32 count, const SegmentClipped* segs);
 
 	// Clips a segment to the buffer but does *not* update the s-buffer itself.
 	// The result will be zero or more output segments.
@@ -1,6 +1,7 @@
 #include <cstring>
 
 #include <TFE_System/profiler.h>
+#include <TFE_System/hash.h>
 #include <TFE_System/math.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
@@ -589,6 +590,20 @@ namespace TFE_Jedi
 		return s_displayListCount[passId];
 	}
 
+	u64 sdisplayList_getHash()
+	{
+		u64 hash = TFE_Hash::FNV_OFFSET_BASIS;
+		for (s32 i = 0; i < SECTOR_PASS_COUNT; i++)
+		{
+			hash = TFE_Hash::fnv1a64Value(s_displayListCount[i], hash);
+			hash = TFE_Hash::hashBlock64(&s_displayListPos[i*MAX_DISP_ITEMS], sizeof(Vec4f) * s_displayListCount[i], hash);
+			hash = TFE_Hash::hashBlock64(&s_displayListData[i*MAX_DISP_ITEMS], sizeof(Vec4ui) * s_displayListCount[i], hash);
+		}
+		hash = TFE_Hash::hashBlock64(s_displayListPlanes, sizeof(Vec4f) * s_displayPlaneCount, hash);
+		hash = TFE_Hash::hashBlock64(s_portalPlaneInfo, sizeof(u32) * s_displayPortalCount, hash);
+		return hash;
+	}
+
 	void sdisplayList_draw(SectorPass passId)
 	{
 		if (!s_displayListCount[passId]) { return; }
@@ -57,6 +57,8 @@ namespace TFE_Jedi
 	void sdisplayList_fixupTrans();
 
 	s32  sdisplayList_getSize(SectorPass passId = SECTOR_PASS_OPAQUE);
+	// Hash of the display list contents, used to compare the results of different traversals.
+	u64  sdisplayList_getHash();
 
 	u32 sdisplayList_getPackedPortalInfo(s32 portalId);
 	u32 sdisplayList_getPlanesFromPortal(u32 portalId, u32 planeType, Vec4f* outPlanes);
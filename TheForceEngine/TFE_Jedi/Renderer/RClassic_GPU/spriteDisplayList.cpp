@@ -1,6 +1,7 @@
 #include <cstring>
 
 #include <TFE_System/profiler.h>
+#include <TFE_System/hash.h>
 #include <TFE_System/math.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
@@ -174,6 +175,16 @@ namespace TFE_Jedi
 	{
 		return s_displayListCount;
 	}
+
+	u64 sprdisplayList_getHash()
+	{
+		u64 hash = TFE_Hash::fnv1a64Value(s_displayListCount);
+		hash = TFE_Hash::hashBlock64(s_displayListPosXZTexture[0], sizeof(Vec4f) * s_displayListCount, hash);
+		hash = TFE_Hash::hashBlock64(s_displayListPosYUTexture[0], sizeof(Vec4f) * s_displayListCount, hash);
+		hash = TFE_Hash::hashBlock64(s_displayListTexIdTexture[0], sizeof(Vec2i) * s_displayListCount, hash);
+		hash = TFE_Hash::hashBlock64(s_displayListObjList, sizeof(void*) * s_displayListCount, hash);
+		return hash;
+	}
 	
 	void sprdisplayList_draw()
 	{
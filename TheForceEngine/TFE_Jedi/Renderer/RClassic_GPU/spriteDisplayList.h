@@ -39,4 +39,6 @@ namespace TFE_Jedi
 	void sprdisplayList_draw();
 
 	s32  sprdisplayList_getSize();
+	// Hash of the sprites in the order they were added.
+	u64  sprdisplayList_getHash();
 }  // TFE_Jedi
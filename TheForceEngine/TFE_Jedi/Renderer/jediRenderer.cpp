@@ -8,6 +8,7 @@
 #include "RClassic_Fixed/rclassicFixedSharedState.h"
 #include "RClassic_Fixed/rclassicFixed.h"
 #include "RClassic_Fixed/rsectorFixed.h"
+#include "RClassic_Fixed/rwallFixed.h"
 
 #include "RClassic_Float/rclassicFloat.h"
 #include "RClassic_Float/rsectorFloat.h"
@@ -35,6 +36,8 @@ namespace TFE_Jedi
 	static Vec3f s_lumMask = { 0 };
 	static Vec3f s_palFx = { 0 };
 	static u32 s_sourcePalette[256];
+	static u32 s_levelDataId = 1;
+	static bool s_levelDataBuilt = false;
 	bool s_showWireframe = false;
 	TFE_Sectors* s_sectorRenderer = nullptr;
 	RendererType s_rendererType = RENDERER_SOFTWARE;
@@ -45,12 +48,27 @@ namespace TFE_Jedi
 	void clear1dDepth();
 	void console_setSubRenderer(const std::vector<std::string>& args);
 	void console_getSubRenderer(const std::vector<std::string>& args);
+	void console_benchmarkColumns(const std::vector<std::string>& args);
+	void console_gpuTraversalCache(const std::vector<std::string>& args);
+	void console_gpuVerifyTraversal(const std::vector<std::string>& args);
 
 	/////////////////////////////////////////////
 	// Implementation
 	/////////////////////////////////////////////
+	static void renderer_levelDataChanged()
+	{
+		s_levelDataId++;
+		s_levelDataBuilt = false;
+	}
+
+	u32 renderer_getLevelDataId()
+	{
+		return s_levelDataBuilt ? s_levelDataId : 0;
+	}
+
 	void renderer_resetState()
 	{
+		renderer_levelDataChanged();
 		RClassic_Fixed::resetState();
 		RClassic_Float::resetState();
 		RClassic_GPU::resetState();
@@ -120,6 +138,9 @@ namespace TFE_Jedi
 		// Remove temporarily until they do something useful again.
 		CCMD("rsetSubRenderer", console_setSubRenderer, 1, "Set the sub-renderer - valid values are: Classic_Fixed, Classic_Float, Classic_GPU.");
 		CCMD("rgetSubRenderer", console_getSubRenderer, 0, "Get the current sub-renderer.");
+		CCMD("rbenchColumns", console_benchmarkColumns, 0, "Benchmark the classic wall column kernels: rbenchColumns [height] [columnCount].");
+		CCMD("rgpuTraversalCache", console_gpuTraversalCache, 0, "Enable or disable the GPU renderer traversal cache: rgpuTraversalCache [0|1] [posTolerance] [dirTolerance].");
+		CCMD("rgpuVerifyTraversal", console_gpuVerifyTraversal, 0, "Compare the GPU renderer cached traversal against the full traversal: rgpuVerifyTraversal [frameCount].");
 
 		// Setup performance counters.
 		TFE_COUNTER(s_maxAdjoinDepth, "Maximum Adjoin Depth");
@@ -141,6 +162,7 @@ namespace TFE_Jedi
 
 	void renderer_reset()
 	{
+		renderer_levelDataChanged();
 		// Reset all allocated renderers.
 		for (s32 i = 0; i < TSR_COUNT; i++)
 		{
@@ -235,6 +257,43 @@ namespace TFE_Jedi
 		TFE_Console::addToHistory(c_subRenderers[s_subRenderer]);
 	}
 
+	void console_benchmarkColumns(const std::vector<std::string>& args)
+	{
+		const s32 height = args.size() >= 2 ? strtol(args[1].c_str(), nullptr, 10) : 1080;
+		const s32 columnCount = args.size() >= 3 ? strtol(args[2].c_str(), nullptr, 10) : 20000;
+		RClassic_Fixed::wall_benchmarkColumns(height, columnCount);
+	}
+
+	void console_gpuTraversalCache(const std::vector<std::string>& args)
+	{
+		bool enabled;
+		f32 posTolerance, dirTolerance;
+		traversalCache_getSettings(&enabled, &posTolerance, &dirTolerance);
+		if (args.size() >= 2)
+		{
+			enabled = strtol(args[1].c_str(), nullptr, 10) != 0;
+			if (args.size() >= 3) { posTolerance = strtof(args[2].c_str(), nullptr); }
+			if (args.size() >= 4) { dirTolerance = strtof(args[3].c_str(), nullptr); }
+			traversalCache_setEnabled(enabled, posTolerance, dirTolerance);
+			traversalCache_getSettings(&enabled, &posTolerance, &dirTolerance);
+		}
+
+		char res[256];
+		sprintf(res, "GPU traversal cache: %s, position tolerance %f, direction tolerance %f.", enabled ? "enabled" : "disabled", posTolerance, dirTolerance);
+		TFE_Console::addToHistory(res);
+	}
+
+	void console_gpuVerifyTraversal(const std::vector<std::string>& args)
+	{
+		if (s_subRenderer != TSR_CLASSIC_GPU)
+		{
+			TFE_Console::addToHistory("The traversal cache is only used by the Classic_GPU sub-renderer.");
+			return;
+		}
+		const s32 frameCount = args.size() >= 2 ? strtol(args[1].c_str(), nullptr, 10) : 60;
+		traversalCache_verify(frameCount);
+	}
+
 	static s32 s_fov = -1;
 	static bool s_clearCachedTextures = false;
 
@@ -290,6 +349,8 @@ namespace TFE_Jedi
 		{
 			return JFALSE;
 		}
+		// The sub-renderers reallocate their buffers and rebuild their level data below.
+		renderer_levelDataChanged();
 
 		if (s_subRenderer != subRenderer)
 		{
@@ -371,6 +432,7 @@ namespace TFE_Jedi
 		}
 
 		s_subRenderer = subRenderer;
+		renderer_levelDataChanged();
 		if (s_sectorRenderer)
 		{
 			s_sectorRenderer->subrendererChanged();
@@ -507,6 +569,7 @@ namespace TFE_Jedi
 		}
 
 		s_drawFrame++;
+		s_levelDataBuilt = true;
 		if (s_subRenderer == TSR_CLASSIC_FIXED)
 		{
 			RClassic_Fixed::computeSkyOffsets();
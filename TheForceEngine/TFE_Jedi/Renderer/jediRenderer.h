@@ -58,6 +58,9 @@ namespace TFE_Jedi
 	JBool setSubRenderer(TFE_SubRenderer subRenderer = TSR_CLASSIC_FIXED);
 	TFE_SubRenderer getSubRenderer();
 	RendererType renderer_getType();
+	// Identifies the level data the sub-renderers have built, 0 until the world has been drawn after a reset.
+	// Snapshots restored in place are only valid while this is unchanged.
+	u32 renderer_getLevelDataId();
 
 	// Camera parameters: yaw, pitch, position (x, y, z)
 	//                    sectorId containing the camera.
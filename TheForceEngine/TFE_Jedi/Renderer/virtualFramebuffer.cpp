@@ -3,6 +3,8 @@
 #include "virtualFramebuffer.h"
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Settings/settings.h>
+#include <TFE_System/framePipeline.h>
+#include <vector>
 
 namespace TFE_Jedi
 {
@@ -28,6 +30,17 @@ namespace TFE_Jedi
 	static FramebufferMode s_mode = VFB_TEXTURE;
 	static FramebufferMode s_nextMode = VFB_TEXTURE;
 
+	// Pipelined frames: frames finished on the simulation thread are copied here and presented by the main thread.
+	struct FrameSnapshot
+	{
+		std::vector<u8> image;
+		u32 palette[256];
+		bool hasImage = false;
+		bool hasPalette = false;
+	};
+	static FrameSnapshot s_snapshot[2];
+	static s32 s_snapshotWrite = 0;
+
 	void vfb_createVirtualDisplay(u32 width, u32 height);
 		
 	////////////////////////////////////////////////////////////////////////
@@ -38,6 +51,14 @@ namespace TFE_Jedi
 	////////////////////////////////////////////////////////////////////////
 	JBool vfb_setResolution(u32 width, u32 height)
 	{
+		// The virtual display is a GPU resource.
+		if (TFE_System::framePipeline_isSimThread())
+		{
+			JBool result = JFALSE;
+			TFE_System::framePipeline_runOnMainThread([&]() { result = vfb_setResolution(width, height); });
+			return result;
+		}
+
 		TFE_Settings_Graphics* graphics = TFE_Settings::getGraphicsSettings();
 		if (width == s_width && height == s_height && s_widescreen == graphics->widescreen && s_mode == s_nextMode)
 		{
@@ -130,6 +151,13 @@ namespace TFE_Jedi
 	void vfb_setPalette(const u32* palette)
 	{
 		memcpy(s_palette, palette, sizeof(u32) * 256);
+		if (TFE_System::framePipeline_isSimThread())
+		{
+			FrameSnapshot* snapshot = &s_snapshot[s_snapshotWrite];
+			memcpy(snapshot->palette, palette, sizeof(u32) * 256);
+			snapshot->hasPalette = true;
+			return;
+		}
 		TFE_RenderBackend::setPalette(palette);
 	}
 
@@ -192,9 +220,39 @@ namespace TFE_Jedi
 	// Frame rendering is done, copy the results to GPU memory.
 	void vfb_swap()
 	{
+		if (TFE_System::framePipeline_isSimThread() && s_mode == VFB_TEXTURE)
+		{
+			FrameSnapshot* snapshot = &s_snapshot[s_snapshotWrite];
+			snapshot->image.assign(s_curFrameBuffer, s_curFrameBuffer + s_width * s_height);
+			snapshot->hasImage = true;
+			return;
+		}
 		TFE_RenderBackend::updateVirtualDisplay(s_curFrameBuffer, s_width * s_height);
 	}
 
+	void vfb_presentSnapshot()
+	{
+		FrameSnapshot* snapshot = &s_snapshot[s_snapshotWrite ^ 1];
+		if (snapshot->hasPalette)
+		{
+			TFE_RenderBackend::setPalette(snapshot->palette);
+		}
+		// Skip frames from before a resolution change.
+		if (snapshot->hasImage && snapshot->image.size() == size_t(s_width * s_height))
+		{
+			TFE_RenderBackend::updateVirtualDisplay(snapshot->image.data(), snapshot->image.size());
+		}
+		snapshot->hasPalette = false;
+		snapshot->hasImage = false;
+	}
+
+	void vfb_flipSnapshot()
+	{
+		s_snapshotWrite ^= 1;
+		s_snapshot[s_snapshotWrite].hasPalette = false;
+		s_snapshot[s_snapshotWrite].hasImage = false;
+	}
+
 	////////////////////////////
 	// Query
 	////////////////////////////
@@ -57,6 +57,12 @@ namespace TFE_Jedi
 	// Frame rendering is done, copy the results to GPU memory.
 	void vfb_swap();
 	void vfb_forceToBlack();
+	// Pipelined frames, called on the main thread.
+	// When called from the simulation thread, vfb_swap() and vfb_setPalette() store the frame in a snapshot instead.
+	// Present the last snapshot made available by vfb_flipSnapshot().
+	void vfb_presentSnapshot();
+	// Call after each pipelined simulation step, so its snapshot is presented next.
+	void vfb_flipSnapshot();
 
 	void vfb_bindRenderTarget(bool clearColor = false);
 	void vfb_unbindRenderTarget();
@@ -3,6 +3,7 @@
 #include "serialization.h"
 #include <TFE_Jedi/Level/levelData.h>
 #include <TFE_System/system.h>
+#include <vector>
 
 using namespace TFE_DarkForces;
 using namespace TFE_Memory;
@@ -16,6 +17,7 @@ namespace TFE_Jedi
 
 	u32 s_sVersion = 0;
 	SerializationMode s_sMode = SMODE_UNKNOWN;
+	static std::vector<u32> s_blockEnds;
 		
 	void serialization_serializeDfSound(Stream* stream, u32 version, SoundSourceId* id)
 	{
@@ -151,4 +153,21 @@ namespace TFE_Jedi
 			frame = (id < 0) ? nullptr : TFE_Sprite_Jedi::getFrameByIndex(ID_GET_INDEX(id), ID_GET_POOL(id));
 		}
 	}
-}
\ No newline at end of file
+
+	void serialization_clearBlocks()
+	{
+		s_blockEnds.clear();
+	}
+
+	void serialization_markBlock(Stream* stream)
+	{
+		if (s_sMode != SMODE_WRITE) { return; }
+		s_blockEnds.push_back((u32)stream->getLoc());
+	}
+
+	u32 serialization_getBlocks(const u32** blockEnds)
+	{
+		*blockEnds = s_blockEnds.data();
+		return (u32)s_blockEnds.size();
+	}
+}
@@ -110,4 +110,10 @@ namespace TFE_Jedi
 	void serialization_serialize3doPtr(Stream* stream, u32 version, JediModel*& model);
 	void serialization_serializeWaxPtr(Stream* stream, u32 version, JediWax*& wax);
 	void serialization_serializeFramePtr(Stream* stream, u32 version, JediFrame*& frame);
+
+	// Block boundaries of the state being written, such as the end of each subsystem.
+	// In-memory snapshots page each block separately so unchanged blocks can be shared.
+	void serialization_clearBlocks();
+	void serialization_markBlock(Stream* stream);
+	u32  serialization_getBlocks(const u32** blockEnds);
 }
\ No newline at end of file
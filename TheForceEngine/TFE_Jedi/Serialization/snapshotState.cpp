@@ -0,0 +1,71 @@
+#include "snapshotState.h"
+#include <vector>
+
+namespace TFE_Jedi
+{
+	struct SnapshotData
+	{
+		void* data;
+		u32 size;
+	};
+
+	// Registration happens during static initialization, so the lists are created on first use.
+	static std::vector<SnapshotData>& getDataList()
+	{
+		static std::vector<SnapshotData> s_dataList;
+		return s_dataList;
+	}
+
+	static std::vector<SnapshotStateFunc>& getFuncList()
+	{
+		static std::vector<SnapshotStateFunc> s_funcList;
+		return s_funcList;
+	}
+
+	bool snapshotState_add(void* data, u32 size)
+	{
+		getDataList().push_back({ data, size });
+		return true;
+	}
+
+	bool snapshotState_addFunc(SnapshotStateFunc func)
+	{
+		getFuncList().push_back(func);
+		return true;
+	}
+
+	// All of the data is handled before the functions, since they may depend on state owned by other modules.
+	void snapshotState_write(Stream* stream)
+	{
+		const std::vector<SnapshotData>& dataList = getDataList();
+		const size_t dataCount = dataList.size();
+		const SnapshotData* entry = dataList.data();
+		for (size_t i = 0; i < dataCount; i++, entry++)
+		{
+			stream->writeBuffer(entry->data, entry->size);
+		}
+
+		const std::vector<SnapshotStateFunc>& funcList = getFuncList();
+		for (size_t i = 0; i < funcList.size(); i++)
+		{
+			funcList[i](stream, true);
+		}
+	}
+
+	void snapshotState_read(Stream* stream)
+	{
+		const std::vector<SnapshotData>& dataList = getDataList();
+		const size_t dataCount = dataList.size();
+		const SnapshotData* entry = dataList.data();
+		for (size_t i = 0; i < dataCount; i++, entry++)
+		{
+			stream->readBuffer(entry->data, entry->size);
+		}
+
+		const std::vector<SnapshotStateFunc>& funcList = getFuncList();
+		for (size_t i = 0; i < funcList.size(); i++)
+		{
+			funcList[i](stream, false);
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Snapshot State
+// This was added for TFE and is not directly based on
+// reverse-engineered code.
+// Module state that lives outside of the game and level memory
+// regions registers itself here so that snapshots can be restored
+// in place, without going through the full serialization path.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_FileSystem/stream.h>
+
+namespace TFE_Jedi
+{
+	// Called after the registered data has been written or read, for state that cannot be copied directly.
+	typedef void(*SnapshotStateFunc)(Stream* stream, bool writeState);
+
+	bool snapshotState_add(void* data, u32 size);
+	bool snapshotState_addFunc(SnapshotStateFunc func);
+
+	void snapshotState_write(Stream* stream);
+	void snapshotState_read(Stream* stream);
+}
+
+// Register a module static, this must be used at namespace scope in the file that owns the variable.
+#define SNAPSHOT_STATE(var) static const bool c_snapshot_##var = TFE_Jedi::snapshotState_add(&var, (u32)sizeof(var))
+#define SNAPSHOT_STATE_FUNC(func) static const bool c_snapshotFunc_##func = TFE_Jedi::snapshotState_addFunc(func)
@@ -9,6 +9,7 @@
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Serialization/snapshotState.h>
 #include <TFE_Input/replay.h>
 #include <stdarg.h>
 #include <tuple>
@@ -96,6 +97,14 @@ namespace TFE_Jedi
 	static bool s_enableTimeLimiter = true;
 	static Task* s_taskPauseTask = nullptr;
 
+	SNAPSHOT_STATE(s_taskCount);
+	SNAPSHOT_STATE(s_rootTask);
+	SNAPSHOT_STATE(s_taskIter);
+	SNAPSHOT_STATE(s_curTask);
+	SNAPSHOT_STATE(s_currentMsg);
+	SNAPSHOT_STATE(s_curContext);
+	SNAPSHOT_STATE(s_frameActiveTaskCount);
+
 	void selectNextTask();
 
 	void createRootTask()
@@ -101,6 +101,7 @@ namespace TFE_Memory
 	u64 alloc_align(u64 baseSize);
 	s32  getBinFromSize(u32 size);
 	bool allocateNewBlock(MemoryRegion* region);
+	void clearBlock(MemoryRegion* region, MemoryBlock* block);
 	void removeHeaderFromFreelist(MemoryBlock* block, RegionAllocHeader* header);
 	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header);
 
@@ -171,20 +172,24 @@ namespace TFE_Memory
 		return region;
 	}
 
+	void clearBlock(MemoryRegion* region, MemoryBlock* block)
+	{
+		block->sizeFree = u32(region->blockSize);
+		block->count = 1;
+
+		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
+		header->size = block->sizeFree;
+		header->free = 0;
+		memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
+		insertBlockIntoFreelist(block, header);
+	}
+
 	void region_clear(MemoryRegion* region)
 	{
 		assert(region);
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
-			MemoryBlock* block = region->memBlocks[i];
-			block->sizeFree = u32(region->blockSize);
-			block->count = 1;
-
-			RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
-			header->size = block->sizeFree;
-			header->free = 0;
-			memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
-			insertBlockIntoFreelist(block, header);
+			clearBlock(region, region->memBlocks[i]);
 			VERIFY_MEMORY();
 		}
 	}
@@ -437,7 +442,8 @@ namespace TFE_Memory
 		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
 		{
 			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
+			// Blocks are allocated separately, so they are not sorted by address.
+			if (ptr >= block && (u8*)ptr < (u8*)block + sizeof(MemoryBlock) + region->blockSize)
 			{
 				rp = RelativePointer((u8*)ptr - (u8*)block - sizeof(MemoryBlock));
 				rp |= (i << c_relativeBlockShift);
@@ -472,53 +478,139 @@ namespace TFE_Memory
 		return (u8*)block + (ptr & c_relativeOffsetMask) + sizeof(MemoryBlock);
 	}
 
+	void writeBlock(MemoryRegion* region, MemoryBlock* block, Stream* stream)
+	{
+		stream->write(&block->count);
+		stream->write(&block->sizeFree);
+		for (s32 bin = 0; bin < ALLOC_BIN_COUNT; bin++)
+		{
+			RelativePointer ptr = region_getRelativePointer(region, block->freeListBins[bin]);
+			stream->write(&ptr);
+		}
+
+		u8* memPtr = (u8*)block + sizeof(MemoryBlock);
+		for (u32 al = 0; al < block->count; al++)
+		{
+			RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
+			if (header->free)
+			{
+				AllocHeaderFree* freeHeader = (AllocHeaderFree*)memPtr;
+				stream->writeBuffer(freeHeader, SHARED_HEADER_SIZE);
+
+				RelativePointer binNext = region_getRelativePointer(region, freeHeader->binNext);
+				RelativePointer binPrev = region_getRelativePointer(region, freeHeader->binPrev);
+				stream->write(&binNext);
+				stream->write(&binPrev);
+			}
+			else
+			{
+				stream->writeBuffer(header, header->size);
+			}
+
+			memPtr += header->size;
+		}
+	}
+
+	void readBlock(MemoryRegion* region, MemoryBlock* block, Stream* stream)
+	{
+		stream->read(&block->count);
+		stream->read(&block->sizeFree);
+		for (s32 bin = 0; bin < ALLOC_BIN_COUNT; bin++)
+		{
+			RelativePointer ptr;
+			stream->read(&ptr);
+			block->freeListBins[bin] = (AllocHeaderFree*)region_getRealPointer(region, ptr);
+		}
+
+		u8* memPtr = (u8*)block + sizeof(MemoryBlock);
+		for (u32 al = 0; al < block->count; al++)
+		{
+			RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
+			stream->readBuffer(header, SHARED_HEADER_SIZE);
+
+			if (header->free)
+			{
+				AllocHeaderFree* freeHeader = (AllocHeaderFree*)memPtr;
+				RelativePointer binNext, binPrev;
+				stream->read(&binNext);
+				stream->read(&binPrev);
+
+				freeHeader->binNext = (AllocHeaderFree*)region_getRealPointer(region, binNext);
+				freeHeader->binPrev = (AllocHeaderFree*)region_getRealPointer(region, binPrev);
+			}
+			else
+			{
+				stream->readBuffer((u8*)header + SHARED_HEADER_SIZE, header->size - SHARED_HEADER_SIZE);
+			}
+
+			memPtr += header->size;
+		}
+	}
+
+	bool region_serialize(MemoryRegion* region, Stream* stream)
+	{
+		if (!region || !stream)
+		{
+			return false;
+		}
+
+		stream->writeBuffer(region->name, 32);
+		stream->write(&region->blockArrCapacity);
+		stream->write(&region->blockCount);
+		stream->write(&region->blockSize);
+		stream->write(&region->maxBlocks);
+
+		for (s32 b = 0; b < region->blockCount; b++)
+		{
+			writeBlock(region, region->memBlocks[b], stream);
+		}
+		return true;
+	}
+
 	bool region_serializeToDisk(MemoryRegion* region, FileStream* file)
 	{
-		if (!region || !file || !file->isOpen())
+		if (!file || !file->isOpen())
+		{
+			return false;
+		}
+		return region_serialize(region, file);
+	}
+
+	bool region_restoreInPlace(MemoryRegion* region, Stream* stream)
+	{
+		if (!region || !stream)
 		{
 			return false;
 		}
 
-		file->writeBuffer(region->name, 32);
-		file->write(&region->blockArrCapacity);
-		file->write(&region->blockCount);
-		file->write(&region->blockSize);
-		file->write(&region->maxBlocks);
+		char name[32];
+		u64 blockArrCapacity, blockCount, blockSize, maxBlocks;
+		stream->readBuffer(name, 32);
+		stream->read(&blockArrCapacity);
+		stream->read(&blockCount);
+		stream->read(&blockSize);
+		stream->read(&maxBlocks);
+
+		// Blocks are never freed before the region is destroyed, so the existing blocks can be overwritten as long as
+		// the region has not shrunk. Any blocks allocated after the data was serialized are simply emptied.
+		if (strncmp(name, region->name, 32) != 0 || blockSize != region->blockSize || blockCount > region->blockCount)
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Cannot restore region '%s' in place, its blocks do not match the serialized data.", region->name);
+			return false;
+		}
 
 		for (s32 b = 0; b < region->blockCount; b++)
 		{
-			MemoryBlock* block = region->memBlocks[b];
-			file->write(&block->count);
-			file->write(&block->sizeFree);
-			for (s32 bin = 0; bin < ALLOC_BIN_COUNT; bin++)
+			if (b < blockCount)
 			{
-				RelativePointer ptr = region_getRelativePointer(region, block->freeListBins[bin]);
-				file->write(&ptr);
+				readBlock(region, region->memBlocks[b], stream);
 			}
-
-			u8* memPtr = (u8*)block + sizeof(MemoryBlock);
-			for (u32 al = 0; al < block->count; al++)
+			else
 			{
-				RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
-				if (header->free)
-				{
-					AllocHeaderFree* freeHeader = (AllocHeaderFree*)memPtr;
-					file->writeBuffer(freeHeader, SHARED_HEADER_SIZE);
-
-					RelativePointer binNext = region_getRelativePointer(region, freeHeader->binNext);
-					RelativePointer binPrev = region_getRelativePointer(region, freeHeader->binPrev);
-					file->write(&binNext);
-					file->write(&binPrev);
-				}
-				else
-				{
-					file->writeBuffer(header, header->size);
-				}
-
-				memPtr += header->size;
+				clearBlock(region, region->memBlocks[b]);
 			}
 		}
-
+		VERIFY_MEMORY();
 		return true;
 	}
 
@@ -613,38 +705,7 @@ namespace TFE_Memory
 				return nullptr;
 			}
 
-			file->read(&block->count);
-			file->read(&block->sizeFree);
-			for (s32 bin = 0; bin < ALLOC_BIN_COUNT; bin++)
-			{
-				RelativePointer ptr;
-				file->read(&ptr);
-				block->freeListBins[bin] = (AllocHeaderFree*)region_getRealPointer(region, ptr);
-			}
-
-			u8* memPtr = (u8*)block + sizeof(MemoryBlock);
-			for (u32 al = 0; al < block->count; al++)
-			{
-				RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
-				file->readBuffer(header, SHARED_HEADER_SIZE);
-
-				if (header->free)
-				{
-					AllocHeaderFree* freeHeader = (AllocHeaderFree*)memPtr;
-					RelativePointer binNext, binPrev;
-					file->read(&binNext);
-					file->read(&binPrev);
-
-					freeHeader->binNext = (AllocHeaderFree*)region_getRealPointer(region, binNext);
-					freeHeader->binPrev = (AllocHeaderFree*)region_getRealPointer(region, binPrev);
-				}
-				else
-				{
-					file->readBuffer((u8*)header + SHARED_HEADER_SIZE, header->size - SHARED_HEADER_SIZE);
-				}
-
-				memPtr += header->size;
-			}
+			readBlock(region, block, file);
 		}
 
 		return region;
@@ -30,11 +30,14 @@ namespace TFE_Memory
 	RelativePointer region_getRelativePointer(MemoryRegion* region, void* ptr);
 	void* region_getRealPointer(MemoryRegion* region, RelativePointer ptr);
 
-	// TODO: Support writing to and restoring from streams in memory.
+	bool region_serialize(MemoryRegion* region, Stream* stream);
 	bool region_serializeToDisk(MemoryRegion* region, FileStream* file);
 	// Restore a region from disk. If 'region' is NULL then a new region is allocated,
 	// otherwise it will attempt to reuse the existing region.
 	MemoryRegion* region_restoreFromDisk(MemoryRegion* region, FileStream* file);
+	// Restore a region serialized with region_serialize() into its existing blocks, so that pointers into the region
+	// stay valid. Fails without modifying the region if the blocks do not match.
+	bool region_restoreInPlace(MemoryRegion* region, Stream* stream);
 
 	void region_test();
 }
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include <cstring>
+
+#include "snapshotRing.h"
+#include <TFE_System/system.h>
+#include <TFE_System/hash.h>
+#include <algorithm>
+#include <assert.h>
+#include <stdlib.h>
+#include <unordered_map>
+#include <vector>
+
+namespace TFE_Memory
+{
+	enum SnapshotRingConst : u32
+	{
+		SNAPSHOT_PAGE_SHIFT = 12u,
+		SNAPSHOT_PAGE_SIZE  = 1u << SNAPSHOT_PAGE_SHIFT,	// 4Kb pages.
+	};
+
+	struct SnapshotPage
+	{
+		u64 hash;
+		u32 size;		// Only the last page of each block can be partial.
+		u32 refCount;
+		u8* data;
+		SnapshotPage* nextFree;
+	};
+
+	struct Snapshot
+	{
+		u32 tag;
+		size_t size;
+		std::vector<SnapshotPage*> pages;
+	};
+}
+
+using namespace TFE_Memory;
+
+struct SnapshotRing
+{
+	char name[32];
+
+	// Ring of snapshots, 'head' is the oldest.
+	Snapshot* slots;
+	u32 slotCount;
+	u32 head;
+	u32 count;
+
+	// Preallocated page pool.
+	SnapshotPage* pages;
+	u8* pageData;
+	u32 pageCount;
+	u32 freeCount;
+	SnapshotPage* freeList;
+
+	// Live pages by content hash, used to share unchanged pages.
+	std::unordered_map<u64, SnapshotPage*> pageMap;
+};
+
+namespace TFE_Memory
+{
+	void releasePage(SnapshotRing* ring, SnapshotPage* page)
+	{
+		assert(page->refCount > 0);
+		page->refCount--;
+		if (page->refCount) { return; }
+
+		std::unordered_map<u64, SnapshotPage*>::iterator iPage = ring->pageMap.find(page->hash);
+		if (iPage != ring->pageMap.end() && iPage->second == page)
+		{
+			ring->pageMap.erase(iPage);
+		}
+		page->nextFree = ring->freeList;
+		ring->freeList = page;
+		ring->freeCount++;
+	}
+
+	void releaseSnapshot(SnapshotRing* ring, Snapshot* snapshot)
+	{
+		const size_t count = snapshot->pages.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			releasePage(ring, snapshot->pages[i]);
+		}
+		snapshot->pages.clear();
+		snapshot->size = 0;
+	}
+
+	void dropOldest(SnapshotRing* ring)
+	{
+		if (!ring->count) { return; }
+		releaseSnapshot(ring, &ring->slots[ring->head]);
+		ring->head = (ring->head + 1) % ring->slotCount;
+		ring->count--;
+	}
+
+	Snapshot* getSnapshot(SnapshotRing* ring, u32 index)
+	{
+		if (!ring || index >= ring->count) { return nullptr; }
+		return &ring->slots[(ring->head + ring->count - 1 - index) % ring->slotCount];
+	}
+
+	SnapshotPage* findPage(SnapshotRing* ring, u64 hash, const u8* src, u32 size)
+	{
+		std::unordered_map<u64, SnapshotPage*>::iterator iPage = ring->pageMap.find(hash);
+		if (iPage == ring->pageMap.end()) { return nullptr; }
+
+		SnapshotPage* page = iPage->second;
+		if (page->size != size || memcmp(page->data, src, size) != 0) { return nullptr; }
+		return page;
+	}
+
+	SnapshotRing* snapshotRing_create(const char* name, u32 slotCount, size_t memoryBudget)
+	{
+		const u32 pageCount = u32(memoryBudget >> SNAPSHOT_PAGE_SHIFT);
+		if (!slotCount || !pageCount) { return nullptr; }
+
+		SnapshotRing* ring = new SnapshotRing();
+		strncpy(ring->name, name, 31);
+		ring->name[31] = 0;
+
+		ring->slots = new Snapshot[slotCount];
+		ring->slotCount = slotCount;
+		ring->head = 0;
+		ring->count = 0;
+
+		ring->pages = (SnapshotPage*)malloc(sizeof(SnapshotPage) * pageCount);
+		ring->pageData = (u8*)malloc(size_t(pageCount) << SNAPSHOT_PAGE_SHIFT);
+		if (!ring->pages || !ring->pageData)
+		{
+			TFE_System::logWrite(LOG_ERROR, "SnapshotRing", "Cannot allocate %u pages for snapshot ring '%s'.", pageCount, ring->name);
+			snapshotRing_destroy(ring);
+			return nullptr;
+		}
+		ring->pageCount = pageCount;
+		snapshotRing_clear(ring);
+		return ring;
+	}
+
+	void snapshotRing_destroy(SnapshotRing* ring)
+	{
+		if (!ring) { return; }
+		delete[] ring->slots;
+		free(ring->pages);
+		free(ring->pageData);
+		delete ring;
+	}
+
+	void snapshotRing_clear(SnapshotRing* ring)
+	{
+		if (!ring) { return; }
+		for (u32 i = 0; i < ring->slotCount; i++)
+		{
+			ring->slots[i].pages.clear();
+			ring->slots[i].size = 0;
+		}
+		ring->head = 0;
+		ring->count = 0;
+		ring->pageMap.clear();
+
+		ring->freeList = nullptr;
+		for (s32 i = s32(ring->pageCount) - 1; i >= 0; i--)
+		{
+			SnapshotPage* page = &ring->pages[i];
+			page->data = ring->pageData + (size_t(i) << SNAPSHOT_PAGE_SHIFT);
+			page->refCount = 0;
+			page->nextFree = ring->freeList;
+			ring->freeList = page;
+		}
+		ring->freeCount = ring->pageCount;
+	}
+
+	bool snapshotRing_push(SnapshotRing* ring, const void* data, size_t size, u32 tag, const u32* blockEnds, u32 blockCount)
+	{
+		if (!ring || !data || !size) { return false; }
+		// Without block boundaries the whole snapshot is a single block.
+		const u32 wholeEnd = u32(size);
+		if (!blockEnds || !blockCount)
+		{
+			blockEnds = &wholeEnd;
+			blockCount = 1;
+		}
+
+		// Each block starts on a new page, so a block that changes size does not shift the pages of the blocks after it.
+		size_t pageCount = 0;
+		size_t blockStart = 0;
+		for (u32 b = 0; b < blockCount; b++)
+		{
+			const size_t blockEnd = b == blockCount - 1 ? size : std::min(size_t(blockEnds[b]), size);
+			if (blockEnd <= blockStart) { continue; }
+			pageCount += (blockEnd - blockStart + SNAPSHOT_PAGE_SIZE - 1) >> SNAPSHOT_PAGE_SHIFT;
+			blockStart = blockEnd;
+		}
+		if (pageCount > ring->pageCount)
+		{
+			TFE_System::logWrite(LOG_WARNING, "SnapshotRing", "Snapshot of %u bytes does not fit in the '%s' memory budget.", u32(size), ring->name);
+			return false;
+		}
+
+		if (ring->count == ring->slotCount)
+		{
+			dropOldest(ring);
+		}
+		// Claim the slot first so that making room below never drops it.
+		Snapshot* snapshot = &ring->slots[(ring->head + ring->count) % ring->slotCount];
+		snapshot->tag = tag;
+		snapshot->size = size;
+		snapshot->pages.clear();
+		snapshot->pages.reserve(pageCount);
+		ring->count++;
+
+		const u8* base = (const u8*)data;
+		blockStart = 0;
+		for (u32 b = 0; b < blockCount; b++)
+		{
+			const size_t blockEnd = b == blockCount - 1 ? size : std::min(size_t(blockEnds[b]), size);
+			for (size_t offset = blockStart; offset < blockEnd; offset += SNAPSHOT_PAGE_SIZE)
+			{
+				const u8* src = base + offset;
+				const u32 pageSize = u32(std::min(blockEnd - offset, size_t(SNAPSHOT_PAGE_SIZE)));
+				const u64 hash = TFE_Hash::fnv1a64(src, pageSize);
+
+				SnapshotPage* page = findPage(ring, hash, src, pageSize);
+				if (page)
+				{
+					page->refCount++;
+					snapshot->pages.push_back(page);
+					continue;
+				}
+
+				while (!ring->freeList && ring->count > 1)
+				{
+					dropOldest(ring);
+				}
+				page = ring->freeList;
+				if (!page)
+				{
+					// Should not happen since the size was checked above, but never leave a partial snapshot.
+					releaseSnapshot(ring, snapshot);
+					ring->count--;
+					return false;
+				}
+				ring->freeList = page->nextFree;
+				ring->freeCount--;
+
+				memcpy(page->data, src, pageSize);
+				page->hash = hash;
+				page->size = pageSize;
+				page->refCount = 1;
+				page->nextFree = nullptr;
+				// If another page with the same hash is already live, keep that one in the map.
+				ring->pageMap.insert({ hash, page });
+				snapshot->pages.push_back(page);
+			}
+			blockStart = std::max(blockStart, blockEnd);
+		}
+		return true;
+	}
+
+	void snapshotRing_pop(SnapshotRing* ring)
+	{
+		Snapshot* snapshot = getSnapshot(ring, 0);
+		if (!snapshot) { return; }
+		releaseSnapshot(ring, snapshot);
+		ring->count--;
+	}
+
+	u32 snapshotRing_getCount(SnapshotRing* ring)
+	{
+		return ring ? ring->count : 0;
+	}
+
+	size_t snapshotRing_getSize(SnapshotRing* ring, u32 index)
+	{
+		Snapshot* snapshot = getSnapshot(ring, index);
+		return snapshot ? snapshot->size : 0;
+	}
+
+	u32 snapshotRing_getTag(SnapshotRing* ring, u32 index)
+	{
+		Snapshot* snapshot = getSnapshot(ring, index);
+		return snapshot ? snapshot->tag : 0;
+	}
+
+	bool snapshotRing_read(SnapshotRing* ring, u32 index, void* dst)
+	{
+		Snapshot* snapshot = getSnapshot(ring, index);
+		if (!snapshot || !dst) { return false; }
+
+		u8* out = (u8*)dst;
+		const size_t count = snapshot->pages.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			const SnapshotPage* page = snapshot->pages[i];
+			memcpy(out, page->data, page->size);
+			out += page->size;
+		}
+		return true;
+	}
+
+	size_t snapshotRing_getMemoryUsed(SnapshotRing* ring)
+	{
+		return ring ? size_t(ring->pageCount - ring->freeCount) << SNAPSHOT_PAGE_SHIFT : 0;
+	}
+
+	size_t snapshotRing_getMemoryBudget(SnapshotRing* ring)
+	{
+		return ring ? size_t(ring->pageCount) << SNAPSHOT_PAGE_SHIFT : 0;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Snapshot ring
+// Holds a fixed number of in-memory snapshots within a memory budget.
+// Snapshot data is split into blocks, such as the state of each
+// subsystem, and each block into pages. Pages that did not change
+// between snapshots are shared, so consecutive snapshots are cheap.
+// All page memory is allocated up front when the ring is created.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+struct SnapshotRing;
+
+namespace TFE_Memory
+{
+	SnapshotRing* snapshotRing_create(const char* name, u32 slotCount, size_t memoryBudget);
+	void snapshotRing_destroy(SnapshotRing* ring);
+	// Remove all snapshots, the page memory is kept.
+	void snapshotRing_clear(SnapshotRing* ring);
+
+	// Add a snapshot as the newest entry; the oldest snapshots are dropped when out of slots or memory.
+	// 'blockEnds' holds the end offset of each block; each block starts on a new page so its pages stay
+	// the same when an earlier block changes size. Pass no blocks to page the data as a single block.
+	// Returns false if the data does not fit in the memory budget.
+	bool snapshotRing_push(SnapshotRing* ring, const void* data, size_t size, u32 tag, const u32* blockEnds = nullptr, u32 blockCount = 0);
+	// Remove the newest snapshot.
+	void snapshotRing_pop(SnapshotRing* ring);
+
+	// Snapshots are indexed from newest (0) to oldest (count - 1).
+	u32    snapshotRing_getCount(SnapshotRing* ring);
+	size_t snapshotRing_getSize(SnapshotRing* ring, u32 index);
+	u32    snapshotRing_getTag(SnapshotRing* ring, u32 index);
+	// Copy the snapshot into 'dst', which must hold at least snapshotRing_getSize() bytes.
+	bool   snapshotRing_read(SnapshotRing* ring, u32 index, void* dst);
+
+	size_t snapshotRing_getMemoryUsed(SnapshotRing* ring);
+	size_t snapshotRing_getMemoryBudget(SnapshotRing* ring);
+}
@@ -265,11 +265,12 @@ void ScreenCapture::endRecording()
 	{
 		update(true);
 
-		TFE_GIF::write();
+		// Waits for the encoder to finish the queued frames.
+		const bool saved = TFE_GIF::write();
 
 		m_state = CONFIRMATION;
 		m_confirmationTimeStart = TFE_System::getTime();
-		m_confirmationMessage = string("GIF saved to " + m_capturePath);
+		m_confirmationMessage = saved ? string("GIF saved to " + m_capturePath) : string("Failed to save GIF to " + m_capturePath);
 	}
 	else 
 	{
@@ -1,6 +1,7 @@
 #include <cstring>
 
 #include <TFE_System/profiler.h>
+#include <TFE_System/parallel.h>
 #include <TFE_System/math.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
@@ -23,7 +24,12 @@
 
 #include <TFE_Asset/imageAsset.h>
 #include <TFE_Memory/chunkedArray.h>
+#include <TFE_System/hash.h>
+#include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
 
+#include <algorithm>
 #include <map>
 
 #define DEBUG_TEXTURE_ATLAS 0
@@ -57,6 +63,40 @@ namespace TFE_Jedi
 	};
 	static const f32 c_satLimit = 0.2f;
 
+	enum PackJobType
+	{
+		PACKJOB_TEXTURE = 0,
+		PACKJOB_DELT,
+		PACKJOB_WAX_CELL,
+	};
+
+	// Texture placement is serial, the texels are copied into place afterward
+	// using one job per texture. Jobs write to disjoint areas of the pages.
+	struct PackJob
+	{
+		s32 type;
+		u32 x, y;
+		s32 page;
+		s32 tableIndex;
+		s32 paddingX, paddingY;
+		s32 mipCount;
+		// Size of the texture in the atlas, not including the padding.
+		s32 width, height;
+		s32 scaleFactor;
+
+		// Source.
+		const TextureData* texData;
+		const TextureData* hdSrc;
+		s32 frameIndex;
+		const void* basePtr;
+		const WaxCell* cell;
+		const HdWax* hdWax;
+
+		// Results.
+		Vec3f halfTint;
+		u64 hash;
+	};
+
 	static std::vector<TextureNode*> s_nodes;
 	static TextureNode* s_root;
 	static TexturePacker* s_texturePacker;
@@ -73,6 +113,7 @@ namespace TFE_Jedi
 	static s32 s_unpackedBuffer = 0;
 	static s32 s_currentPage = 0;
 	static AssetPool s_assetPool;
+	static std::vector<PackJob> s_packJobs;
 
 	static u32 s_conversionPal[PALETTE_COUNT][PALETTE_SIZE];
 
@@ -625,10 +666,10 @@ namespace TFE_Jedi
 		}
 		else
 		{
-			const s32 srcStride = w * 4;
+			const s32 dstStride = (w + paddingX) * 4;
 			for (s32 y = 0; y < h + paddingY; y++, output += dstStrideInTexels)
 			{
-				memset(output, 0, srcStride);
+				memset(output, 0, dstStride);
 			}
 		}
 	}
@@ -705,10 +746,10 @@ namespace TFE_Jedi
 		}
 		else
 		{
-			const s32 srcStride = w * 4;
+			const s32 dstStride = (w + paddingX) * 4;
 			for (s32 y = 0; y < h + paddingY; y++, output += dstStrideInTexels)
 			{
-				memset(output, 0, srcStride);
+				memset(output, 0, dstStride);
 			}
 		}
 
@@ -731,15 +772,15 @@ namespace TFE_Jedi
 		}
 	}
 
-	void generateTrueColorMips(const TextureNode* node, const TextureData* texData, s32 scaleFactor, s32 paddingX, s32 paddingY, s32 mipCount, u32* output)
+	void generateTrueColorMips(const PackJob* job)
 	{
-		const u32* source = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
-		u32 w = texData->width  * scaleFactor + paddingX;
-		u32 h = texData->height * scaleFactor + paddingY;
+		const u32* source = (u32*)getWritePointer(job->page, job->x, job->y, 0);
+		u32 w = job->width  + job->paddingX;
+		u32 h = job->height + job->paddingY;
 		u32 stride = s_texturePacker->width;
-		for (s32 m = 1; m < mipCount; m++)
+		for (s32 m = 1; m < job->mipCount; m++)
 		{
-			output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, m);
+			u32* output = (u32*)getWritePointer(job->page, job->x, job->y, m);
 			generateMipmap(source, output, w, h, stride);
 
 			stride >>= 1;
@@ -763,70 +804,53 @@ namespace TFE_Jedi
 		}
 	}
 
-	void packNode(const TextureNode* node, const TextureData* texData, Vec4i* tableEntry, s32 paddingX, s32 paddingY, s32 mipCount, const TextureData* hdSrc, s32 frameIndex)
+	void packNode(PackJob* job)
 	{
 		// Copy the texture into place.
-		const s32 offsetX = paddingX / 2;
-		const s32 offsetY = paddingY / 2;
-		const bool isHdTex = hdSrc && hdSrc->hdAssetData;
+		const TextureData* texData = job->texData;
+		const TextureData* hdSrc = job->hdSrc;
+		const s32 offsetX = job->paddingX / 2;
+		const s32 offsetY = job->paddingY / 2;
 		const u8* srcImage = texData->image;
-		const s32 scaleFactor = isHdTex ? hdSrc->scaleFactor : 1;
 
-		Vec3f halfTint = { 1.0f, 1.0f, 1.0f };
+		job->halfTint = { 1.0f, 1.0f, 1.0f };
 		if (s_texturePacker->trueColor)
 		{
-			u32* output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
-			if (isHdTex)
+			u32* output = (u32*)getWritePointer(job->page, job->x, job->y, 0);
+			if (hdSrc)
 			{
 				const u32* srcImageHd = (u32*)hdSrc->hdAssetData;
-				copyHdTrueColorTexture(texData, scaleFactor, srcImageHd, frameIndex, paddingX, paddingY, offsetX, offsetY, output);
+				copyHdTrueColorTexture(texData, job->scaleFactor, srcImageHd, job->frameIndex, job->paddingX, job->paddingY, offsetX, offsetY, output);
 			}
 			else
 			{
-				copy8BitToTrueColorTexture(texData, srcImage, paddingX, paddingY, offsetX, offsetY, output, halfTint);
+				copy8BitToTrueColorTexture(texData, srcImage, job->paddingX, job->paddingY, offsetX, offsetY, output, job->halfTint);
 			}
-			generateTrueColorMips(node, texData, scaleFactor, paddingX, paddingY, mipCount, output);
+			generateTrueColorMips(job);
 		}
 		else
 		{
-			u8* output = getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u8* output = getWritePointer(job->page, job->x, job->y, 0);
 			copy8BitTo8BitTexture(texData, srcImage, output);
 		}
-		s_usedTexels += texData->width * texData->height;
-
-		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x + offsetX;
-		tableEntry->y = (s32)node->rect.y + offsetY;
-		tableEntry->z = (s32)texData->width  * scaleFactor;
-		tableEntry->w = (s32)texData->height * scaleFactor;
-
-		// Page the page index into the x offset.
-		tableEntry->x |= (s_currentPage << 12);
-		tableEntry->y |= (scaleFactor << 12);
-
-		// Half color tint packed.
-		const s32 r = s32(halfTint.x * 255.0);
-		const s32 g = s32(halfTint.y * 255.0);
-		const s32 b = s32(halfTint.z * 255.0);
-		tableEntry->z |= ((r << 15) | (g << 23));
-		tableEntry->w |= (b << 15);
 	}
 
-	void packNodeDeltaTex(const TextureNode* node, const TextureData* texData, Vec4i* tableEntry, s32 paddingX, s32 paddingY)
+	void packNodeDeltaTex(PackJob* job)
 	{
 		// Copy the texture into place.
-		s32 offsetX = paddingX / 2;
-		s32 offsetY = paddingY / 2;
+		const TextureData* texData = job->texData;
+		s32 offsetX = job->paddingX / 2;
+		s32 offsetY = job->paddingY / 2;
 		const u8* srcImage = texData->image;
 		if (s_texturePacker->trueColor)
 		{
 			const u32* pal = getPalette(texData->palIndex);
 
-			u32* output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
-			for (s32 y = 0; y < texData->height + paddingY; y++, output += s_texturePacker->width)
+			u32* output = (u32*)getWritePointer(job->page, job->x, job->y, 0);
+			for (s32 y = 0; y < texData->height + job->paddingY; y++, output += s_texturePacker->width)
 			{
 				const s32 ySrc = y - offsetY;
-				for (s32 x = 0; x < texData->width + paddingX; x++)
+				for (s32 x = 0; x < texData->width + job->paddingX; x++)
 				{
 					const s32 xSrc = x - offsetX;
 					const bool outside = ySrc < 0 || xSrc < 0 || ySrc >= texData->height || xSrc >= texData->width;
@@ -839,7 +863,7 @@ namespace TFE_Jedi
 		}
 		else
 		{
-			u8* output = getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u8* output = getWritePointer(job->page, job->x, job->y, 0);
 			for (s32 y = 0; y < texData->height; y++, output += s_texturePacker->width)
 			{
 				for (s32 x = 0; x < texData->width; x++)
@@ -848,57 +872,57 @@ namespace TFE_Jedi
 				}
 			}
 		}
-		s_usedTexels += texData->width * texData->height;
-
-		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x + offsetX;
-		tableEntry->y = (s32)node->rect.y + offsetY;
-		tableEntry->z = (s32)texData->width;
-		tableEntry->w = (s32)texData->height;
+	}
 
-		// Page the page index into the x offset.
-		s32 scaleFactor = 1;
-		tableEntry->x |= (s_currentPage << 12);
-		tableEntry->y |= (scaleFactor << 12);
+	// Returns the 8-bit column 'x' of a wax cell, compressed columns are decompressed into 'workBuffer'.
+	const u8* getWaxCellColumn(const PackJob* job, s32 x, s32 height, u8* workBuffer)
+	{
+		const WaxCell* cell = job->cell;
+		const u8* imageData = (u8*)cell + sizeof(WaxCell);
+		const u8* image = (cell->compressed == 1) ? imageData + (cell->sizeX * sizeof(u32)) : imageData;
+		const u32* columnOffset = (u32*)((u8*)job->basePtr + cell->columnOffset);
+		if (cell->compressed)
+		{
+			const u8* colPtr = (u8*)cell + columnOffset[x];
+			sprite_decompressColumn(colPtr, workBuffer, height);
+			return workBuffer;
+		}
+		return image + columnOffset[x];
 	}
 		
-	void packNodeCell(const TextureNode* node, const void* basePtr, const WaxCell* cell, const HdWax* hdWax, Vec4i* tableEntry, s32 paddingX, s32 paddingY)
+	void packNodeCell(PackJob* job)
 	{
 		// Copy the texture into place.
-		s32 offsetX = paddingX / 2;
-		s32 offsetY = paddingY / 2;
-
-		const s32 compressed = hdWax ? 0 : cell->compressed;
-		u8* imageData = hdWax ? (u8*)hdWax->cells[cell->id].data : (u8*)cell + sizeof(WaxCell);
-		u8* image = (compressed == 1) ? imageData + (cell->sizeX * sizeof(u32)) : imageData;
+		const WaxCell* cell = job->cell;
+		const HdWax* hdWax = job->hdWax;
+		s32 offsetX = job->paddingX / 2;
+		s32 offsetY = job->paddingY / 2;
 
-		s32 scaleFactor = hdWax ? 2 : 1;	// TODO: Hardcoded.
-		s32 w = cell->sizeX * scaleFactor;
-		s32 h = cell->sizeY * scaleFactor;
+		s32 w = job->width;
+		s32 h = job->height;
 		
 		u8 columnWorkBuffer[WAX_DECOMPRESS_SIZE];
-		const u32* columnOffset = (u32*)((u8*)basePtr + cell->columnOffset);
 		if (s_texturePacker->trueColor)
 		{
 			const u32* pal = getPalette(PALETTE_DEFAULT_IDX);
 			const u8* remap = &TFE_DarkForces::s_levelColorMap[31 << 8];
 
-			u32* output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u32* output = (u32*)getWritePointer(job->page, job->x, job->y, 0);
 
-			for (s32 x = 0; x < w + paddingX; x++)
+			for (s32 x = 0; x < w + job->paddingX; x++)
 			{
 				const s32 xSrc = x - offsetX;
 				if (xSrc < 0 || xSrc >= w)
 				{
-					for (s32 y = 0; y < h + paddingY; y++)
+					for (s32 y = 0; y < h + job->paddingY; y++)
 					{
 						output[y*s_texturePacker->width + x] = 0;
 					}
 				}
 				else if (hdWax)
 				{
-					u32* imageDataHd = (u32*)imageData;
-					for (s32 y = 0; y < h + paddingY; y++)
+					const u32* imageDataHd = (u32*)hdWax->cells[cell->id].data;
+					for (s32 y = 0; y < h + job->paddingY; y++)
 					{
 						const s32 ySrc = y - offsetY;
 						const bool outside = ySrc < 0 || ySrc >= h;
@@ -908,15 +932,8 @@ namespace TFE_Jedi
 				}
 				else
 				{
-					u8* column = (u8*)image + columnOffset[xSrc];
-					if (compressed)
-					{
-						const u8* colPtr = (u8*)cell + columnOffset[xSrc];
-						sprite_decompressColumn(colPtr, columnWorkBuffer, cell->sizeY);
-						column = columnWorkBuffer;
-					}
-
-					for (s32 y = 0; y < h + paddingY; y++)
+					const u8* column = getWaxCellColumn(job, xSrc, cell->sizeY, columnWorkBuffer);
+					for (s32 y = 0; y < h + job->paddingY; y++)
 					{
 						const s32 ySrc = y - offsetY;
 						bool outside = ySrc < 0 || ySrc >= h;
@@ -938,34 +955,343 @@ namespace TFE_Jedi
 		}
 		else
 		{
-			u8* output = getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u8* output = getWritePointer(job->page, job->x, job->y, 0);
 			for (s32 x = 0; x < w; x++)
 			{
-				u8* column = (u8*)image + columnOffset[x];
-				if (compressed)
-				{
-					const u8* colPtr = (u8*)cell + columnOffset[x];
-					sprite_decompressColumn(colPtr, columnWorkBuffer, h);
-					column = columnWorkBuffer;
-				}
-
+				const u8* column = getWaxCellColumn(job, x, h, columnWorkBuffer);
 				for (s32 y = 0; y < h; y++)
 				{
 					output[y*s_texturePacker->width + x] = column[y];
 				}
 			}
 		}
-		s_usedTexels += w * h;
+	}
+
+	void packJob_run(PackJob* job)
+	{
+		switch (job->type)
+		{
+			case PACKJOB_TEXTURE:  { packNode(job); } break;
+			case PACKJOB_DELT:     { packNodeDeltaTex(job); } break;
+			case PACKJOB_WAX_CELL: { packNodeCell(job); } break;
+		}
+	}
 
-		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x + offsetX;
-		tableEntry->y = (s32)node->rect.y + offsetY;
-		tableEntry->z = (s32)w;
-		tableEntry->w = (s32)h;
+	// Copy the mapping into the texture table.
+	void packJob_writeTableEntry(const PackJob* job)
+	{
+		Vec4i* tableEntry = &s_texturePacker->textureTable[job->tableIndex];
+		tableEntry->x = (s32)job->x + job->paddingX / 2;
+		tableEntry->y = (s32)job->y + job->paddingY / 2;
+		tableEntry->z = job->width;
+		tableEntry->w = job->height;
 
 		// Page the page index into the x offset.
-		tableEntry->x |= (s_currentPage << 12);
-		tableEntry->y |= (scaleFactor << 12);
+		tableEntry->x |= (job->page << 12);
+		tableEntry->y |= (job->scaleFactor << 12);
+
+		if (job->type == PACKJOB_TEXTURE)
+		{
+			// Half color tint packed.
+			const s32 r = s32(job->halfTint.x * 255.0);
+			const s32 g = s32(job->halfTint.y * 255.0);
+			const s32 b = s32(job->halfTint.z * 255.0);
+			tableEntry->z |= ((r << 15) | (g << 23));
+			tableEntry->w |= (b << 15);
+		}
+	}
+
+	// Hash of everything that determines the texels written by the job, but not its position.
+	u64 packJob_computeHash(const PackJob* job)
+	{
+		u64 hash = TFE_Hash::fnv1a64Value(job->type);
+		hash = TFE_Hash::fnv1a64Value(job->width, hash);
+		hash = TFE_Hash::fnv1a64Value(job->height, hash);
+		hash = TFE_Hash::fnv1a64Value(job->paddingX, hash);
+		hash = TFE_Hash::fnv1a64Value(job->paddingY, hash);
+		hash = TFE_Hash::fnv1a64Value(job->mipCount, hash);
+		hash = TFE_Hash::fnv1a64Value(job->scaleFactor, hash);
+
+		const TextureData* texData = job->texData;
+		if (job->type == PACKJOB_WAX_CELL)
+		{
+			const WaxCell* cell = job->cell;
+			if (job->hdWax)
+			{
+				hash = TFE_Hash::hashBlock64(job->hdWax->cells[cell->id].data, size_t(job->width) * size_t(job->height) * sizeof(u32), hash);
+			}
+			else
+			{
+				// Hash the decompressed columns, matching packNodeCell().
+				u8 columnWorkBuffer[WAX_DECOMPRESS_SIZE];
+				for (s32 x = 0; x < job->width; x++)
+				{
+					hash = TFE_Hash::hashBlock64(getWaxCellColumn(job, x, cell->sizeY, columnWorkBuffer), cell->sizeY, hash);
+				}
+			}
+			return hash;
+		}
+
+		hash = TFE_Hash::fnv1a64Value(texData->flags, hash);
+		hash = TFE_Hash::fnv1a64Value(texData->palIndex, hash);
+		if (job->hdSrc)
+		{
+			const size_t frameSize = size_t(job->width) * size_t(job->height) * sizeof(u32);
+			if (job->hdSrc->hdAssetData)
+			{
+				hash = TFE_Hash::hashBlock64((u8*)job->hdSrc->hdAssetData + job->frameIndex * frameSize, frameSize, hash);
+			}
+		}
+		else if (texData->image)
+		{
+			hash = TFE_Hash::hashBlock64(texData->image, size_t(texData->width) * size_t(texData->height), hash);
+		}
+		return hash;
+	}
+
+	// Size of the area written by the job at mip 0, the padding is included.
+	void packJob_getExtent(const PackJob* job, u32 mip, s32* w, s32* h)
+	{
+		*w = (job->width  + job->paddingX) >> mip;
+		*h = (job->height + job->paddingY) >> mip;
+	}
+
+	size_t packJob_getDataSize(const PackJob* job)
+	{
+		size_t size = 0;
+		for (s32 m = 0; m < job->mipCount; m++)
+		{
+			s32 w, h;
+			packJob_getExtent(job, m, &w, &h);
+			size += size_t(w) * size_t(h) * s_texturePacker->bytesPerTexel;
+		}
+		return size;
+	}
+
+	// Copy the texels written by the job from the page into 'data' or from 'data' into the page.
+	void packJob_copyData(const PackJob* job, u8* data, bool toPage)
+	{
+		const u32 bytesPerTexel = s_texturePacker->bytesPerTexel;
+		for (s32 m = 0; m < job->mipCount; m++)
+		{
+			s32 w, h;
+			packJob_getExtent(job, m, &w, &h);
+			const size_t rowSize = size_t(w) * bytesPerTexel;
+			const size_t pageStride = size_t(s_texturePacker->width >> m) * bytesPerTexel;
+
+			u8* page = getWritePointer(job->page, job->x, job->y, m);
+			for (s32 y = 0; y < h; y++, page += pageStride, data += rowSize)
+			{
+				if (toPage) { memcpy(page, data, rowSize); }
+				else        { memcpy(data, page, rowSize); }
+			}
+		}
+	}
+
+	/////////////////////////////////////////////////////////
+	// Atlas Cache
+	// The texels written by each pack are saved to PATH_PROGRAM_DATA/AtlasCache/
+	// keyed by the hash of the source textures, palettes and packer settings.
+	// Only the texels are cached, placement is always computed, so cached data
+	// can be used no matter where the textures end up.
+	// Each pack is a separate file, only the most recently written files are kept.
+	/////////////////////////////////////////////////////////
+	enum AtlasCacheConst : u32
+	{
+		ATLAS_CACHE_MAGIC   = 0x43415446,	// "TFAC"
+		ATLAS_CACHE_VERSION = 1,
+		ATLAS_CACHE_MAX_FILES = 64,		// Enough for every level of a game (level and object packs) and the game pool.
+	};
+
+	struct AtlasCacheHeader
+	{
+		u32 magic;
+		u32 version;
+		u64 key;
+		u32 jobCount;
+		u32 bytesPerTexel;
+		u64 dataSize;
+	};
+
+	u64 atlasCache_computeKey()
+	{
+		const s32 count = (s32)s_packJobs.size();
+		TFE_System::parallelFor(count, [](s32 i) { s_packJobs[i].hash = packJob_computeHash(&s_packJobs[i]); });
+
+		u64 key = TFE_Hash::fnv1a64(s_texturePacker->name);
+		key = TFE_Hash::fnv1a64Value(s_texturePacker->width, key);
+		key = TFE_Hash::fnv1a64Value(s_texturePacker->height, key);
+		key = TFE_Hash::fnv1a64Value(s_texturePacker->bytesPerTexel, key);
+		key = TFE_Hash::fnv1a64Value(s_colorIndexStart, key);
+		key = TFE_Hash::fnv1a64Value(s_assetPool, key);
+		key = TFE_Hash::fnv1a64(s_conversionPal, sizeof(s_conversionPal), key);
+		if (TFE_DarkForces::s_levelColorMap)
+		{
+			key = TFE_Hash::fnv1a64(&TFE_DarkForces::s_levelColorMap[16 << 8], 256, key);
+			key = TFE_Hash::fnv1a64(&TFE_DarkForces::s_levelColorMap[31 << 8], 256, key);
+		}
+		key = TFE_Hash::fnv1a64Value(count, key);
+		for (s32 i = 0; i < count; i++)
+		{
+			key = TFE_Hash::fnv1a64Value(s_packJobs[i].hash, key);
+		}
+		return key;
+	}
+
+	void atlasCache_getPath(u64 key, char* path)
+	{
+		sprintf(path, "%sAtlasCache/%016llx.tac", TFE_Paths::getPath(PATH_PROGRAM_DATA), (unsigned long long)key);
+	}
+
+	size_t atlasCache_getDataSize(std::vector<size_t>& offsets)
+	{
+		const s32 count = (s32)s_packJobs.size();
+		offsets.resize(count);
+
+		size_t dataSize = 0;
+		for (s32 i = 0; i < count; i++)
+		{
+			offsets[i] = dataSize;
+			dataSize += packJob_getDataSize(&s_packJobs[i]);
+		}
+		return dataSize;
+	}
+
+	// Returns true if the texels were loaded from the cache.
+	bool atlasCache_load(u64 key)
+	{
+		char cachePath[TFE_MAX_PATH];
+		atlasCache_getPath(key, cachePath);
+		if (!FileUtil::exists(cachePath)) { return false; }
+
+		u8* data = nullptr;
+		const u32 size = FileStream::readContents(cachePath, (void**)&data);
+		if (!data) { return false; }
+
+		std::vector<size_t> offsets;
+		const size_t dataSize = atlasCache_getDataSize(offsets);
+		const s32 count = (s32)s_packJobs.size();
+		const size_t tintSize = sizeof(Vec3f) * count;
+
+		const AtlasCacheHeader* header = (const AtlasCacheHeader*)data;
+		const bool valid = size >= sizeof(AtlasCacheHeader) && header->magic == ATLAS_CACHE_MAGIC && header->version == ATLAS_CACHE_VERSION &&
+			header->key == key && header->jobCount == (u32)count && header->bytesPerTexel == s_texturePacker->bytesPerTexel &&
+			header->dataSize == dataSize && size == sizeof(AtlasCacheHeader) + tintSize + dataSize;
+		if (valid)
+		{
+			const Vec3f* tints = (const Vec3f*)(data + sizeof(AtlasCacheHeader));
+			u8* texels = data + sizeof(AtlasCacheHeader) + tintSize;
+			TFE_System::parallelFor(count, [&](s32 i)
+			{
+				s_packJobs[i].halfTint = tints[i];
+				packJob_copyData(&s_packJobs[i], texels + offsets[i], true);
+			});
+		}
+		else
+		{
+			TFE_System::logWrite(LOG_WARNING, "TexturePacker", "Atlas cache '%s' does not match, rebuilding.", cachePath);
+		}
+		free(data);
+		return valid;
+	}
+
+	// Remove the oldest cache files once there are too many, such as the packs of levels or mods that changed.
+	void atlasCache_prune(const char* cacheDir)
+	{
+		FileList fileList;
+		FileUtil::readDirectory(cacheDir, "tac", fileList);
+		if (fileList.size() <= ATLAS_CACHE_MAX_FILES) { return; }
+
+		std::vector<std::pair<u64, std::string>> files;
+		for (size_t i = 0; i < fileList.size(); i++)
+		{
+			char path[TFE_MAX_PATH];
+			sprintf(path, "%s%s", cacheDir, fileList[i].c_str());
+			files.push_back({ FileUtil::getModifiedTime(path), path });
+		}
+		std::sort(files.begin(), files.end());
+
+		const size_t removeCount = files.size() - ATLAS_CACHE_MAX_FILES;
+		for (size_t i = 0; i < removeCount; i++)
+		{
+			FileUtil::deleteFile(files[i].second.c_str());
+		}
+		TFE_System::logWrite(LOG_MSG, "TexturePacker", "Removed %u old atlas cache files.", u32(removeCount));
+	}
+
+	void atlasCache_save(u64 key)
+	{
+		char cacheDir[TFE_MAX_PATH];
+		sprintf(cacheDir, "%sAtlasCache/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		if (!FileUtil::directoryExits(cacheDir))
+		{
+			FileUtil::makeDirectory(cacheDir);
+		}
+
+		std::vector<size_t> offsets;
+		const s32 count = (s32)s_packJobs.size();
+		AtlasCacheHeader header = {};
+		header.magic = ATLAS_CACHE_MAGIC;
+		header.version = ATLAS_CACHE_VERSION;
+		header.key = key;
+		header.jobCount = (u32)count;
+		header.bytesPerTexel = s_texturePacker->bytesPerTexel;
+		header.dataSize = atlasCache_getDataSize(offsets);
+
+		char cachePath[TFE_MAX_PATH];
+		atlasCache_getPath(key, cachePath);
+		FileStream file;
+		if (!file.open(cachePath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "TexturePacker", "Cannot write atlas cache '%s'.", cachePath);
+			return;
+		}
+		file.writeBuffer(&header, sizeof(AtlasCacheHeader));
+		for (s32 i = 0; i < count; i++)
+		{
+			file.writeBuffer(&s_packJobs[i].halfTint, sizeof(Vec3f));
+		}
+
+		std::vector<u8> buffer;
+		for (s32 i = 0; i < count; i++)
+		{
+			buffer.resize(packJob_getDataSize(&s_packJobs[i]));
+			packJob_copyData(&s_packJobs[i], buffer.data(), false);
+			file.writeBuffer(buffer.data(), (u32)buffer.size());
+		}
+		file.close();
+
+		atlasCache_prune(cacheDir);
+	}
+
+	// Copy the texels of all of the textures placed by the last pack into the pages.
+	void texturepacker_runJobs()
+	{
+		const s32 count = (s32)s_packJobs.size();
+		if (!count) { return; }
+		const u64 startTime = TFE_System::getCurrentTimeInTicks();
+
+		// 8-bit textures are a straight copy, so only true color packs are cached.
+		const bool useCache = s_texturePacker->trueColor;
+		const u64 key = useCache ? atlasCache_computeKey() : 0;
+		const bool cached = useCache && atlasCache_load(key);
+		if (!cached)
+		{
+			TFE_System::parallelFor(count, [](s32 i) { packJob_run(&s_packJobs[i]); });
+			if (useCache)
+			{
+				atlasCache_save(key);
+			}
+		}
+
+		for (s32 i = 0; i < count; i++)
+		{
+			packJob_writeTableEntry(&s_packJobs[i]);
+		}
+		s_packJobs.clear();
+
+		const f64 packTime = TFE_System::convertFromTicksToMillis(TFE_System::getCurrentTimeInTicks() - startTime);
+		TFE_System::logWrite(LOG_MSG, "TexturePacker", "Packed %d textures into '%s' in %0.2f ms%s.", count, s_texturePacker->name, packTime, cached ? " (cached)" : "");
 	}
 
 	bool isTextureInMap(TextureData* tex)
@@ -1061,7 +1387,26 @@ namespace TFE_Jedi
 
 		assert(node->tex == tex && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
 		tex->textureId = s_texturePacker->texturesPacked;
-		packNode(node, tex, &s_texturePacker->textureTable[s_texturePacker->texturesPacked], paddingX, paddingY, (tex->flags & ENABLE_MIP_MAPS) ? s_texturePacker->mipCount : 1, packHdTextures ? baseFrame : nullptr, frameIndex);
+
+		const TextureData* hdSrc = packHdTextures && baseFrame->hdAssetData ? baseFrame : nullptr;
+		PackJob job = {};
+		job.type = PACKJOB_TEXTURE;
+		job.x = node->rect.x;
+		job.y = node->rect.y;
+		job.page = s_currentPage;
+		job.tableIndex = s_texturePacker->texturesPacked;
+		job.paddingX = paddingX;
+		job.paddingY = paddingY;
+		job.mipCount = (tex->flags & ENABLE_MIP_MAPS) ? s_texturePacker->mipCount : 1;
+		job.scaleFactor = hdSrc ? hdSrc->scaleFactor : 1;
+		job.width  = tex->width  * job.scaleFactor;
+		job.height = tex->height * job.scaleFactor;
+		job.texData = tex;
+		job.hdSrc = hdSrc;
+		job.frameIndex = frameIndex;
+		s_packJobs.push_back(job);
+
+		s_usedTexels += tex->width * tex->height;
 		s_texturePacker->texturesPacked++;
 		return true;
 	}
@@ -1081,7 +1426,23 @@ namespace TFE_Jedi
 
 		assert(node->tex == tex && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
 		tex->textureId = s_texturePacker->texturesPacked;
-		packNodeDeltaTex(node, tex, &s_texturePacker->textureTable[s_texturePacker->texturesPacked], padding, padding);
+
+		PackJob job = {};
+		job.type = PACKJOB_DELT;
+		job.x = node->rect.x;
+		job.y = node->rect.y;
+		job.page = s_currentPage;
+		job.tableIndex = s_texturePacker->texturesPacked;
+		job.paddingX = padding;
+		job.paddingY = padding;
+		job.mipCount = 1;
+		job.width = tex->width;
+		job.height = tex->height;
+		job.scaleFactor = 1;
+		job.texData = tex;
+		s_packJobs.push_back(job);
+
+		s_usedTexels += tex->width * tex->height;
 		s_texturePacker->texturesPacked++;
 		return true;
 	}
@@ -1109,7 +1470,25 @@ namespace TFE_Jedi
 
 		assert(node->tex == cell && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
 		cell->textureId = s_texturePacker->texturesPacked;
-		packNodeCell(node, basePtr, cell, hdWax, &s_texturePacker->textureTable[s_texturePacker->texturesPacked], padding, padding);
+
+		PackJob job = {};
+		job.type = PACKJOB_WAX_CELL;
+		job.x = node->rect.x;
+		job.y = node->rect.y;
+		job.page = s_currentPage;
+		job.tableIndex = s_texturePacker->texturesPacked;
+		job.paddingX = padding;
+		job.paddingY = padding;
+		job.mipCount = 1;
+		job.width = w;
+		job.height = h;
+		job.scaleFactor = scale;
+		job.basePtr = basePtr;
+		job.cell = cell;
+		job.hdWax = hdWax;
+		s_packJobs.push_back(job);
+
+		s_usedTexels += w * h;
 		s_texturePacker->texturesPacked++;
 		return true;
 	}
@@ -1268,6 +1647,7 @@ namespace TFE_Jedi
 
 		// Get textures.
 		s_texInfoPool.clear();
+		s_packJobs.clear();
 		if (getList(s_texInfoPool, pool))
 		{
 			s32 count = (s32)s_texInfoPool.size();
@@ -1435,6 +1815,9 @@ namespace TFE_Jedi
 					}
 				}
 			}
+
+			// 5. Copy the textures into the pages.
+			texturepacker_runJobs();
 		}
 		return s_texturePacker->texturesPacked;
 	}
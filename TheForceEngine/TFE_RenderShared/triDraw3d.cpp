@@ -5,6 +5,7 @@
 #include <TFE_System/system.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <assert.h>
+#include <string.h>
 #include <vector>
 
 #define TRI3D_MAX_DRAW_COUNT 65536
@@ -34,6 +35,16 @@ namespace TFE_RenderShared
 		s32 vtxCount;
 		s32 idxCount;
 	};
+	// Vertices and indices are kept on the CPU as well so the mesh can be compared against freshly built geometry.
+	struct Tri3dMesh
+	{
+		std::vector<Tri3dVertex> vertices;
+		std::vector<s32> indices;
+		std::vector<Tri3dDraw> draws[TRIMODE_COUNT];
+		VertexBuffer vertexBuffer;
+		IndexBuffer indexBuffer;
+		bool gpuValid = false;
+	};
 	static const AttributeMapping c_tri3dAttrMapping[]=
 	{
 		{ATTR_POS,   ATYPE_FLOAT, 3, 0, false},
@@ -73,6 +84,13 @@ namespace TFE_RenderShared
 	static DrawMode s_lastDrawMode = TRIMODE_COUNT;
 	static Grid s_gridDef = {};
 
+	// Mesh capture, the geometry is appended to the frame buffers and then moved out.
+	static bool s_meshCapture = false;
+	static u32 s_meshVtxStart;
+	static u32 s_meshIdxStart;
+	static u32 s_meshDrawStart[TRIMODE_COUNT];
+	static std::vector<Tri3dMesh*> s_meshQueue;
+
 	bool canMergeDraws(DrawMode mode, TextureGpu* texture, u32 drawFlags = TFLAG_NONE);
 	u32 setDrawFlags(bool showGrid, bool sky);
 
@@ -164,6 +182,8 @@ namespace TFE_RenderShared
 		{
 			s_triDrawCount[i] = 0;
 		}
+		s_meshCapture = false;
+		s_meshQueue.clear();
 	}
 		
 	bool triDraw3d_expand(DrawMode pass)
@@ -508,21 +528,25 @@ namespace TFE_RenderShared
 		outVert[0].pos = { corners[0].x, corners[0].y, corners[0].z };
 		outVert[0].uv = { 0.0f, 0.0f };
 		outVert[0].uv1 = { (dx >= dz) ? gridCorners[0].x : gridCorners[0].z, gridCorners[0].y };
+		outVert[0].uv2 = { 0.0f, 0.0f };
 		outVert[0].color = color;
 
 		outVert[1].pos = { corners[1].x, corners[0].y, corners[1].z };
 		outVert[1].uv = { 1.0f, 0.0f };
 		outVert[1].uv1 = { (dx >= dz) ? gridCorners[1].x : gridCorners[1].z, gridCorners[0].y };
+		outVert[1].uv2 = { 0.0f, 0.0f };
 		outVert[1].color = color;
 
 		outVert[2].pos = { corners[1].x, corners[1].y, corners[1].z };
 		outVert[2].uv = { 1.0f, 1.0f };
 		outVert[2].uv1 = { (dx >= dz) ? gridCorners[1].x : gridCorners[1].z, gridCorners[1].y };
+		outVert[2].uv2 = { 0.0f, 0.0f };
 		outVert[2].color = color;
 
 		outVert[3].pos = { corners[0].x, corners[1].y, corners[0].z };
 		outVert[3].uv = { 0.0f, 1.0f };
 		outVert[3].uv1 = { (dx >= dz) ? gridCorners[0].x : gridCorners[0].z, gridCorners[1].y };
+		outVert[3].uv2 = { 0.0f, 0.0f };
 		outVert[3].color = color;
 
 		outIdx[0] = vtxOffset + 0;
@@ -594,21 +618,25 @@ namespace TFE_RenderShared
 		outVert[0].pos = vtx[0];
 		outVert[0].uv = { 0.0f, 0.0f };
 		outVert[0].uv1 = { (dx >= dz) ? gridCorners[0].x : gridCorners[0].z, gridCorners[0].y };
+		outVert[0].uv2 = { 0.0f, 0.0f };
 		outVert[0].color = color;
 
 		outVert[1].pos = vtx[1];
 		outVert[1].uv = { 1.0f, 0.0f };
 		outVert[1].uv1 = { (dx >= dz) ? gridCorners[1].x : gridCorners[1].z, gridCorners[1].y };
+		outVert[1].uv2 = { 0.0f, 0.0f };
 		outVert[1].color = color;
 
 		outVert[2].pos = vtx[2];
 		outVert[2].uv = { 1.0f, 1.0f };
 		outVert[2].uv1 = { (dx >= dz) ? gridCorners[2].x : gridCorners[2].z, gridCorners[2].y };
+		outVert[2].uv2 = { 0.0f, 0.0f };
 		outVert[2].color = color;
 
 		outVert[3].pos = vtx[3];
 		outVert[3].uv = { 0.0f, 1.0f };
 		outVert[3].uv1 = { (dx >= dz) ? gridCorners[3].x : gridCorners[3].z, gridCorners[3].y };
+		outVert[3].uv2 = { 0.0f, 0.0f };
 		outVert[3].color = color;
 
 		outIdx[0] = vtxOffset + 0;
@@ -674,6 +702,7 @@ namespace TFE_RenderShared
 			outVert[v].pos = vertices[v];
 			outVert[v].uv = { 0.5f, 0.5f };
 			outVert[v].uv1 = posToGrid(s_gridDef, posXZ);
+			outVert[v].uv2 = { 0.0f, 0.0f };
 			outVert[v].color = color;
 		}
 
@@ -697,12 +726,177 @@ namespace TFE_RenderShared
 		s_idxCount += idxCount;
 	}
 
+	Tri3dMesh* triDraw3d_createMesh()
+	{
+		return new Tri3dMesh();
+	}
+
+	void triDraw3d_destroyMesh(Tri3dMesh* mesh)
+	{
+		if (!mesh) { return; }
+		mesh->vertexBuffer.destroy();
+		mesh->indexBuffer.destroy();
+		delete mesh;
+	}
+
+	void triDraw3d_beginMesh()
+	{
+		assert(!s_meshCapture);
+		s_meshCapture = true;
+		s_meshVtxStart = s_vtxCount;
+		s_meshIdxStart = s_idxCount;
+		for (s32 i = 0; i < TRIMODE_COUNT; i++)
+		{
+			s_meshDrawStart[i] = s_triDrawCount[i];
+		}
+		// Mesh draws must not be merged into the existing frame draws.
+		s_lastDrawMode = TRIMODE_COUNT;
+	}
+
+	// Removes the captured geometry from the frame buffers.
+	void triDraw3d_endCapture()
+	{
+		s_vtxCount = s_meshVtxStart;
+		s_idxCount = s_meshIdxStart;
+		for (s32 i = 0; i < TRIMODE_COUNT; i++)
+		{
+			s_triDrawCount[i] = s_meshDrawStart[i];
+		}
+		s_lastDrawMode = TRIMODE_COUNT;
+		s_meshCapture = false;
+	}
+
+	bool triDraw3d_endMesh(Tri3dMesh* mesh)
+	{
+		if (!s_meshCapture) { return false; }
+		const u32 vtxCount = s_vtxCount - s_meshVtxStart;
+		const u32 idxCount = s_idxCount - s_meshIdxStart;
+
+		// Copy the geometry with offsets relative to the start of the mesh.
+		mesh->vertices.assign(s_vertices + s_meshVtxStart, s_vertices + s_vtxCount);
+		mesh->indices.resize(idxCount);
+		for (u32 i = 0; i < idxCount; i++)
+		{
+			mesh->indices[i] = s_indices[s_meshIdxStart + i] - s32(s_meshVtxStart);
+		}
+		for (s32 i = 0; i < TRIMODE_COUNT; i++)
+		{
+			mesh->draws[i].assign(s_triDraw[i] + s_meshDrawStart[i], s_triDraw[i] + s_triDrawCount[i]);
+			for (size_t d = 0; d < mesh->draws[i].size(); d++)
+			{
+				mesh->draws[i][d].vtxOffset -= s32(s_meshVtxStart);
+				mesh->draws[i][d].idxOffset -= s32(s_meshIdxStart);
+			}
+		}
+		triDraw3d_endCapture();
+
+		// Upload.
+		mesh->gpuValid = false;
+		if (vtxCount < 1 || idxCount < 1) { return true; }
+		if (!mesh->vertexBuffer.getHandle())
+		{
+			if (!mesh->vertexBuffer.create(vtxCount, sizeof(Tri3dVertex), c_tri3dAttrCount, c_tri3dAttrMapping, false, mesh->vertices.data()) ||
+				!mesh->indexBuffer.create(idxCount, sizeof(u32), false, mesh->indices.data()))
+			{
+				mesh->vertexBuffer.destroy();
+				mesh->indexBuffer.destroy();
+				return false;
+			}
+		}
+		else
+		{
+			mesh->vertexBuffer.update(mesh->vertices.data(), vtxCount * sizeof(Tri3dVertex));
+			mesh->indexBuffer.update(mesh->indices.data(), idxCount * sizeof(s32));
+		}
+		mesh->gpuValid = true;
+		return true;
+	}
+
+	bool triDraw3d_endMeshCompare(const Tri3dMesh* mesh)
+	{
+		if (!s_meshCapture) { return false; }
+		const u32 vtxCount = s_vtxCount - s_meshVtxStart;
+		const u32 idxCount = s_idxCount - s_meshIdxStart;
+
+		bool equal = vtxCount == (u32)mesh->vertices.size() && idxCount == (u32)mesh->indices.size();
+		if (equal && vtxCount)
+		{
+			equal = memcmp(mesh->vertices.data(), s_vertices + s_meshVtxStart, sizeof(Tri3dVertex) * vtxCount) == 0;
+		}
+		for (u32 i = 0; i < idxCount && equal; i++)
+		{
+			equal = mesh->indices[i] == s_indices[s_meshIdxStart + i] - s32(s_meshVtxStart);
+		}
+		for (s32 i = 0; i < TRIMODE_COUNT && equal; i++)
+		{
+			const u32 drawCount = s_triDrawCount[i] - s_meshDrawStart[i];
+			equal = drawCount == (u32)mesh->draws[i].size();
+			for (u32 d = 0; d < drawCount && equal; d++)
+			{
+				const Tri3dDraw& a = mesh->draws[i][d];
+				const Tri3dDraw& b = s_triDraw[i][s_meshDrawStart[i] + d];
+				equal = a.texture == b.texture && a.mode == b.mode && a.drawFlags == b.drawFlags &&
+					a.vtxOffset == b.vtxOffset - s32(s_meshVtxStart) && a.idxOffset == b.idxOffset - s32(s_meshIdxStart) &&
+					a.vtxCount == b.vtxCount && a.idxCount == b.idxCount;
+			}
+		}
+		triDraw3d_endCapture();
+		return equal;
+	}
+
+	void triDraw3d_addMesh(Tri3dMesh* mesh)
+	{
+		if (mesh && mesh->gpuValid)
+		{
+			s_meshQueue.push_back(mesh);
+		}
+	}
+
+	void triDraw3d_drawList(s32 mode, const Tri3dDraw* draws, u32 drawCount, f32* skyParam1, const f32* gridScaleOpacity)
+	{
+		const f32 gridScaleOpacityNone[] = { 0.0f, 0.0f };
+		s32 isTexPrev = -1;
+		bool prevGrid = true;
+		for (u32 t = 0; t < drawCount; t++)
+		{
+			const Tri3dDraw* draw = &draws[t];
+			s32 isTexturedSky[] = { draw->texture ? 1 : 0, (draw->drawFlags & TFLAG_SKY) ? 1 : 0 };
+			bool showGrid = !(draw->drawFlags & TFLAG_NO_GRID);
+			if (isTexturedSky[1])
+			{
+				skyParam1[2] = 1.0f / f32(draw->texture->getWidth());
+				skyParam1[3] = 1.0f / f32(draw->texture->getHeight());
+				s_shader[mode].setVariable(s_shaderState[mode].skyParam1Id, SVT_VEC4, skyParam1);
+			}
+			s_shader[mode].setVariable(s_shaderState[mode].svIsTextured, SVT_IVEC2, isTexturedSky);
+			if (isTexturedSky[0])
+			{
+				draw->texture->bind(0);
+				if (isTexPrev != isTexturedSky[0])
+				{
+					s_shader[mode].setVariable(s_shaderState[mode].svGridScaleOpacity, SVT_VEC2, showGrid ? gridScaleOpacity : gridScaleOpacityNone);
+				}
+			}
+			else if (isTexPrev != isTexturedSky[0] || prevGrid != showGrid)
+			{
+				s_shader[mode].setVariable(s_shaderState[mode].svGridScaleOpacity, SVT_VEC2, showGrid ? gridScaleOpacity : gridScaleOpacityNone);
+			}
+			isTexPrev = isTexturedSky[0];
+			prevGrid = showGrid;
+
+			TFE_RenderBackend::drawIndexedTriangles(draw->idxCount / 3, sizeof(u32), draw->idxOffset);
+		}
+	}
+
 	void triDraw3d_draw(const Camera3d* camera, f32 width, f32 height, f32 gridScale, f32 gridOpacity, bool depthTest, bool culling)
 	{
-		if (s_vtxCount < 1 || s_idxCount < 1) { return; }
+		if ((s_vtxCount < 1 || s_idxCount < 1) && s_meshQueue.empty()) { return; }
 
-		s_vertexBuffer.update(s_vertices, s_vtxCount * sizeof(Tri3dVertex));
-		s_indexBuffer.update(s_indices, s_idxCount * sizeof(s32));
+		if (s_vtxCount > 0 && s_idxCount > 0)
+		{
+			s_vertexBuffer.update(s_vertices, s_vtxCount * sizeof(Tri3dVertex));
+			s_indexBuffer.update(s_indices, s_idxCount * sizeof(s32));
+		}
 
 		TFE_RenderState::setStateEnable(culling, STATE_CULLING);
 		TFE_RenderState::setStateEnable(depthTest, STATE_DEPTH_TEST | STATE_DEPTH_WRITE);
@@ -741,11 +935,18 @@ namespace TFE_RenderShared
 		    nearPlaneHalfLen * 2.0f / width,
 			1.0f, 1.0f
 		};
+		const f32 gridScaleOpacity[] = { gridScale, gridOpacity };
 
+		const size_t meshCount = s_meshQueue.size();
 		bool blendEnable[] = { false, true };
 		for (s32 i = 0; i < TRIMODE_COUNT; i++)
 		{
-			if (s_triDrawCount[i] < 1) { continue; }
+			bool hasMeshDraws = false;
+			for (size_t m = 0; m < meshCount && !hasMeshDraws; m++)
+			{
+				hasMeshDraws = !s_meshQueue[m]->draws[i].empty();
+			}
+			if (s_triDrawCount[i] < 1 && !hasMeshDraws) { continue; }
 
 			s_shader[i].bind();
 			// Bind Uniforms & Textures.
@@ -753,48 +954,27 @@ namespace TFE_RenderShared
 			s_shader[i].setVariable(s_shaderState[i].svCameraView, SVT_MAT3x3, camera->viewMtx.data);
 			s_shader[i].setVariable(s_shaderState[i].svCameraProj, SVT_MAT4x4, camera->projMtx.data);
 
-			f32 gridScaleOpacityNone[] = { 0.0f, 0.0f };
-			f32 gridScaleOpacity[] = { gridScale, gridOpacity };
-			f32 gridScaleOpacityTex[] = { gridScale, gridOpacity };
-
-			// Bind vertex/index buffers and setup attributes for BlitVert
-			s_vertexBuffer.bind();
-			s_indexBuffer.bind();
-
 			TFE_RenderState::setStateEnable(blendEnable[i], STATE_BLEND);
 			s_shader[i].setVariable(s_shaderState[i].skyParam0Id, SVT_VEC4, skyParam0);
-			
-			// Draw.
-			s32 isTexPrev = -1;
-			bool prevGrid = true;
-			for (u32 t = 0; t < s_triDrawCount[i]; t++)
+
+			// Draw the frame geometry.
+			if (s_triDrawCount[i] > 0)
 			{
-				Tri3dDraw* draw = &s_triDraw[i][t];
-				s32 isTexturedSky[] = { draw->texture ? 1 : 0, (draw->drawFlags & TFLAG_SKY) ? 1 : 0 };
-				bool showGrid = !(draw->drawFlags & TFLAG_NO_GRID);
-				if (isTexturedSky[1])
-				{
-					skyParam1[2] = 1.0f / f32(draw->texture->getWidth());
-					skyParam1[3] = 1.0f / f32(draw->texture->getHeight());
-					s_shader[i].setVariable(s_shaderState[i].skyParam1Id, SVT_VEC4, skyParam1);
-				}
-				s_shader[i].setVariable(s_shaderState[i].svIsTextured, SVT_IVEC2, isTexturedSky);
-				if (isTexturedSky[0])
-				{
-					draw->texture->bind(0);
-					if (isTexPrev != isTexturedSky[0])
-					{
-						s_shader[i].setVariable(s_shaderState[i].svGridScaleOpacity, SVT_VEC2, showGrid ? gridScaleOpacityTex : gridScaleOpacityNone);
-					}
-				}
-				else if (isTexPrev != isTexturedSky[0] || prevGrid != showGrid)
-				{
-					s_shader[i].setVariable(s_shaderState[i].svGridScaleOpacity, SVT_VEC2, showGrid ? gridScaleOpacity : gridScaleOpacityNone);
-				}
-				isTexPrev = isTexturedSky[0];
-				prevGrid = showGrid;
+				// Bind vertex/index buffers and setup attributes for BlitVert
+				s_vertexBuffer.bind();
+				s_indexBuffer.bind();
+				triDraw3d_drawList(i, s_triDraw[i], s_triDrawCount[i], skyParam1, gridScaleOpacity);
+			}
+
+			// Then the retained meshes, each from its own buffers.
+			for (size_t m = 0; m < meshCount; m++)
+			{
+				const Tri3dMesh* mesh = s_meshQueue[m];
+				if (mesh->draws[i].empty()) { continue; }
 
-				TFE_RenderBackend::drawIndexedTriangles(draw->idxCount / 3, sizeof(u32), draw->idxOffset);
+				mesh->vertexBuffer.bind();
+				mesh->indexBuffer.bind();
+				triDraw3d_drawList(i, mesh->draws[i].data(), (u32)mesh->draws[i].size(), skyParam1, gridScaleOpacity);
 			}
 		}
 
@@ -809,6 +989,7 @@ namespace TFE_RenderShared
 		{
 			s_triDrawCount[i] = 0;
 		}
+		s_meshQueue.clear();
 	}
 
 	u32 setDrawFlags(bool showGrid, bool sky)
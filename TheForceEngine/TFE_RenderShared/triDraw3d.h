@@ -37,5 +37,18 @@ namespace TFE_RenderShared
 	void triDraw3d_addDeformedQuadTextured(DrawMode pass, Vec3f* vtx, const Vec2f* uvVtx, const u32 color, TextureGpu* texture, bool sky = false);
 	void triDraw3d_addTextured(DrawMode pass, u32 idxCount, u32 vtxCount, const Vec3f* vertices, const Vec2f* uv, const s32* indices, const u32 color, bool invSide, TextureGpu* texture, bool showGrid = true, bool sky = false);
 
+	// Retained meshes.
+	// Geometry added between triDraw3d_beginMesh() and triDraw3d_endMesh() is moved into GPU buffers owned by the mesh
+	// instead of being drawn this frame. The mesh is then queued with triDraw3d_addMesh() each frame until rebuilt.
+	// Backfaces are left to GPU culling, so mesh geometry should be added regardless of the camera.
+	struct Tri3dMesh;
+	Tri3dMesh* triDraw3d_createMesh();
+	void triDraw3d_destroyMesh(Tri3dMesh* mesh);
+	void triDraw3d_beginMesh();
+	bool triDraw3d_endMesh(Tri3dMesh* mesh);
+	// Compares the geometry added since triDraw3d_beginMesh() with the retained mesh and then discards it.
+	bool triDraw3d_endMeshCompare(const Tri3dMesh* mesh);
+	void triDraw3d_addMesh(Tri3dMesh* mesh);
+
 	void triDraw3d_draw(const Camera3d* camera, f32 width, f32 height, f32 gridScale, f32 gridOpacity, bool depthTest = true, bool culling = true);
 }
@@ -451,6 +451,8 @@ namespace TFE_Settings
 		writeKeyValue_Float(settings, "anisotropyQuality", s_graphicsSettings.anisotropyQuality);
 
 		writeKeyValue_Int(settings, "frameRateLimit", s_graphicsSettings.frameRateLimit);
+		writeKeyValue_Bool(settings, "precisePacing", s_graphicsSettings.precisePacing);
+		writeKeyValue_Bool(settings, "pipelinedFrames", s_graphicsSettings.pipelinedFrames);
 		writeKeyValue_Float(settings, "brightness", s_graphicsSettings.brightness);
 		writeKeyValue_Float(settings, "contrast", s_graphicsSettings.contrast);
 		writeKeyValue_Float(settings, "saturation", s_graphicsSettings.saturation);
@@ -504,6 +506,7 @@ namespace TFE_Settings
 		writeKeyValue_Int(settings, "audioDevice", s_soundSettings.audioDevice);
 		writeKeyValue_Int(settings, "midiOutput", s_soundSettings.midiOutput);
 		writeKeyValue_Int(settings, "midiType", s_soundSettings.midiType);
+		writeKeyValue_Int(settings, "midiRenderAheadMs", s_soundSettings.midiRenderAheadMs);
 		writeKeyValue_Bool(settings, "use16Channels", s_soundSettings.use16Channels);
 		writeKeyValue_Bool(settings, "disableSoundInMenus", s_soundSettings.disableSoundInMenus);
 	}
@@ -571,11 +574,15 @@ namespace TFE_Settings
 		writeKeyValue_Bool(settings, "df_showReplayCounter", s_gameSettings.df_showReplayCounter);
 		writeKeyValue_Int(settings,  "df_recordFrameRate", s_gameSettings.df_recordFrameRate);
 		writeKeyValue_Int(settings,  "df_playbackFrameRate", s_gameSettings.df_playbackFrameRate);
+		writeKeyValue_Int(settings,  "df_demoKeyframeInterval", s_gameSettings.df_demoKeyframeInterval);
 		writeKeyValue_Bool(settings, "df_enableRecording", s_gameSettings.df_enableRecording);
 		writeKeyValue_Bool(settings, "df_enableRecordingAll", s_gameSettings.df_enableRecordingAll);
 		writeKeyValue_Bool(settings, "df_demologging", s_gameSettings.df_demologging);
 		writeKeyValue_Bool(settings, "df_autoNextMission", s_gameSettings.df_autoEndMission);
 		writeKeyValue_Bool(settings, "df_showKeyColors", s_gameSettings.df_showKeyColors);
+		writeKeyValue_Bool(settings, "df_enableRewind", s_gameSettings.df_enableRewind);
+		writeKeyValue_Int(settings,  "df_rewindInterval", s_gameSettings.df_rewindInterval);
+		writeKeyValue_Int(settings,  "df_rewindBudgetMB", s_gameSettings.df_rewindBudgetMB);
 	}
 
 	void writePerGameSettings(FileStream& settings)
@@ -829,6 +836,14 @@ namespace TFE_Settings
 		{
 			s_graphicsSettings.frameRateLimit = parseInt(value);
 		}
+		else if (strcasecmp("precisePacing", key) == 0)
+		{
+			s_graphicsSettings.precisePacing = parseBool(value);
+		}
+		else if (strcasecmp("pipelinedFrames", key) == 0)
+		{
+			s_graphicsSettings.pipelinedFrames = parseBool(value);
+		}
 		else if (strcasecmp("brightness", key) == 0)
 		{
 			s_graphicsSettings.brightness = parseFloat(value);
@@ -995,6 +1010,10 @@ namespace TFE_Settings
 		{
 			s_soundSettings.midiType = parseInt(value);
 		}
+		else if (strcasecmp("midiRenderAheadMs", key) == 0)
+		{
+			s_soundSettings.midiRenderAheadMs = parseInt(value);
+		}
 		else if (strcasecmp("use16Channels", key) == 0)
 		{
 			s_soundSettings.use16Channels = parseBool(value);
@@ -1221,6 +1240,10 @@ namespace TFE_Settings
 		{
 			s_gameSettings.df_playbackFrameRate = parseInt(value);
 		}
+		else if (strcasecmp("df_demoKeyframeInterval", key) == 0)
+		{
+			s_gameSettings.df_demoKeyframeInterval = parseInt(value);
+		}
 		else if (strcasecmp("df_enableRecording", key) == 0)
 		{
 			s_gameSettings.df_enableRecording = parseBool(value);
@@ -1241,6 +1264,18 @@ namespace TFE_Settings
 		{
 			s_gameSettings.df_showKeyColors = parseBool(value);
 		}
+		else if (strcasecmp("df_enableRewind", key) == 0)
+		{
+			s_gameSettings.df_enableRewind = parseBool(value);
+		}
+		else if (strcasecmp("df_rewindInterval", key) == 0)
+		{
+			s_gameSettings.df_rewindInterval = parseInt(value);
+		}
+		else if (strcasecmp("df_rewindBudgetMB", key) == 0)
+		{
+			s_gameSettings.df_rewindBudgetMB = parseInt(value);
+		}
 	}
 
 	void parseOutlawsSettings(const char* key, const char* value)
@@ -43,6 +43,11 @@ struct TFE_Settings_Temp
 	bool forceFullscreen = false;
 	bool df_demologging = false;
 	bool exit_after_replay = false;
+	bool forcePipelinedFrames = false;
+	f32  demoSeekTest = 0.0f;	// Demo time in seconds where playback seeks back once, for testing.
+	bool verifySnapshots = false;	// Compare in-place snapshot restores against the serialized game state, for testing.
+	s32  verifyTraversalFrames = 0;	// Frames where the GPU renderer checks its traversal cache, for testing.
+	f32  verifyOpl3Seconds = 0.0f;	// Seconds of the OPL3 benchmark script rendered and compared at startup, for testing.
 };
 
 struct TFE_Settings_Window
@@ -73,6 +78,8 @@ struct TFE_Settings_Graphics
 	bool  overrideLighting = false;
 	bool  useSmoothDeltaTime = true;
 	s32   frameRateLimit = 240;
+	bool  precisePacing = false;
+	bool  pipelinedFrames = false;
 	f32   brightness = 1.0f;
 	f32   contrast = 1.0f;
 	f32   saturation = 1.0f;
@@ -187,6 +194,7 @@ struct TFE_Settings_Sound
 	s32 audioDevice = -1;			// Use the audio device default.
 	s32 midiOutput  = -1;			// Use the midi type default.
 	s32 midiType = MIDI_TYPE_DEFAULT;
+	s32 midiRenderAheadMs = 50;		// How far ahead synthesized midi is rendered.
 	bool use16Channels = false;
 	bool disableSoundInMenus = false;
 };
@@ -229,8 +237,12 @@ struct TFE_Settings_Game
 	bool df_demologging = false;        // Log the record/playback logging
 	bool df_autoEndMission = false;     // Automatically skip to the next mission
 	bool df_showKeyColors = false;      // Shows the door key color on the minimap
+	bool df_enableRewind = false;       // Keep in-memory snapshots of the game so it can be rewound.
+	s32  df_rewindInterval = 2;         // Seconds between rewind snapshots.
+	s32  df_rewindBudgetMB = 64;        // Memory budget for rewind snapshots, in megabytes.
 	s32  df_recordFrameRate = 4;        // Recording Framerate value
 	s32  df_playbackFrameRate = 2;      // Playback Framerate value
+	s32  df_demoKeyframeInterval = 60;  // Seconds between game state keyframes stored in demos, 0 = none.
 	PitchLimit df_pitchLimit  = PITCH_VANILLA_PLUS;
 };
 
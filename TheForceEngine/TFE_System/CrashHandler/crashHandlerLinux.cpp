@@ -58,6 +58,8 @@ static void tfe_sigaction(int signo, siginfo_t *siginfo, void *uctx)
 		return;
 	}
 
+	// The interrupted thread may hold the log locks.
+	TFE_System::logEnterSignalMode();
 	TFE_System::logWrite(LOG_ERROR, "CrashHandler", "Received Signal %d errno %d code %d", signo, siginfo->si_addr, siginfo->si_errno, siginfo->si_code);
 
 	switch (signo) {
@@ -81,6 +83,8 @@ static void tfe_sigaction(int signo, siginfo_t *siginfo, void *uctx)
 		TFE_System::logWrite(LOG_ERROR, "CrashHandler", "no backtrace possible");
 	}
 
+	TFE_System::logFlush();
+
 	// for certain signals, the default handler will create
 	// a coredump if enabled by administrator.
 	signal(signo, SIG_DFL);
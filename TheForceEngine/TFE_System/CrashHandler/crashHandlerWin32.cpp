@@ -174,6 +174,9 @@ void getExceptionPointers(u32 dwExceptionCode, EXCEPTION_POINTERS** ppExceptionP
 // This method creates minidump of the process
 void createMiniDump(EXCEPTION_POINTERS* pExcPtrs)
 {   
+	// Write out the queued log messages first, writing the dump can take a while or fail.
+	TFE_System::logFlush();
+
     HMODULE hDbgHelp = NULL;
     HANDLE hFile = NULL;
     MINIDUMP_EXCEPTION_INFORMATION mei;
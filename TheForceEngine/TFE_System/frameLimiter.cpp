@@ -1,11 +1,22 @@
 #include <TFE_System/frameLimiter.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 namespace TFE_System
 {
 	static const f64 c_expAveF0 = 0.95;
 	static const f64 c_expAveF1 = 1.0 - c_expAveF0;
 	static const f64 c_epsilon = DBL_EPSILON + 0.001;	// We sleep for ~1ms each iteration, so add 1ms to the epsilon.
-	
+	// Precise pacing: stop sleeping when the deadline is closer than one sleep plus the measured oversleep and spin the rest.
+	static const f64 c_sleepStep = 0.001;
+	static const f64 c_spinMargin = 0.0002;
+	// A single long sleep (scheduler hiccup) should not turn every following frame into a spin, so limit the estimate.
+	static const f64 c_maxOversleep = 0.002;
+	// Histogram buckets are 50us wide and cover 0 - 100ms, longer frames go in the last bucket.
+	static const f64 c_histogramStep = 0.00005;
+	static const s32 c_histogramSize = 2000;
+
 	static f64 s_limitFPS = 0.0;
 	static f64 s_limitDelta = 0.0;
 	static f64 s_limitDeltaActual = 0.0;
@@ -13,6 +24,16 @@ namespace TFE_System
 	static f64 s_accuracyAve = 0.0;
 	static u64 s_beginTicks = 0;
 
+	static FramePacing s_pacing = FRAME_PACING_SLEEP;
+	static u64 s_deadlineTicks = 0;
+	static f64 s_oversleep = 0.0;
+
+	static u64 s_prevEndTicks = 0;
+	static u32 s_histogram[c_histogramSize];
+	static u32 s_frameCount = 0;
+	static f64 s_frameTimeSum = 0.0;
+	static f64 s_frameTimeMax = 0.0;
+
 	// Set the frame limit in Frames Per Second (FPS).
 	// A value of 0 sets no limit.
 	void frameLimiter_set(f64 limitFPS/* = 0.0*/)
@@ -35,6 +56,8 @@ namespace TFE_System
 			s_accuracy    = 0.0;
 			s_accuracyAve = 0.0;
 		}
+		// Restart the schedule.
+		s_deadlineTicks = 0;
 	}
 
 	f64 frameLimiter_get()
@@ -42,15 +65,29 @@ namespace TFE_System
 		return s_limitFPS;
 	}
 
+	void frameLimiter_setPacing(FramePacing pacing)
+	{
+		s_pacing = pacing;
+		s_deadlineTicks = 0;
+	}
+
+	FramePacing frameLimiter_getPacing()
+	{
+		return s_pacing;
+	}
+
 	void frameLimiter_begin()
 	{
 		s_beginTicks = getCurrentTimeInTicks();
 	}
 
-	void frameLimiter_end()
+	f64 ticksToSeconds(u64 t0, u64 t1)
 	{
-		if (s_limitDelta == 0.0) { return; }
+		return t1 > t0 ? convertFromTicksToSeconds(t1 - t0) : 0.0;
+	}
 
+	void waitSleep()
+	{
 		u64 curTick = TFE_System::getCurrentTimeInTicks();
 		if (curTick >= s_beginTicks)
 		{
@@ -66,16 +103,126 @@ namespace TFE_System
 				curSec = TFE_System::convertFromTicksToSeconds(curTick);
 				dt = curSec - beginSec;
 			}
+		}
+	}
+
+	void waitPrecise()
+	{
+		const u64 periodTicks = u64(s_limitDeltaActual / convertFromTicksToSeconds(1));
+		u64 curTick = getCurrentTimeInTicks();
+
+		// Deadlines follow an absolute schedule so that errors do not accumulate from frame to frame.
+		// Start a new schedule if the previous deadline is more than a frame behind, otherwise a long frame would cause a burst of short frames.
+		s_deadlineTicks += periodTicks;
+		if (s_deadlineTicks + periodTicks < curTick || s_deadlineTicks > curTick + 2*periodTicks)
+		{
+			s_deadlineTicks = s_beginTicks + periodTicks;
+		}
+
+		// Coarse sleep, compensated by how much longer than requested the OS actually sleeps.
+		while (ticksToSeconds(curTick, s_deadlineTicks) > c_sleepStep + s_oversleep + c_spinMargin)
+		{
+			const u64 sleepStart = curTick;
+			TFE_System::sleep(1);
+			curTick = getCurrentTimeInTicks();
+
+			const f64 oversleep = std::min(std::max(0.0, ticksToSeconds(sleepStart, curTick) - c_sleepStep), c_maxOversleep);
+			s_oversleep = s_oversleep*c_expAveF0 + oversleep*c_expAveF1;
+		}
+		// Spin for the remainder, yielding so other threads can still run.
+		while (curTick < s_deadlineTicks)
+		{
+			std::this_thread::yield();
+			curTick = getCurrentTimeInTicks();
+		}
+	}
+
+	void recordFrameTime(u64 endTicks)
+	{
+		if (s_prevEndTicks && endTicks > s_prevEndTicks)
+		{
+			const f64 frameTime = convertFromTicksToSeconds(endTicks - s_prevEndTicks);
+			const s32 bucket = std::min(s32(frameTime / c_histogramStep), c_histogramSize - 1);
+			s_histogram[bucket]++;
+			s_frameCount++;
+			s_frameTimeSum += frameTime;
+			s_frameTimeMax = std::max(s_frameTimeMax, frameTime);
+		}
+		s_prevEndTicks = endTicks;
+	}
+
+	void frameLimiter_end()
+	{
+		if (s_limitDelta != 0.0)
+		{
+			if (s_pacing == FRAME_PACING_PRECISE)
+			{
+				waitPrecise();
+			}
+			else
+			{
+				waitSleep();
+			}
+		}
+		const u64 endTicks = getCurrentTimeInTicks();
+		if (s_limitDelta != 0.0 && endTicks >= s_beginTicks)
+		{
+			const f64 dt = convertFromTicksToSeconds(endTicks - s_beginTicks);
 			// Accuracy - how close is delta time to the desired delta?
 			// 1.0 = 100% accurate, 0.0 = fully inaccurate (dt = 0)
 			// > 1.0 : frame is too long; < 1.0 : frame is too short.
 			s_accuracy = 1.0 - (dt - s_limitDeltaActual) / s_limitDeltaActual;
 			s_accuracyAve = (s_accuracyAve == 0.0) ? s_accuracy : s_accuracyAve*c_expAveF0 + s_accuracy*c_expAveF1;
 		}
+		recordFrameTime(endTicks);
 	}
 
 	f64 frameLimiter_getAccuracy()
 	{
 		return s_accuracyAve;
 	}
-}
\ No newline at end of file
+
+	f64 getPercentile(f64 percentile)
+	{
+		// The frame count includes every frame, so the last bucket is always reached.
+		const u32 target = std::max(1u, u32(f64(s_frameCount) * percentile + 0.5));
+		u32 count = 0;
+		for (s32 i = 0; i < c_histogramSize; i++)
+		{
+			count += s_histogram[i];
+			if (count >= target)
+			{
+				// Use the bucket center, clamped to the largest frame time actually seen.
+				return std::min((f64(i) + 0.5) * c_histogramStep, s_frameTimeMax);
+			}
+		}
+		return s_frameTimeMax;
+	}
+
+	void frameLimiter_getStats(FrameTimeStats* stats)
+	{
+		stats->frameCount = s_frameCount;
+		if (!s_frameCount)
+		{
+			stats->average = 0.0;
+			stats->p50 = 0.0;
+			stats->p99 = 0.0;
+			stats->max = 0.0;
+			return;
+		}
+		stats->average = s_frameTimeSum / f64(s_frameCount);
+		stats->p50 = getPercentile(0.50);
+		stats->p99 = getPercentile(0.99);
+		stats->max = s_frameTimeMax;
+	}
+
+	void frameLimiter_resetStats()
+	{
+		memset(s_histogram, 0, sizeof(s_histogram));
+		s_frameCount = 0;
+		s_frameTimeSum = 0.0;
+		s_frameTimeMax = 0.0;
+		// The next frame is measured from the next frameLimiter_end().
+		s_prevEndTicks = 0;
+	}
+}
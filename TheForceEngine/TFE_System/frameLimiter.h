@@ -8,12 +8,34 @@
 
 namespace TFE_System
 {
+	enum FramePacing
+	{
+		FRAME_PACING_SLEEP = 0,		// Sleep in 1ms steps until the frame time has elapsed.
+		FRAME_PACING_PRECISE,		// Follow an absolute schedule, sleep coarsely and spin for the remainder.
+	};
+
+	// Frame time statistics, in seconds, since the last reset.
+	struct FrameTimeStats
+	{
+		u32 frameCount;
+		f64 average;
+		f64 p50;
+		f64 p99;
+		f64 max;
+	};
+
 	// Set the frame limit in Frames Per Second (FPS).
 	// A value of 0 sets no limit.
 	void frameLimiter_set(f64 limitFPS = 0.0);
 	f64 frameLimiter_get();
 	f64 frameLimiter_getAccuracy();
+	void frameLimiter_setPacing(FramePacing pacing);
+	FramePacing frameLimiter_getPacing();
 
 	void frameLimiter_begin();
 	void frameLimiter_end();
+
+	// Frame times are recorded whether or not a limit is set.
+	void frameLimiter_getStats(FrameTimeStats* stats);
+	void frameLimiter_resetStats();
 }
@@ -0,0 +1,186 @@
+#include "framePipeline.h"
+#include <TFE_System/system.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The simulation and main threads never run game code at the same time: the main thread only presents
+// the previous frame while a step is running, so the simulation itself runs in the same order as without
+// the pipeline and replays stay deterministic.
+namespace TFE_System
+{
+	struct MainThreadRequest
+	{
+		const std::function<void()>* func;
+		bool done;
+	};
+
+	static bool s_enabled = false;
+	static std::thread s_worker;
+	static std::mutex s_mutex;
+	static std::condition_variable s_workerCond;
+	static std::condition_variable s_mainCond;
+	static std::vector<MainThreadRequest*> s_requests;
+	static FrameSimFunc s_simFunc = nullptr;
+	static bool s_simRunning = false;
+	static bool s_simResult = false;
+	static bool s_quit = false;
+	static thread_local bool s_isSimThread = false;
+
+	// Stats.
+	static u64 s_beginTicks;
+	static f64 s_simTime;
+	static u32 s_statFrames;
+	static f64 s_statSim;
+	static f64 s_statSimMax;
+	static f64 s_statPresent;
+	static f64 s_statWait;
+
+	void workerThread()
+	{
+		s_isSimThread = true;
+		std::unique_lock<std::mutex> lock(s_mutex);
+		while (true)
+		{
+			s_workerCond.wait(lock, [] { return s_simFunc || s_quit; });
+			if (!s_simFunc) { break; }
+
+			FrameSimFunc func = s_simFunc;
+			lock.unlock();
+			const u64 start = getCurrentTimeInTicks();
+			const bool result = func();
+			const f64 simTime = convertFromTicksToSeconds(getCurrentTimeInTicks() - start);
+			lock.lock();
+
+			s_simFunc = nullptr;
+			s_simResult = result;
+			s_simTime = simTime;
+			s_simRunning = false;
+			s_mainCond.notify_one();
+		}
+	}
+
+	void framePipeline_init()
+	{
+		if (s_worker.joinable()) { return; }
+		s_quit = false;
+		s_worker = std::thread(workerThread);
+	}
+
+	void framePipeline_destroy()
+	{
+		if (!s_worker.joinable()) { return; }
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			s_quit = true;
+		}
+		s_workerCond.notify_one();
+		s_worker.join();
+	}
+
+	void framePipeline_enable(bool enable)
+	{
+		if (enable == s_enabled) { return; }
+		s_enabled = enable;
+		if (enable)
+		{
+			framePipeline_init();
+		}
+		else
+		{
+			framePipeline_destroy();
+		}
+		framePipeline_resetStats();
+		TFE_System::logWrite(LOG_MSG, "System", "Pipelined frames %s.", enable ? "enabled" : "disabled");
+	}
+
+	bool framePipeline_isEnabled()
+	{
+		return s_enabled;
+	}
+
+	void framePipeline_beginSim(FrameSimFunc func)
+	{
+		if (!s_worker.joinable())
+		{
+			framePipeline_init();
+		}
+
+		s_beginTicks = getCurrentTimeInTicks();
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			s_simFunc = func;
+			s_simRunning = true;
+		}
+		s_workerCond.notify_one();
+	}
+
+	bool framePipeline_endSim()
+	{
+		const u64 endTicks = getCurrentTimeInTicks();
+		std::unique_lock<std::mutex> lock(s_mutex);
+		while (true)
+		{
+			s_mainCond.wait(lock, [] { return !s_simRunning || !s_requests.empty(); });
+			if (s_requests.empty()) { break; }
+
+			MainThreadRequest* request = s_requests.front();
+			s_requests.erase(s_requests.begin());
+			lock.unlock();
+			(*request->func)();
+			lock.lock();
+
+			request->done = true;
+			s_workerCond.notify_all();
+		}
+
+		const f64 presentTime = convertFromTicksToSeconds(endTicks - s_beginTicks);
+		s_statFrames++;
+		s_statSim += s_simTime;
+		s_statSimMax = std::max(s_statSimMax, s_simTime);
+		s_statPresent += presentTime;
+		s_statWait += convertFromTicksToSeconds(getCurrentTimeInTicks() - endTicks);
+		return s_simResult;
+	}
+
+	bool framePipeline_isSimThread()
+	{
+		return s_isSimThread;
+	}
+
+	void framePipeline_runOnMainThread(const std::function<void()>& func)
+	{
+		if (!s_isSimThread)
+		{
+			func();
+			return;
+		}
+
+		MainThreadRequest request = { &func, false };
+		std::unique_lock<std::mutex> lock(s_mutex);
+		s_requests.push_back(&request);
+		s_mainCond.notify_one();
+		s_workerCond.wait(lock, [&request] { return request.done; });
+	}
+
+	void framePipeline_getStats(FramePipelineStats* stats)
+	{
+		const f64 scale = s_statFrames ? 1.0 / f64(s_statFrames) : 0.0;
+		stats->frameCount = s_statFrames;
+		stats->simAverage = s_statSim * scale;
+		stats->simMax = s_statSimMax;
+		stats->presentAverage = s_statPresent * scale;
+		stats->waitAverage = s_statWait * scale;
+	}
+
+	void framePipeline_resetStats()
+	{
+		s_statFrames = 0;
+		s_statSim = 0.0;
+		s_statSimMax = 0.0;
+		s_statPresent = 0.0;
+		s_statWait = 0.0;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine System Library
+// Pipelined frames - the game simulation runs on a worker thread
+// while the main thread presents the previous frame.
+//////////////////////////////////////////////////////////////////////
+
+#include "system.h"
+#include <functional>
+
+namespace TFE_System
+{
+	// Runs one simulation step, the return value is passed back by framePipeline_endSim().
+	typedef bool(*FrameSimFunc)();
+
+	// Pipelined frame timings, in seconds, since the last reset.
+	struct FramePipelineStats
+	{
+		u32 frameCount;
+		f64 simAverage;		// Simulation time on the worker thread.
+		f64 simMax;
+		f64 presentAverage;	// Main thread time spent presenting while the simulation runs.
+		f64 waitAverage;	// Main thread time spent waiting for the simulation afterward.
+	};
+
+	void framePipeline_init();
+	void framePipeline_destroy();
+
+	void framePipeline_enable(bool enable);
+	bool framePipeline_isEnabled();
+
+	// Start the simulation step on the worker thread.
+	void framePipeline_beginSim(FrameSimFunc func);
+	// Wait for the simulation step to finish, running any work it queued for the main thread in the meantime.
+	bool framePipeline_endSim();
+	// Returns true when called from the simulation thread during a pipelined step.
+	bool framePipeline_isSimThread();
+	// Run a function on the main thread, the calling thread waits for it to finish.
+	// This is used for work that must stay on the main thread, such as GPU resource updates.
+	void framePipeline_runOnMainThread(const std::function<void()>& func);
+
+	void framePipeline_getStats(FramePipelineStats* stats);
+	void framePipeline_resetStats();
+}
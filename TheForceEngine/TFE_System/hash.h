@@ -0,0 +1,56 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine System Library
+// Simple non-cryptographic hashing (64-bit FNV-1a), used to build
+// keys for on-disk caches and to detect changed data.
+//////////////////////////////////////////////////////////////////////
+#include "types.h"
+#include <string.h>
+
+namespace TFE_Hash
+{
+	enum : u64
+	{
+		FNV_OFFSET_BASIS = 0xcbf29ce484222325ull,
+		FNV_PRIME        = 0x00000100000001b3ull,
+	};
+
+	inline u64 fnv1a64(const void* data, size_t size, u64 hash = FNV_OFFSET_BASIS)
+	{
+		const u8* bytes = (const u8*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+
+	inline u64 fnv1a64(const char* str, u64 hash = FNV_OFFSET_BASIS)
+	{
+		if (!str) { return hash; }
+		return fnv1a64(str, strlen(str) + 1, hash);
+	}
+
+	template<typename T>
+	inline u64 fnv1a64Value(const T& value, u64 hash = FNV_OFFSET_BASIS)
+	{
+		return fnv1a64(&value, sizeof(T), hash);
+	}
+
+	// Faster variant for large blocks of data, such as images, which consumes 8 bytes at a time.
+	// Note the result is not the same as fnv1a64() for the same data.
+	inline u64 hashBlock64(const void* data, size_t size, u64 hash = FNV_OFFSET_BASIS)
+	{
+		const u8* bytes = (const u8*)data;
+		for (; size >= 8; size -= 8, bytes += 8)
+		{
+			u64 value;
+			memcpy(&value, bytes, 8);
+			hash ^= value;
+			hash *= FNV_PRIME;
+			hash ^= hash >> 29;
+		}
+		return fnv1a64(bytes, size, hash);
+	}
+}
@@ -6,22 +6,52 @@
 #include <TFE_FileSystem/paths.h>
 #include <TFE_FrontEndUI/frontEndUi.h>
 
+#include <algorithm>
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctime>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #ifdef _WIN32
 	#include <Windows.h>
 	#include <io.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
 #endif
 
 namespace TFE_System
 {
+	// Messages are formatted on the calling thread and pushed into a lock-free multi-producer ring.
+	// A writer thread drains the ring in batches; errors and critical messages are flushed
+	// synchronously so they reach the disk before a likely crash.
+	enum LogConst : u32
+	{
+		LOG_RING_SIZE  = 1024,					// Must be a power of two.
+		LOG_RING_MASK  = LOG_RING_SIZE - 1,
+		LOG_SLOT_SIZE  = 512,					// Longer messages are written synchronously.
+		LOG_BATCH_SIZE = 65536,
+		LOG_WRITER_INTERVAL_MS = 10,
+		LOG_WAKE_THRESHOLD = LOG_RING_SIZE / 4,	// Wake the writer early once the ring is this full.
+		LOG_CONSOLE_QUEUE_MAX = 2048,			// Oldest console messages are dropped past this count.
+	};
+
+	struct LogSlot
+	{
+		atomic_u32 sequence;	// Stored relative to the slot index, see loadSequence().
+		u32 length;		// Length of the full line, excluding the null terminator.
+		u32 msgOffset;	// The message without the time and tag, which is sent to the console.
+		u32 msgLength;
+		char text[LOG_SLOT_SIZE];
+	};
+
 	static FileStream s_logFile;
-	static char s_workStr[32768];
-	static char s_msgStr[32768];
 	static const char* c_typeNames[]=
 	{
 		"",			//LOG_MSG = 0,
@@ -30,6 +60,34 @@ namespace TFE_System
 		"Critical", //LOG_CRITICAL,
 	};
 
+	static LogSlot s_ring[LOG_RING_SIZE];
+	static atomic_u32 s_enqueuePos(0);
+	static atomic_u32 s_dequeuePos(0);	// Only advanced while holding s_drainMutex, or in signal mode.
+	static atomic_u32 s_droppedCount(0);
+	static u32 s_totalDropped = 0;
+
+	// Draining (and writing to the file) is serialized by this mutex, the ring itself is lock-free for producers.
+	static std::mutex s_drainMutex;
+	static char s_batch[LOG_BATCH_SIZE];
+	static u32 s_batchSize = 0;
+
+	static std::thread s_writerThread;
+	static atomic_bool s_writerRunning(false);
+	static std::mutex s_wakeMutex;
+	static std::condition_variable s_wakeCond;
+
+	// The console is not thread-safe, so messages are forwarded from the main thread in logUpdate().
+	// The queue is capped so a log storm cannot grow it without limit if the main thread stalls.
+	static std::mutex s_consoleMutex;
+	static std::deque<std::string> s_consoleQueue;
+	static u32 s_consoleDropped = 0;
+
+	// Set by logEnterSignalMode(), after which logging takes no locks and writes directly to the file.
+	static atomic_bool s_signalMode(false);
+#ifndef _WIN32
+	static int s_signalFd = -1;
+#endif
+
 	bool includeTime = true;
 	int maxLogRotations = 3;
 
@@ -38,23 +96,291 @@ namespace TFE_System
 		includeTime = !includeTime;
 	}
 
+	// The slot for position 'pos' is ready to write when its sequence is 'pos' and ready to read when it is 'pos + 1'.
+	// Sequences are stored minus the slot index, so the zero-initialized ring already starts with slot i at
+	// sequence i and no initialization has to run before the first message, whichever thread logs it.
+	u32 loadSequence(u32 pos)
+	{
+		return s_ring[pos & LOG_RING_MASK].sequence.load(std::memory_order_acquire) + (pos & LOG_RING_MASK);
+	}
+
+	void storeSequence(u32 pos, u32 seq)
+	{
+		s_ring[pos & LOG_RING_MASK].sequence.store(seq - (pos & LOG_RING_MASK), std::memory_order_release);
+	}
+
+	void flushBatch()
+	{
+		if (!s_batchSize) { return; }
+		s_logFile.writeBuffer(s_batch, s_batchSize);
+		s_logFile.flush();
+#ifndef _WIN32
+		fwrite(s_batch, 1, s_batchSize, stderr);
+#endif
+		s_batchSize = 0;
+	}
+
+	void writeLine(const char* line, u32 length, const char* msg, u32 msgLength)
+	{
+		if (s_batchSize + length > LOG_BATCH_SIZE)
+		{
+			flushBatch();
+		}
+		if (length > LOG_BATCH_SIZE)
+		{
+			s_logFile.writeBuffer(line, length);
+#ifndef _WIN32
+			fwrite(line, 1, length, stderr);
+#endif
+		}
+		else
+		{
+			memcpy(s_batch + s_batchSize, line, length);
+			s_batchSize += length;
+		}
+#ifdef _WIN32
+		OutputDebugStringA(line);
+#endif
+		std::lock_guard<std::mutex> lock(s_consoleMutex);
+		if (s_consoleQueue.size() >= LOG_CONSOLE_QUEUE_MAX)
+		{
+			s_consoleQueue.pop_front();
+			s_consoleDropped++;
+		}
+		s_consoleQueue.emplace_back(msg, msgLength);
+	}
+
+	// Requires s_drainMutex.
+	void drainRing()
+	{
+		u32 pos = s_dequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			LogSlot* slot = &s_ring[pos & LOG_RING_MASK];
+			const u32 seq = loadSequence(pos);
+			if (s32(seq - (pos + 1)) < 0) { break; }
+
+			writeLine(slot->text, slot->length, slot->text + slot->msgOffset, slot->msgLength);
+			storeSequence(pos, pos + LOG_RING_SIZE);
+			pos++;
+			s_dequeuePos.store(pos, std::memory_order_relaxed);
+		}
+
+		const u32 dropped = s_droppedCount.exchange(0);
+		if (dropped)
+		{
+			s_totalDropped += dropped;
+			char line[128];
+			const s32 len = snprintf(line, sizeof(line), "[Log] %u messages were dropped, the log ring was full.\r\n", dropped);
+			writeLine(line, (u32)len, line + 6, (u32)len - 8);
+		}
+		flushBatch();
+	}
+
+	void writeSignalSafe(const char* line, u32 length)
+	{
+#ifndef _WIN32
+		if (s_signalFd >= 0 && write(s_signalFd, line, length) < 0) { }
+		if (write(STDERR_FILENO, line, length) < 0) { }
+#endif
+	}
+
+	// Signal mode only: drain without s_drainMutex or stdio, which the interrupted thread may be holding.
+	// The writer thread may be stopped in the middle of a batch, so a few lines can be lost or repeated.
+	void drainRingSignalSafe()
+	{
+		u32 pos = s_dequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			LogSlot* slot = &s_ring[pos & LOG_RING_MASK];
+			if (s32(loadSequence(pos) - (pos + 1)) < 0) { break; }
+
+			writeSignalSafe(slot->text, slot->length);
+			storeSequence(pos, pos + LOG_RING_SIZE);
+			pos++;
+			s_dequeuePos.store(pos, std::memory_order_relaxed);
+		}
+	}
+
+	void logEnterSignalMode()
+	{
+		s_signalMode.store(true);
+	}
+
+	void logFlush()
+	{
+		if (s_signalMode.load())
+		{
+			drainRingSignalSafe();
+			return;
+		}
+		std::lock_guard<std::mutex> lock(s_drainMutex);
+		if (s_logFile.isOpen())
+		{
+			drainRing();
+		}
+	}
+
+	void writerThreadFunc()
+	{
+		while (s_writerRunning.load())
+		{
+			{
+				std::unique_lock<std::mutex> lock(s_wakeMutex);
+				s_wakeCond.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_INTERVAL_MS));
+			}
+			logFlush();
+		}
+	}
+
+	bool enqueueLine(const char* line, u32 length, u32 msgOffset, u32 msgLength)
+	{
+		u32 pos = s_enqueuePos.load(std::memory_order_relaxed);
+		LogSlot* slot;
+		for (;;)
+		{
+			slot = &s_ring[pos & LOG_RING_MASK];
+			const s32 diff = s32(loadSequence(pos) - pos);
+			if (diff == 0)
+			{
+				if (s_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+			}
+			else if (diff < 0)
+			{
+				return false;	// Full.
+			}
+			else
+			{
+				pos = s_enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		memcpy(slot->text, line, length + 1);
+		slot->length = length;
+		slot->msgOffset = msgOffset;
+		slot->msgLength = msgLength;
+		storeSequence(pos, pos + 1);
+
+		if (pos - s_dequeuePos.load(std::memory_order_relaxed) >= LOG_WAKE_THRESHOLD)
+		{
+			s_wakeCond.notify_one();
+		}
+		return true;
+	}
+
+	void startWriter()
+	{
+		if (s_writerRunning.load()) { return; }
+		s_writerRunning.store(true);
+		s_writerThread = std::thread(writerThreadFunc);
+	}
+
+	void stopWriter()
+	{
+		if (!s_writerRunning.load()) { return; }
+		s_writerRunning.store(false);
+		s_wakeCond.notify_one();
+		if (s_writerThread.joinable())
+		{
+			s_writerThread.join();
+		}
+	}
+
 	bool logOpen(const char* filename, bool append)
 	{
 		char logPath[TFE_MAX_PATH];
 		TFE_Paths::appendPath(PATH_USER_DOCUMENTS, filename, logPath);
-		if (append)
+
+		bool res;
 		{
-			return s_logFile.open(logPath, Stream::MODE_APPEND);
+			std::lock_guard<std::mutex> lock(s_drainMutex);
+			// Messages queued for a previously opened log still go to that file.
+			if (s_logFile.isOpen())
+			{
+				drainRing();
+				s_logFile.close();
+			}
+			res = s_logFile.open(logPath, append ? Stream::MODE_APPEND : Stream::MODE_WRITE);
+		#ifndef _WIN32
+			// A second, unbuffered descriptor for the signal handler, which cannot use stdio.
+			if (s_signalFd >= 0) { close(s_signalFd); }
+			s_signalFd = res ? open(logPath, O_WRONLY | O_APPEND) : -1;
+		#endif
 		}
-		else
+		if (res)
 		{
-			return s_logFile.open(logPath, Stream::MODE_WRITE);
+			startWriter();
 		}
+		return res;
 	}
 
 	void logClose()
 	{
+		stopWriter();
+
+		std::lock_guard<std::mutex> lock(s_drainMutex);
+		if (s_logFile.isOpen())
+		{
+			drainRing();
+			if (s_totalDropped)
+			{
+				char line[128];
+				const s32 len = snprintf(line, sizeof(line), "[Log] %u messages were dropped in total.\r\n", s_totalDropped);
+				s_logFile.writeBuffer(line, (u32)len);
+				s_totalDropped = 0;
+			}
+		}
 		s_logFile.close();
+	#ifndef _WIN32
+		if (s_signalFd >= 0)
+		{
+			close(s_signalFd);
+			s_signalFd = -1;
+		}
+	#endif
+	}
+
+	void logUpdate()
+	{
+		std::deque<std::string> messages;
+		u32 dropped;
+		{
+			std::lock_guard<std::mutex> lock(s_consoleMutex);
+			messages.swap(s_consoleQueue);
+			dropped = s_consoleDropped;
+			s_consoleDropped = 0;
+		}
+
+		if (dropped)
+		{
+			// The messages are still in the log file, only the console copies were dropped.
+			char msg[128];
+			snprintf(msg, sizeof(msg), "[Log] %u older messages were not shown in the console, see the log file.", dropped);
+			TFE_FrontEndUI::logToConsole(msg);
+		}
+
+		const size_t count = messages.size();
+		for (size_t m = 0; m < count; m++)
+		{
+			std::string& str = messages[m];
+			char* msg = &str[0];
+			const size_t len = str.length();
+			char* msgStart = msg;
+			for (size_t i = 0; i < len; i++)
+			{
+				if (msg[i] == '\n')
+				{
+					msg[i] = 0;
+					TFE_FrontEndUI::logToConsole(msgStart);
+
+					msgStart = msg + i + 1;
+				}
+			}
+			if (msgStart < msg + len)
+			{
+				TFE_FrontEndUI::logToConsole(msgStart);
+			}
+		}
 	}
 
 	void debugWrite(const char* tag, const char* str, ...)
@@ -62,18 +388,20 @@ namespace TFE_System
 		if (!tag || !str) { return; }
 
 		//Handle the variable input, "printf" style messages
+		char msgStr[LOG_SLOT_SIZE];
 		va_list arg;
 		va_start(arg, str);
-		vsprintf(s_msgStr, str, arg);
+		vsnprintf(msgStr, sizeof(msgStr), str, arg);
 		va_end(arg);
 
-		sprintf(s_workStr, "[%s] %s\r\n", tag, s_msgStr);
+		char workStr[LOG_SLOT_SIZE + 256];
+		snprintf(workStr, sizeof(workStr), "[%s] %s\r\n", tag, msgStr);
 
 		//Write to the debugger or terminal output.
 #ifdef _WIN32
-		OutputDebugStringA(s_workStr);
+		OutputDebugStringA(workStr);
 #else
-		fprintf(stderr, "%s", s_workStr);
+		fprintf(stderr, "%s", workStr);
 #endif
 	}
 
@@ -100,65 +428,108 @@ namespace TFE_System
 			strftime(timeStr, sizeof(timeStr) - 4, "%Y-%b-%d %H:%M:%S", &now_tm); // Leave space for milliseconds
 
 			// Add milliseconds to the formatted time
-			snprintf(timeStr + strlen(timeStr), 8, ".%03lld - ", milliseconds.count());
+			snprintf(timeStr + strlen(timeStr), 8, ".%03lld - ", (long long)milliseconds.count());
 		}
 		else
 		{
 			timeStr[0] = 0;
 		}
 
-		//Handle the variable input, "printf" style messages
-		va_list arg;
-		va_start(arg, str);
-		vsprintf(s_msgStr, str, arg);
-		va_end(arg);
-
-		//Format the message		
+		//Format the prefix
+		char prefix[256];
+		s32 prefixLen;
 		if (type != LOG_MSG)
 		{
-			sprintf(s_workStr, "%s[%s : %s] %s\r\n", timeStr, c_typeNames[type], tag, s_msgStr);
+			prefixLen = snprintf(prefix, sizeof(prefix), "%s[%s : %s] ", timeStr, c_typeNames[type], tag);
 		}
 		else
 		{
-			sprintf(s_workStr, "%s[%s] %s\r\n", timeStr, tag, s_msgStr);
+			prefixLen = snprintf(prefix, sizeof(prefix), "%s[%s] ", timeStr, tag);
 		}
+		prefixLen = std::min(prefixLen, s32(sizeof(prefix)) - 1);
+
+		//Handle the variable input, "printf" style messages
+		//Most messages fit in a ring slot and are formatted in place on the stack.
+		char line[LOG_SLOT_SIZE];
+		memcpy(line, prefix, prefixLen);
+		const s32 maxMsgLen = LOG_SLOT_SIZE - prefixLen - 3;
+
+		va_list arg;
+		va_start(arg, str);
+		va_list argCopy;
+		va_copy(argCopy, arg);
+		s32 msgLen = vsnprintf(line + prefixLen, maxMsgLen + 1, str, arg);
+		va_end(arg);
+		if (msgLen < 0) { msgLen = 0; }
 
-		//Write to disk
-		s_logFile.writeBuffer(s_workStr, (u32)strlen(s_workStr));
-		//Make sure to flush the file to disk if a crash is likely.
-		//if (type == LOG_ERROR || type == LOG_CRITICAL)
+		if (s_signalMode.load(std::memory_order_relaxed))
 		{
-			s_logFile.flush();
+			// In a signal handler, write after the queued messages without locks or allocations; long messages are cut.
+			va_end(argCopy);
+			msgLen = std::min(msgLen, maxMsgLen);
+			const u32 length = u32(prefixLen + msgLen + 2);
+			line[prefixLen + msgLen] = '\r';
+			line[prefixLen + msgLen + 1] = '\n';
+			drainRingSignalSafe();
+			writeSignalSafe(line, length);
+			return;
 		}
-		//Write to the debugger or terminal output.
-#ifdef _WIN32
-		OutputDebugStringA(s_workStr);
-#else
-		fprintf(stderr, "%s", s_workStr);
-#endif
-		//Critical log messages also act as asserts in the debugger.
-		if (type == LOG_CRITICAL)
+		else if (msgLen <= maxMsgLen)
 		{
-			assert(0);
-		}
+			va_end(argCopy);
+			const u32 length = u32(prefixLen + msgLen + 2);
+			line[prefixLen + msgLen] = '\r';
+			line[prefixLen + msgLen + 1] = '\n';
+			line[length] = 0;
 
-		sprintf(s_workStr, "%s - [%s] %s", timeStr, tag, s_msgStr);
-		size_t len = strlen(s_msgStr);
-		char* msg = s_msgStr;
-		char* msgStart = msg;
-		for (size_t i = 0; i < len; i++)
+			const bool flush = type == LOG_ERROR || type == LOG_CRITICAL;
+			if (!enqueueLine(line, length, prefixLen, msgLen))
+			{
+				if (flush)
+				{
+					// Errors are never dropped, make room and write synchronously.
+					std::lock_guard<std::mutex> lock(s_drainMutex);
+					drainRing();
+					writeLine(line, length, line + prefixLen, msgLen);
+					flushBatch();
+				}
+				else
+				{
+					s_droppedCount++;
+				}
+			}
+			else if (flush)
+			{
+				//Make sure to flush the file to disk if a crash is likely.
+				logFlush();
+			}
+		}
+		else
 		{
-			if (msg[i] == '\n')
+			// Long messages are rare, write them synchronously after the queued messages to keep the order.
+			const u32 length = u32(prefixLen + msgLen + 2);
+			char* longLine = (char*)malloc(length + 1);
+			if (longLine)
 			{
-				msg[i] = 0;
-				TFE_FrontEndUI::logToConsole(msgStart);
+				memcpy(longLine, prefix, prefixLen);
+				vsnprintf(longLine + prefixLen, msgLen + 1, str, argCopy);
+				longLine[prefixLen + msgLen] = '\r';
+				longLine[prefixLen + msgLen + 1] = '\n';
+				longLine[length] = 0;
 
-				msgStart = msg + i + 1;
+				std::lock_guard<std::mutex> lock(s_drainMutex);
+				drainRing();
+				writeLine(longLine, length, longLine + prefixLen, msgLen);
+				flushBatch();
+				free(longLine);
 			}
+			va_end(argCopy);
 		}
-		if (msgStart < s_msgStr + len)
+
+		//Critical log messages also act as asserts in the debugger.
+		if (type == LOG_CRITICAL)
 		{
-			TFE_FrontEndUI::logToConsole(msgStart);
+			assert(0);
 		}
 	}
 
@@ -0,0 +1,43 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine System Library
+// Simple fork/join helper for splitting independent work items
+// across the available hardware threads.
+//////////////////////////////////////////////////////////////////////
+#include "types.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace TFE_System
+{
+	// Run func(i) for i = [0, count) on a pool of worker threads, the calling thread also does work.
+	// Returns once all of the items are done. Items are picked up in order, but may finish in any order.
+	template<typename Func>
+	void parallelFor(s32 count, Func func)
+	{
+		const s32 threadCount = std::min(count, s32(std::max(1u, std::thread::hardware_concurrency())));
+		if (threadCount <= 1)
+		{
+			for (s32 i = 0; i < count; i++) { func(i); }
+			return;
+		}
+
+		std::atomic<s32> next(0);
+		auto worker = [&]()
+		{
+			for (s32 i = next++; i < count; i = next++) { func(i); }
+		};
+		std::vector<std::thread> threads;
+		for (s32 t = 1; t < threadCount; t++)
+		{
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (size_t t = 0; t < threads.size(); t++)
+		{
+			threads[t].join();
+		}
+	}
+}
@@ -6,7 +6,8 @@
 
 namespace
 {
-	static char s_line[4096];
+	// Per thread so that separate parsers can be used on worker threads.
+	static thread_local char s_line[4096];
 	bool isWhitespace(const char c)
 	{
 		if (c > 32 && c < 127)
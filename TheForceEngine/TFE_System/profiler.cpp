@@ -3,9 +3,11 @@
 #include "profiler.h"
 #include <assert.h>
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <map>
+#include <thread>
 
 // TODO: Support call "paths" - with seperate time per path.
 
@@ -64,6 +66,9 @@ namespace TFE_Profiler
 	static u32 s_zoneStack[MAX_ZONE_STACK];
 	static u64 s_currentFrame = 1;
 	static u64 s_currentPath;
+	// Zones are only recorded on the thread that begins frames, the zone stack is not shared between threads.
+	// Atomic since other threads (such as the pipelined simulation worker) read it while frames begin.
+	static std::atomic<std::thread::id> s_frameThread;
 
 	void addZoneChild(u32 parentId, u32 zoneId)
 	{
@@ -104,6 +109,8 @@ namespace TFE_Profiler
 
 	u32 beginZone(const char* name, const char* func, u32 lineNumber)
 	{
+		if (std::this_thread::get_id() != s_frameThread.load(std::memory_order_relaxed)) { return NULL_ZONE; }
+
 		ZoneMap::iterator iZone = s_zoneMap.find(name);
 		u32 id = 0;
 
@@ -152,6 +159,7 @@ namespace TFE_Profiler
 
 	void endZone(u32 id, u64 dt)
 	{
+		if (id == NULL_ZONE) { return; }
 		s_zoneList[id].timeInZone[s_writeBuffer] += TFE_System::convertFromTicksToSeconds(dt);
 		s_level--;
 	}
@@ -176,6 +184,7 @@ namespace TFE_Profiler
 
 	void frameBegin()
 	{
+		s_frameThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
 		std::swap(s_readBuffer, s_writeBuffer);
 		// Validate buffer indices.
 		assert(s_readBuffer < ZONE_BUFFER_COUNT && s_writeBuffer < ZONE_BUFFER_COUNT && s_readBuffer != s_writeBuffer);
@@ -133,6 +133,8 @@ namespace TFE_System
 	
 	void update()
 	{
+		logUpdate();
+
 		// This assumes that SDL_GetPerformanceCounter() is monotonic.
 		// However if errors do occur, the dt clamp later should limit the side effects.
 		const u64 curTime = SDL_GetPerformanceCounter();
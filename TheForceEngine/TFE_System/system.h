@@ -60,6 +60,12 @@ namespace TFE_System
 	void logClose();
 	void logWrite(LogWriteType type, const char* tag, const char* str, ...);
 	void openRotatingLog(const char* fileName, bool append=false);
+	// Log messages are written by a background thread, this blocks until everything logged so far is on disk.
+	void logFlush();
+	// Called at the start of a crash signal handler: from then on logging and logFlush() take no locks.
+	void logEnterSignalMode();
+	// Forward logged messages to the console, must be called from the main thread.
+	void logUpdate();
 
 	// Lighter weight debug output (only useful when running in a terminal or debugger).
 	void debugWrite(const char* tag, const char* str, ...);
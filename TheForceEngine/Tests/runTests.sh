@@ -58,38 +58,93 @@ if [[ ! -s "$demo_log_path" || ! -f "$demo_log_path" ]]; then
     fi
 fi
 
-# Run the demo and generate new log file
-pushd $root_path
-echo "Running TFE test..."
-echo "Executing Command $root_path/theforceengine -gDark -r$demo_path --demo_logging --exit_after_replay ....."
-$root_path/theforceengine -gDark -r$demo_path --demo_logging --exit_after_replay
-result=$?
-echo "Done running test. Result is $result"
-
-if [ $result != "0" ]; then
-    echo "ERROR: TFE failed to run. Please look at the logs hopefully generated in $user_doc_path"
+# Run the demo with extra options and diff the last line of the replay.log with the base one.
+# Usage: run_test <test name> [extra theforceengine options]
+run_test() {
+    test_name=$1
+    shift
+    pushd $root_path
+    echo "Running TFE $test_name test..."
+    echo "Executing Command $root_path/theforceengine -gDark -r$demo_path --demo_logging --exit_after_replay $@ ....."
+    $root_path/theforceengine -gDark -r$demo_path --demo_logging --exit_after_replay "$@"
+    result=$?
+    popd
+    echo "Done running $test_name test. Result is $result"
+
+    if [ $result != "0" ]; then
+	echo "ERROR: TFE failed to run. Please look at the logs hopefully generated in $user_doc_path"
+	exit 1
+    fi
+
+    # Diff Log Results of the test replay.log and the base one.
+    if [ ! -f $user_doc_path/replay.log ]; then
+	echo "ERROR: Missing $user_doc_path/replay.log - No log generated?"
+	exit 1
+    fi
+
+    if [ ! -f $demo_log_path ]; then
+	echo "ERROR: Missing $demo_log_path - did you not checkout the latest code?"
+	exit 1
+    fi
+
+    if diff <(tail -n 1 $user_doc_path/replay.log) <(tail -n 1 $demo_log_path) > /dev/null; then
+	echo "$test_name TEST SUCCEEDED RESULTS MATCH!"
+    else
+	echo "ERROR: $test_name RESULTS DO NOT MATCH!"
+	diff <(tail -n 1 $user_doc_path/replay.log) <(tail -n 1 $demo_log_path)
+	exit 1
+    fi
+}
+
+# Straight playback.
+run_test "Playback"
+
+# Seek back from 20 to 10 seconds once, then play on to the end. The result must match a straight playback.
+run_test "Seek" --demo_seek_test 20
+if ! grep -q "Seek to update" $user_doc_path/replay.log; then
+    echo "ERROR: The seek test never seeked, see $user_doc_path/replay.log"
     exit 1
 fi
 
-# Diff Log Results of the test replay.log and the base one.
-
-if [ ! -f $user_doc_path/replay.log ]; then
-    echo "ERROR: Missing $user_doc_path/replay.log - No log generated?"
+# Seek back again, restoring the keyframe snapshot in place and checking it against the serialized keyframe.
+run_test "Snapshot" --demo_seek_test 20 --verify_snapshots
+if ! grep -q "in place in" $user_doc_path/replay.log || ! grep -q "Snapshot restore verified" $user_doc_path/replay.log; then
+    echo "ERROR: The snapshot test never restored a snapshot in place, see $user_doc_path/replay.log"
+    exit 1
+fi
+if grep -q "Snapshot restore mismatch" $user_doc_path/replay.log; then
+    echo "ERROR: The state restored in place does not match the serialized keyframe, see $user_doc_path/replay.log"
+    exit 1
+fi
+if ! grep -q "Seek to update" $user_doc_path/replay.log; then
+    echo "ERROR: The snapshot test never finished the seek, see $user_doc_path/replay.log"
     exit 1
 fi
 
-if [ ! -f $demo_log_path ]; then
-    echo "ERROR: Missing $demo_log_path - did you not checkout the latest code?"
+# Simulate on the worker thread while the previous frame is presented. The result must match a straight playback.
+run_test "Pipelined" --pipelined_frames
+if ! grep -q "Pipelined frames:" $user_doc_path/the_force_engine_log.txt; then
+    echo "ERROR: The pipelined test never ran a pipelined frame, see $user_doc_path/the_force_engine_log.txt"
     exit 1
-fi    
+fi
 
-result=`diff <(tail -n 1 $user_doc_path/replay.log) <(tail -n 1 $demo_log_path)`
+# Check the GPU renderer traversal cache against the full traversal. The result must match a straight playback.
+run_test "Traversal" --verify_traversal 600
+if ! grep -q "Traversal cache: .* frames verified" $user_doc_path/the_force_engine_log.txt; then
+    echo "ERROR: The traversal test never verified a frame, it requires the GPU renderer. See $user_doc_path/the_force_engine_log.txt"
+    exit 1
+fi
+if grep -q "Traversal cache mismatch" $user_doc_path/the_force_engine_log.txt; then
+    echo "ERROR: The traversal cache does not match the full traversal, see $user_doc_path/the_force_engine_log.txt"
+    exit 1
+fi
 
-if $result > /dev/null; then
-    echo "TEST SUCCEEDED RESULTS MATCH!"
-    exit 0
-else
-    echo "ERROR: RESULTS DO NOT MATCH!"
-    echo $result
+# Render the OPL3 benchmark script with the block and per-sample paths at startup, the outputs must match.
+run_test "OPL3" --verify_opl3 30
+if ! grep -q "OPL3 synth cost per second of audio: .* output matches" $user_doc_path/the_force_engine_log.txt; then
+    echo "ERROR: The OPL3 block render output does not match the per-sample path, see $user_doc_path/the_force_engine_log.txt"
     exit 1
 fi
+
+echo "ALL TESTS SUCCEEDED!"
+exit 0
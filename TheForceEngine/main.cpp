@@ -19,8 +19,10 @@
 #include <TFE_System/system.h>
 #include <TFE_System/CrashHandler/crashHandler.h>
 #include <TFE_System/frameLimiter.h>
+#include <TFE_System/framePipeline.h>
 #include <TFE_System/tfeMessage.h>
 #include <TFE_Jedi/Task/task.h>
+#include <TFE_Jedi/Renderer/virtualFramebuffer.h>
 #include <TFE_RenderShared/texturePacker.h>
 #include <TFE_Asset/paletteAsset.h>
 #include <TFE_Asset/imageAsset.h>
@@ -421,6 +423,26 @@ bool systemMenuKeyCombo()
 	return TFE_System::systemUiRequestPosted() || (inputMapping_getActionState(IAS_SYSTEM_MENU) == STATE_PRESSED);
 }
 
+// Simulation step run on the worker thread for pipelined frames.
+bool runGameTasks()
+{
+	return TFE_Jedi::task_run() != 0;
+}
+
+void logPipelineStats()
+{
+	TFE_System::FramePipelineStats pipeline;
+	TFE_System::framePipeline_getStats(&pipeline);
+	if (!pipeline.frameCount) { return; }
+
+	TFE_System::FrameTimeStats frames;
+	TFE_System::frameLimiter_getStats(&frames);
+	TFE_System::logWrite(LOG_MSG, "Pipeline", "Frames: %u, average: %0.3fms, p50: %0.3fms, p99: %0.3fms, max: %0.3fms.", frames.frameCount,
+		frames.average * 1000.0, frames.p50 * 1000.0, frames.p99 * 1000.0, frames.max * 1000.0);
+	TFE_System::logWrite(LOG_MSG, "Pipeline", "Pipelined frames: %u, simulation: %0.3fms average, %0.3fms max, present: %0.3fms, wait: %0.3fms.",
+		pipeline.frameCount, pipeline.simAverage * 1000.0, pipeline.simMax * 1000.0, pipeline.presentAverage * 1000.0, pipeline.waitAverage * 1000.0);
+}
+
 void parseCommandLine(s32 argc, char* argv[])
 {
 	if (argc < 1) { return; }
@@ -682,8 +704,12 @@ int main(int argc, char* argv[])
 	TFE_SaveSystem::setCurrentGame(gameInfo->id);
 
 	// Setup the framelimiter.
+	TFE_System::frameLimiter_setPacing(graphics->precisePacing ? TFE_System::FRAME_PACING_PRECISE : TFE_System::FRAME_PACING_SLEEP);
 	TFE_System::frameLimiter_set(graphics->frameRateLimit);
 
+	// Pipelined frames.
+	TFE_System::framePipeline_enable(graphics->pipelinedFrames || TFE_Settings::getTempSettings()->forcePipelinedFrames);
+
 	// Start reading the mods immediately?
 	TFE_FrontEndUI::modLoader_read();
 
@@ -915,6 +941,7 @@ int main(int argc, char* argv[])
 
 		const bool isConsoleOpen = TFE_FrontEndUI::isConsoleOpen();
 		bool endInputFrame = true;
+		bool pipelineFrame = false;
 		if (s_curState == APP_STATE_EDITOR)
 		{
 		#if ENABLE_EDITOR == 1
@@ -934,7 +961,15 @@ int main(int argc, char* argv[])
 			{
 				TFE_SaveSystem::update();
 				s_curGame->loopGame();
-				endInputFrame = TFE_Jedi::task_run() != 0;
+
+				// A pipelined simulation step is started once the UI has been built, see below.
+				pipelineFrame = TFE_System::framePipeline_isEnabled() && s_curGame->canPipelineFrame();
+				if (!pipelineFrame)
+				{
+					// Present any frame left over from the last pipelined step before drawing a new one.
+					TFE_Jedi::vfb_presentSnapshot();
+					endInputFrame = TFE_Jedi::task_run() != 0;
+				}
 			}
 		}
 		else
@@ -963,9 +998,30 @@ int main(int argc, char* argv[])
 		}
 	#endif
 
+		// Simulate the next frame on the worker thread while the previous one is presented.
+		// The game and UI state are not touched by the main thread until the step is done.
+		if (pipelineFrame && !(s_curGame && s_curGame->canPipelineFrame()))
+		{
+			// The UI changed the game state, such as the renderer, so run this step on the main thread.
+			pipelineFrame = false;
+			TFE_Jedi::vfb_presentSnapshot();
+			endInputFrame = s_curGame ? TFE_Jedi::task_run() != 0 : true;
+		}
+		else if (pipelineFrame)
+		{
+			TFE_System::framePipeline_beginSim(runGameTasks);
+			TFE_Jedi::vfb_presentSnapshot();
+		}
+
 		// Blit the frame to the window and draw UI.
 		TFE_RenderBackend::swap(swap);
 
+		if (pipelineFrame)
+		{
+			endInputFrame = TFE_System::framePipeline_endSim();
+			TFE_Jedi::vfb_flipSnapshot();
+		}
+
 		// Handle framerate limiter.
 		TFE_System::frameLimiter_end();
 
@@ -1017,6 +1073,9 @@ int main(int argc, char* argv[])
 	}
 #endif
 
+	logPipelineStats();
+	TFE_System::framePipeline_destroy();
+
 	if (s_curGame)
 	{
 		freeGame(s_curGame);
@@ -1113,5 +1172,30 @@ void parseOption(const char* name, const std::vector<const char*>& values, bool
 		{
 			TFE_Settings::getTempSettings()->exit_after_replay = true;
 		}
+		else if (strcasecmp(name, "pipelined_frames") == 0)
+		{
+			// --pipelined_frames, frame timings are written to the log on exit.
+			TFE_Settings::getTempSettings()->forcePipelinedFrames = true;
+		}
+		else if (strcasecmp(name, "demo_seek_test") == 0 && values.size() >= 1)
+		{
+			// --demo_seek_test <seconds>, playback seeks back to half this time once and then continues.
+			TFE_Settings::getTempSettings()->demoSeekTest = (f32)atof(values[0]);
+		}
+		else if (strcasecmp(name, "verify_snapshots") == 0)
+		{
+			// --verify_snapshots, states restored in place by rewind and demo seeking are checked against the load path.
+			TFE_Settings::getTempSettings()->verifySnapshots = true;
+		}
+		else if (strcasecmp(name, "verify_traversal") == 0 && values.size() >= 1)
+		{
+			// --verify_traversal <frames>, the GPU renderer checks its traversal cache against the full traversal.
+			TFE_Settings::getTempSettings()->verifyTraversalFrames = atoi(values[0]);
+		}
+		else if (strcasecmp(name, "verify_opl3") == 0 && values.size() >= 1)
+		{
+			// --verify_opl3 <seconds>, the OPL3 block render path is checked against the per-sample path at startup.
+			TFE_Settings::getTempSettings()->verifyOpl3Seconds = (f32)atof(values[0]);
+		}
 	}
 }
\ No newline at end of file